@@ -11,8 +11,16 @@
 
 #if POLYMEC_HAVE_DOUBLE_PRECISION
 #define NC_REAL NC_DOUBLE
+#define nc_put_vara_real nc_put_vara_double
+#define nc_get_vara_real nc_get_vara_double
+#define nc_get_vars_real nc_get_vars_double
+#define nc_get_var_real nc_get_var_double
 #else
 #define NC_REAL NC_FLOAT
+#define nc_put_vara_real nc_put_vara_float
+#define nc_get_vara_real nc_get_vara_float
+#define nc_get_vars_real nc_get_vars_float
+#define nc_get_var_real nc_get_var_float
 #endif
 
 struct cf_file_t 
@@ -25,10 +33,16 @@ struct cf_file_t
   int time_id, time_dim, lat_id, lat_dim, lon_id, lon_dim, lev_id, lev_dim;
   char lev_name[POLYGLOT_CF_MAX_NAME+1];
 
-  // Lat-lon variable metadata/indices.
-  int nlat, nlon, nlev;
+  // Lat-lon variable metadata/indices. The grid dimensions and the length 
+  // of the time series are cached here so that reads and writes needn't 
+  // query them.
+  int nlat, nlon, nlev, num_times;
   string_int_unordered_map_t *ll_vars, *td_ll_vars;
   string_int_unordered_map_t *ll_surface_vars, *td_ll_surface_vars;
+
+  // Storage type and policy for newly defined lat-lon variables.
+  nc_type var_type;
+  cf_storage_policy_t storage;
 };
 
 // Helpers.
@@ -190,6 +204,129 @@ static void find_vertical_coordinate(int file_id, int* lev_id, int* lev_dim, cha
   polymec_error("Could not identify vertical coordinate from file metadata.");
 }
 
+// Narrows n real numbers in x to single precision, storing them in y.
+static void narrow_reals(size_t n, const real_t* x, float* y)
+{
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (size_t i = 0; i < n; ++i)
+    y[i] = (float)x[i];
+}
+
+// Widens n single-precision numbers in x to real numbers, storing them in y.
+static void widen_floats(size_t n, const float* x, real_t* y)
+{
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (size_t i = 0; i < n; ++i)
+    y[i] = (real_t)x[i];
+}
+
+// Writes real-valued data to the hyperslab of the given variable described 
+// by start and count. If the variable is stored in single precision, the data 
+// is narrowed here so that NetCDF needn't convert it value by value.
+static int put_real_vara(int file_id, 
+                         int var_id, 
+                         const size_t* start,
+                         const size_t* count,
+                         real_t* data)
+{
+  nc_type type;
+  int err = nc_inq_vartype(file_id, var_id, &type);
+  if (err != NC_NOERR)
+    return err;
+  if ((type != NC_FLOAT) || (sizeof(real_t) == sizeof(float)))
+    return nc_put_vara_real(file_id, var_id, start, count, data);
+
+  int ndims;
+  nc_inq_varndims(file_id, var_id, &ndims);
+  size_t n = 1;
+  for (int d = 0; d < ndims; ++d)
+    n *= count[d];
+  float* fdata = polymec_malloc(sizeof(float) * n);
+  narrow_reals(n, data, fdata);
+  err = nc_put_vara_float(file_id, var_id, start, count, fdata);
+  polymec_free(fdata);
+  return err;
+}
+
+// Reads real-valued data from the hyperslab of the given variable described 
+// by start, count, and stride (NULL for unit strides), widening it from 
+// single precision if that's how it's stored.
+static int get_real_vars(int file_id, 
+                         int var_id, 
+                         const size_t* start,
+                         const size_t* count,
+                         const ptrdiff_t* stride,
+                         real_t* data)
+{
+  nc_type type;
+  int err = nc_inq_vartype(file_id, var_id, &type);
+  if (err != NC_NOERR)
+    return err;
+  if ((type != NC_FLOAT) || (sizeof(real_t) == sizeof(float)))
+    return nc_get_vars_real(file_id, var_id, start, count, stride, data);
+
+  int ndims;
+  nc_inq_varndims(file_id, var_id, &ndims);
+  size_t n = 1;
+  for (int d = 0; d < ndims; ++d)
+    n *= count[d];
+  float* fdata = polymec_malloc(sizeof(float) * n);
+  err = nc_get_vars_float(file_id, var_id, start, count, stride, fdata);
+  if (err == NC_NOERR)
+    widen_floats(n, fdata, data);
+  polymec_free(fdata);
+  return err;
+}
+
+// Looks up the ID of the given lat-lon variable (surface or not) and sets up 
+// start/count arrays for its data at the num_times times beginning at the 
+// given time index. Returns the ID.
+static int latlon_var_slab(cf_file_t* file, 
+                           const char* var_name, 
+                           bool surface,
+                           int time_index,
+                           int num_times,
+                           size_t* start,
+                           size_t* count)
+{
+  string_int_unordered_map_t* td_vars = (surface) ? file->td_ll_surface_vars : file->td_ll_vars;
+  string_int_unordered_map_t* vars = (surface) ? file->ll_surface_vars : file->ll_vars;
+
+  int var_id, d = 0;
+  int* var_id_p = string_int_unordered_map_get(td_vars, (char*)var_name);
+  if (var_id_p != NULL)
+  {
+    ASSERT(time_index >= 0);
+    ASSERT(num_times >= 1);
+    ASSERT(time_index + num_times <= file->num_times);
+    var_id = *var_id_p;
+    start[d] = (size_t)time_index;
+    count[d++] = (size_t)num_times;
+  }
+  else
+  {
+    var_id_p = string_int_unordered_map_get(vars, (char*)var_name);
+    ASSERT(var_id_p != NULL);
+    ASSERT(num_times == 1);
+    var_id = *var_id_p;
+  }
+
+  if (!surface)
+  {
+    start[d] = 0;
+    count[d++] = (size_t)file->nlev;
+  }
+  start[d] = 0;
+  count[d++] = (size_t)file->nlat;
+  start[d] = 0;
+  count[d++] = (size_t)file->nlon;
+  return var_id;
+}
+
 // Implementation.
 
 cf_file_t* cf_file_new(const char* filename)
@@ -210,10 +347,13 @@ cf_file_t* cf_file_new(const char* filename)
   cf->time_dim = cf->lat_dim = cf->lon_dim = cf->lev_dim = -1;
   strcpy(cf->lev_name, "lev");
   cf->nlat = cf->nlon = cf->nlev = -1;
+  cf->num_times = 0;
   cf->ll_vars = string_int_unordered_map_new();
   cf->td_ll_vars = string_int_unordered_map_new();
   cf->ll_surface_vars = string_int_unordered_map_new();
   cf->td_ll_surface_vars = string_int_unordered_map_new();
+  cf->var_type = NC_REAL;
+  cf->storage = cf_default_storage_policy();
 
   // Write in our conventions.
   char conventions[NC_MAX_NAME+1];
@@ -251,10 +391,13 @@ cf_file_t* cf_file_open(const char* filename)
   cf->time_id = cf->lat_id = cf->lon_id = cf->lev_id = -1;
   cf->time_dim = cf->lat_dim = cf->lon_dim = cf->lev_dim = -1;
   cf->nlat = cf->nlon = cf->nlev = -1;
+  cf->num_times = 0;
   cf->ll_vars = string_int_unordered_map_new();
   cf->td_ll_vars = string_int_unordered_map_new();
   cf->ll_surface_vars = string_int_unordered_map_new();
   cf->td_ll_surface_vars = string_int_unordered_map_new();
+  cf->var_type = NC_REAL;
+  cf->storage = cf_default_storage_policy();
 
   // Parse the CF conventions version numbers from the string.
   int num;
@@ -294,6 +437,11 @@ cf_file_t* cf_file_open(const char* filename)
   {
     cf->time_dim = dim_id;
     cf->time_id = var_identifier(cf->file_id, "time");
+    size_t num_times;
+    err = nc_inq_dimlen(cf->file_id, cf->time_dim, &num_times);
+    if (err != NC_NOERR)
+      polymec_error("cf_file_open: Error finding length of time series: %s", nc_strerror(err));
+    cf->num_times = (int)num_times;
   }
   else if (err != NC_EBADDIM)
     polymec_error("cf_file_open: Error retrieving time dim ID: ", nc_strerror(err));
@@ -586,17 +734,17 @@ void cf_file_read_latlon_grid(cf_file_t* file,
   ASSERT(cf_file_has_latlon_grid(file));
 
   // Latitude.
-  int err = nc_get_var(file->file_id, file->lat_id, latitude_points);
+  int err = nc_get_var_real(file->file_id, file->lat_id, latitude_points);
   if (err != NC_NOERR)
     polymec_error("cf_file_get_latlon_points: Error retrieving latitudes.");
 
   // Longitude.
-  err = nc_get_var(file->file_id, file->lon_id, longitude_points);
+  err = nc_get_var_real(file->file_id, file->lon_id, longitude_points);
   if (err != NC_NOERR)
     polymec_error("cf_file_get_latlon_points: Error retrieving longitudes.");
 
   // Vertical.
-  err = nc_get_var(file->file_id, file->lev_id, vertical_points);
+  err = nc_get_var_real(file->file_id, file->lev_id, vertical_points);
   if (err != NC_NOERR)
     polymec_error("cf_file_get_latlon_points: Error retrieving vertical coordinates.");
 }
@@ -639,37 +787,159 @@ void cf_file_get_time_metadata(cf_file_t* file,
 }
 
 int cf_file_append_time(cf_file_t* file, real_t t)
+{
+  return cf_file_append_times(file, 1, &t);
+}
+
+int cf_file_append_times(cf_file_t* file, int num_times, real_t* times)
 {
   ASSERT(cf_file_has_time_series(file));
+  ASSERT(num_times >= 1);
 
-  size_t size = (size_t)cf_file_num_times(file);
-  int err = nc_put_var1(file->file_id, file->time_id, &size, &t);
+  size_t start = (size_t)file->num_times, count = (size_t)num_times;
+  int err = nc_put_vara_real(file->file_id, file->time_id, &start, &count, times);
   if (err != NC_NOERR)
-    polymec_error("cf_file_append_time: Error appending time t = %g: %s", t, nc_strerror(err));
+    polymec_error("cf_file_append_times: Error appending %d times: %s", num_times, nc_strerror(err));
+  file->num_times += num_times;
 
-  return (int)size;
+  return (int)start;
 }
 
 int cf_file_num_times(cf_file_t* file)
 {
-  if (!cf_file_has_time_series(file))
-    return 0;
-
-  // Find the size of the time series.
-  size_t size;
-  int err = nc_inq_dimlen(file->file_id, file->time_id, &size);
-  if (err != NC_NOERR)
-    polymec_error("cf_file_append_time: Error finding length of time series: %s", nc_strerror(err));
-  return (int)size;
+  return file->num_times;
 }
 
 void cf_file_get_times(cf_file_t* file, real_t* times)
 {
-  int err = nc_get_var(file->file_id, file->time_id, times);
+  int err = nc_get_var_real(file->file_id, file->time_id, times);
   if (err != NC_NOERR)
     polymec_error("cf_file_get_times: Error retrieving times.");
 }
 
+void cf_file_set_single_precision(cf_file_t* file, bool single_precision)
+{
+  ASSERT(file->writing);
+  file->var_type = (single_precision) ? NC_FLOAT : NC_REAL;
+}
+
+cf_storage_policy_t cf_default_storage_policy()
+{
+  cf_storage_policy_t policy = {.chunking = CF_CHUNK_DEFAULT, 
+                                .num_chunk_times = 0,
+                                .deflate_level = 0, 
+                                .shuffle = false,
+                                .chunk_cache_size = 0};
+  return policy;
+}
+
+void cf_file_set_storage_policy(cf_file_t* file, 
+                                cf_storage_policy_t* policy)
+{
+  ASSERT(file->writing);
+  ASSERT(policy->num_chunk_times >= 0);
+  ASSERT(policy->deflate_level >= 0);
+  ASSERT(policy->deflate_level <= 9);
+  file->storage = *policy;
+}
+
+// Number of times in each chunk of a variable chunked for time series 
+// access, unless the storage policy says otherwise.
+static const int default_num_chunk_times = 64;
+
+// Number of latitudes and longitudes in the tiles of a variable chunked for 
+// time series access.
+static const int time_series_tile_size = 32;
+
+// HDF5's limit on the size of a chunk (in bytes). Time slices of very fine 
+// grids are split into groups of levels (and latitudes) to stay below it.
+static const size_t max_chunk_bytes = ((size_t)1 << 32) - 1;
+
+// Chunk cache parameters for CF variables. Our chunks are whole time 
+// slices (or tiles of time series), so a cache holds relatively few of 
+// them, and NetCDF's default number of hash slots (a prime) is ample. A 
+// chunk that has been read or written in full isn't revisited as we step 
+// through time, so it is always the first to be preempted.
+static const size_t chunk_cache_slots = 1009;
+static const float chunk_cache_preemption = 1.0;
+
+// Applies the file's storage policy to the newly-defined lat-lon variable 
+// (surface or not) with the given ID.
+static void apply_storage_policy(cf_file_t* file,
+                                 const char* var_name,
+                                 int var_id,
+                                 bool time_dependent,
+                                 bool surface)
+{
+  cf_storage_policy_t* policy = &file->storage;
+  int err;
+  if (policy->chunking != CF_CHUNK_DEFAULT)
+  {
+    // Time slices hold every point in the grid at a single time, and time 
+    // series hold a few points at many times.
+    bool slices = (policy->chunking == CF_CHUNK_TIME_SLICE);
+    size_t chunks[4];
+    int d = 0;
+    if (time_dependent)
+    {
+      int num_chunk_times = (policy->num_chunk_times > 0) ? policy->num_chunk_times 
+                                                          : default_num_chunk_times;
+      chunks[d++] = (slices) ? 1 : (size_t)num_chunk_times;
+    }
+    size_t nlev = (size_t)((slices) ? file->nlev : 1);
+    size_t nlat = (size_t)((slices) ? file->nlat : MIN(file->nlat, time_series_tile_size));
+    size_t nlon = (size_t)((slices) ? file->nlon : MIN(file->nlon, time_series_tile_size));
+    if (slices)
+    {
+      // Split the levels, and then the latitudes, of a slice that's too big 
+      // for a single chunk.
+      nc_type type;
+      size_t value_size;
+      nc_inq_vartype(file->file_id, var_id, &type);
+      nc_inq_type(file->file_id, type, NULL, &value_size);
+      size_t max_chunk_values = max_chunk_bytes / value_size;
+      if (!surface)
+        nlev = MIN(nlev, MAX(max_chunk_values / (nlat * nlon), 1));
+      nlat = MIN(nlat, MAX(max_chunk_values / nlon, 1));
+    }
+    if (!surface)
+      chunks[d++] = nlev;
+    chunks[d++] = nlat;
+    chunks[d++] = nlon;
+    err = nc_def_var_chunking(file->file_id, var_id, NC_CHUNKED, chunks);
+    if (err != NC_NOERR)
+      polymec_error("cf_file: Error chunking var %s: %s", var_name, nc_strerror(err));
+  }
+
+  if ((policy->deflate_level > 0) || policy->shuffle)
+  {
+    err = nc_def_var_deflate(file->file_id, var_id, (policy->shuffle) ? 1 : 0, 
+                             (policy->deflate_level > 0) ? 1 : 0, 
+                             policy->deflate_level);
+    if (err != NC_NOERR)
+      polymec_error("cf_file: Error compressing var %s: %s", var_name, nc_strerror(err));
+  }
+
+  if (policy->chunk_cache_size > 0)
+    cf_file_set_var_chunk_cache(file, var_name, policy->chunk_cache_size);
+}
+
+void cf_file_set_var_chunk_cache(cf_file_t* file,
+                                 const char* var_name,
+                                 size_t cache_size)
+{
+  ASSERT(cache_size > 0);
+  int var_id = var_identifier(file->file_id, var_name);
+  ASSERT(var_id != -1);
+  int err = nc_set_var_chunk_cache(file->file_id, var_id, cache_size, 
+                                   chunk_cache_slots, chunk_cache_preemption);
+  if (err != NC_NOERR)
+  {
+    polymec_error("cf_file_set_var_chunk_cache: Error setting chunk cache for var %s: %s", 
+                  var_name, nc_strerror(err));
+  }
+}
+
 void cf_file_define_latlon_var(cf_file_t* file, 
                                const char* var_name,
                                bool time_dependent,
@@ -687,7 +957,7 @@ void cf_file_define_latlon_var(cf_file_t* file,
   {
     ASSERT(cf_file_has_time_series(file));
     int dims[4] = {file->time_dim, file->lev_dim, file->lat_dim, file->lon_dim};
-    int err = nc_def_var(file->file_id, var_name, NC_REAL, 4, dims, &var_id);
+    int err = nc_def_var(file->file_id, var_name, file->var_type, 4, dims, &var_id);
     if (err != NC_NOERR)
       polymec_error("cf_file_define_latlon_var: Error defining var %s: %s", var_name, nc_strerror(err));
     string_int_unordered_map_insert_with_k_dtor(file->td_ll_vars, string_dup(var_name), var_id, string_free);
@@ -695,12 +965,15 @@ void cf_file_define_latlon_var(cf_file_t* file,
   else
   {
     int dims[3] = {file->lev_dim, file->lat_dim, file->lon_dim};
-    int err = nc_def_var(file->file_id, var_name, NC_REAL, 3, dims, &var_id);
+    int err = nc_def_var(file->file_id, var_name, file->var_type, 3, dims, &var_id);
     if (err != NC_NOERR)
       polymec_error("cf_file_define_latlon_var: Error defining var %s: %s", var_name, nc_strerror(err));
     string_int_unordered_map_insert_with_k_dtor(file->ll_vars, string_dup(var_name), var_id, string_free);
   }
 
+  // Storage.
+  apply_storage_policy(file, var_name, var_id, time_dependent, false);
+
   // Metadata.
   put_attribute(file->file_id, var_id, "short_name", short_name);
   put_attribute(file->file_id, var_id, "long_name", long_name);
@@ -734,39 +1007,11 @@ void cf_file_write_latlon_var(cf_file_t* file,
 {
   ASSERT(cf_file_has_latlon_var(file, var_name));
 
-  int var_id = var_identifier(file->file_id, var_name);
-
-  // If we don't have a time series, we just write the whole thing.
-  if (!cf_file_has_time_series(file))
-  {
-    int err = nc_put_var(file->file_id, var_id, var_data);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_var: Error writing data for var %s: %s", var_name, nc_strerror(err));
-  }
-  // Otherwise, we get fancy and write a hyper slice.
-  else
-  {
-    ASSERT(time_index >= 0);
-    ASSERT(time_index < cf_file_num_times(file));
-
-    // Size up the dimensions.
-    size_t lat_len, lon_len, lev_len;
-    int err = nc_inq_dimlen(file->file_id, file->lat_dim, &lat_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_var: Error getting lat dimension %s", nc_strerror(err));
-    err = nc_inq_dimlen(file->file_id, file->lon_dim, &lon_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_var: Error getting lon dimension %s", nc_strerror(err));
-    err = nc_inq_dimlen(file->file_id, file->lev_dim, &lev_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_var: Error getting lev dimension %s", nc_strerror(err));
-
-    size_t startp[4] = {time_index, 0, 0, 0};
-    size_t countp[4] = {1, lev_len, lat_len, lon_len};
-    err = nc_put_vara(file->file_id, var_id, startp, countp, var_data);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_var: Error writing data for var %s: %s", var_name, nc_strerror(err));
-  }
+  size_t start[4], count[4];
+  int var_id = latlon_var_slab(file, var_name, false, time_index, 1, start, count);
+  int err = put_real_vara(file->file_id, var_id, start, count, var_data);
+  if (err != NC_NOERR)
+    polymec_error("cf_file_write_latlon_var: Error writing data for var %s: %s", var_name, nc_strerror(err));
 }
 
 void cf_file_read_latlon_var(cf_file_t* file, 
@@ -776,50 +1021,11 @@ void cf_file_read_latlon_var(cf_file_t* file,
 {
   ASSERT(cf_file_has_latlon_var(file, var_name));
 
-  bool time_dependent = false;
-  int var_id;
-  int* var_id_p = string_int_unordered_map_get(file->td_ll_vars, (char*)var_name);
-  if (var_id_p != NULL)
-    var_id = *var_id_p; 
-  else
-  {
-    var_id_p = string_int_unordered_map_get(file->ll_vars, (char*)var_name);
-    ASSERT(var_id_p != NULL);
-    time_dependent = true;
-    var_id = *var_id_p;
-  }
-
-  // If we don't have a time series, we just write the whole thing.
-  if (!time_dependent)
-  {
-    int err = nc_get_var(file->file_id, var_id, var_data);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_var: Error reading data for var %s: %s", var_name, nc_strerror(err));
-  }
-  // Otherwise, we get fancy and read a hyper slice.
-  else
-  {
-    ASSERT(time_index >= 0);
-    ASSERT(time_index < cf_file_num_times(file));
-
-    // Size up the dimensions.
-    size_t lat_len, lon_len, lev_len;
-    int err = nc_inq_dimlen(file->file_id, file->lat_dim, &lat_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_var: Error getting lat dimension %s", nc_strerror(err));
-    err = nc_inq_dimlen(file->file_id, file->lon_dim, &lon_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_var: Error getting lon dimension %s", nc_strerror(err));
-    err = nc_inq_dimlen(file->file_id, file->lev_dim, &lev_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_var: Error getting lev dimension %s", nc_strerror(err));
-
-    size_t startp[4] = {time_index, 0, 0, 0};
-    size_t countp[4] = {1, lev_len, lat_len, lon_len};
-    err = nc_get_vara(file->file_id, var_id, startp, countp, var_data);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_var: Error writing data for var %s: %s", var_name, nc_strerror(err));
-  }
+  size_t start[4], count[4];
+  int var_id = latlon_var_slab(file, var_name, false, time_index, 1, start, count);
+  int err = get_real_vars(file->file_id, var_id, start, count, NULL, var_data);
+  if (err != NC_NOERR)
+    polymec_error("cf_file_read_latlon_var: Error reading data for var %s: %s", var_name, nc_strerror(err));
 }
 
 void cf_file_define_latlon_surface_var(cf_file_t* file, 
@@ -840,7 +1046,7 @@ void cf_file_define_latlon_surface_var(cf_file_t* file,
     ASSERT(cf_file_has_time_series(file));
 
     int dims[3] = {file->time_dim, file->lat_dim, file->lon_dim};
-    int err = nc_def_var(file->file_id, var_name, NC_REAL, 3, dims, &var_id);
+    int err = nc_def_var(file->file_id, var_name, file->var_type, 3, dims, &var_id);
     if (err != NC_NOERR)
       polymec_error("cf_file_define_latlon_surface_var: Error defining var %s: %s", var_name, nc_strerror(err));
     string_int_unordered_map_insert_with_k_dtor(file->td_ll_surface_vars, string_dup(var_name), var_id, string_free);
@@ -848,12 +1054,15 @@ void cf_file_define_latlon_surface_var(cf_file_t* file,
   else
   {
     int dims[2] = {file->lat_dim, file->lon_dim};
-    int err = nc_def_var(file->file_id, var_name, NC_REAL, 2, dims, &var_id);
+    int err = nc_def_var(file->file_id, var_name, file->var_type, 2, dims, &var_id);
     if (err != NC_NOERR)
       polymec_error("cf_file_define_latlon_surface_var: Error defining var %s: %s", var_name, nc_strerror(err));
     string_int_unordered_map_insert_with_k_dtor(file->ll_surface_vars, string_dup(var_name), var_id, string_free);
   }
 
+  // Storage.
+  apply_storage_policy(file, var_name, var_id, time_dependent, true);
+
   // Metadata.
   put_attribute(file->file_id, var_id, "short_name", short_name);
   put_attribute(file->file_id, var_id, "long_name", long_name);
@@ -883,36 +1092,11 @@ void cf_file_write_latlon_surface_var(cf_file_t* file,
 {
   ASSERT(cf_file_has_latlon_surface_var(file, var_name));
 
-  int var_id = var_identifier(file->file_id, var_name);
-
-  // If we don't have a time series, we just write the whole thing.
-  if (!cf_file_has_time_series(file))
-  {
-    int err = nc_put_var(file->file_id, var_id, var_data);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_surface_var: Error writing data for var %s: %s", var_name, nc_strerror(err));
-  }
-  // Otherwise, we get fancy and write a hyper slice.
-  else
-  {
-    ASSERT(time_index >= 0);
-    ASSERT(time_index < cf_file_num_times(file));
-
-    // Size up the dimensions.
-    size_t lat_len, lon_len;
-    int err = nc_inq_dimlen(file->file_id, file->lat_dim, &lat_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_surface_var: Error getting lat dimension %s", nc_strerror(err));
-    err = nc_inq_dimlen(file->file_id, file->lon_dim, &lon_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_surface_var: Error getting lon dimension %s", nc_strerror(err));
-
-    size_t startp[4] = {time_index, 0, 0};
-    size_t countp[4] = {1, lat_len, lon_len};
-    err = nc_put_vara(file->file_id, var_id, startp, countp, var_data);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_write_latlon_surface_var: Error writing data for var %s: %s", var_name, nc_strerror(err));
-  }
+  size_t start[4], count[4];
+  int var_id = latlon_var_slab(file, var_name, true, time_index, 1, start, count);
+  int err = put_real_vara(file->file_id, var_id, start, count, var_data);
+  if (err != NC_NOERR)
+    polymec_error("cf_file_write_latlon_surface_var: Error writing data for var %s: %s", var_name, nc_strerror(err));
 }
 
 void cf_file_read_latlon_surface_var(cf_file_t* file, 
@@ -922,46 +1106,253 @@ void cf_file_read_latlon_surface_var(cf_file_t* file,
 {
   ASSERT(cf_file_has_latlon_surface_var(file, var_name));
 
-  bool time_dependent = false;
-  int var_id;
-  int* var_id_p = string_int_unordered_map_get(file->td_ll_vars, (char*)var_name);
-  if (var_id_p != NULL)
-    var_id = *var_id_p; 
+  size_t start[4], count[4];
+  int var_id = latlon_var_slab(file, var_name, true, time_index, 1, start, count);
+  int err = get_real_vars(file->file_id, var_id, start, count, NULL, var_data);
+  if (err != NC_NOERR)
+    polymec_error("cf_file_read_latlon_surface_var: Error reading data for var %s: %s", var_name, nc_strerror(err));
+}
+
+
+void cf_file_find_latlon_region(cf_file_t* file,
+                                real_t min_latitude,
+                                real_t max_latitude,
+                                real_t min_longitude,
+                                real_t max_longitude,
+                                cf_latlon_region_t* region)
+{
+  ASSERT(cf_file_has_latlon_grid(file));
+  ASSERT(min_latitude <= max_latitude);
+
+  real_t* lat = polymec_malloc(sizeof(real_t) * (file->nlat + file->nlon));
+  real_t* lon = &lat[file->nlat];
+  int err = nc_get_var_real(file->file_id, file->lat_id, lat);
+  if (err == NC_NOERR)
+    err = nc_get_var_real(file->file_id, file->lon_id, lon);
+  if (err != NC_NOERR)
+    polymec_error("cf_file_find_latlon_region: Error retrieving lat-lon points: %s", nc_strerror(err));
+
+  // Latitudes may ascend or descend, so we take the smallest index range 
+  // that contains the ones within the box.
+  region->first_level = 0;
+  region->num_levels = file->nlev;
+  region->first_lat = file->nlat;
+  region->num_lats = 0;
+  region->lat_stride = 1;
+  int last_lat = -1;
+  for (int j = 0; j < file->nlat; ++j)
+  {
+    if ((lat[j] >= min_latitude) && (lat[j] <= max_latitude))
+    {
+      region->first_lat = MIN(region->first_lat, j);
+      last_lat = j;
+    }
+  }
+  if (last_lat == -1)
+    region->first_lat = 0;
   else
+    region->num_lats = last_lat - region->first_lat + 1;
+
+  // Longitudes are periodic, so we measure each one eastward from the 
+  // western edge of the box, which crosses the dateline if its eastern edge 
+  // lies to the west of its western edge.
+  real_t width = max_longitude - min_longitude;
+  bool whole_globe = (width >= 360.0);
+  while (width < 0.0) 
+    width += 360.0;
+  int num_inside = 0;
+  bool* inside = polymec_malloc(sizeof(bool) * MAX(file->nlon, 1));
+  for (int i = 0; i < file->nlon; ++i)
   {
-    var_id_p = string_int_unordered_map_get(file->ll_vars, (char*)var_name);
-    ASSERT(var_id_p != NULL);
-    time_dependent = true;
-    var_id = *var_id_p;
+    real_t east = fmod(lon[i] - min_longitude, 360.0);
+    if (east < 0.0)
+      east += 360.0;
+    inside[i] = whole_globe || (east <= width);
+    if (inside[i])
+      ++num_inside;
+  }
+  region->first_lon = 0;
+  region->num_lons = num_inside;
+  region->lon_stride = 1;
+  if ((num_inside > 0) && (num_inside < file->nlon))
+  {
+    // The region begins at the point inside the box that follows a point 
+    // outside it.
+    for (int i = 0; i < file->nlon; ++i)
+    {
+      if (inside[i] && !inside[(i + file->nlon - 1) % file->nlon])
+      {
+        region->first_lon = i;
+        break;
+      }
+    }
   }
+  polymec_free(inside);
+  polymec_free(lat);
+}
 
-  // If we don't have a time series, we just write the whole thing.
-  if (!time_dependent)
+// Reads the given region of a lat-lon variable (surface or not) at the given 
+// time index into data. The longitude range wraps around the end of the 
+// grid, so a region that crosses it is read as two hyperslabs whose rows 
+// are interleaved.
+static void read_latlon_region(cf_file_t* file, 
+                               const char* var_name,
+                               bool surface,
+                               int time_index,
+                               cf_latlon_region_t* region,
+                               real_t* data)
+{
+  ASSERT(region->lat_stride > 0);
+  ASSERT(region->lon_stride > 0);
+  ASSERT((region->first_lat >= 0) && (region->num_lats >= 0));
+  ASSERT(region->first_lat + (region->num_lats-1) * region->lat_stride < file->nlat);
+  ASSERT((region->first_lon >= 0) && (region->first_lon < file->nlon));
+  ASSERT(region->num_lons >= 0);
+  ASSERT((region->num_lons-1) * region->lon_stride < file->nlon);
+
+  size_t start[4], count[4];
+  ptrdiff_t stride[4] = {1, 1, 1, 1};
+  int var_id = latlon_var_slab(file, var_name, surface, time_index, 1, start, count);
+  string_int_unordered_map_t* td_vars = (surface) ? file->td_ll_surface_vars : file->td_ll_vars;
+  int ndims = (surface) ? 2 : 3;
+  if (string_int_unordered_map_contains(td_vars, (char*)var_name))
+    ++ndims;
+  int lev = ndims - 3, lat = ndims - 2, lon = ndims - 1;
+  if (!surface)
   {
-    int err = nc_get_var(file->file_id, var_id, var_data);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_surface_var: Error reading data for var %s: %s", var_name, nc_strerror(err));
+    ASSERT((region->first_level >= 0) && (region->num_levels >= 0));
+    ASSERT(region->first_level + region->num_levels <= file->nlev);
+    start[lev] = (size_t)region->first_level;
+    count[lev] = (size_t)region->num_levels;
+  }
+  start[lat] = (size_t)region->first_lat;
+  count[lat] = (size_t)region->num_lats;
+  stride[lat] = (ptrdiff_t)region->lat_stride;
+  start[lon] = (size_t)region->first_lon;
+  stride[lon] = (ptrdiff_t)region->lon_stride;
+
+  size_t num_rows = 1;
+  for (int d = 0; d < lon; ++d)
+    num_rows *= count[d];
+  if ((num_rows == 0) || (region->num_lons == 0))
+    return;
+
+  // How many longitudes can we read before we hit the end of the grid?
+  int num_lons = region->num_lons;
+  int lon_stride = region->lon_stride;
+  int num_east = (file->nlon - region->first_lon + lon_stride - 1) / lon_stride;
+  int err;
+  if (num_lons <= num_east)
+  {
+    count[lon] = (size_t)num_lons;
+    err = get_real_vars(file->file_id, var_id, start, count, stride, data);
   }
-  // Otherwise, we get fancy and read a hyper slice.
   else
   {
-    ASSERT(time_index >= 0);
-    ASSERT(time_index < cf_file_num_times(file));
+    // Read the eastern and western parts of the region separately and 
+    // interleave their rows.
+    real_t* part = polymec_malloc(sizeof(real_t) * num_rows * MAX(num_east, num_lons - num_east));
+    count[lon] = (size_t)num_east;
+    err = get_real_vars(file->file_id, var_id, start, count, stride, part);
+    if (err == NC_NOERR)
+    {
+      for (size_t r = 0; r < num_rows; ++r)
+        memcpy(&data[r*num_lons], &part[r*num_east], sizeof(real_t) * num_east);
+      start[lon] = (size_t)(region->first_lon + num_east * lon_stride - file->nlon);
+      count[lon] = (size_t)(num_lons - num_east);
+      err = get_real_vars(file->file_id, var_id, start, count, stride, part);
+    }
+    if (err == NC_NOERR)
+    {
+      for (size_t r = 0; r < num_rows; ++r)
+        memcpy(&data[r*num_lons + num_east], &part[r*(num_lons - num_east)], sizeof(real_t) * (num_lons - num_east));
+    }
+    polymec_free(part);
+  }
+  if (err != NC_NOERR)
+    polymec_error("cf_file: Error reading region of var %s: %s", var_name, nc_strerror(err));
+}
 
-    // Size up the dimensions.
-    size_t lat_len, lon_len;
-    int err = nc_inq_dimlen(file->file_id, file->lat_dim, &lat_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_surface_var: Error getting lat dimension %s", nc_strerror(err));
-    err = nc_inq_dimlen(file->file_id, file->lon_dim, &lon_len);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_surface_var: Error getting lon dimension %s", nc_strerror(err));
+void cf_file_read_latlon_var_region(cf_file_t* file, 
+                                    const char* var_name,
+                                    int time_index, 
+                                    cf_latlon_region_t* region,
+                                    real_t* var_data)
+{
+  ASSERT(cf_file_has_latlon_var(file, var_name));
+  read_latlon_region(file, var_name, false, time_index, region, var_data);
+}
 
-    size_t startp[3] = {time_index, 0, 0};
-    size_t countp[3] = {1, lat_len, lon_len};
-    err = nc_get_vara(file->file_id, var_id, startp, countp, var_data);
-    if (err != NC_NOERR)
-      polymec_error("cf_file_read_latlon_surface_var: Error writing data for var %s: %s", var_name, nc_strerror(err));
+void cf_file_read_latlon_surface_var_region(cf_file_t* file, 
+                                            const char* var_name,
+                                            int time_index, 
+                                            cf_latlon_region_t* region,
+                                            real_t* var_data)
+{
+  ASSERT(cf_file_has_latlon_surface_var(file, var_name));
+  read_latlon_region(file, var_name, true, time_index, region, var_data);
+}
+
+// Writes or reads the data of the given time-dependent lat-lon variable 
+// (surface or not) for num_times times beginning at the given time index 
+// in a single hyperslab.
+static void transfer_latlon_var_times(cf_file_t* file, 
+                                      const char* var_name,
+                                      bool surface,
+                                      bool writing,
+                                      int first_time_index,
+                                      int num_times,
+                                      real_t* var_data)
+{
+  size_t start[4], count[4];
+  int var_id = latlon_var_slab(file, var_name, surface, first_time_index, 
+                               num_times, start, count);
+  int err = (writing) ? put_real_vara(file->file_id, var_id, start, count, var_data)
+                      : get_real_vars(file->file_id, var_id, start, count, NULL, var_data);
+  if (err != NC_NOERR)
+  {
+    polymec_error("cf_file: Error %s data for times %d-%d of var %s: %s", 
+                  (writing) ? "writing" : "reading", first_time_index, 
+                  first_time_index + num_times - 1, var_name, nc_strerror(err));
   }
 }
 
+void cf_file_write_latlon_var_times(cf_file_t* file, 
+                                    const char* var_name,
+                                    int first_time_index, 
+                                    int num_times,
+                                    real_t* var_data)
+{
+  ASSERT(string_int_unordered_map_contains(file->td_ll_vars, (char*)var_name));
+  transfer_latlon_var_times(file, var_name, false, true, first_time_index, num_times, var_data);
+}
+
+void cf_file_read_latlon_var_times(cf_file_t* file, 
+                                   const char* var_name,
+                                   int first_time_index, 
+                                   int num_times,
+                                   real_t* var_data)
+{
+  ASSERT(string_int_unordered_map_contains(file->td_ll_vars, (char*)var_name));
+  transfer_latlon_var_times(file, var_name, false, false, first_time_index, num_times, var_data);
+}
+
+void cf_file_write_latlon_surface_var_times(cf_file_t* file, 
+                                            const char* var_name,
+                                            int first_time_index, 
+                                            int num_times,
+                                            real_t* var_data)
+{
+  ASSERT(string_int_unordered_map_contains(file->td_ll_surface_vars, (char*)var_name));
+  transfer_latlon_var_times(file, var_name, true, true, first_time_index, num_times, var_data);
+}
+
+void cf_file_read_latlon_surface_var_times(cf_file_t* file, 
+                                           const char* var_name,
+                                           int first_time_index, 
+                                           int num_times,
+                                           real_t* var_data)
+{
+  ASSERT(string_int_unordered_map_contains(file->td_ll_surface_vars, (char*)var_name));
+  transfer_latlon_var_times(file, var_name, true, false, first_time_index, num_times, var_data);
+}
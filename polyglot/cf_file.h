@@ -162,6 +162,65 @@ void cf_file_get_time_metadata(cf_file_t* file,
                                char* time_units,
                                char* calendar);
 
+// Sets whether lat-lon variables (3D or surface) defined after this call 
+// store their data in single precision (32-bit floats) instead of at the 
+// precision of real_t. Data is narrowed as it's written and widened back to 
+// real_t as it's read, so this halves the storage of fields that don't need 
+// double precision in the file. Calling this between variable definitions 
+// sets the precision variable by variable. By default, variables are stored 
+// at the precision of real_t.
+void cf_file_set_single_precision(cf_file_t* file, bool single_precision);
+
+// This type identifies the ways in which the data of a lat-lon variable can 
+// be divided into chunks in the file. 
+typedef enum
+{
+  CF_CHUNK_DEFAULT,     // NetCDF's default chunking.
+  CF_CHUNK_TIME_SLICE,  // Each chunk holds the entire grid at one time, 
+                        // which suits writing and reading whole time steps. 
+                        // (Grids too big for one chunk are split by level, 
+                        // and then by latitude.)
+  CF_CHUNK_TIME_SERIES  // Each chunk holds a small lat-lon tile on one level 
+                        // at many times, which suits reading the histories 
+                        // of points or regions.
+} cf_chunking_t;
+
+// This type describes how the data of lat-lon variables is stored:
+//   chunking - the shape of each chunk of data.
+//   num_chunk_times - the number of times in each chunk of a time-dependent 
+//                     variable chunked for time series access, or 0 for a 
+//                     default (64).
+//   deflate_level - the level of compression, from 0 (none) to 9.
+//   shuffle - whether the bytes of each value are shuffled before they're 
+//             compressed, which helps with smooth fields.
+//   chunk_cache_size - the size (in bytes) of the variable's chunk cache, 
+//                      or 0 for NetCDF's default.
+typedef struct
+{
+  cf_chunking_t chunking;
+  int num_chunk_times;
+  int deflate_level;
+  bool shuffle;
+  size_t chunk_cache_size;
+} cf_storage_policy_t;
+
+// Returns the default storage policy, under which variables are chunked 
+// as NetCDF sees fit and are not compressed.
+cf_storage_policy_t cf_default_storage_policy();
+
+// Sets the storage policy for lat-lon variables (3D or surface) defined 
+// after this call, in the same way as cf_file_set_single_precision. The 
+// file must have been opened for writing.
+void cf_file_set_storage_policy(cf_file_t* file, 
+                                cf_storage_policy_t* policy);
+
+// Sets the size (in bytes) of the chunk cache for the given variable. Chunk 
+// caches aren't stored in the file, so this is how a file opened for 
+// reading gets a cache that fits its access pattern.
+void cf_file_set_var_chunk_cache(cf_file_t* file,
+                                 const char* var_name,
+                                 size_t cache_size);
+
 // Defines a (3D) variable that is defined on the points of a lat-lon grid, 
 // setting up metadata like short and long names and units. If the variable 
 // is time-dependent, its dimensions will be (time, vertical, lat, lon); 
@@ -227,6 +286,11 @@ void cf_file_read_latlon_grid(cf_file_t* file,
 // an integer index identifying that time.
 int cf_file_append_time(cf_file_t* file, real_t t);
 
+// Appends num_times times to the time series in the grid in a single 
+// transfer, returning the index of the first of them. The rest follow it 
+// consecutively.
+int cf_file_append_times(cf_file_t* file, int num_times, real_t* times);
+
 // Writes a variable that is defined on the points of a lat-lon grid, 
 // specifying a time index that associates this entry with a given time. This 
 // time index is ignored if the variable is not time dependent.
@@ -259,4 +323,86 @@ void cf_file_read_latlon_surface_var(cf_file_t* file,
                                      int time_index, 
                                      real_t* var_data);
 
+// Writes a time-dependent variable that is defined on the points of a lat-lon 
+// grid for num_times consecutive times beginning at first_time_index, in a 
+// single transfer. var_data holds the data for each time in turn, as it 
+// would be passed to cf_file_write_latlon_var. These times must already 
+// have been appended to the time series.
+void cf_file_write_latlon_var_times(cf_file_t* file, 
+                                    const char* var_name,
+                                    int first_time_index, 
+                                    int num_times,
+                                    real_t* var_data);
+
+// Reads a time-dependent variable that is defined on the points of a lat-lon 
+// grid for num_times consecutive times beginning at first_time_index, in a 
+// single transfer, storing the data for each time in turn in var_data.
+void cf_file_read_latlon_var_times(cf_file_t* file, 
+                                   const char* var_name,
+                                   int first_time_index, 
+                                   int num_times,
+                                   real_t* var_data);
+
+// Writes a time-dependent surface variable on a lat-lon grid for num_times 
+// consecutive times beginning at first_time_index, in a single transfer.
+void cf_file_write_latlon_surface_var_times(cf_file_t* file, 
+                                            const char* var_name,
+                                            int first_time_index, 
+                                            int num_times,
+                                            real_t* var_data);
+
+// Reads a time-dependent surface variable on a lat-lon grid for num_times 
+// consecutive times beginning at first_time_index, in a single transfer.
+void cf_file_read_latlon_surface_var_times(cf_file_t* file, 
+                                           const char* var_name,
+                                           int first_time_index, 
+                                           int num_times,
+                                           real_t* var_data);
+
+// This type describes a region of a lat-lon grid in terms of index ranges, 
+// for reading portions of lat-lon variables. Latitudes and longitudes may 
+// be decimated by reading only every (lat_stride)th latitude and every 
+// (lon_stride)th longitude, starting from first_lat and first_lon. The 
+// longitude range is periodic: indices past the end of the grid wrap around 
+// to its beginning, so a region may cross the dateline, but it may not 
+// span more than the entire grid. Levels are ignored for surface variables.
+typedef struct
+{
+  int first_level, num_levels;
+  int first_lat, num_lats, lat_stride;
+  int first_lon, num_lons, lon_stride;
+} cf_latlon_region_t;
+
+// Finds the region of the file's lat-lon grid containing all levels and the 
+// points within the given latitude/longitude bounding box (in the units of 
+// the grid), with unit strides. If max_longitude is less than min_longitude, 
+// the box crosses the dateline, heading east from min_longitude. If no 
+// points are within the box, region->num_lats or region->num_lons is zero.
+void cf_file_find_latlon_region(cf_file_t* file,
+                                real_t min_latitude,
+                                real_t max_latitude,
+                                real_t min_longitude,
+                                real_t max_longitude,
+                                cf_latlon_region_t* region);
+
+// Reads the given region of a variable that is defined on the points of a 
+// lat-lon grid, specifying an index for the time at which the data will be 
+// read. var_data must hold num_levels*num_lats*num_lons values, which are 
+// stored in (level, lat, lon) order. Only the region is read from the file.
+void cf_file_read_latlon_var_region(cf_file_t* file, 
+                                    const char* var_name,
+                                    int time_index, 
+                                    cf_latlon_region_t* region,
+                                    real_t* var_data);
+
+// Reads the given region of a variable that is defined on the surface of a 
+// lat-lon grid, specifying an index for the time at which the data will be 
+// read. var_data must hold num_lats*num_lons values, which are stored in 
+// (lat, lon) order.
+void cf_file_read_latlon_surface_var_region(cf_file_t* file, 
+                                            const char* var_name,
+                                            int time_index, 
+                                            cf_latlon_region_t* region,
+                                            real_t* var_data);
+
 #endif
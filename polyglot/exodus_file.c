@@ -5,7 +5,13 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "core/array.h"
+#include "core/array_utils.h"
+#include "core/serializer.h"
+#include "core/unordered_map.h"
 #include "polyglot/exodus_file.h"
 
 // This warning couples Doxygen \deprecated tags to code in Exodus, 
@@ -23,6 +29,9 @@
 #if !defined NC_HAS_NC4 || !NC_HAS_NC4
 #error "The NetCDF library used does not support NetCDF4."
 #endif
+#if NC_HAS_PARALLEL
+#include "netcdf_par.h"
+#endif
 
 #include "exodusII.h"
 #include "exodusII_int.h"
@@ -42,6 +51,49 @@ static void set_ex_opts()
   }
 }
 
+// Meshes are written and read in chunks of at most this many entries, so 
+// that the buffers used to stage them have a fixed size.
+static const int chunk_size = 65536;
+
+// NetCDF can't shrink the time dimension of a file, so when a file's time 
+// series is truncated (see exodus_file_truncate), we record the number of 
+// valid time steps in this global attribute. Any steps after these are stale.
+static const char* num_time_steps_att = "polymec_num_time_steps";
+
+// Exodus doesn't record the element type of an empty ("NULL") block, and 
+// blocks are often empty in some files of a decomposed database. We record 
+// the element types (fe_mesh_element_t values) of all element blocks in 
+// this global attribute.
+static const char* elem_block_types_att = "polymec_elem_block_types";
+
+// Returns the number of valid time steps in the Exodus file with the given 
+// identifier.
+static int num_valid_times(int ex_id)
+{
+  int num_times = MAX((int)ex_inquire_int(ex_id, EX_INQ_TIME), 0);
+  int num_valid_times;
+  if (nc_get_att_int(ex_id, NC_GLOBAL, num_time_steps_att, &num_valid_times) == NC_NOERR)
+    num_times = MIN(num_times, MAX(num_valid_times, 0));
+  return num_times;
+}
+
+// Returns a newly-allocated array of the element types recorded for the 
+// num_blocks element blocks in the Exodus file with the given identifier, 
+// with FE_INVALID for all blocks if the file doesn't record them.
+static int* recorded_block_types(int ex_id, int num_blocks)
+{
+  int* types = polymec_malloc(sizeof(int) * (num_blocks + 1));
+  size_t num_types;
+  if ((nc_inq_attlen(ex_id, NC_GLOBAL, elem_block_types_att, &num_types) != NC_NOERR) ||
+      ((int)num_types != num_blocks) ||
+      (nc_get_att_int(ex_id, NC_GLOBAL, elem_block_types_att, types) != NC_NOERR))
+  {
+    for (int i = 0; i < num_blocks; ++i)
+      types[i] = (int)FE_INVALID;
+  }
+  return types;
+}
+
 // This helper function converts the given element identifier string and number of nodes to 
 // our own element enumerated type.
 static fe_mesh_element_t get_element_type(const char* elem_type_id)
@@ -74,9 +126,53 @@ static void get_elem_name(fe_mesh_element_t elem_type,
   }
 }
 
+// This type holds the names of the variables defined on a given type of 
+// entity, in order, and maps each name to its (0-based) index.
+typedef struct
+{
+  string_array_t* names;
+  string_int_unordered_map_t* indices;
+} var_table_t;
+
+static var_table_t* var_table_new()
+{
+  var_table_t* table = polymec_malloc(sizeof(var_table_t));
+  table->names = string_array_new();
+  table->indices = string_int_unordered_map_new();
+  return table;
+}
+
+static void var_table_free(var_table_t* table)
+{
+  string_array_free(table->names);
+  string_int_unordered_map_free(table->indices);
+  polymec_free(table);
+}
+
+// Returns the index of the named variable in the table, or -1 if it's not 
+// there.
+static int var_table_index(var_table_t* table, const char* name)
+{
+  int* index = string_int_unordered_map_get(table->indices, (char*)name);
+  return (index != NULL) ? *index : -1;
+}
+
+// Appends the named variable to the table, returning its index.
+static int var_table_add(var_table_t* table, const char* name)
+{
+  int index = (int)table->names->size;
+  string_array_append_with_dtor(table->names, string_dup(name), string_free);
+  string_int_unordered_map_insert_with_k_dtor(table->indices, string_dup(name), index, string_free);
+  return index;
+}
+
+// This type stages output for an I/O thread (defined below).
+typedef struct async_writer_t async_writer_t;
+
 struct exodus_file_t 
 {
   char title[MAX_NAME_LENGTH+1];
+  char filename[FILENAME_MAX+1];
   MPI_Comm comm;        // Parallel communicator.
 
 #if POLYMEC_HAVE_MPI
@@ -91,6 +187,17 @@ struct exodus_file_t
   // Set to true if we're writing to an Exodus file, false if not.
   bool writing;
 
+  // Set to true if we're appending to an existing Exodus file.
+  bool appending;
+
+  // Set to true if this file holds one process's portion of a decomposed 
+  // (file-per-process) database, in which case proc is that process.
+  bool decomposed;
+  int proc;
+
+  // Set to true if the file was created or opened for parallel I/O.
+  bool parallel;
+
   int num_nodes, num_edges, num_faces, num_elem, 
       num_elem_blocks, num_face_blocks, num_edge_blocks,
       num_elem_sets, num_face_sets, num_edge_sets, num_node_sets, num_side_sets;
@@ -98,11 +205,47 @@ struct exodus_file_t
   int* face_block_ids;
   int* edge_block_ids;
 
-  // Variable names.
-  string_array_t *node_var_names, *node_set_var_names,
-                 *edge_var_names, *edge_set_var_names,
-                 *face_var_names, *face_set_var_names,
-                 *elem_var_names, *elem_set_var_names, *side_set_var_names;
+  // Offsets of the first entity in each block, with the total number of 
+  // entities at the end, so field data can be moved without querying blocks.
+  int* elem_block_offsets;
+  int* face_block_offsets;
+  int* edge_block_offsets;
+
+  // Identifiers of element, node, and side sets, and the offsets of their 
+  // first entries, for set fields.
+  int *elem_set_ids, *elem_set_offsets;
+  int *node_set_ids, *node_set_offsets;
+  int *side_set_ids, *side_set_offsets;
+
+  // Number of nodes whose field values we write. This is the number of 
+  // owned nodes for a distributed mesh, and all nodes otherwise.
+  int num_owned_nodes;
+
+  // If each process writes its own portion of a distributed mesh (see 
+  // exodus_file_write_distributed_mesh), these hold the file positions of 
+  // the first of this process's elements in each element block, of its 
+  // owned nodes, and of its first entries in each element and side set. 
+  // The offsets above are then local. Otherwise, these are NULL.
+  int* elem_block_starts;
+  int* node_starts;
+  int* elem_set_starts;
+  int* side_set_starts;
+
+  // Set to true once the variables in the file have been defined.
+  bool vars_defined;
+
+  // Asynchronous output, or NULL if output is synchronous.
+  async_writer_t* async;
+
+  // Size of the HDF5 chunk cache for each variable, or 0 for the default.
+  size_t chunk_cache_size;
+
+  // Variables.
+  var_table_t *global_vars;
+  var_table_t *node_vars, *node_set_vars,
+              *edge_vars, *edge_set_vars,
+              *face_vars, *face_set_vars,
+              *elem_vars, *elem_set_vars, *side_set_vars;
 };
 
 bool exodus_file_query(const char* filename,
@@ -157,7 +300,7 @@ bool exodus_file_query(const char* filename,
       // Make sure that each of the element blocks in this file have 
       // valid 3D element types.
       int num_elem_blocks = (int)mesh_info.num_elem_blk;
-      int elem_block_ids[num_elem_blocks];
+      int* elem_block_ids = polymec_malloc(sizeof(int) * (num_elem_blocks+1));
       ex_get_ids(id, EX_ELEM_BLOCK, elem_block_ids);
       for (int i = 0; i < num_elem_blocks; ++i)
       {
@@ -175,6 +318,7 @@ bool exodus_file_query(const char* filename,
           break;
         }
       }
+      polymec_free(elem_block_ids);
       
       if (valid)
       {
@@ -200,13 +344,14 @@ bool exodus_file_query(const char* filename,
 
         if (times != NULL)
         {
-          // Ask for the times within the file.
+          // Ask for the (valid) times within the file.
           int num_times = (int)ex_inquire_int(id, EX_INQ_TIME);
-          real_array_resize(times, num_times);
+          real_array_resize(times, MAX(num_times, 0));
           if (num_times > 0)
           {
             ex_get_all_times(id, times->data);
           }
+          real_array_resize(times, num_valid_times(id));
         }
       }
     }
@@ -222,60 +367,819 @@ bool exodus_file_query(const char* filename,
   return valid;
 }
 
-static void fetch_variable_names(int ex_id, ex_entity_type obj_type, string_array_t* var_names)
+static exodus_catalog_t* exodus_catalog_new()
 {
-  int num_vars;
+  exodus_catalog_t* catalog = polymec_malloc(sizeof(exodus_catalog_t));
+  memset(catalog, 0, sizeof(exodus_catalog_t));
+  catalog->elem_block_names = string_array_new();
+  catalog->global_fields = string_array_new();
+  catalog->node_fields = string_array_new();
+  catalog->elem_fields = string_array_new();
+  catalog->elem_set_fields = string_array_new();
+  catalog->node_set_fields = string_array_new();
+  catalog->side_set_fields = string_array_new();
+  catalog->times = real_array_new();
+  return catalog;
+}
+
+void exodus_catalog_free(exodus_catalog_t* catalog)
+{
+  if (catalog->elem_block_types != NULL)
+    polymec_free(catalog->elem_block_types);
+  if (catalog->elem_block_sizes != NULL)
+    polymec_free(catalog->elem_block_sizes);
+  string_array_free(catalog->elem_block_names);
+  string_array_free(catalog->global_fields);
+  string_array_free(catalog->node_fields);
+  string_array_free(catalog->elem_fields);
+  string_array_free(catalog->elem_set_fields);
+  string_array_free(catalog->node_set_fields);
+  string_array_free(catalog->side_set_fields);
+  real_array_free(catalog->times);
+  polymec_free(catalog);
+}
+
+static void catalog_variable_names(int ex_id, 
+                                   ex_entity_type obj_type, 
+                                   string_array_t* names)
+{
+  int num_vars = 0;
+  ex_get_variable_param(ex_id, obj_type, &num_vars);
+  for (int i = 1; i <= num_vars; ++i)
+  {
+    char name[MAX_NAME_LENGTH+1];
+    ex_get_variable_name(ex_id, obj_type, i, name);
+    string_array_append_with_dtor(names, string_dup(name), string_free);
+  }
+}
+
+// Reads the catalog of the given Exodus file directly from its header, 
+// returning NULL if it isn't a valid (3D) Exodus file.
+static exodus_catalog_t* read_catalog(const char* filename)
+{
+  int my_real_size = (int)sizeof(real_t);
+  int io_real_size = 0;
+  float version;
+  int id = ex_open(filename, EX_READ, &my_real_size, &io_real_size, &version);
+  if (id < 0)
+    return NULL;
+
+  ex_init_params mesh_info;
+  int status = ex_get_init_ext(id, &mesh_info);
+  if ((status < 0) || (mesh_info.num_dim != 3))
+  {
+    ex_close(id);
+    return NULL;
+  }
+
+  exodus_catalog_t* catalog = exodus_catalog_new();
+  catalog->real_size = (size_t)io_real_size;
+  catalog->version = version;
+  catalog->num_nodes = (int)mesh_info.num_nodes;
+  catalog->num_elem = (int)mesh_info.num_elem;
+  catalog->num_faces = (int)mesh_info.num_face;
+  catalog->num_edges = (int)mesh_info.num_edge;
+  catalog->num_elem_sets = (int)mesh_info.num_elem_sets;
+  catalog->num_node_sets = (int)mesh_info.num_node_sets;
+  catalog->num_side_sets = (int)mesh_info.num_side_sets;
+
+  // Element blocks, each of which must have a valid 3D element type.
+  int num_elem_blocks = catalog->num_elem_blocks = (int)mesh_info.num_elem_blk;
+  catalog->elem_block_types = polymec_malloc(sizeof(fe_mesh_element_t) * (num_elem_blocks+1));
+  catalog->elem_block_sizes = polymec_malloc(sizeof(int) * (num_elem_blocks+1));
+  int* elem_block_ids = polymec_malloc(sizeof(int) * (num_elem_blocks+1));
+  ex_get_ids(id, EX_ELEM_BLOCK, elem_block_ids);
+  for (int i = 0; i < num_elem_blocks; ++i)
+  {
+    int elem_block = elem_block_ids[i];
+    char elem_type_name[MAX_NAME_LENGTH+1], block_name[MAX_NAME_LENGTH+1];
+    int num_elem, num_nodes_per_elem, num_faces_per_elem;
+    ex_get_block(id, EX_ELEM_BLOCK, elem_block, 
+                 elem_type_name, &num_elem,
+                 &num_nodes_per_elem, NULL,
+                 &num_faces_per_elem, NULL);
+    catalog->elem_block_types[i] = get_element_type(elem_type_name);
+    if (catalog->elem_block_types[i] == FE_INVALID)
+    {
+      polymec_free(elem_block_ids);
+      exodus_catalog_free(catalog);
+      ex_close(id);
+      return NULL;
+    }
+    catalog->elem_block_sizes[i] = num_elem;
+    ex_get_name(id, EX_ELEM_BLOCK, elem_block, block_name);
+    if (strlen(block_name) == 0)
+      sprintf(block_name, "block_%d", elem_block);
+    string_array_append_with_dtor(catalog->elem_block_names, string_dup(block_name), string_free);
+  }
+  polymec_free(elem_block_ids);
+
+  // Number of processes, as in exodus_file_query.
+  int dim_id;
+  if (nc_inq_dimid(id, DIM_NUM_PROCS, &dim_id) == NC_NOERR)
+  {
+    int num_proc_in_file;
+    char file_type[2];
+    ex_get_init_info(id, &catalog->num_mpi_processes, &num_proc_in_file, file_type);
+  }
+  else
+    catalog->num_mpi_processes = 1;
+
+  catalog_variable_names(id, EX_GLOBAL, catalog->global_fields);
+  catalog_variable_names(id, EX_NODAL, catalog->node_fields);
+  catalog_variable_names(id, EX_ELEM_BLOCK, catalog->elem_fields);
+  catalog_variable_names(id, EX_ELEM_SET, catalog->elem_set_fields);
+  catalog_variable_names(id, EX_NODE_SET, catalog->node_set_fields);
+  catalog_variable_names(id, EX_SIDE_SET, catalog->side_set_fields);
+
+  int num_times = (int)ex_inquire_int(id, EX_INQ_TIME);
+  real_array_resize(catalog->times, MAX(num_times, 0));
+  if (num_times > 0)
+    ex_get_all_times(id, catalog->times->data);
+  real_array_resize(catalog->times, num_valid_times(id));
+
+  ex_close(id);
+  return catalog;
+}
+
+// A catalog index begins with this tag and a header of ints: the index 
+// format version, sizeof(real_t), and the size of the index in bytes. The 
+// header is followed by the key of the Exodus file (see catalog_key), and 
+// then by the catalog itself.
+static const char catalog_index_tag[8] = "PGEXOCAT";
+#define CATALOG_INDEX_VERSION 2
+
+// An index is valid for an Exodus file with the same modification time, to 
+// the nanosecond, and size. Whole seconds aren't enough, since a file can 
+// be rewritten within a second of its last write.
+#define CATALOG_KEY_SIZE 3
+static void catalog_key(struct stat* file_stat, size_t key[CATALOG_KEY_SIZE])
+{
+  key[0] = (size_t)file_stat->st_mtime;
+#ifdef __APPLE__
+  key[1] = (size_t)file_stat->st_mtimespec.tv_nsec;
+#else
+  key[1] = (size_t)file_stat->st_mtim.tv_nsec;
+#endif
+  key[2] = (size_t)file_stat->st_size;
+}
+
+static void write_catalog_names(string_array_t* names, 
+                                byte_array_t* bytes, 
+                                size_t* offset)
+{
+  int num_names = (int)names->size;
+  byte_array_write_ints(bytes, 1, &num_names, offset);
+  for (int i = 0; i < num_names; ++i)
+  {
+    int len = (int)strlen(names->data[i]);
+    byte_array_write_ints(bytes, 1, &len, offset);
+    byte_array_write_chars(bytes, len, names->data[i], offset);
+  }
+}
+
+// Returns true if the given number of items of the given size can be read 
+// from the given offset within an index's bytes.
+static bool catalog_index_has(byte_array_t* bytes, 
+                              size_t offset, 
+                              int num_items, 
+                              size_t item_size)
+{
+  return (num_items >= 0) && (offset <= bytes->size) && 
+         ((size_t)num_items <= (bytes->size - offset) / item_size);
+}
+
+// Reads names from an index into the given array, returning false if the 
+// index is too short to hold them.
+static bool read_catalog_names(byte_array_t* bytes, 
+                               size_t* offset,
+                               string_array_t* names)
+{
+  int num_names;
+  if (!catalog_index_has(bytes, *offset, 1, sizeof(int)))
+    return false;
+  byte_array_read_ints(bytes, 1, &num_names, offset);
+  if (!catalog_index_has(bytes, *offset, num_names, sizeof(int)))
+    return false;
+  for (int i = 0; i < num_names; ++i)
+  {
+    int len;
+    if (!catalog_index_has(bytes, *offset, 1, sizeof(int)))
+      return false;
+    byte_array_read_ints(bytes, 1, &len, offset);
+    if (!catalog_index_has(bytes, *offset, len, sizeof(char)))
+      return false;
+    char* name = polymec_malloc(sizeof(char) * (len+1));
+    byte_array_read_chars(bytes, len, name, offset);
+    name[len] = '\0';
+    string_array_append_with_dtor(names, name, string_free);
+  }
+  return true;
+}
+
+// Reads the catalog in the given index bytes, returning NULL if the counts 
+// in the index don't fit within it.
+static exodus_catalog_t* read_catalog_bytes(byte_array_t* bytes)
+{
+  size_t offset = 0;
+  int counts[9];
+  if (!catalog_index_has(bytes, offset, 1, sizeof(size_t) + sizeof(float) + sizeof(counts)))
+    return NULL;
+  exodus_catalog_t* catalog = exodus_catalog_new();
+  byte_array_read_size_ts(bytes, 1, &catalog->real_size, &offset);
+  byte_array_read_chars(bytes, sizeof(float), (char*)&catalog->version, &offset);
+  byte_array_read_ints(bytes, 9, counts, &offset);
+  catalog->num_mpi_processes = counts[0];
+  catalog->num_nodes = counts[1];
+  catalog->num_elem = counts[2];
+  catalog->num_faces = counts[3];
+  catalog->num_edges = counts[4];
+  catalog->num_elem_sets = counts[5];
+  catalog->num_node_sets = counts[6];
+  catalog->num_side_sets = counts[7];
+  int num_elem_blocks = counts[8];
+  if (!catalog_index_has(bytes, offset, num_elem_blocks, 2 * sizeof(int)))
+  {
+    exodus_catalog_free(catalog);
+    return NULL;
+  }
+  catalog->num_elem_blocks = num_elem_blocks;
+  int* types = polymec_malloc(sizeof(int) * (num_elem_blocks+1));
+  byte_array_read_ints(bytes, num_elem_blocks, types, &offset);
+  catalog->elem_block_types = polymec_malloc(sizeof(fe_mesh_element_t) * (num_elem_blocks+1));
+  for (int i = 0; i < num_elem_blocks; ++i)
+    catalog->elem_block_types[i] = (fe_mesh_element_t)types[i];
+  polymec_free(types);
+  catalog->elem_block_sizes = polymec_malloc(sizeof(int) * (num_elem_blocks+1));
+  byte_array_read_ints(bytes, num_elem_blocks, catalog->elem_block_sizes, &offset);
+  int num_times;
+  bool valid = read_catalog_names(bytes, &offset, catalog->elem_block_names) &&
+               read_catalog_names(bytes, &offset, catalog->global_fields) &&
+               read_catalog_names(bytes, &offset, catalog->node_fields) &&
+               read_catalog_names(bytes, &offset, catalog->elem_fields) &&
+               read_catalog_names(bytes, &offset, catalog->elem_set_fields) &&
+               read_catalog_names(bytes, &offset, catalog->node_set_fields) &&
+               read_catalog_names(bytes, &offset, catalog->side_set_fields) &&
+               catalog_index_has(bytes, offset, 1, sizeof(int));
+  if (valid)
+  {
+    byte_array_read_ints(bytes, 1, &num_times, &offset);
+    valid = catalog_index_has(bytes, offset, num_times, sizeof(real_t));
+  }
+  if (!valid)
+  {
+    exodus_catalog_free(catalog);
+    return NULL;
+  }
+  real_array_resize(catalog->times, num_times);
+  byte_array_read_real_ts(bytes, num_times, catalog->times->data, &offset);
+  return catalog;
+}
+
+// Returns the catalog stored in the given index if it describes an Exodus 
+// file with the given key, or NULL if it doesn't (or if it can't be read).
+static exodus_catalog_t* read_catalog_index(const char* index_name, 
+                                            size_t file_key[CATALOG_KEY_SIZE])
+{
+  FILE* f = fopen(index_name, "rb");
+  if (f == NULL)
+    return NULL;
+
+  // Check the tag and header before reading the rest.
+  char tag[8];
+  int header[3];
+  size_t key[CATALOG_KEY_SIZE];
+  bool valid = (fread(tag, sizeof(char), 8, f) == 8) && 
+               (memcmp(tag, catalog_index_tag, 8) == 0) &&
+               (fread(header, sizeof(int), 3, f) == 3) &&
+               (header[0] == CATALOG_INDEX_VERSION) && 
+               (header[1] == (int)sizeof(real_t)) &&
+               (fread(key, sizeof(size_t), CATALOG_KEY_SIZE, f) == CATALOG_KEY_SIZE) && 
+               (memcmp(key, file_key, sizeof(key)) == 0);
+  size_t size = valid ? (size_t)header[2] : 0;
+  size_t start = 8 + sizeof(header) + sizeof(key);
+  byte_array_t* bytes = byte_array_new();
+  if (valid && (size > start))
+  {
+    byte_array_resize(bytes, size - start);
+    valid = (fread(bytes->data, sizeof(uint8_t), size - start, f) == size - start) &&
+            (fgetc(f) == EOF);
+  }
+  else
+    valid = false;
+  fclose(f);
+  exodus_catalog_t* catalog = valid ? read_catalog_bytes(bytes) : NULL;
+  byte_array_free(bytes);
+  return catalog;
+}
+
+// Writes the given catalog to an index for an Exodus file with the given 
+// key. The index is written to a temporary file and then moved into place, 
+// so that concurrent scans never see a partial index. Failures are 
+// ignored, since the index is only a cache.
+static void write_catalog_index(exodus_catalog_t* catalog,
+                                const char* index_name, 
+                                size_t key[CATALOG_KEY_SIZE])
+{
+  byte_array_t* bytes = byte_array_new();
+  size_t offset = 0;
+  byte_array_write_chars(bytes, 8, (char*)catalog_index_tag, &offset);
+  int header[3] = {CATALOG_INDEX_VERSION, (int)sizeof(real_t), 0};
+  byte_array_write_ints(bytes, 3, header, &offset);
+  byte_array_write_size_ts(bytes, CATALOG_KEY_SIZE, key, &offset);
+  byte_array_write_size_ts(bytes, 1, &catalog->real_size, &offset);
+  byte_array_write_chars(bytes, sizeof(float), (char*)&catalog->version, &offset);
+  int counts[9] = {catalog->num_mpi_processes, catalog->num_nodes, 
+                   catalog->num_elem, catalog->num_faces, catalog->num_edges,
+                   catalog->num_elem_sets, catalog->num_node_sets, 
+                   catalog->num_side_sets, catalog->num_elem_blocks};
+  byte_array_write_ints(bytes, 9, counts, &offset);
+  int* types = polymec_malloc(sizeof(int) * (catalog->num_elem_blocks+1));
+  for (int i = 0; i < catalog->num_elem_blocks; ++i)
+    types[i] = (int)catalog->elem_block_types[i];
+  byte_array_write_ints(bytes, catalog->num_elem_blocks, types, &offset);
+  polymec_free(types);
+  byte_array_write_ints(bytes, catalog->num_elem_blocks, catalog->elem_block_sizes, &offset);
+  write_catalog_names(catalog->elem_block_names, bytes, &offset);
+  write_catalog_names(catalog->global_fields, bytes, &offset);
+  write_catalog_names(catalog->node_fields, bytes, &offset);
+  write_catalog_names(catalog->elem_fields, bytes, &offset);
+  write_catalog_names(catalog->elem_set_fields, bytes, &offset);
+  write_catalog_names(catalog->node_set_fields, bytes, &offset);
+  write_catalog_names(catalog->side_set_fields, bytes, &offset);
+  int num_times = (int)catalog->times->size;
+  byte_array_write_ints(bytes, 1, &num_times, &offset);
+  byte_array_write_real_ts(bytes, num_times, catalog->times->data, &offset);
+
+  // Go back and record the size of the index.
+  size_t size = offset;
+  header[2] = (int)size;
+  offset = 8;
+  byte_array_write_ints(bytes, 3, header, &offset);
+
+  char tmp_name[FILENAME_MAX+1];
+  snprintf(tmp_name, FILENAME_MAX, "%s.%d", index_name, (int)getpid());
+  FILE* f = fopen(tmp_name, "wb");
+  if (f != NULL)
+  {
+    bool written = (fwrite(bytes->data, sizeof(uint8_t), size, f) == size);
+    written = (fclose(f) == 0) && written;
+    if (!written || (rename(tmp_name, index_name) != 0))
+      remove(tmp_name);
+  }
+  byte_array_free(bytes);
+}
+
+exodus_catalog_t* exodus_file_catalog(const char* filename, bool use_index)
+{
+  set_ex_opts();
+
+  struct stat file_stat;
+  if (stat(filename, &file_stat) != 0)
+    return NULL;
+  size_t key[CATALOG_KEY_SIZE];
+  catalog_key(&file_stat, key);
+
+  char index_name[FILENAME_MAX+1];
+  exodus_catalog_t* catalog = NULL;
+  if (use_index)
+  {
+    snprintf(index_name, FILENAME_MAX, "%s.catalog", filename);
+    catalog = read_catalog_index(index_name, key);
+    if (catalog != NULL)
+    {
+      log_debug("exodus_file_catalog: Read catalog for %s from index.", filename);
+      return catalog;
+    }
+  }
+
+  catalog = read_catalog(filename);
+  if ((catalog != NULL) && use_index)
+    write_catalog_index(catalog, index_name, key);
+  return catalog;
+}
+
+// Returns the file positions of this process's first entries in the blocks 
+// (or sets) of the given type, or NULL if it writes them in their entirety.
+static int* block_starts(exodus_file_t* file, ex_entity_type block_type)
+{
+  if (block_type == EX_ELEM_BLOCK)
+    return file->elem_block_starts;
+  else if (block_type == EX_NODAL)
+    return file->node_starts;
+  else if (block_type == EX_ELEM_SET)
+    return file->elem_set_starts;
+  else if (block_type == EX_SIDE_SET)
+    return file->side_set_starts;
+  else
+    return NULL;
+}
+
+// Returns the number of chunks of the given size needed to write the given 
+// number of entries. When processes write their portions of a distributed 
+// mesh to a shared file, each must make the same (collective) calls, so 
+// this is the largest number of chunks any of them needs.
+static int num_chunks(exodus_file_t* file, int num_entries, int size)
+{
+  int n = (num_entries + size - 1) / size;
+  if (file->node_starts != NULL)
+    MPI_Allreduce(MPI_IN_PLACE, &n, 1, MPI_INT, MPI_MAX, file->comm);
+  return n;
+}
+
+// Processes writing their portions of a distributed mesh to a shared file 
+// use collective access to its variables, which lets HDF5 extend their time 
+// dimensions.
+static void use_collective_access(exodus_file_t* file)
+{
+#if NC_HAS_PARALLEL
+  if (file->parallel && (file->node_starts != NULL))
+  {
+    int num_vars;
+    nc_inq_nvars(file->ex_id, &num_vars);
+    for (int v = 0; v < num_vars; ++v)
+      nc_var_par_access(file->ex_id, v, NC_COLLECTIVE);
+  }
+#endif
+}
+
+// Writes the given field data for the variable with the given index to the 
+// blocks (or sets) of the given type, using the given identifiers and 
+// offsets. Returns a negative status if any of the writes fail.
+static int write_block_field(exodus_file_t* file,
+                             int time_index,
+                             ex_entity_type block_type,
+                             int num_blocks,
+                             int* block_ids,
+                             int* block_offsets,
+                             int var_index,
+                             real_t* field_data)
+{
+  int status = 0;
+  int* starts = block_starts(file, block_type);
+  for (int i = 0; i < num_blocks; ++i)
+  {
+    int offset = block_offsets[i];
+    int N = block_offsets[i+1] - offset;
+    int s;
+    if (starts != NULL)
+    {
+      s = ex_put_partial_var(file->ex_id, time_index, block_type, var_index+1, 
+                             block_ids[i], starts[i]+1, N, &field_data[offset]);
+    }
+    else
+    {
+      s = ex_put_var(file->ex_id, time_index, block_type, var_index+1, 
+                     block_ids[i], N, &field_data[offset]);
+    }
+    status = MIN(status, s);
+  }
+  return status;
+}
+
+// This type represents a staged write of a time value (if num_blocks is 
+// -1) or of field data for a variable on blocks or sets. The identifiers, 
+// offsets, and data are stored in the same allocation.
+typedef struct async_write_t
+{
+  int time_index;
+  real_t time;
+  ex_entity_type block_type;
+  int num_blocks;
+  int* block_ids;
+  int* block_offsets;
+  int var_index;
+  real_t* data;
+  size_t size;
+  struct async_write_t* next;
+} async_write_t;
+
+// This type holds a queue of staged writes, which an I/O thread writes to 
+// the file in order.
+struct async_writer_t
+{
+  exodus_file_t* file;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t has_writes, has_space, drained;
+  async_write_t *first, *last;
+  size_t staged_bytes, max_staged_bytes;
+  bool busy, stopping;
+  int status;
+};
+
+static void* write_async_output(void* context)
+{
+  async_writer_t* writer = context;
+  pthread_mutex_lock(&writer->lock);
+  while (true)
+  {
+    while ((writer->first == NULL) && !writer->stopping)
+      pthread_cond_wait(&writer->has_writes, &writer->lock);
+    if (writer->first == NULL)
+      break;
+
+    // Pop the next write and perform it outside of the lock.
+    async_write_t* w = writer->first;
+    writer->first = w->next;
+    if (writer->first == NULL)
+      writer->last = NULL;
+    writer->busy = true;
+    pthread_mutex_unlock(&writer->lock);
+    int status;
+    if (w->num_blocks == -1)
+      status = ex_put_time(writer->file->ex_id, w->time_index, &w->time);
+    else
+    {
+      status = write_block_field(writer->file, w->time_index, w->block_type, 
+                                 w->num_blocks, w->block_ids, w->block_offsets, 
+                                 w->var_index, w->data);
+    }
+    pthread_mutex_lock(&writer->lock);
+
+    if ((status < 0) && (writer->status >= 0))
+      writer->status = status;
+    writer->staged_bytes -= w->size;
+    writer->busy = false;
+    polymec_free(w);
+    pthread_cond_broadcast(&writer->has_space);
+    if (writer->first == NULL)
+      pthread_cond_broadcast(&writer->drained);
+  }
+  pthread_mutex_unlock(&writer->lock);
+  return NULL;
+}
+
+static async_writer_t* async_writer_new(exodus_file_t* file, 
+                                        size_t max_staged_bytes)
+{
+  async_writer_t* writer = polymec_malloc(sizeof(async_writer_t));
+  writer->file = file;
+  writer->first = writer->last = NULL;
+  writer->staged_bytes = 0;
+  writer->max_staged_bytes = max_staged_bytes;
+  writer->busy = writer->stopping = false;
+  writer->status = 0;
+  pthread_mutex_init(&writer->lock, NULL);
+  pthread_cond_init(&writer->has_writes, NULL);
+  pthread_cond_init(&writer->has_space, NULL);
+  pthread_cond_init(&writer->drained, NULL);
+  if (pthread_create(&writer->thread, NULL, write_async_output, writer) != 0)
+    polymec_error("exodus_file_enable_async_output: Could not start I/O thread.");
+  return writer;
+}
+
+// Waits for all staged writes to finish, returning a negative status if 
+// any of them failed.
+static int async_writer_flush(async_writer_t* writer)
+{
+  pthread_mutex_lock(&writer->lock);
+  while ((writer->first != NULL) || writer->busy)
+    pthread_cond_wait(&writer->drained, &writer->lock);
+  int status = writer->status;
+  writer->status = 0;
+  pthread_mutex_unlock(&writer->lock);
+  return status;
+}
+
+static int async_writer_free(async_writer_t* writer)
+{
+  int status = async_writer_flush(writer);
+  pthread_mutex_lock(&writer->lock);
+  writer->stopping = true;
+  pthread_cond_signal(&writer->has_writes);
+  pthread_mutex_unlock(&writer->lock);
+  pthread_join(writer->thread, NULL);
+  pthread_cond_destroy(&writer->drained);
+  pthread_cond_destroy(&writer->has_space);
+  pthread_cond_destroy(&writer->has_writes);
+  pthread_mutex_destroy(&writer->lock);
+  polymec_free(writer);
+  return status;
+}
+
+// Adds the given write to the queue, waiting for earlier writes to finish 
+// if it won't fit within the staging limit.
+static void async_writer_push(async_writer_t* writer, async_write_t* w)
+{
+  pthread_mutex_lock(&writer->lock);
+  while ((writer->staged_bytes > 0) && 
+         (writer->staged_bytes + w->size > writer->max_staged_bytes))
+    pthread_cond_wait(&writer->has_space, &writer->lock);
+  w->next = NULL;
+  if (writer->last != NULL)
+    writer->last->next = w;
+  else
+    writer->first = w;
+  writer->last = w;
+  writer->staged_bytes += w->size;
+  pthread_cond_signal(&writer->has_writes);
+  pthread_mutex_unlock(&writer->lock);
+}
+
+// Writes a time value, staging it if output is asynchronous.
+static int put_time(exodus_file_t* file, int time_index, real_t time)
+{
+  if (file->async == NULL)
+    return ex_put_time(file->ex_id, time_index, &time);
+
+  async_write_t* w = polymec_malloc(sizeof(async_write_t));
+  w->time_index = time_index;
+  w->time = time;
+  w->num_blocks = -1;
+  w->size = sizeof(async_write_t);
+  async_writer_push(file->async, w);
+  return 0;
+}
+
+// Writes field data for the variable with the given name and index on 
+// blocks or sets, copying it to a staging buffer if output is asynchronous. 
+// Synchronous write failures are fatal; asynchronous ones are reported when 
+// the file is closed.
+static void put_block_field(exodus_file_t* file,
+                            int time_index,
+                            ex_entity_type block_type,
+                            int num_blocks,
+                            int* block_ids,
+                            int* block_offsets,
+                            const char* var_name,
+                            int var_index,
+                            real_t* field_data)
+{
+  if (file->async == NULL)
+  {
+    int status = write_block_field(file, time_index, block_type, num_blocks, 
+                                   block_ids, block_offsets, var_index, field_data);
+    if (status < 0)
+    {
+      polymec_error("exodus_file: Could not write field %s at time index %d.", 
+                    var_name, time_index);
+    }
+    return;
+  }
+
+  // There's nothing to write for entities without blocks (edges, usually).
+  if (num_blocks == 0)
+    return;
+
+  int num_values = block_offsets[num_blocks];
+  size_t size = sizeof(async_write_t) + sizeof(real_t) * num_values + 
+                sizeof(int) * (2*num_blocks+1);
+  async_write_t* w = polymec_malloc(size);
+  w->time_index = time_index;
+  w->block_type = block_type;
+  w->num_blocks = num_blocks;
+  w->var_index = var_index;
+  w->data = (real_t*)&w[1];
+  memcpy(w->data, field_data, sizeof(real_t) * num_values);
+  w->block_ids = (int*)&w->data[num_values];
+  memcpy(w->block_ids, block_ids, sizeof(int) * num_blocks);
+  w->block_offsets = &w->block_ids[num_blocks];
+  memcpy(w->block_offsets, block_offsets, sizeof(int) * (num_blocks+1));
+  w->size = size;
+  async_writer_push(file->async, w);
+}
+
+// Waits for any pending asynchronous output to be written, before the 
+// file is used directly. NetCDF isn't thread-safe, so every function that 
+// calls it on the file from the calling thread must call this first.
+static void finish_async_output(exodus_file_t* file, const char* func_name)
+{
+  if ((file->async != NULL) && (async_writer_flush(file->async) < 0))
+    polymec_error("%s: Asynchronous output to Exodus file failed.", func_name);
+}
+
+static int fetch_variable_names(int ex_id, ex_entity_type obj_type, var_table_t* vars)
+{
+  int num_vars = 0;
   ex_get_variable_param(ex_id, obj_type, &num_vars);
-  for (int i = 0; i < num_vars; ++i)
-    string_array_append_with_dtor(var_names, (char*)polymec_malloc(sizeof(char) * (MAX_NAME_LENGTH+1)), string_free);
   if (num_vars > 0)
-    ex_get_variable_names(ex_id, obj_type, num_vars, var_names->data);
+  {
+    char** names = polymec_malloc(sizeof(char*) * num_vars);
+    for (int i = 0; i < num_vars; ++i)
+      names[i] = polymec_malloc(sizeof(char) * (MAX_NAME_LENGTH+1));
+    ex_get_variable_names(ex_id, obj_type, num_vars, names);
+    for (int i = 0; i < num_vars; ++i)
+    {
+      var_table_add(vars, names[i]);
+      polymec_free(names[i]);
+    }
+    polymec_free(names);
+  }
+  return MAX(num_vars, 0);
 }
 
-static void fetch_all_variable_names(exodus_file_t* file)
+static int fetch_all_variable_names(exodus_file_t* file)
 {
-  fetch_variable_names(file->ex_id, EX_NODAL, file->node_var_names);
-  fetch_variable_names(file->ex_id, EX_NODE_SET, file->node_set_var_names);
-  fetch_variable_names(file->ex_id, EX_EDGE_BLOCK, file->edge_var_names);
-  fetch_variable_names(file->ex_id, EX_EDGE_SET, file->edge_set_var_names);
-  fetch_variable_names(file->ex_id, EX_FACE_BLOCK, file->face_var_names);
-  fetch_variable_names(file->ex_id, EX_FACE_SET, file->face_set_var_names);
-  fetch_variable_names(file->ex_id, EX_ELEM_BLOCK, file->elem_var_names);
-  fetch_variable_names(file->ex_id, EX_ELEM_SET, file->elem_set_var_names);
-  fetch_variable_names(file->ex_id, EX_SIDE_SET, file->side_set_var_names);
+  return fetch_variable_names(file->ex_id, EX_GLOBAL, file->global_vars) + 
+         fetch_variable_names(file->ex_id, EX_NODAL, file->node_vars) + 
+         fetch_variable_names(file->ex_id, EX_NODE_SET, file->node_set_vars) + 
+         fetch_variable_names(file->ex_id, EX_EDGE_BLOCK, file->edge_vars) + 
+         fetch_variable_names(file->ex_id, EX_EDGE_SET, file->edge_set_vars) + 
+         fetch_variable_names(file->ex_id, EX_FACE_BLOCK, file->face_vars) + 
+         fetch_variable_names(file->ex_id, EX_FACE_SET, file->face_set_vars) + 
+         fetch_variable_names(file->ex_id, EX_ELEM_BLOCK, file->elem_vars) + 
+         fetch_variable_names(file->ex_id, EX_ELEM_SET, file->elem_set_vars) + 
+         fetch_variable_names(file->ex_id, EX_SIDE_SET, file->side_set_vars);
 }
 
 static void free_all_variable_names(exodus_file_t* file)
 {
-  string_array_free(file->node_var_names);
-  string_array_free(file->node_set_var_names);
-  string_array_free(file->edge_var_names);
-  string_array_free(file->edge_set_var_names);
-  string_array_free(file->face_var_names);
-  string_array_free(file->face_set_var_names);
-  string_array_free(file->elem_var_names);
-  string_array_free(file->elem_set_var_names);
-  string_array_free(file->side_set_var_names);
+  var_table_free(file->global_vars);
+  var_table_free(file->node_vars);
+  var_table_free(file->node_set_vars);
+  var_table_free(file->edge_vars);
+  var_table_free(file->edge_set_vars);
+  var_table_free(file->face_vars);
+  var_table_free(file->face_set_vars);
+  var_table_free(file->elem_vars);
+  var_table_free(file->elem_set_vars);
+  var_table_free(file->side_set_vars);
+}
+
+// Fetches the identifiers of the blocks of the given type, and computes 
+// the offsets of their entities.
+static void fetch_blocks(int ex_id, 
+                         ex_entity_type block_type, 
+                         int num_blocks,
+                         int** block_ids,
+                         int** block_offsets)
+{
+  *block_ids = polymec_malloc(sizeof(int) * (num_blocks+1));
+  *block_offsets = polymec_malloc(sizeof(int) * (num_blocks+1));
+  (*block_offsets)[0] = 0;
+  if (num_blocks > 0)
+    ex_get_ids(ex_id, block_type, *block_ids);
+  for (int i = 0; i < num_blocks; ++i)
+  {
+    int N;
+    ex_get_block(ex_id, block_type, (*block_ids)[i], NULL, &N, NULL, NULL, NULL, NULL);
+    (*block_offsets)[i+1] = (*block_offsets)[i] + N;
+  }
+}
+
+// Fetches the identifiers of the sets of the given type, and computes the 
+// offsets of their entries.
+static void fetch_sets(int ex_id, 
+                       ex_entity_type set_type, 
+                       int num_sets,
+                       int** set_ids,
+                       int** set_offsets)
+{
+  *set_ids = polymec_malloc(sizeof(int) * (num_sets+1));
+  *set_offsets = polymec_malloc(sizeof(int) * (num_sets+1));
+  (*set_offsets)[0] = 0;
+  if (num_sets > 0)
+    ex_get_ids(ex_id, set_type, *set_ids);
+  for (int i = 0; i < num_sets; ++i)
+  {
+    int N, num_dist_factors;
+    ex_get_set_param(ex_id, set_type, (*set_ids)[i], &N, &num_dist_factors);
+    (*set_offsets)[i+1] = (*set_offsets)[i] + N;
+  }
 }
 
+// Opens the given Exodus file with the given mode (EX_READ, EX_WRITE to 
+// append to an existing file, or EX_CLOBBER to create a new one). If 
+// decomposed is true, the file is opened serially, since it belongs only to 
+// this process. A new file stores its real numbers with io_real_size bytes, 
+// or at the precision of real_t if io_real_size is 0.
 static exodus_file_t* open_exodus_file(MPI_Comm comm,
                                        const char* filename,
-                                       int mode)
+                                       int mode,
+                                       int io_real_size,
+                                       bool decomposed)
 {
   set_ex_opts();
 
   exodus_file_t* file = polymec_malloc(sizeof(exodus_file_t));
+  strncpy(file->filename, filename, FILENAME_MAX);
+  file->filename[FILENAME_MAX] = '\0';
   file->last_time_index = 0;
   file->comm = comm;
+  file->decomposed = decomposed;
+  file->proc = 0;
+  file->parallel = false;
   int real_size = (int)sizeof(real_t);
   file->ex_real_size = 0;
+  if (mode & EX_CLOBBER)
+  {
+    // Exodus stores floats if we don't ask for a word size.
+    file->ex_real_size = (io_real_size > 0) ? io_real_size : real_size;
+  }
 #if POLYMEC_HAVE_MPI
   MPI_Info_create(&file->mpi_info);
-  if (mode & EX_READ)
+  if (mode & (EX_READ | EX_WRITE))
   {
-    file->ex_id = ex_open_par(filename, mode, &real_size,
-                              &file->ex_real_size, &file->ex_version, 
-                              file->comm, file->mpi_info);
+    if (decomposed)
+      file->ex_id = -1;
+    else
+    {
+      file->ex_id = ex_open_par(filename, mode, &real_size,
+                                &file->ex_real_size, &file->ex_version, 
+                                file->comm, file->mpi_info);
+      file->parallel = (file->ex_id >= 0);
+    }
 
     // Did that work? If not, try the serial opener.
     if (file->ex_id < 0)
@@ -288,9 +1192,15 @@ static exodus_file_t* open_exodus_file(MPI_Comm comm,
   {
     ASSERT(mode & EX_CLOBBER);
     file->ex_version = EX_API_VERS;
-    file->ex_id = ex_create_par(filename, mode, &real_size,
-                                &file->ex_real_size, 
-                                file->comm, file->mpi_info);
+    if (decomposed)
+      file->ex_id = -1;
+    else
+    {
+      file->ex_id = ex_create_par(filename, mode, &real_size,
+                                  &file->ex_real_size, 
+                                  file->comm, file->mpi_info);
+      file->parallel = (file->ex_id >= 0);
+    }
 
     // Did that work? If not, try the serial creator.
     if (file->ex_id < 0)
@@ -301,7 +1211,7 @@ static exodus_file_t* open_exodus_file(MPI_Comm comm,
     }
   }
 #else
-  if (mode & EX_READ)
+  if (mode & (EX_READ | EX_WRITE))
   {
     file->ex_id = ex_open(filename, mode, &real_size,
                           &file->ex_real_size, &file->ex_version);
@@ -315,21 +1225,59 @@ static exodus_file_t* open_exodus_file(MPI_Comm comm,
 #endif
   if (file->ex_id >= 0)
   {
-    file->writing = (mode & EX_CLOBBER);
-    file->node_var_names = string_array_new();
-    file->node_set_var_names = string_array_new();
-    file->edge_var_names = string_array_new();
-    file->edge_set_var_names = string_array_new();
-    file->face_var_names = string_array_new();
-    file->face_set_var_names = string_array_new();
-    file->elem_var_names = string_array_new();
-    file->elem_set_var_names = string_array_new();
-    file->side_set_var_names = string_array_new();
+    file->writing = ((mode & (EX_CLOBBER | EX_WRITE)) != 0);
+    file->appending = ((mode & EX_WRITE) != 0);
+    file->global_vars = var_table_new();
+    file->node_vars = var_table_new();
+    file->node_set_vars = var_table_new();
+    file->edge_vars = var_table_new();
+    file->edge_set_vars = var_table_new();
+    file->face_vars = var_table_new();
+    file->face_set_vars = var_table_new();
+    file->elem_vars = var_table_new();
+    file->elem_set_vars = var_table_new();
+    file->side_set_vars = var_table_new();
 
-    if (!file->writing)
+    // Until we know better, the file has no mesh.
+    file->num_nodes = 0;
+    file->num_edges = 0;
+    file->num_faces = 0;
+    file->num_elem = 0;
+    file->num_elem_blocks = 0;
+    file->elem_block_ids = NULL;
+    file->elem_block_offsets = NULL;
+    file->num_face_blocks = 0;
+    file->face_block_ids = NULL;
+    file->face_block_offsets = NULL;
+    file->num_edge_blocks = 0;
+    file->edge_block_ids = NULL;
+    file->edge_block_offsets = NULL;
+    file->elem_set_ids = NULL;
+    file->elem_set_offsets = NULL;
+    file->node_set_ids = NULL;
+    file->node_set_offsets = NULL;
+    file->side_set_ids = NULL;
+    file->side_set_offsets = NULL;
+    file->num_owned_nodes = 0;
+    file->elem_block_starts = NULL;
+    file->node_starts = NULL;
+    file->elem_set_starts = NULL;
+    file->side_set_starts = NULL;
+    file->vars_defined = false;
+    file->async = NULL;
+    file->chunk_cache_size = 0;
+    file->num_elem_sets = 0;
+    file->num_face_sets = 0;
+    file->num_edge_sets = 0;
+    file->num_node_sets = 0;
+    file->num_side_sets = 0;
+
+    if (!(mode & EX_CLOBBER))
     {
-      // Read all the available variable names.
-      fetch_all_variable_names(file);
+      // Read all the available variable names. Fields in a file we're 
+      // appending to are already defined, if it has any.
+      int num_vars = fetch_all_variable_names(file);
+      file->vars_defined = (file->writing && (num_vars > 0));
 
       // Get information from the file.
       ex_init_params mesh_info;
@@ -337,48 +1285,37 @@ static exodus_file_t* open_exodus_file(MPI_Comm comm,
       if ((status >= 0) && (mesh_info.num_dim == 3))
       {
         strncpy(file->title, mesh_info.title, MAX_NAME_LENGTH);
-        file->num_nodes = (int)mesh_info.num_nodes;
+        file->last_time_index = num_valid_times(file->ex_id);
+        file->num_nodes = file->num_owned_nodes = (int)mesh_info.num_nodes;
         file->num_elem = (int)mesh_info.num_elem;
         file->num_faces = (int)mesh_info.num_face;
         file->num_edges = (int)mesh_info.num_edge;
         file->num_elem_blocks = (int)mesh_info.num_elem_blk;
-        file->elem_block_ids = polymec_malloc(sizeof(int) * file->num_elem_blocks);
-        if (file->num_elem_blocks > 0)
-          ex_get_ids(file->ex_id, EX_ELEM_BLOCK, file->elem_block_ids);
+        fetch_blocks(file->ex_id, EX_ELEM_BLOCK, file->num_elem_blocks, 
+                     &file->elem_block_ids, &file->elem_block_offsets);
         file->num_face_blocks = (int)mesh_info.num_face_blk;
-        file->face_block_ids = polymec_malloc(sizeof(int) * file->num_face_blocks);
-        if (file->num_face_blocks > 0)
-          ex_get_ids(file->ex_id, EX_FACE_BLOCK, file->face_block_ids);
+        fetch_blocks(file->ex_id, EX_FACE_BLOCK, file->num_face_blocks, 
+                     &file->face_block_ids, &file->face_block_offsets);
         file->num_edge_blocks = (int)mesh_info.num_edge_blk;
-        file->edge_block_ids = polymec_malloc(sizeof(int) * file->num_edge_blocks);
-        if (file->num_edge_blocks > 0)
-          ex_get_ids(file->ex_id, EX_EDGE_BLOCK, file->edge_block_ids);
+        fetch_blocks(file->ex_id, EX_EDGE_BLOCK, file->num_edge_blocks, 
+                     &file->edge_block_ids, &file->edge_block_offsets);
         file->num_elem_sets = (int)mesh_info.num_elem_sets;
         file->num_face_sets = (int)mesh_info.num_face_sets;
         file->num_edge_sets = (int)mesh_info.num_edge_sets;
         file->num_node_sets = (int)mesh_info.num_node_sets;
         file->num_side_sets = (int)mesh_info.num_side_sets;
+        fetch_sets(file->ex_id, EX_ELEM_SET, file->num_elem_sets, 
+                   &file->elem_set_ids, &file->elem_set_offsets);
+        fetch_sets(file->ex_id, EX_NODE_SET, file->num_node_sets, 
+                   &file->node_set_ids, &file->node_set_offsets);
+        fetch_sets(file->ex_id, EX_SIDE_SET, file->num_side_sets, 
+                   &file->side_set_ids, &file->side_set_offsets);
       }
     }
     else
     {
       // By default, the title of the database is its filename.
       strncpy(file->title, filename, MAX_NAME_LENGTH);
-      file->num_nodes = 0;
-      file->num_edges = 0;
-      file->num_faces = 0;
-      file->num_elem = 0;
-      file->num_elem_blocks = 0;
-      file->elem_block_ids = NULL;
-      file->num_face_blocks = 0;
-      file->face_block_ids = NULL;
-      file->num_edge_blocks = 0;
-      file->edge_block_ids = NULL;
-      file->num_elem_sets = 0;
-      file->num_face_sets = 0;
-      file->num_edge_sets = 0;
-      file->num_node_sets = 0;
-      file->num_side_sets = 0;
     }
   }
   else
@@ -393,7 +1330,14 @@ static exodus_file_t* open_exodus_file(MPI_Comm comm,
 exodus_file_t* exodus_file_new(MPI_Comm comm,
                                const char* filename)
 {
-  return open_exodus_file(comm, filename, EX_CLOBBER | EX_NETCDF4);
+  return open_exodus_file(comm, filename, EX_CLOBBER | EX_NETCDF4, 0, false);
+}
+
+exodus_file_t* exodus_file_new_single_precision(MPI_Comm comm,
+                                                const char* filename)
+{
+  return open_exodus_file(comm, filename, EX_CLOBBER | EX_NETCDF4, 
+                          (int)sizeof(float), false);
 }
 
 exodus_file_t* exodus_file_open(MPI_Comm comm,
@@ -401,27 +1345,114 @@ exodus_file_t* exodus_file_open(MPI_Comm comm,
 {
   if (!file_exists(filename))
     polymec_error("exodus_file_open: %s does not exist.", filename);
-  return open_exodus_file(comm, filename, EX_READ);
+  return open_exodus_file(comm, filename, EX_READ, 0, false);
 }
 
-void exodus_file_close(exodus_file_t* file)
+exodus_file_t* exodus_file_open_for_append(MPI_Comm comm,
+                                           const char* filename)
 {
-  if (file->writing)
-  {
-    // Write a QA record.
-    char* qa_record[1][4];
-    qa_record[0][0] = string_dup(polymec_executable_name());
-    qa_record[0][1] = string_dup(polymec_executable_name());
-    time_t invocation_time = polymec_invocation_time();
-    struct tm* time_data = localtime(&invocation_time);
-    char date[20], instant[20];
-    snprintf(date, 19, "%02d/%02d/%02d", time_data->tm_mon, time_data->tm_mday, 
-             time_data->tm_year % 100);
-    qa_record[0][2] = string_dup(date);
-    snprintf(instant, 19, "%02d:%02d:%02d", time_data->tm_hour, time_data->tm_min, 
-             time_data->tm_sec % 60);
-    qa_record[0][3] = string_dup(instant);
-    ex_put_qa(file->ex_id, 1, qa_record);
+  if (!file_exists(filename))
+    polymec_error("exodus_file_open_for_append: %s does not exist.", filename);
+  return open_exodus_file(comm, filename, EX_WRITE, 0, false);
+}
+
+// Generates the name of the given process's file within a decomposed 
+// database with the given prefix, as <prefix>.<num_files>.<proc>, with proc 
+// padded with zeros to the width of num_files.
+static void get_decomposed_filename(const char* prefix, 
+                                    int num_files, 
+                                    int proc, 
+                                    char* filename)
+{
+  int num_digits = 1;
+  for (int n = num_files; n >= 10; n /= 10)
+    ++num_digits;
+  snprintf(filename, FILENAME_MAX, "%s.%d.%0*d", prefix, num_files, num_digits, proc);
+}
+
+// Opens the given process's file within a decomposed database.
+static exodus_file_t* open_decomposed_file(MPI_Comm comm,
+                                           const char* prefix,
+                                           int num_files,
+                                           int proc,
+                                           int mode)
+{
+  char filename[FILENAME_MAX];
+  get_decomposed_filename(prefix, num_files, proc, filename);
+  if ((mode & EX_READ) && !file_exists(filename))
+    return NULL;
+  exodus_file_t* file = open_exodus_file(comm, filename, mode, 0, true);
+  if (file != NULL)
+    file->proc = proc;
+  return file;
+}
+
+exodus_file_t* exodus_file_new_decomposed(MPI_Comm comm,
+                                          const char* prefix)
+{
+  int rank, nprocs;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nprocs);
+  return open_decomposed_file(comm, prefix, nprocs, rank, EX_CLOBBER | EX_NETCDF4);
+}
+
+exodus_file_t* exodus_file_open_decomposed(MPI_Comm comm,
+                                           const char* prefix)
+{
+  int rank, nprocs;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nprocs);
+  exodus_file_t* file = open_decomposed_file(comm, prefix, nprocs, rank, EX_READ);
+  if (file == NULL)
+    polymec_error("exodus_file_open_decomposed: %s.%d.* does not exist.", prefix, nprocs);
+
+  // Make sure the database was decomposed for this many processes.
+  int num_procs, num_procs_in_file;
+  char file_type[2];
+  if ((ex_get_init_info(file->ex_id, &num_procs, &num_procs_in_file, file_type) < 0) || 
+      (num_procs != nprocs))
+  {
+    polymec_error("exodus_file_open_decomposed: %s was not decomposed for %d processes.", 
+                  prefix, nprocs);
+  }
+  return file;
+}
+
+void exodus_file_close(exodus_file_t* file)
+{
+  if ((file->async != NULL) && (async_writer_free(file->async) < 0))
+    polymec_error("exodus_file_close: Asynchronous output to Exodus file failed.");
+  if (file->writing)
+  {
+    // Record the number of valid time steps if the time series is (or was) 
+    // truncated.
+    int num_times = (int)ex_inquire_int(file->ex_id, EX_INQ_TIME);
+    if ((file->last_time_index < num_times) || 
+        (nc_inq_attid(file->ex_id, NC_GLOBAL, num_time_steps_att, NULL) == NC_NOERR))
+    {
+      nc_redef(file->ex_id);
+      nc_put_att_int(file->ex_id, NC_GLOBAL, num_time_steps_att, NC_INT, 1, 
+                     &file->last_time_index);
+      nc_enddef(file->ex_id);
+    }
+  }
+  if (file->writing && !file->appending)
+  {
+    // Write a QA record. A file we've appended to already has its QA 
+    // records, which can't be added to.
+    char* qa_record[1][4];
+    qa_record[0][0] = string_dup(polymec_executable_name());
+    qa_record[0][1] = string_dup(polymec_executable_name());
+    time_t invocation_time = polymec_invocation_time();
+    struct tm* time_data = localtime(&invocation_time);
+    char date[20], instant[20];
+    snprintf(date, 19, "%02d/%02d/%02d", time_data->tm_mon, time_data->tm_mday, 
+             time_data->tm_year % 100);
+    qa_record[0][2] = string_dup(date);
+    snprintf(instant, 19, "%02d:%02d:%02d", time_data->tm_hour, time_data->tm_min, 
+             time_data->tm_sec % 60);
+    qa_record[0][3] = string_dup(instant);
+    ex_put_qa(file->ex_id, 1, qa_record);
     for (int i = 0; i < 4; ++i)
       string_free(qa_record[0][i]);
   }
@@ -433,12 +1464,151 @@ void exodus_file_close(exodus_file_t* file)
     polymec_free(file->face_block_ids);
   if (file->edge_block_ids != NULL)
     polymec_free(file->edge_block_ids);
+  if (file->elem_block_offsets != NULL)
+    polymec_free(file->elem_block_offsets);
+  if (file->face_block_offsets != NULL)
+    polymec_free(file->face_block_offsets);
+  if (file->edge_block_offsets != NULL)
+    polymec_free(file->edge_block_offsets);
+  if (file->elem_set_ids != NULL)
+  {
+    polymec_free(file->elem_set_ids);
+    polymec_free(file->elem_set_offsets);
+  }
+  if (file->node_set_ids != NULL)
+  {
+    polymec_free(file->node_set_ids);
+    polymec_free(file->node_set_offsets);
+  }
+  if (file->side_set_ids != NULL)
+  {
+    polymec_free(file->side_set_ids);
+    polymec_free(file->side_set_offsets);
+  }
+  if (file->node_starts != NULL)
+  {
+    polymec_free(file->elem_block_starts);
+    polymec_free(file->node_starts);
+    polymec_free(file->elem_set_starts);
+    polymec_free(file->side_set_starts);
+  }
   free_all_variable_names(file);
 #if POLYMEC_HAVE_MPI
   MPI_Info_free(&file->mpi_info);
 #endif
 
   ex_close(file->ex_id);
+  polymec_free(file);
+}
+
+void exodus_file_enable_async_output(exodus_file_t* file, 
+                                     size_t max_staged_bytes)
+{
+  ASSERT(file->writing);
+  ASSERT(max_staged_bytes > 0);
+  if (file->async != NULL)
+  {
+    finish_async_output(file, "exodus_file_enable_async_output");
+    file->async->max_staged_bytes = max_staged_bytes;
+    return;
+  }
+
+#if POLYMEC_HAVE_MPI
+  // A file shared by several processes is written with MPI I/O, which 
+  // the I/O thread can only call if MPI allows any thread to call it.
+  int nprocs;
+  MPI_Comm_size(file->comm, &nprocs);
+  if (!file->decomposed && (nprocs > 1))
+  {
+    int thread_level;
+    MPI_Query_thread(&thread_level);
+    if (thread_level < MPI_THREAD_MULTIPLE)
+    {
+      log_debug("exodus_file_enable_async_output: MPI doesn't support "
+                "MPI_THREAD_MULTIPLE, so output remains synchronous.");
+      return;
+    }
+  }
+#endif
+
+  file->async = async_writer_new(file, max_staged_bytes);
+}
+
+void exodus_file_flush(exodus_file_t* file)
+{
+  finish_async_output(file, "exodus_file_flush");
+}
+
+void exodus_file_set_compression(exodus_file_t* file, 
+                                  int deflate_level,
+                                  bool shuffle)
+{
+  ASSERT(file->writing);
+  ASSERT(deflate_level >= 0);
+  ASSERT(deflate_level <= 9);
+  finish_async_output(file, "exodus_file_set_compression");
+
+  ex_set_option(file->ex_id, EX_OPT_COMPRESSION_LEVEL, deflate_level);
+  ex_set_option(file->ex_id, EX_OPT_COMPRESSION_SHUFFLE, (shuffle) ? 1 : 0);
+}
+
+// Number of slots in the hash table for each variable's chunk cache 
+// (NetCDF's default, a prime).
+static const size_t chunk_cache_slots = 1009;
+
+// Fraction of fully-read or -written chunks preempted from each cache.
+static const float chunk_cache_preemption = 0.75;
+
+// Sets the chunk cache size of every variable in the file.
+static void set_var_chunk_caches(exodus_file_t* file)
+{
+  int num_vars;
+  nc_inq_nvars(file->ex_id, &num_vars);
+  for (int v = 0; v < num_vars; ++v)
+  {
+    nc_set_var_chunk_cache(file->ex_id, v, file->chunk_cache_size, 
+                           chunk_cache_slots, chunk_cache_preemption);
+  }
+}
+
+void exodus_file_set_chunk_cache(exodus_file_t* file, size_t cache_size)
+{
+  ASSERT(cache_size > 0);
+  finish_async_output(file, "exodus_file_set_chunk_cache");
+  file->chunk_cache_size = cache_size;
+  set_var_chunk_caches(file);
+}
+
+real_t exodus_file_compression_ratio(exodus_file_t* file)
+{
+  finish_async_output(file, "exodus_file_compression_ratio");
+  if (file->writing)
+    ex_update(file->ex_id);
+
+  // Add up the sizes of all the variables in the file.
+  size_t data_size = 0;
+  int num_vars;
+  nc_inq_nvars(file->ex_id, &num_vars);
+  for (int v = 0; v < num_vars; ++v)
+  {
+    nc_type type;
+    int num_dims, dim_ids[NC_MAX_VAR_DIMS];
+    nc_inq_var(file->ex_id, v, NULL, &type, &num_dims, dim_ids, NULL);
+    size_t var_size;
+    nc_inq_type(file->ex_id, type, NULL, &var_size);
+    for (int d = 0; d < num_dims; ++d)
+    {
+      size_t dim_len;
+      nc_inq_dimlen(file->ex_id, dim_ids[d], &dim_len);
+      var_size *= dim_len;
+    }
+    data_size += var_size;
+  }
+
+  struct stat file_info;
+  if ((stat(file->filename, &file_info) != 0) || (file_info.st_size == 0))
+    return 0.0;
+  return (real_t)data_size / (real_t)file_info.st_size;
 }
 
 char* exodus_file_title(exodus_file_t* file)
@@ -458,26 +1628,59 @@ static void write_set(exodus_file_t* file,
                       int* set,
                       size_t set_size)
 {
+  // Set entries are 1-based in Exodus files, so we convert them in chunks. 
+  // Side sets are stored as (element, side) pairs, which we also separate.
+  // Side numbers are already 1-based.
   int num_dist_factors = 0;
-  if (set_type != EX_SIDE_SET)
-  {
-    ex_put_set_param(file->ex_id, set_type, (ex_entity_id)set_id, set_size, num_dist_factors);
-    ex_put_set(file->ex_id, set_type, (ex_entity_id)set_id, set, NULL);
-  }
-  else
+  bool side_set = (set_type == EX_SIDE_SET);
+  int num_entries = (int)(side_set ? set_size/2 : set_size);
+  ex_put_set_param(file->ex_id, set_type, (ex_entity_id)set_id, num_entries, num_dist_factors);
+  int* entries = polymec_malloc(sizeof(int) * 2 * chunk_size);
+  int* sides = &entries[chunk_size];
+  for (int first = 0; first < num_entries; first += chunk_size)
   {
-    ex_put_set_param(file->ex_id, set_type, (ex_entity_id)set_id, set_size/2, num_dist_factors);
-    int elems[set_size/2], faces[set_size/2];
-    for (int i = 0; i < set_size/2; ++i)
+    int n = MIN(chunk_size, num_entries - first);
+    for (int i = 0; i < n; ++i)
     {
-      elems[i] = set[2*i];
-      faces[i] = set[2*i+1];
+      if (side_set)
+      {
+        entries[i] = set[2*(first+i)] + 1;
+        sides[i] = set[2*(first+i)+1];
+      }
+      else
+        entries[i] = set[first+i] + 1;
     }
-    ex_put_set(file->ex_id, set_type, (ex_entity_id)set_id, elems, faces);
+    ex_put_partial_set(file->ex_id, set_type, (ex_entity_id)set_id, first+1, n, 
+                       entries, side_set ? sides : NULL);
   }
+  polymec_free(entries);
   ex_put_name(file->ex_id, set_type, (ex_entity_id)set_id, set_name);
 }
 
+// Records the identifiers and entry offsets of the sets of the given type 
+// in the mesh, as written by write_set. The number of entries in a side set 
+// is its number of sides.
+static void record_sets(fe_mesh_t* mesh,
+                        bool (*next_set)(fe_mesh_t*, int*, char**, int**, size_t*),
+                        int num_sets,
+                        int entry_size,
+                        int** set_ids,
+                        int** set_offsets)
+{
+  *set_ids = polymec_realloc(*set_ids, sizeof(int) * (num_sets+1));
+  *set_offsets = polymec_realloc(*set_offsets, sizeof(int) * (num_sets+1));
+  (*set_offsets)[0] = 0;
+  int pos = 0, i = 0, *set;
+  size_t set_size;
+  char* set_name;
+  while (next_set(mesh, &pos, &set_name, &set, &set_size))
+  {
+    (*set_ids)[i] = i+1;
+    (*set_offsets)[i+1] = (*set_offsets)[i] + (int)set_size/entry_size;
+    ++i;
+  }
+}
+
 // This helper determines whether the given element type can have the given 
 // number of nodes in an Exodus file.
 static bool element_is_supported(fe_mesh_element_t elem_type, 
@@ -495,10 +1698,491 @@ static bool element_is_supported(fe_mesh_element_t elem_type,
     return false;
 }
 
+// This type describes the sides of an element in terms of its nodes, in 
+// Exodus's side numbering. Higher-order elements list their corner nodes 
+// first, so these descriptions apply to them as well.
+typedef struct
+{
+  int num_sides;
+  int num_side_nodes[6];
+  int side_nodes[6][4];
+} elem_side_info_t;
+
+static const elem_side_info_t tet_side_info = 
+  {4, {3, 3, 3, 3}, {{0, 1, 3}, {1, 2, 3}, {0, 3, 2}, {0, 2, 1}}};
+static const elem_side_info_t pyramid_side_info = 
+  {5, {3, 3, 3, 3, 4}, {{0, 1, 4}, {1, 2, 4}, {2, 3, 4}, {0, 4, 3}, {0, 3, 2, 1}}};
+static const elem_side_info_t wedge_side_info = 
+  {5, {4, 4, 4, 3, 3}, {{0, 1, 4, 3}, {1, 2, 5, 4}, {0, 3, 5, 2}, {0, 2, 1}, {3, 4, 5}}};
+static const elem_side_info_t hex_side_info = 
+  {6, {4, 4, 4, 4, 4, 4}, {{0, 1, 5, 4}, {1, 2, 6, 5}, {2, 3, 7, 6}, 
+                           {0, 4, 7, 3}, {0, 3, 2, 1}, {4, 5, 6, 7}}};
+
+static const elem_side_info_t* get_elem_side_info(fe_mesh_element_t elem_type)
+{
+  switch(elem_type)
+  {
+    case FE_TETRAHEDRON: return &tet_side_info;
+    case FE_PYRAMID: return &pyramid_side_info;
+    case FE_WEDGE: return &wedge_side_info;
+    case FE_HEXAHEDRON: return &hex_side_info;
+    default: return NULL;
+  }
+}
+
+// Orders int pairs lexicographically (for qsort).
+static int int_pair_cmp(const void* l, const void* r)
+{
+  const int* lp = l;
+  const int* rp = r;
+  if (lp[0] != rp[0])
+    return (lp[0] < rp[0]) ? -1 : 1;
+  else
+    return (lp[1] < rp[1]) ? -1 : (lp[1] > rp[1]) ? 1 : 0;
+}
+
+// Orders int triples lexicographically (for qsort).
+static int int_triple_cmp(const void* l, const void* r)
+{
+  int c = int_pair_cmp(l, r);
+  if (c == 0)
+  {
+    const int* lp = l;
+    const int* rp = r;
+    c = (lp[2] < rp[2]) ? -1 : (lp[2] > rp[2]) ? 1 : 0;
+  }
+  return c;
+}
+
+// This type holds the Nemesis load balance information for a process's 
+// portion of a distributed mesh. Internal nodes are referenced only by our 
+// elements, border nodes by our elements and those of other processes, and 
+// external nodes only by our ghost elements. Border elements have border 
+// nodes. Indices are 1-based, as Exodus expects.
+typedef struct
+{
+  int_array_t *internal_nodes, *border_nodes, *external_nodes;
+  int_array_t *internal_elems, *border_elems;
+
+  // Node communication maps, as (process, node) pairs, and element 
+  // communication maps, as (process, element, side) triples, in order of 
+  // process.
+  int_array_t *node_cmaps, *elem_cmaps;
+} nemesis_info_t;
+
+static nemesis_info_t* nemesis_info_new(MPI_Comm comm, fe_mesh_t* mesh)
+{
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  int num_elem = fe_mesh_num_elements(mesh);
+  int num_ghosts = fe_mesh_num_ghost_elements(mesh);
+  int num_nodes = fe_mesh_num_nodes(mesh);
+
+  // Find the owner of each of our ghost elements.
+  int* elem_owners = polymec_malloc(sizeof(int) * (num_elem + num_ghosts));
+  for (int e = 0; e < num_elem + num_ghosts; ++e)
+    elem_owners[e] = rank;
+  exchanger_exchange(fe_mesh_element_exchanger(mesh), elem_owners, 1, 0, MPI_INT);
+  int* ghost_owners = &elem_owners[num_elem];
+
+  // Gather the nodes of our ghost elements.
+  int* ghost_node_offsets = polymec_malloc(sizeof(int) * (num_ghosts+1));
+  int_array_t* ghost_nodes = int_array_new();
+  ghost_node_offsets[0] = 0;
+  int pos = 0, first_elem, end_elem;
+  fe_block_t* block;
+  while (fe_mesh_next_ghost_block_range(mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    for (int e = first_elem; e < end_elem; ++e)
+    {
+      int num_elem_nodes;
+      const int* elem_nodes = fe_block_element_nodes(block, e - first_elem, &num_elem_nodes);
+      for (int i = 0; i < num_elem_nodes; ++i)
+        int_array_append(ghost_nodes, elem_nodes[i]);
+      ghost_node_offsets[e - num_elem + 1] = (int)ghost_nodes->size;
+    }
+  }
+
+  // Mark the nodes referenced by our elements.
+  bool* referenced = polymec_malloc(sizeof(bool) * num_nodes);
+  memset(referenced, 0, sizeof(bool) * num_nodes);
+  for (int e = 0; e < num_elem; ++e)
+  {
+    int num_elem_nodes;
+    const int* elem_nodes = fe_mesh_element_nodes(mesh, e, &num_elem_nodes);
+    for (int i = 0; i < num_elem_nodes; ++i)
+      referenced[elem_nodes[i]] = true;
+  }
+
+  // A node that we reference is shared with the owner of every ghost 
+  // element that references it.
+  nemesis_info_t* info = polymec_malloc(sizeof(nemesis_info_t));
+  info->node_cmaps = int_array_new();
+  for (int g = 0; g < num_ghosts; ++g)
+  {
+    for (int i = ghost_node_offsets[g]; i < ghost_node_offsets[g+1]; ++i)
+    {
+      int n = ghost_nodes->data[i];
+      if (referenced[n])
+      {
+        int_array_append(info->node_cmaps, ghost_owners[g]);
+        int_array_append(info->node_cmaps, n+1);
+      }
+    }
+  }
+  int num_pairs = (int)info->node_cmaps->size/2;
+  qsort(info->node_cmaps->data, num_pairs, 2*sizeof(int), int_pair_cmp);
+  int num_unique_pairs = 0;
+  for (int i = 0; i < num_pairs; ++i)
+  {
+    int* pair = &info->node_cmaps->data[2*i];
+    if ((num_unique_pairs == 0) || 
+        (int_pair_cmp(pair, &info->node_cmaps->data[2*(num_unique_pairs-1)]) != 0))
+    {
+      info->node_cmaps->data[2*num_unique_pairs] = pair[0];
+      info->node_cmaps->data[2*num_unique_pairs+1] = pair[1];
+      ++num_unique_pairs;
+    }
+  }
+  int_array_resize(info->node_cmaps, 2*num_unique_pairs);
+
+  // Classify our nodes.
+  bool* border = polymec_malloc(sizeof(bool) * num_nodes);
+  memset(border, 0, sizeof(bool) * num_nodes);
+  for (int i = 0; i < num_unique_pairs; ++i)
+    border[info->node_cmaps->data[2*i+1]-1] = true;
+  info->internal_nodes = int_array_new();
+  info->border_nodes = int_array_new();
+  info->external_nodes = int_array_new();
+  for (int n = 0; n < num_nodes; ++n)
+  {
+    if (!referenced[n])
+      int_array_append(info->external_nodes, n+1);
+    else if (border[n])
+      int_array_append(info->border_nodes, n+1);
+    else
+      int_array_append(info->internal_nodes, n+1);
+  }
+  polymec_free(referenced);
+
+  // Find the ghost elements attached to each node.
+  int* node_ghost_offsets = polymec_malloc(sizeof(int) * (num_nodes+1));
+  memset(node_ghost_offsets, 0, sizeof(int) * (num_nodes+1));
+  for (int i = 0; i < ghost_node_offsets[num_ghosts]; ++i)
+    ++node_ghost_offsets[ghost_nodes->data[i]+1];
+  for (int n = 0; n < num_nodes; ++n)
+    node_ghost_offsets[n+1] += node_ghost_offsets[n];
+  int* node_ghosts = polymec_malloc(sizeof(int) * node_ghost_offsets[num_nodes]);
+  int* node_ghost_counts = polymec_malloc(sizeof(int) * num_nodes);
+  memset(node_ghost_counts, 0, sizeof(int) * num_nodes);
+  for (int g = 0; g < num_ghosts; ++g)
+  {
+    for (int i = ghost_node_offsets[g]; i < ghost_node_offsets[g+1]; ++i)
+    {
+      int n = ghost_nodes->data[i];
+      node_ghosts[node_ghost_offsets[n] + node_ghost_counts[n]++] = g;
+    }
+  }
+  polymec_free(node_ghost_counts);
+
+  // Classify our elements. Each side of a border element whose nodes all 
+  // belong to a ghost element is shared with that ghost element's owner.
+  info->internal_elems = int_array_new();
+  info->border_elems = int_array_new();
+  info->elem_cmaps = int_array_new();
+  for (int e = 0; e < num_elem; ++e)
+  {
+    int num_elem_nodes;
+    const int* elem_nodes = fe_mesh_element_nodes(mesh, e, &num_elem_nodes);
+    bool is_border = false;
+    for (int i = 0; i < num_elem_nodes; ++i)
+    {
+      if (border[elem_nodes[i]])
+      {
+        is_border = true;
+        break;
+      }
+    }
+    if (!is_border)
+    {
+      int_array_append(info->internal_elems, e+1);
+      continue;
+    }
+    int_array_append(info->border_elems, e+1);
+
+    int block_elem_index;
+    fe_block_t* elem_block = fe_mesh_element_block(mesh, e, &block_elem_index);
+    const elem_side_info_t* side_info = get_elem_side_info(fe_block_element_type(elem_block));
+    ASSERT(side_info != NULL);
+    for (int s = 0; s < side_info->num_sides; ++s)
+    {
+      const int* side_nodes = side_info->side_nodes[s];
+      int num_side_nodes = side_info->num_side_nodes[s];
+      int n0 = elem_nodes[side_nodes[0]];
+      for (int i = node_ghost_offsets[n0]; i < node_ghost_offsets[n0+1]; ++i)
+      {
+        int g = node_ghosts[i];
+        int num_shared_nodes = 1;
+        for (int j = 1; j < num_side_nodes; ++j)
+        {
+          int n = elem_nodes[side_nodes[j]];
+          for (int k = ghost_node_offsets[g]; k < ghost_node_offsets[g+1]; ++k)
+          {
+            if (ghost_nodes->data[k] == n)
+            {
+              ++num_shared_nodes;
+              break;
+            }
+          }
+        }
+        if (num_shared_nodes == num_side_nodes)
+        {
+          int_array_append(info->elem_cmaps, ghost_owners[g]);
+          int_array_append(info->elem_cmaps, e+1);
+          int_array_append(info->elem_cmaps, s+1);
+          break;
+        }
+      }
+    }
+  }
+  qsort(info->elem_cmaps->data, info->elem_cmaps->size/3, 3*sizeof(int), int_triple_cmp);
+
+  // Clean up.
+  polymec_free(border);
+  polymec_free(node_ghosts);
+  polymec_free(node_ghost_offsets);
+  int_array_free(ghost_nodes);
+  polymec_free(ghost_node_offsets);
+  polymec_free(elem_owners);
+
+  return info;
+}
+
+static void nemesis_info_free(nemesis_info_t* info)
+{
+  int_array_free(info->internal_nodes);
+  int_array_free(info->border_nodes);
+  int_array_free(info->external_nodes);
+  int_array_free(info->internal_elems);
+  int_array_free(info->border_elems);
+  int_array_free(info->node_cmaps);
+  int_array_free(info->elem_cmaps);
+  polymec_free(info);
+}
+
+// Counts the communication maps in the given array of tuples (whose first 
+// entries are processes), storing each map's process and size in procs 
+// and counts if they are non-NULL.
+static int count_cmaps(int_array_t* cmaps, int tuple_size, int* procs, int* counts)
+{
+  int num_tuples = (int)cmaps->size / tuple_size;
+  int num_cmaps = 0;
+  for (int i = 0; i < num_tuples; ++i)
+  {
+    int proc = cmaps->data[tuple_size*i];
+    if ((i == 0) || (proc != cmaps->data[tuple_size*(i-1)]))
+    {
+      if (procs != NULL)
+      {
+        procs[num_cmaps] = proc;
+        counts[num_cmaps] = 0;
+      }
+      ++num_cmaps;
+    }
+    if (counts != NULL)
+      ++counts[num_cmaps-1];
+  }
+  return num_cmaps;
+}
+
+// Writes the global parameters of a decomposed database and the load 
+// balance parameters for this process's file. This must be done before 
+// the mesh itself is written.
+static void write_nemesis_params(exodus_file_t* file, 
+                                 fe_mesh_t* mesh,
+                                 nemesis_info_t* info)
+{
+  int nprocs;
+  MPI_Comm_size(file->comm, &nprocs);
+  ex_put_init_info(file->ex_id, nprocs, 1, "p");
+
+  // Sum up global numbers of nodes and elements, and those within each 
+  // block and set. Nodes are counted by their owners.
+  int num_blocks = fe_mesh_num_blocks(mesh);
+  int num_node_sets = fe_mesh_num_node_sets(mesh);
+  int num_side_sets = fe_mesh_num_side_sets(mesh);
+  int num_counts = 2 + num_blocks + num_node_sets + num_side_sets;
+  int* counts = polymec_malloc(sizeof(int) * 2 * num_counts);
+  int* global_counts = &counts[num_counts];
+  int num_owned_nodes = fe_mesh_num_owned_nodes(mesh);
+  counts[0] = num_owned_nodes;
+  counts[1] = fe_mesh_num_elements(mesh);
+  int pos = 0, i = 2, *set;
+  char* name;
+  fe_block_t* block;
+  while (fe_mesh_next_block(mesh, &pos, &name, &block))
+    counts[i++] = fe_block_num_elements(block);
+  size_t set_size;
+  pos = 0;
+  while (fe_mesh_next_node_set(mesh, &pos, &name, &set, &set_size))
+  {
+    counts[i] = 0;
+    for (size_t j = 0; j < set_size; ++j)
+    {
+      if (set[j] < num_owned_nodes)
+        ++counts[i];
+    }
+    ++i;
+  }
+  pos = 0;
+  while (fe_mesh_next_side_set(mesh, &pos, &name, &set, &set_size))
+    counts[i++] = (int)(set_size/2);
+  MPI_Allreduce(counts, global_counts, num_counts, MPI_INT, MPI_SUM, file->comm);
+
+  ex_put_init_global(file->ex_id, global_counts[0], global_counts[1], 
+                     num_blocks, num_node_sets, num_side_sets);
+  int num_ids = MAX(num_blocks, MAX(num_node_sets, num_side_sets));
+  int* ids = polymec_malloc(sizeof(int) * (num_ids + 1));
+  int* df_counts = polymec_malloc(sizeof(int) * (num_ids + 1));
+  for (int j = 0; j < num_ids; ++j)
+  {
+    ids[j] = j + 1;
+    df_counts[j] = 0;
+  }
+  if (num_blocks > 0)
+    ex_put_eb_info_global(file->ex_id, ids, &global_counts[2]);
+  if (num_node_sets > 0)
+    ex_put_ns_param_global(file->ex_id, ids, &global_counts[2+num_blocks], df_counts);
+  if (num_side_sets > 0)
+    ex_put_ss_param_global(file->ex_id, ids, &global_counts[2+num_blocks+num_node_sets], df_counts);
+  polymec_free(df_counts);
+  polymec_free(ids);
+  polymec_free(counts);
+
+  int num_node_cmaps = count_cmaps(info->node_cmaps, 2, NULL, NULL);
+  int num_elem_cmaps = count_cmaps(info->elem_cmaps, 3, NULL, NULL);
+  ex_put_loadbal_param(file->ex_id, 
+                       info->internal_nodes->size, info->border_nodes->size, 
+                       info->external_nodes->size, info->internal_elems->size, 
+                       info->border_elems->size, num_node_cmaps, num_elem_cmaps, 
+                       file->proc);
+
+  // Each communication map is identified by its process (plus 1).
+  int* cmap_ids = polymec_malloc(sizeof(int) * 2 * (num_node_cmaps + num_elem_cmaps + 1));
+  int* cmap_counts = &cmap_ids[num_node_cmaps + num_elem_cmaps + 1];
+  count_cmaps(info->node_cmaps, 2, cmap_ids, cmap_counts);
+  count_cmaps(info->elem_cmaps, 3, &cmap_ids[num_node_cmaps], &cmap_counts[num_node_cmaps]);
+  for (int j = 0; j < num_node_cmaps + num_elem_cmaps; ++j)
+    ++cmap_ids[j];
+  ex_put_cmap_params(file->ex_id, cmap_ids, cmap_counts, 
+                     &cmap_ids[num_node_cmaps], &cmap_counts[num_node_cmaps], 
+                     file->proc);
+  polymec_free(cmap_ids);
+}
+
+// Writes the node and element maps, communication maps, and global node and 
+// element indices for this process's file in a decomposed database.
+static void write_nemesis_maps(exodus_file_t* file, 
+                               fe_mesh_t* mesh,
+                               nemesis_info_t* info)
+{
+  ex_put_processor_node_maps(file->ex_id, info->internal_nodes->data, 
+                             info->border_nodes->data, info->external_nodes->data,
+                             file->proc);
+  ex_put_processor_elem_maps(file->ex_id, info->internal_elems->data,
+                             info->border_elems->data, file->proc);
+
+  // Node communication maps.
+  int num_pairs = (int)info->node_cmaps->size/2;
+  int* cmap_entries = polymec_malloc(sizeof(int) * 3 * (num_pairs+1));
+  for (int i = 0; i < num_pairs; )
+  {
+    int proc = info->node_cmaps->data[2*i], n = 0;
+    for (; (i < num_pairs) && (info->node_cmaps->data[2*i] == proc); ++i, ++n)
+    {
+      cmap_entries[n] = info->node_cmaps->data[2*i+1];
+      cmap_entries[num_pairs+n] = proc;
+    }
+    ex_put_node_cmap(file->ex_id, proc+1, cmap_entries, &cmap_entries[num_pairs], 
+                     file->proc);
+  }
+  polymec_free(cmap_entries);
+
+  // Element communication maps.
+  int num_triples = (int)info->elem_cmaps->size/3;
+  cmap_entries = polymec_malloc(sizeof(int) * 3 * (num_triples+1));
+  for (int i = 0; i < num_triples; )
+  {
+    int proc = info->elem_cmaps->data[3*i], n = 0;
+    for (; (i < num_triples) && (info->elem_cmaps->data[3*i] == proc); ++i, ++n)
+    {
+      cmap_entries[n] = info->elem_cmaps->data[3*i+1];
+      cmap_entries[num_triples+n] = info->elem_cmaps->data[3*i+2];
+      cmap_entries[2*num_triples+n] = proc;
+    }
+    ex_put_elem_cmap(file->ex_id, proc+1, cmap_entries, &cmap_entries[num_triples], 
+                     &cmap_entries[2*num_triples], file->proc);
+  }
+  polymec_free(cmap_entries);
+
+  // Global (1-based) node and element indices. A mesh that isn't 
+  // distributed is numbered as it stands.
+  int num_nodes = fe_mesh_num_nodes(mesh);
+  int num_elem = fe_mesh_num_elements(mesh);
+  const int* node_ids = fe_mesh_node_global_ids(mesh);
+  const int* elem_ids = fe_mesh_element_global_ids(mesh);
+  int* ids = polymec_malloc(sizeof(int) * (MAX(num_nodes, num_elem) + 1));
+  for (int n = 0; n < num_nodes; ++n)
+    ids[n] = ((node_ids != NULL) ? node_ids[n] : n) + 1;
+  ex_put_id_map(file->ex_id, EX_NODE_MAP, ids);
+  for (int e = 0; e < num_elem; ++e)
+    ids[e] = ((elem_ids != NULL) ? elem_ids[e] : e) + 1;
+  ex_put_id_map(file->ex_id, EX_ELEM_MAP, ids);
+  polymec_free(ids);
+}
+
+// Writes the (element or node) id map of the given type in chunks for the 
+// entities at file positions [start, start + num_entities), using the given 
+// identifiers, or the entities' 1-based positions if ids is NULL.
+static void write_id_map(exodus_file_t* file, 
+                         ex_entity_type map_type,
+                         int start,
+                         int num_entities,
+                         const int* ids)
+{
+  int* chunk = polymec_malloc(sizeof(int) * chunk_size);
+  int nc = num_chunks(file, num_entities, chunk_size);
+  for (int c = 0, first = 0; c < nc; ++c, first += chunk_size)
+  {
+    int n = MAX(0, MIN(chunk_size, num_entities - first));
+    for (int i = 0; i < n; ++i)
+      chunk[i] = (ids != NULL) ? ids[first+i] : start+first+i+1;
+    ex_put_partial_id_map(file->ex_id, map_type, start+first+1, n, chunk);
+  }
+  polymec_free(chunk);
+}
+
+// Reads the (element or node) identifiers of the given type for the 
+// entities [first, first + num_entities) in chunks, storing them in ids. 
+// Exodus supplies 1-based indices if the file has no id map.
+static void fetch_id_map(exodus_file_t* file, 
+                         ex_entity_type map_type,
+                         int first,
+                         int num_entities,
+                         int* ids)
+{
+  for (int offset = 0; offset < num_entities; offset += chunk_size)
+  {
+    int n = MIN(chunk_size, num_entities - offset);
+    ex_get_partial_id_map(file->ex_id, map_type, first+offset+1, n, &ids[offset]);
+  }
+}
+
 void exodus_file_write_mesh(exodus_file_t* file,
                             fe_mesh_t* mesh)
 {
   ASSERT(file->writing);
+  finish_async_output(file, "exodus_file_write_mesh");
 
   // See whether we have polyhedral blocks, and whether the non-polyhedral
   // blocks have supported element types.
@@ -517,16 +2201,33 @@ void exodus_file_write_mesh(exodus_file_t* file,
     }
     else if (elem_type != FE_INVALID)
     {
-      // Check the number of nodes for the element.
-      if (!element_is_supported(elem_type, fe_block_num_element_nodes(block, 0)))
+      // Check the number of nodes for the element. Blocks can be empty in 
+      // the files of a decomposed database.
+      if ((fe_block_num_elements(block) > 0) && 
+          !element_is_supported(elem_type, fe_block_num_element_nodes(block, 0)))
         polymec_error("exodus_file_write_mesh: Element type in block %s has invalid number of nodes.", block_name);
     }
     else
       polymec_error("exodus_file_write_mesh: Invalid element type for block %s.", block_name);
   }
 
+  // A decomposed database describes how our portion of a distributed mesh 
+  // connects to those of other processes.
+  nemesis_info_t* nem_info = NULL;
+  if (file->decomposed)
+  {
+    int nprocs;
+    MPI_Comm_size(file->comm, &nprocs);
+    if ((nprocs > 1) && (fe_mesh_element_global_ids(mesh) == NULL))
+      polymec_error("exodus_file_write_mesh: A decomposed database requires a distributed mesh.");
+    if (is_polyhedral)
+      polymec_error("exodus_file_write_mesh: A decomposed database can't have polyhedral blocks.");
+    nem_info = nemesis_info_new(file->comm, mesh);
+    write_nemesis_params(file, mesh, nem_info);
+  }
+
   // Write out information about elements, faces, edges, nodes.
-  file->num_nodes = fe_mesh_num_nodes(mesh);
+  file->num_nodes = file->num_owned_nodes = fe_mesh_num_nodes(mesh);
   ex_init_params params;
   strcpy(params.title, file->title);
   params.num_dim = 3;
@@ -551,29 +2252,40 @@ void exodus_file_write_mesh(exodus_file_t* file,
   params.num_node_maps = 0;
   ex_put_init_ext(file->ex_id, &params);
 
+  // Record the block layout so that fields can be written without 
+  // querying the file.
+  file->num_elem = num_elem;
+  file->num_faces = num_faces;
+  file->num_edges = num_edges;
+  file->num_elem_blocks = num_blocks;
+  file->elem_block_ids = polymec_realloc(file->elem_block_ids, sizeof(int) * (num_blocks+1));
+  file->elem_block_offsets = polymec_realloc(file->elem_block_offsets, sizeof(int) * (num_blocks+1));
+  file->elem_block_offsets[0] = 0;
+  file->num_face_blocks = params.num_face_blk;
+  file->face_block_ids = polymec_realloc(file->face_block_ids, sizeof(int) * 2);
+  file->face_block_offsets = polymec_realloc(file->face_block_offsets, sizeof(int) * 2);
+  file->face_block_ids[0] = 1;
+  file->face_block_offsets[0] = 0;
+  file->face_block_offsets[1] = num_faces;
+
   // If we have any polyhedral element blocks, we write out a single face 
   // block that incorporates all of the polyhedral elements.
   if (is_polyhedral)
   {
-    // Generate face->node connectivity information.
+    // Generate face->node connectivity information straight from the 
+    // mesh's face->node arrays, shifting to Exodus's 1-based indices.
     int num_pfaces = fe_mesh_num_faces(mesh);
-    int face_node_size = 0;
-    int num_face_nodes[num_pfaces];
+    const int *face_node_offsets, *mesh_face_nodes;
+    fe_mesh_get_face_node_connectivity(mesh, &face_node_offsets, &mesh_face_nodes);
+    // Exodus has no partial writes for polyhedral connectivity, so this 
+    // is staged in its entirety.
+    int face_node_size = face_node_offsets[num_pfaces];
+    int* num_face_nodes = polymec_malloc(sizeof(int) * num_pfaces);
     for (int f = 0; f < num_pfaces; ++f)
-    {
-      int num_nodes = fe_mesh_num_face_nodes(mesh, f);
-      num_face_nodes[f] = num_nodes;
-      face_node_size += num_nodes;
-    }
+      num_face_nodes[f] = face_node_offsets[f+1] - face_node_offsets[f];
     int* face_nodes = polymec_malloc(sizeof(int) * face_node_size);
-    int offset = 0;
-    for (int f = 0; f < num_pfaces; ++f)
-    {
-      fe_mesh_get_face_nodes(mesh, f, &face_nodes[offset]);
-      offset += num_face_nodes[f];
-    }
     for (int i = 0; i < face_node_size; ++i)
-      face_nodes[i] += 1;
+      face_nodes[i] = mesh_face_nodes[i] + 1;
 
     // Write an "nsided" face block.
     ex_put_block(file->ex_id, EX_FACE_BLOCK, 1, "nsided",
@@ -587,80 +2299,112 @@ void exodus_file_write_mesh(exodus_file_t* file,
     // Number of nodes per face.
     ex_put_entity_count_per_polyhedra(file->ex_id, EX_FACE_BLOCK, 
                                       1, num_face_nodes); 
+    polymec_free(num_face_nodes);
   }
 
   // Go over the element blocks and write out the data.
+  int* ibuf = polymec_malloc(sizeof(int) * MAX(chunk_size, 27));
   pos = 0;
   while (fe_mesh_next_block(mesh, &pos, &block_name, &block))
   {
     int elem_block = pos;
     int num_e = fe_block_num_elements(block);
+    file->elem_block_ids[elem_block-1] = elem_block;
+    file->elem_block_offsets[elem_block] = file->elem_block_offsets[elem_block-1] + num_e;
     fe_mesh_element_t elem_type = fe_block_element_type(block);
     if (elem_type == FE_POLYHEDRON)
     {
       // Count up the faces in the block and write the block information.
-      int tot_num_elem_faces = 0;
-      int faces_per_elem[num_e];
+      const int *elem_face_offsets, *block_elem_faces;
+      fe_block_get_face_connectivity(block, &elem_face_offsets, &block_elem_faces);
+      int tot_num_elem_faces = elem_face_offsets[num_e];
+      int* faces_per_elem = polymec_malloc(sizeof(int) * num_e);
       for (int i = 0; i < num_e; ++i)
-      {
-        faces_per_elem[i] = fe_block_num_element_faces(block, i);
-        tot_num_elem_faces += faces_per_elem[i];
-      }
+        faces_per_elem[i] = elem_face_offsets[i+1] - elem_face_offsets[i];
       ex_put_block(file->ex_id, EX_ELEM_BLOCK, elem_block, "nfaced", 
                    num_e, 0, 0, tot_num_elem_faces, 0);
 
-      // Write elem->face connectivity information.
-      int elem_faces[tot_num_elem_faces], offset = 0;
-      for (int i = 0; i < num_e; ++i)
-      {
-        fe_block_get_element_faces(block, i, &elem_faces[offset]);
-        offset += faces_per_elem[i];
-      }
+      // Write elem->face connectivity information (all at once, as for 
+      // the face block).
+      int* elem_faces = polymec_malloc(sizeof(int) * tot_num_elem_faces);
       for (int i = 0; i < tot_num_elem_faces; ++i)
-        elem_faces[i] += 1;
+        elem_faces[i] = block_elem_faces[i] + 1;
       ex_put_conn(file->ex_id, EX_ELEM_BLOCK, elem_block, NULL, NULL, elem_faces);
       ex_put_entity_count_per_polyhedra(file->ex_id, EX_ELEM_BLOCK, elem_block, faces_per_elem); 
+      polymec_free(elem_faces);
+      polymec_free(faces_per_elem);
     }
     else if (elem_type != FE_INVALID)
     {
       // Get element information.
       char elem_type_name[MAX_NAME_LENGTH+1];
       get_elem_name(elem_type, elem_type_name);
-      int num_nodes_per_elem = fe_block_num_element_nodes(block, 0);
+      int num_nodes_per_elem = (num_e > 0) ? fe_block_num_element_nodes(block, 0) : 0;
 
       // Write the block.
       ex_put_block(file->ex_id, EX_ELEM_BLOCK, elem_block, elem_type_name, 
                    num_e, num_nodes_per_elem, 0, 0, 0);
 
-      // Write the elem->node connectivity.
-      int elem_nodes[num_e* num_nodes_per_elem], offset = 0;
-      for (int i = 0; i < num_e; ++i)
+      // Write the elem->node connectivity in chunks of whole elements.
+      const int *elem_node_offsets, *block_elem_nodes;
+      fe_block_get_node_connectivity(block, &elem_node_offsets, &block_elem_nodes);
+      int chunk_elems = MAX(1, chunk_size / MAX(num_nodes_per_elem, 1));
+      for (int first = 0; first < num_e; first += chunk_elems)
       {
-        fe_block_get_element_nodes(block, i, &elem_nodes[offset]);
-        offset += num_nodes_per_elem;
+        int n = MIN(chunk_elems, num_e - first);
+        const int* chunk_nodes = &block_elem_nodes[first * num_nodes_per_elem];
+        for (int i = 0; i < n * num_nodes_per_elem; ++i)
+          ibuf[i] = chunk_nodes[i] + 1;
+        ex_put_partial_elem_conn(file->ex_id, elem_block, first+1, n, ibuf);
       }
-      for (int i = 0; i < num_e* num_nodes_per_elem; ++i)
-        elem_nodes[i] += 1;
-      ex_put_conn(file->ex_id, EX_ELEM_BLOCK, elem_block, elem_nodes, NULL, NULL);
     }
 
     // Set the element block name.
     ex_put_name(file->ex_id, EX_ELEM_BLOCK, elem_block, block_name);
   }
+  polymec_free(ibuf);
+
+  // Record the element type of every block, empty or not.
+  if (num_blocks > 0)
+  {
+    int block_types[num_blocks];
+    pos = 0;
+    while (fe_mesh_next_block(mesh, &pos, &block_name, &block))
+      block_types[pos-1] = (int)fe_block_element_type(block);
+    nc_redef(file->ex_id);
+    nc_put_att_int(file->ex_id, NC_GLOBAL, elem_block_types_att, NC_INT, 
+                   num_blocks, block_types);
+    nc_enddef(file->ex_id);
+  }
 
-  // Set node positions.
-  real_t x[file->num_nodes], y[file->num_nodes], z[file->num_nodes];
+  // Set node positions in chunks.
+  real_t* x = polymec_malloc(sizeof(real_t) * 3 * chunk_size);
+  real_t* y = &x[chunk_size];
+  real_t* z = &y[chunk_size];
   point_t* X = fe_mesh_node_positions(mesh);
-  for (int n = 0; n < file->num_nodes; ++n)
+  for (int first = 0; first < file->num_nodes; first += chunk_size)
   {
-    x[n] = X[n].x;
-    y[n] = X[n].y;
-    z[n] = X[n].z;
+    int n = MIN(chunk_size, file->num_nodes - first);
+    for (int i = 0; i < n; ++i)
+    {
+      x[i] = X[first+i].x;
+      y[i] = X[first+i].y;
+      z[i] = X[first+i].z;
+    }
+    ex_put_partial_coord(file->ex_id, first+1, n, x, y, z);
   }
-  ex_put_coord(file->ex_id, x, y, z);
+  polymec_free(x);
   char* coord_names[3] = {"x", "y", "z"};
   ex_put_coord_names(file->ex_id, coord_names);
 
+  // Element and node identifiers. A decomposed database's id maps hold 
+  // global indices instead (see write_nemesis_maps).
+  if (!file->decomposed)
+  {
+    write_id_map(file, EX_NODE_MAP, 0, file->num_nodes, fe_mesh_node_ids(mesh));
+    write_id_map(file, EX_ELEM_MAP, 0, file->num_elem, fe_mesh_element_ids(mesh));
+  }
+
   // Write sets of entities.
   int *set, set_id = 0;
   size_t set_size;
@@ -680,6 +2424,307 @@ void exodus_file_write_mesh(exodus_file_t* file,
   pos = set_id = 0;
   while (fe_mesh_next_side_set(mesh, &pos, &set_name, &set, &set_size))
     write_set(file, EX_SIDE_SET, ++set_id, set_name, set, set_size);
+  record_sets(mesh, fe_mesh_next_element_set, file->num_elem_sets, 1,
+              &file->elem_set_ids, &file->elem_set_offsets);
+  record_sets(mesh, fe_mesh_next_node_set, file->num_node_sets, 1,
+              &file->node_set_ids, &file->node_set_offsets);
+  record_sets(mesh, fe_mesh_next_side_set, file->num_side_sets, 2,
+              &file->side_set_ids, &file->side_set_offsets);
+
+  if (file->decomposed)
+  {
+    write_nemesis_maps(file, mesh, nem_info);
+    nemesis_info_free(nem_info);
+  }
+}
+
+// Writes this process's entries in a set of the given type, whose entries 
+// on all processes total total_size, starting at the given file position. 
+// Entries are 0-based file indices, and are converted to Exodus's 1-based 
+// numbering here.
+static void write_partial_set(exodus_file_t* file, 
+                              ex_entity_type set_type,
+                              int set_id,
+                              char* set_name,
+                              int total_size,
+                              int start,
+                              int num_entries,
+                              int* entries,
+                              int* extra)
+{
+  ex_put_set_param(file->ex_id, set_type, (ex_entity_id)set_id, total_size, 0);
+  ex_put_name(file->ex_id, set_type, (ex_entity_id)set_id, set_name);
+  int* buf = polymec_malloc(sizeof(int) * chunk_size);
+  int nc = num_chunks(file, num_entries, chunk_size);
+  for (int c = 0, first = 0; c < nc; ++c, first += chunk_size)
+  {
+    int n = MAX(0, MIN(chunk_size, num_entries - first));
+    for (int j = 0; j < n; ++j)
+      buf[j] = entries[first+j] + 1;
+    ex_put_partial_set(file->ex_id, set_type, (ex_entity_id)set_id, 
+                       start+first+1, n, (n > 0) ? buf : NULL, 
+                       ((n > 0) && (extra != NULL)) ? &extra[first] : NULL);
+  }
+  polymec_free(buf);
+}
+
+void exodus_file_write_distributed_mesh(exodus_file_t* file,
+                                        fe_mesh_t* mesh)
+{
+  ASSERT(file->writing);
+  ASSERT(!file->decomposed);
+  int rank, nprocs;
+  MPI_Comm_rank(file->comm, &rank);
+  MPI_Comm_size(file->comm, &nprocs);
+  if ((nprocs > 1) && (fe_mesh_element_global_ids(mesh) == NULL))
+    polymec_error("exodus_file_write_distributed_mesh: The mesh is not distributed.");
+  if ((nprocs > 1) && !file->parallel)
+    polymec_error("exodus_file_write_distributed_mesh: %s was not created for parallel I/O.", file->filename);
+  finish_async_output(file, "exodus_file_write_distributed_mesh");
+
+  // Every process has the same blocks (some perhaps empty), so we find the 
+  // element type and number of nodes per element of each block from the 
+  // processes with elements in it.
+  int num_blocks = fe_mesh_num_blocks(mesh);
+  int block_info[2*num_blocks+1];
+  int pos = 0;
+  char* block_name;
+  fe_block_t* block;
+  while (fe_mesh_next_block(mesh, &pos, &block_name, &block))
+  {
+    int b = pos - 1;
+    fe_mesh_element_t elem_type = fe_block_element_type(block);
+    if (elem_type == FE_POLYHEDRON)
+      polymec_error("exodus_file_write_distributed_mesh: Block %s is polyhedral, and can't be distributed.", block_name);
+    else if (elem_type == FE_INVALID)
+      polymec_error("exodus_file_write_distributed_mesh: Invalid element type for block %s.", block_name);
+    block_info[2*b] = block_info[2*b+1] = -1;
+    if (fe_block_num_elements(block) > 0)
+    {
+      block_info[2*b] = (int)elem_type;
+      block_info[2*b+1] = fe_block_num_element_nodes(block, 0);
+      if (!element_is_supported(elem_type, block_info[2*b+1]))
+        polymec_error("exodus_file_write_distributed_mesh: Element type in block %s has invalid number of nodes.", block_name);
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, block_info, 2*num_blocks, MPI_INT, MPI_MAX, file->comm);
+
+  // Count our elements in each block, our owned nodes, and our entries in 
+  // each set. Only owned nodes are written to node sets, so that shared 
+  // nodes appear once. A prefix scan of these counts gives the file 
+  // positions at which we write, and a sum gives the sizes of the file's 
+  // blocks and sets.
+  int num_elem_sets = fe_mesh_num_element_sets(mesh);
+  int num_node_sets = fe_mesh_num_node_sets(mesh);
+  int num_side_sets = fe_mesh_num_side_sets(mesh);
+  int num_counts = num_blocks + 1 + num_elem_sets + num_node_sets + num_side_sets;
+  int counts[num_counts], starts[num_counts], totals[num_counts];
+  int num_owned_nodes = fe_mesh_num_owned_nodes(mesh);
+  int* elem_set_counts = &counts[num_blocks+1];
+  int* node_set_counts = &elem_set_counts[num_elem_sets];
+  int* side_set_counts = &node_set_counts[num_node_sets];
+  pos = 0;
+  while (fe_mesh_next_block(mesh, &pos, &block_name, &block))
+    counts[pos-1] = fe_block_num_elements(block);
+  counts[num_blocks] = num_owned_nodes;
+  int i = 0, *set;
+  size_t set_size;
+  char* set_name;
+  pos = 0;
+  while (fe_mesh_next_element_set(mesh, &pos, &set_name, &set, &set_size))
+    elem_set_counts[i++] = (int)set_size;
+  pos = i = 0;
+  while (fe_mesh_next_node_set(mesh, &pos, &set_name, &set, &set_size))
+  {
+    node_set_counts[i] = 0;
+    for (size_t j = 0; j < set_size; ++j)
+    {
+      if (set[j] < num_owned_nodes)
+        ++node_set_counts[i];
+    }
+    ++i;
+  }
+  pos = i = 0;
+  while (fe_mesh_next_side_set(mesh, &pos, &set_name, &set, &set_size))
+    side_set_counts[i++] = (int)set_size/2;
+  MPI_Exscan(counts, starts, num_counts, MPI_INT, MPI_SUM, file->comm);
+  if (rank == 0)
+    memset(starts, 0, sizeof(int) * num_counts);
+  MPI_Allreduce(counts, totals, num_counts, MPI_INT, MPI_SUM, file->comm);
+
+  // Record the layout of the file and of our portion of it.
+  int num_elem = 0;
+  for (int b = 0; b < num_blocks; ++b)
+    num_elem += totals[b];
+  file->num_nodes = totals[num_blocks];
+  file->num_owned_nodes = num_owned_nodes;
+  file->num_elem = num_elem;
+  file->num_faces = file->num_edges = 0;
+  file->num_elem_blocks = num_blocks;
+  file->num_face_blocks = file->num_edge_blocks = 0;
+  file->num_elem_sets = num_elem_sets;
+  file->num_face_sets = file->num_edge_sets = 0;
+  file->num_node_sets = num_node_sets;
+  file->num_side_sets = num_side_sets;
+  file->elem_block_ids = polymec_realloc(file->elem_block_ids, sizeof(int) * (num_blocks+1));
+  file->elem_block_offsets = polymec_realloc(file->elem_block_offsets, sizeof(int) * (num_blocks+1));
+  file->elem_block_offsets[0] = 0;
+  for (int b = 0; b < num_blocks; ++b)
+  {
+    file->elem_block_ids[b] = b+1;
+    file->elem_block_offsets[b+1] = file->elem_block_offsets[b] + counts[b];
+  }
+  file->elem_block_starts = polymec_realloc(file->elem_block_starts, sizeof(int) * (num_blocks+1));
+  memcpy(file->elem_block_starts, starts, sizeof(int) * num_blocks);
+  file->node_starts = polymec_realloc(file->node_starts, sizeof(int));
+  file->node_starts[0] = starts[num_blocks];
+  file->elem_set_starts = polymec_realloc(file->elem_set_starts, sizeof(int) * (num_elem_sets+1));
+  memcpy(file->elem_set_starts, &starts[num_blocks+1], sizeof(int) * num_elem_sets);
+  file->side_set_starts = polymec_realloc(file->side_set_starts, sizeof(int) * (num_side_sets+1));
+  memcpy(file->side_set_starts, &starts[num_counts-num_side_sets], sizeof(int) * num_side_sets);
+  record_sets(mesh, fe_mesh_next_element_set, num_elem_sets, 1,
+              &file->elem_set_ids, &file->elem_set_offsets);
+  record_sets(mesh, fe_mesh_next_node_set, num_node_sets, 1,
+              &file->node_set_ids, &file->node_set_offsets);
+  record_sets(mesh, fe_mesh_next_side_set, num_side_sets, 2,
+              &file->side_set_ids, &file->side_set_offsets);
+
+  ex_init_params params;
+  memset(&params, 0, sizeof(ex_init_params));
+  strcpy(params.title, file->title);
+  params.num_dim = 3;
+  params.num_nodes = file->num_nodes;
+  params.num_elem = num_elem;
+  params.num_elem_blk = num_blocks;
+  params.num_elem_sets = num_elem_sets;
+  params.num_node_sets = num_node_sets;
+  params.num_side_sets = num_side_sets;
+  ex_put_init_ext(file->ex_id, &params);
+
+  // The file indices of our owned nodes follow from our position, and those 
+  // of the other nodes we reference come from their owners.
+  int num_nodes = fe_mesh_num_nodes(mesh);
+  int* node_index = polymec_malloc(sizeof(int) * (num_nodes+1));
+  for (int n = 0; n < num_owned_nodes; ++n)
+    node_index[n] = file->node_starts[0] + n;
+  exchanger_exchange(fe_mesh_node_exchanger(mesh), node_index, 1, 0, MPI_INT);
+
+  // Write the blocks and our portion of their elem->node connectivity, 
+  // noting the file indices of our elements for the sets.
+  int my_num_elem = fe_mesh_num_elements(mesh);
+  int* elem_index = polymec_malloc(sizeof(int) * (my_num_elem+1));
+  const int* elem_ids = fe_mesh_element_ids(mesh);
+  int* ibuf = polymec_malloc(sizeof(int) * MAX(chunk_size, 27));
+  int block_start = 0;
+  pos = 0;
+  while (fe_mesh_next_block(mesh, &pos, &block_name, &block))
+  {
+    int b = pos - 1, elem_block = pos;
+    int num_e = counts[b], offset = file->elem_block_offsets[b];
+    for (int e = 0; e < num_e; ++e)
+      elem_index[offset+e] = block_start + starts[b] + e;
+
+    char elem_type_name[MAX_NAME_LENGTH+1];
+    get_elem_name((fe_mesh_element_t)block_info[2*b], elem_type_name);
+    int num_nodes_per_elem = MAX(block_info[2*b+1], 0);
+    ex_put_block(file->ex_id, EX_ELEM_BLOCK, elem_block, elem_type_name, 
+                 totals[b], num_nodes_per_elem, 0, 0, 0);
+    ex_put_name(file->ex_id, EX_ELEM_BLOCK, elem_block, block_name);
+    if (totals[b] > 0)
+    {
+      const int *elem_node_offsets, *block_elem_nodes;
+      fe_block_get_node_connectivity(block, &elem_node_offsets, &block_elem_nodes);
+      int chunk_elems = MAX(1, chunk_size / MAX(num_nodes_per_elem, 1));
+      int nc = num_chunks(file, num_e, chunk_elems);
+      for (int c = 0, first = 0; c < nc; ++c, first += chunk_elems)
+      {
+        int n = MAX(0, MIN(chunk_elems, num_e - first));
+        for (int j = 0; j < n * num_nodes_per_elem; ++j)
+          ibuf[j] = node_index[block_elem_nodes[first * num_nodes_per_elem + j]] + 1;
+        ex_put_partial_elem_conn(file->ex_id, elem_block, starts[b]+first+1, n, ibuf);
+      }
+    }
+
+    // Element identifiers, within the map for all blocks.
+    write_id_map(file, EX_ELEM_MAP, block_start + starts[b], num_e, 
+                 (elem_ids != NULL) ? &elem_ids[offset] : NULL);
+    block_start += totals[b];
+  }
+  polymec_free(ibuf);
+
+  // Positions and identifiers of our owned nodes.
+  real_t* x = polymec_malloc(sizeof(real_t) * 3 * chunk_size);
+  real_t* y = &x[chunk_size];
+  real_t* z = &y[chunk_size];
+  point_t* X = fe_mesh_node_positions(mesh);
+  int nc = num_chunks(file, num_owned_nodes, chunk_size);
+  for (int c = 0, first = 0; c < nc; ++c, first += chunk_size)
+  {
+    int n = MAX(0, MIN(chunk_size, num_owned_nodes - first));
+    for (int j = 0; j < n; ++j)
+    {
+      x[j] = X[first+j].x;
+      y[j] = X[first+j].y;
+      z[j] = X[first+j].z;
+    }
+    ex_put_partial_coord(file->ex_id, file->node_starts[0]+first+1, n, x, y, z);
+  }
+  polymec_free(x);
+  char* coord_names[3] = {"x", "y", "z"};
+  ex_put_coord_names(file->ex_id, coord_names);
+  write_id_map(file, EX_NODE_MAP, file->node_starts[0], num_owned_nodes, 
+               fe_mesh_node_ids(mesh));
+
+  // Our entries in each set, by file index.
+  int_array_t* entries = int_array_new();
+  int_array_t* sides = int_array_new();
+  pos = i = 0;
+  while (fe_mesh_next_element_set(mesh, &pos, &set_name, &set, &set_size))
+  {
+    int_array_clear(entries);
+    for (size_t j = 0; j < set_size; ++j)
+      int_array_append(entries, elem_index[set[j]]);
+    write_partial_set(file, EX_ELEM_SET, i+1, set_name, 
+                      totals[num_blocks+1+i], file->elem_set_starts[i], 
+                      elem_set_counts[i], entries->data, NULL);
+    ++i;
+  }
+  pos = i = 0;
+  while (fe_mesh_next_node_set(mesh, &pos, &set_name, &set, &set_size))
+  {
+    int_array_clear(entries);
+    for (size_t j = 0; j < set_size; ++j)
+    {
+      if (set[j] < num_owned_nodes)
+        int_array_append(entries, node_index[set[j]]);
+    }
+    write_partial_set(file, EX_NODE_SET, i+1, set_name, 
+                      totals[num_blocks+1+num_elem_sets+i], 
+                      starts[num_blocks+1+num_elem_sets+i],
+                      node_set_counts[i], entries->data, NULL);
+    ++i;
+  }
+  pos = i = 0;
+  while (fe_mesh_next_side_set(mesh, &pos, &set_name, &set, &set_size))
+  {
+    int_array_clear(entries);
+    int_array_clear(sides);
+    for (size_t j = 0; j < set_size/2; ++j)
+    {
+      int_array_append(entries, elem_index[set[2*j]]);
+      int_array_append(sides, set[2*j+1]);
+    }
+    write_partial_set(file, EX_SIDE_SET, i+1, set_name, 
+                      totals[num_counts-num_side_sets+i], file->side_set_starts[i], 
+                      side_set_counts[i], entries->data, sides->data);
+    ++i;
+  }
+  int_array_free(entries);
+  int_array_free(sides);
+  polymec_free(elem_index);
+  polymec_free(node_index);
+
+  use_collective_access(file);
 }
 
 static void fetch_set(exodus_file_t* file, 
@@ -694,11 +2739,235 @@ static void fetch_set(exodus_file_t* file,
   int num_dist_factors;
   ex_get_set_param(file->ex_id, set_type, (ex_entity_id)set_id, &set_size, &num_dist_factors);
   int* set = create_set(mesh, set_name, (size_t)set_size);
-  ex_get_set(file->ex_id, set_type, (ex_entity_id)set_id, set, NULL);
+  if (set_type != EX_SIDE_SET)
+  {
+    // Exodus numbers set entries from 1.
+    ex_get_set(file->ex_id, set_type, (ex_entity_id)set_id, set, NULL);
+    for (int i = 0; i < set_size; ++i)
+      set[i] -= 1;
+  }
+  else
+  {
+    // Side sets are stored as (element, side) pairs, which we assemble in 
+    // chunks.
+    int* elems = polymec_malloc(sizeof(int) * 2 * chunk_size);
+    int* sides = &elems[chunk_size];
+    for (int first = 0; first < set_size; first += chunk_size)
+    {
+      int n = MIN(chunk_size, set_size - first);
+      ex_get_partial_side_set(file->ex_id, (ex_entity_id)set_id, first+1, n, elems, sides);
+      for (int i = 0; i < n; ++i)
+      {
+        set[2*(first+i)] = elems[i] - 1;
+        set[2*(first+i)+1] = sides[i];
+      }
+    }
+    polymec_free(elems);
+  }
+}
+
+// Reads the element->node connectivity of the given block in chunks into a 
+// newly-allocated array, converting its node numbers to 0-based indices 
+// and mapping them through node_index if it's non-NULL.
+static int* fetch_block_node_conn(exodus_file_t* file, 
+                                  int elem_block,
+                                  int num_elem,
+                                  int num_nodes_per_elem,
+                                  int* node_index)
+{
+  int* node_conn = polymec_malloc(sizeof(int) * (num_elem * num_nodes_per_elem + 1));
+  for (int first = 0; first < num_elem; first += chunk_size)
+  {
+    int n = MIN(chunk_size, num_elem - first);
+    int* chunk = &node_conn[first * num_nodes_per_elem];
+    ex_get_partial_conn(file->ex_id, EX_ELEM_BLOCK, elem_block, first+1, n, 
+                        chunk, NULL, NULL);
+    for (int j = 0; j < n * num_nodes_per_elem; ++j)
+    {
+      if (node_index != NULL)
+      {
+        chunk[j] = node_index[chunk[j]-1];
+        ASSERT(chunk[j] >= 0);
+      }
+      else
+        chunk[j] -= 1;
+    }
+  }
+  return node_conn;
+}
+
+// Reads the node positions in the given Exodus file in chunks, storing 
+// those of the nodes with non-negative indices in node_index (or all nodes, 
+// if node_index is NULL) in the given array.
+static void fetch_node_positions(exodus_file_t* file, 
+                                 int* node_index,
+                                 point_t* X)
+{
+  real_t* x = polymec_malloc(sizeof(real_t) * 3 * chunk_size);
+  real_t* y = &x[chunk_size];
+  real_t* z = &y[chunk_size];
+  for (int first = 0; first < file->num_nodes; first += chunk_size)
+  {
+    int n = MIN(chunk_size, file->num_nodes - first);
+    ex_get_partial_coord(file->ex_id, first+1, n, x, y, z);
+    for (int i = 0; i < n; ++i)
+    {
+      int j = (node_index != NULL) ? node_index[first+i] : first+i;
+      if (j >= 0)
+      {
+        X[j].x = x[i];
+        X[j].y = y[i];
+        X[j].z = z[i];
+      }
+    }
+  }
+  polymec_free(x);
+}
+
+// Reads this process's portion of the mesh in a decomposed database, 
+// omitting its external nodes (which belong only to ghost elements). The 
+// global indices of the mesh's elements and nodes are returned in 
+// newly-allocated arrays in *elem_global_ids and *node_global_ids.
+static fe_mesh_t* read_decomposed_mesh(exodus_file_t* file,
+                                       int** elem_global_ids,
+                                       int** node_global_ids)
+{
+  // We keep the internal and border nodes, in their original order.
+  int num_int_nodes, num_bor_nodes, num_ext_nodes, num_int_elems, 
+      num_bor_elems, num_node_cmaps, num_elem_cmaps;
+  ex_get_loadbal_param(file->ex_id, &num_int_nodes, &num_bor_nodes, 
+                       &num_ext_nodes, &num_int_elems, &num_bor_elems, 
+                       &num_node_cmaps, &num_elem_cmaps, file->proc);
+  int num_nodes = num_int_nodes + num_bor_nodes;
+  int* nodes = polymec_malloc(sizeof(int) * (num_nodes + num_ext_nodes + 1));
+  ex_get_processor_node_maps(file->ex_id, nodes, &nodes[num_int_nodes], 
+                             &nodes[num_nodes], file->proc);
+  int_qsort(nodes, num_nodes);
+  int* node_index = polymec_malloc(sizeof(int) * (file->num_nodes + 1));
+  for (int n = 0; n < file->num_nodes; ++n)
+    node_index[n] = -1;
+  for (int n = 0; n < num_nodes; ++n)
+    node_index[nodes[n]-1] = n;
+
+  // Fetch global indices.
+  int* ids = polymec_malloc(sizeof(int) * (MAX(file->num_nodes, file->num_elem) + 1));
+  ex_get_id_map(file->ex_id, EX_NODE_MAP, ids);
+  *node_global_ids = polymec_malloc(sizeof(int) * (num_nodes + 1));
+  for (int n = 0; n < num_nodes; ++n)
+    (*node_global_ids)[n] = ids[nodes[n]-1] - 1;
+  ex_get_id_map(file->ex_id, EX_ELEM_MAP, ids);
+  *elem_global_ids = polymec_malloc(sizeof(int) * (file->num_elem + 1));
+  for (int e = 0; e < file->num_elem; ++e)
+    (*elem_global_ids)[e] = ids[e] - 1;
+  polymec_free(ids);
+
+  // The element types of empty blocks come from our block types attribute. 
+  // Databases written without it get them from the processes on which the 
+  // blocks aren't empty.
+  int* block_types = polymec_malloc(sizeof(int) * (file->num_elem_blocks + 1));
+  int* recorded_types = recorded_block_types(file->ex_id, file->num_elem_blocks);
+  for (int i = 0; i < file->num_elem_blocks; ++i)
+  {
+    int elem_block = file->elem_block_ids[i];
+    char elem_type_name[MAX_NAME_LENGTH+1];
+    int num_elem, num_nodes_per_elem;
+    ex_get_block(file->ex_id, EX_ELEM_BLOCK, elem_block, 
+                 elem_type_name, &num_elem,
+                 &num_nodes_per_elem, NULL, NULL, NULL);
+    fe_mesh_element_t elem_type = (num_elem > 0) ? get_element_type(elem_type_name) 
+                                                 : (fe_mesh_element_t)recorded_types[i];
+    if ((num_elem > 0) && ((elem_type == FE_POLYHEDRON) || (elem_type == FE_INVALID)))
+    {
+      ex_close(file->ex_id);
+      polymec_error("Block %d of a decomposed database contains an unsupported element type.", elem_block);
+    }
+    block_types[i] = (int)elem_type;
+  }
+  polymec_free(recorded_types);
+  MPI_Allreduce(MPI_IN_PLACE, block_types, file->num_elem_blocks, MPI_INT, MPI_MAX, file->comm);
+
+  // Read the element blocks, keeping empty ones so that the blocks line 
+  // up across processes.
+  fe_mesh_t* mesh = fe_mesh_new(file->comm, num_nodes);
+  for (int i = 0; i < file->num_elem_blocks; ++i)
+  {
+    int elem_block = file->elem_block_ids[i];
+    char elem_type_name[MAX_NAME_LENGTH+1];
+    int num_elem, num_nodes_per_elem;
+    ex_get_block(file->ex_id, EX_ELEM_BLOCK, elem_block, 
+                 elem_type_name, &num_elem,
+                 &num_nodes_per_elem, NULL, NULL, NULL);
+    fe_mesh_element_t elem_type = (fe_mesh_element_t)block_types[i];
+
+    int* node_conn = fetch_block_node_conn(file, elem_block, num_elem, 
+                                           num_nodes_per_elem, node_index);
+    fe_block_t* block = fe_block_from_node_indices(num_elem, elem_type, 
+                                                   num_nodes_per_elem, node_conn);
+
+    char block_name[MAX_NAME_LENGTH+1];
+    ex_get_name(file->ex_id, EX_ELEM_BLOCK, elem_block, block_name);
+    if (strlen(block_name) == 0)
+      sprintf(block_name, "block_%d", elem_block);
+    fe_mesh_add_block(mesh, block_name, block);
+  }
+
+  polymec_free(block_types);
+
+  // Node positions.
+  fetch_node_positions(file, node_index, fe_mesh_node_positions(mesh));
+  polymec_free(nodes);
+
+  // Element, node, and side sets.
+  for (int i = 1; i <= file->num_elem_sets; ++i)
+    fetch_set(file, EX_ELEM_SET, i, mesh, fe_mesh_create_element_set);
+  int_array_t* subset = int_array_new();
+  int* chunk = polymec_malloc(sizeof(int) * chunk_size);
+  for (int i = 1; i <= file->num_node_sets; ++i)
+  {
+    char set_name[MAX_NAME_LENGTH+1];
+    ex_get_name(file->ex_id, EX_NODE_SET, (ex_entity_id)i, set_name);
+    int set_size, num_dist_factors;
+    ex_get_set_param(file->ex_id, EX_NODE_SET, (ex_entity_id)i, &set_size, &num_dist_factors);
+    int_array_clear(subset);
+    for (int first = 0; first < set_size; first += chunk_size)
+    {
+      int n = MIN(chunk_size, set_size - first);
+      ex_get_partial_node_set(file->ex_id, (ex_entity_id)i, first+1, n, chunk);
+      for (int j = 0; j < n; ++j)
+      {
+        if (node_index[chunk[j]-1] != -1)
+          int_array_append(subset, node_index[chunk[j]-1]);
+      }
+    }
+    int* set = fe_mesh_create_node_set(mesh, set_name, subset->size);
+    memcpy(set, subset->data, sizeof(int) * subset->size);
+  }
+  polymec_free(chunk);
+  int_array_free(subset);
+  for (int i = 1; i <= file->num_side_sets; ++i)
+    fetch_set(file, EX_SIDE_SET, i, mesh, fe_mesh_create_side_set);
+  polymec_free(node_index);
+
+  return mesh;
 }
 
 fe_mesh_t* exodus_file_read_mesh(exodus_file_t* file)
 {
+  finish_async_output(file, "exodus_file_read_mesh");
+
+  // A decomposed database holds our portion of a distributed mesh, to 
+  // which we add ghost elements and nodes. These end up in the same order 
+  // as they were written.
+  if (file->decomposed)
+  {
+    int *elem_ids, *node_ids;
+    fe_mesh_t* mesh = read_decomposed_mesh(file, &elem_ids, &node_ids);
+    fe_mesh_add_ghosts(&mesh, elem_ids, node_ids);
+    polymec_free(elem_ids);
+    polymec_free(node_ids);
+    return mesh;
+  }
+
   // Create the "host" FE mesh.
   fe_mesh_t* mesh = fe_mesh_new(file->comm, file->num_nodes);
 
@@ -751,10 +3020,12 @@ fe_mesh_t* exodus_file_read_mesh(exodus_file_t* file)
     fe_mesh_set_face_nodes(mesh, num_faces, num_face_nodes, face_nodes);
 
     // Clean up.
+    polymec_free(face_nodes);
     polymec_free(num_face_nodes);
   }
 
   // Go over the element blocks and feel out the data.
+  int* recorded_types = recorded_block_types(file->ex_id, file->num_elem_blocks);
   for (int i = 0; i < file->num_elem_blocks; ++i)
   {
     int elem_block = file->elem_block_ids[i];
@@ -765,8 +3036,10 @@ fe_mesh_t* exodus_file_read_mesh(exodus_file_t* file)
                  &num_nodes_per_elem, NULL,
                  &num_faces_per_elem, NULL);
 
-    // Get the type of element for this block.
-    fe_mesh_element_t elem_type = get_element_type(elem_type_name);
+    // Get the type of element for this block. Empty blocks have only the 
+    // type we recorded for them, if any.
+    fe_mesh_element_t elem_type = (num_elem > 0) ? get_element_type(elem_type_name)
+                                                 : (fe_mesh_element_t)recorded_types[i];
     fe_block_t* block = NULL;
     char block_name[MAX_NAME_LENGTH+1];
     if (elem_type == FE_POLYHEDRON)
@@ -789,22 +3062,21 @@ fe_mesh_t* exodus_file_read_mesh(exodus_file_t* file)
 
       // Create the element block.
       block = polyhedral_fe_block_new(num_elem, num_elem_faces, elem_faces);
+      polymec_free(elem_faces);
+      polymec_free(num_elem_faces);
     }
     else if (elem_type != FE_INVALID)
     {
-      // Get the element's nodal mapping.
-      int* node_conn = polymec_malloc(sizeof(int) * num_elem * num_nodes_per_elem);
-      ex_get_conn(file->ex_id, EX_ELEM_BLOCK, elem_block, node_conn, NULL, NULL);
-      
-      // Subtract 1 from each element node.
-      for (int j = 0; j < num_elem * num_nodes_per_elem; ++j)
-        node_conn[j] -= 1;
-
-      // Build the element block.
-      block = fe_block_new(num_elem, elem_type, num_nodes_per_elem, node_conn);
+      // Get the element's nodal mapping. This is read straight into the 
+      // block's storage, so there's nothing to stage.
+      int* node_conn = fetch_block_node_conn(file, elem_block, num_elem, 
+                                             num_nodes_per_elem, NULL);
+      block = fe_block_from_node_indices(num_elem, elem_type, 
+                                         num_nodes_per_elem, node_conn);
     }
     else
     {
+      polymec_free(recorded_types);
       fe_mesh_free(mesh);
       ex_close(file->ex_id);
       polymec_error("Block %d contains an invalid (3D) element type.", elem_block);
@@ -818,17 +3090,18 @@ fe_mesh_t* exodus_file_read_mesh(exodus_file_t* file)
     // Add the element block to the mesh.
     fe_mesh_add_block(mesh, block_name, block);
   }
+  polymec_free(recorded_types);
 
-  // Fetch node positions and compute geometry.
-  real_t x[file->num_nodes], y[file->num_nodes], z[file->num_nodes];
-  ex_get_coord(file->ex_id, x, y, z);
-  point_t* X = fe_mesh_node_positions(mesh);
-  for (int n = 0; n < file->num_nodes; ++n)
-  {
-    X[n].x = x[n];
-    X[n].y = y[n];
-    X[n].z = z[n];
-  }
+  // Fetch node positions.
+  fetch_node_positions(file, NULL, fe_mesh_node_positions(mesh));
+
+  // Fetch element and node identifiers.
+  int* ids = polymec_malloc(sizeof(int) * (MAX(file->num_nodes, file->num_elem) + 1));
+  fetch_id_map(file, EX_NODE_MAP, 0, file->num_nodes, ids);
+  fe_mesh_set_node_ids(mesh, ids);
+  fetch_id_map(file, EX_ELEM_MAP, 0, file->num_elem, ids);
+  fe_mesh_set_element_ids(mesh, ids);
+  polymec_free(ids);
 
   // Fetch sets of entities.
   for (int i = 1; i <= file->num_elem_sets; ++i)
@@ -845,263 +3118,1408 @@ fe_mesh_t* exodus_file_read_mesh(exodus_file_t* file)
   return mesh;
 }
 
-int exodus_file_write_time(exodus_file_t* file, real_t time)
+// This type accumulates the faces of a finite volume mesh as elements are 
+// streamed in, identifying each element face with a previously-encountered 
+// face that has the same nodes. Faces that have been encountered only once 
+// are linked into lists headed by their smallest nodes, and are unlinked 
+// when they are encountered again, since a face joins at most two cells.
+typedef struct
 {
-  ASSERT(file->writing);
-  int next_index = file->last_time_index + 1;
-  int status = ex_put_time(file->ex_id, next_index, &time);
-  if (status >= 0)
-    file->last_time_index = next_index;
-  else 
-    next_index = status;
-  return next_index;
+  int num_faces, face_capacity, face_node_capacity;
+  int* face_node_offsets;
+  int* face_nodes;
+  int* face_cells;
+  int* next;
+  int* head;
+} face_builder_t;
+
+static void face_builder_init(face_builder_t* builder, 
+                              int num_nodes, 
+                              int face_capacity)
+{
+  builder->num_faces = 0;
+  builder->face_capacity = MAX(face_capacity, 1);
+  builder->face_node_capacity = 4 * builder->face_capacity;
+  builder->face_node_offsets = polymec_malloc(sizeof(int) * (builder->face_capacity+1));
+  builder->face_node_offsets[0] = 0;
+  builder->face_nodes = polymec_malloc(sizeof(int) * builder->face_node_capacity);
+  builder->face_cells = polymec_malloc(sizeof(int) * 2 * builder->face_capacity);
+  builder->next = polymec_malloc(sizeof(int) * builder->face_capacity);
+  builder->head = polymec_malloc(sizeof(int) * MAX(num_nodes, 1));
+  for (int n = 0; n < num_nodes; ++n)
+    builder->head[n] = -1;
 }
 
-bool exodus_file_next_time(exodus_file_t* file,
-                           int* pos,
-                           int* time_index,
-                           real_t* time)
+static inline void sort_swap(int* a, int* b)
 {
-  if (*pos >= file->last_time_index)
-    return false;
+  int lo = (*a < *b) ? *a : *b;
+  int hi = (*a < *b) ? *b : *a;
+  *a = lo;
+  *b = hi;
+}
 
-  int next_index = *pos + 1;
-  int status = ex_get_time(file->ex_id, next_index, time);
-  if (status >= 0)
-  {
-    *time_index = *pos = next_index;
-    return true;
-  }
-  else
-    return false;
+// Sorts the given 3 or 4 face nodes into key, padding 3-node faces with -1 
+// so that they sort first.
+static inline void make_face_key(int num_nodes, const int* nodes, int* key)
+{
+  key[0] = (num_nodes == 4) ? nodes[3] : -1;
+  key[1] = nodes[0];
+  key[2] = nodes[1];
+  key[3] = nodes[2];
+  sort_swap(&key[0], &key[1]);
+  sort_swap(&key[2], &key[3]);
+  sort_swap(&key[0], &key[2]);
+  sort_swap(&key[1], &key[3]);
+  sort_swap(&key[1], &key[2]);
 }
 
-void exodus_file_write_element_field(exodus_file_t* file,
-                                     int time_index,
-                                     const char* field_name,
-                                     real_t* field_data)
+// Returns the index of the face with the given nodes, which belongs to 
+// the given cell, adding the face if it hasn't been encountered yet.
+static int face_builder_add(face_builder_t* builder,
+                            int cell,
+                            int num_nodes,
+                            const int* nodes)
 {
-  ASSERT(file->writing);
+  int key[4];
+  make_face_key(num_nodes, nodes, key);
+  int min_node = (num_nodes == 4) ? key[0] : key[1];
 
-  // Find the variable index if it already exists.
-  int index = 0;
-  while (index < file->elem_var_names->size)
+  // Have we seen this face already?
+  int prev = -1;
+  for (int f = builder->head[min_node]; f != -1; prev = f, f = builder->next[f])
   {
-    if (strcmp(field_name, file->elem_var_names->data[index]) == 0)
-      break;
-    ++index;
+    int offset = builder->face_node_offsets[f];
+    int f_num_nodes = builder->face_node_offsets[f+1] - offset;
+    if (f_num_nodes != num_nodes)
+      continue;
+    int f_key[4];
+    make_face_key(f_num_nodes, &builder->face_nodes[offset], f_key);
+    if ((f_key[0] == key[0]) && (f_key[1] == key[1]) && 
+        (f_key[2] == key[2]) && (f_key[3] == key[3]))
+    {
+      builder->face_cells[2*f+1] = cell;
+      if (prev == -1)
+        builder->head[min_node] = builder->next[f];
+      else
+        builder->next[prev] = builder->next[f];
+      return f;
+    }
   }
 
-  // Append the variable to our list if we didn't find it.
-  if (index >= file->elem_var_names->size)
-    string_array_append_with_dtor(file->elem_var_names, string_dup(field_name), string_free);
-
-  // Insert the data.
-  int offset = 0;
-  for (int i = 0; i < file->num_elem_blocks; ++i)
+  // Make room for a new face.
+  int face = builder->num_faces;
+  if (face == builder->face_capacity)
   {
-    int N;
-    ex_get_block(file->ex_id, EX_ELEM_BLOCK, file->elem_block_ids[i], NULL, &N, NULL, NULL, NULL, NULL);
-    ex_put_var(file->ex_id, time_index, EX_ELEM_BLOCK, index+1, i, N, &field_data[offset]);
-    offset += N;
+    builder->face_capacity *= 2;
+    builder->face_node_offsets = polymec_realloc(builder->face_node_offsets, sizeof(int) * (builder->face_capacity+1));
+    builder->face_cells = polymec_realloc(builder->face_cells, sizeof(int) * 2 * builder->face_capacity);
+    builder->next = polymec_realloc(builder->next, sizeof(int) * builder->face_capacity);
   }
+  int offset = builder->face_node_offsets[face];
+  if (offset + num_nodes > builder->face_node_capacity)
+  {
+    builder->face_node_capacity *= 2;
+    builder->face_nodes = polymec_realloc(builder->face_nodes, sizeof(int) * builder->face_node_capacity);
+  }
+
+  // Add it, taking its node ordering from this first encounter.
+  memcpy(&builder->face_nodes[offset], nodes, sizeof(int) * num_nodes);
+  builder->face_node_offsets[face+1] = offset + num_nodes;
+  builder->face_cells[2*face] = cell;
+  builder->face_cells[2*face+1] = -1;
+  builder->next[face] = builder->head[min_node];
+  builder->head[min_node] = face;
+  ++builder->num_faces;
+  return face;
 }
 
-real_t* exodus_file_read_element_field(exodus_file_t* file,
-                                       int time_index,
-                                       const char* field_name)
+// Reads the given set into a newly-created tag with the set's name.
+static void fetch_set_tag(exodus_file_t* file, 
+                          ex_entity_type set_type,
+                          int set_id,
+                          tagger_t* tags)
+{
+  char set_name[MAX_NAME_LENGTH+1];
+  ex_get_name(file->ex_id, set_type, (ex_entity_id)set_id, set_name);
+  int set_size;
+  int num_dist_factors;
+  ex_get_set_param(file->ex_id, set_type, (ex_entity_id)set_id, &set_size, &num_dist_factors);
+  int* tag = mesh_create_tag(tags, set_name, (size_t)set_size);
+  ex_get_set(file->ex_id, set_type, (ex_entity_id)set_id, tag, NULL);
+  for (int i = 0; i < set_size; ++i)
+    tag[i] -= 1;
+}
+
+// Returns the index of the face (as numbered by fe_element_get_face_nodes) 
+// of an element of the given type that is the given (1-based) Exodus side, 
+// or -1 if there's no such side.
+static int exodus_side_face(fe_mesh_element_t elem_type, int side)
 {
-  // Find the variable index.
-  int index = 0;
-  while (index < file->elem_var_names->size)
+  const elem_side_info_t* side_info = get_elem_side_info(elem_type);
+  if ((side < 1) || (side > side_info->num_sides))
+    return -1;
+
+  // Find the face with the same local nodes.
+  static const int local_nodes[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+  int side_key[4];
+  make_face_key(side_info->num_side_nodes[side-1], side_info->side_nodes[side-1], side_key);
+  for (int f = 0; f < side_info->num_sides; ++f)
   {
-    if (strcmp(field_name, file->elem_var_names->data[index]) == 0)
-      break;
-    ++index;
+    int face_nodes[4], face_key[4];
+    int num_face_nodes = fe_element_get_face_nodes(elem_type, f, local_nodes, face_nodes);
+    make_face_key(num_face_nodes, face_nodes, face_key);
+    if (memcmp(face_key, side_key, sizeof(face_key)) == 0)
+      return f;
   }
+  return -1;
+}
 
-  // Fetch the field data.
-  if (index < file->elem_var_names->size)
+// Reads the given side set into a newly-created face tag with the set's 
+// name, given the element types of the blocks of the mesh.
+static void fetch_side_set_tag(exodus_file_t* file, 
+                               int set_id,
+                               int* block_types,
+                               mesh_t* mesh)
+{
+  char set_name[MAX_NAME_LENGTH+1];
+  ex_get_name(file->ex_id, EX_SIDE_SET, (ex_entity_id)set_id, set_name);
+  int set_size;
+  int num_dist_factors;
+  ex_get_set_param(file->ex_id, EX_SIDE_SET, (ex_entity_id)set_id, &set_size, &num_dist_factors);
+  int* tag = mesh_create_tag(mesh->face_tags, set_name, (size_t)set_size);
+  int* elems = polymec_malloc(sizeof(int) * 2 * chunk_size);
+  int* sides = &elems[chunk_size];
+  int b = 0;
+  for (int first = 0; first < set_size; first += chunk_size)
   {
-    int offset = 0;
-    real_t* field = polymec_malloc(sizeof(real_t) * file->num_elem);
-    memset(field, 0, sizeof(real_t) * file->num_elem);
-    for (int i = 0; i < file->num_elem_blocks; ++i)
+    int n = MIN(chunk_size, set_size - first);
+    ex_get_partial_side_set(file->ex_id, (ex_entity_id)set_id, first+1, n, elems, sides);
+    for (int i = 0; i < n; ++i)
     {
-      int N;
-      ex_get_block(file->ex_id, EX_ELEM_BLOCK, file->elem_block_ids[i], NULL, &N, NULL, NULL, NULL, NULL);
-      ex_get_var(file->ex_id, time_index, EX_ELEM_BLOCK, index+1, i, N, &field[offset]);
-      offset += N;
+      int cell = elems[i] - 1;
+      if ((cell < 0) || (cell >= mesh->num_cells))
+        polymec_error("exodus_file_read_fv_mesh: Side set %s has an invalid element.", set_name);
+
+      // Find the element's block, starting from the last one.
+      if ((cell < file->elem_block_offsets[b]) || (cell >= file->elem_block_offsets[b+1]))
+      {
+        b = 0;
+        while (cell >= file->elem_block_offsets[b+1])
+          ++b;
+      }
+      int f = exodus_side_face((fe_mesh_element_t)block_types[b], sides[i]);
+      if (f == -1)
+        polymec_error("exodus_file_read_fv_mesh: Side set %s has an invalid side.", set_name);
+      tag[first+i] = mesh->cell_faces[mesh->cell_face_offsets[cell] + f];
     }
-    return field;
   }
-  else
-    return NULL;
+  polymec_free(elems);
 }
 
-bool exodus_file_contains_element_field(exodus_file_t* file, 
-                                        int time_index,
-                                        const char* field_name)
+mesh_t* exodus_file_read_fv_mesh(exodus_file_t* file)
 {
-  int index = 0;
-  while (index < file->elem_var_names->size)
-  {
-    if (strcmp(field_name, file->elem_var_names->data[index]) == 0)
-      return true;
-  }
-  return false;
-}
+  finish_async_output(file, "exodus_file_read_fv_mesh");
 
-void exodus_file_write_face_field(exodus_file_t* file,
-                                  int time_index,
-                                  const char* field_name,
-                                  real_t* field_data)
+  // Feel out the element blocks. Decomposed databases and polyhedral 
+  // elements are handled by way of a finite element mesh.
+  int* block_types = polymec_malloc(sizeof(int) * MAX(file->num_elem_blocks, 1));
+  int* block_nodes_per_elem = polymec_malloc(sizeof(int) * MAX(file->num_elem_blocks, 1));
+  int* cell_face_offsets = polymec_malloc(sizeof(int) * (file->num_elem + 1));
+  cell_face_offsets[0] = 0;
+  bool use_fe_mesh = file->decomposed;
+  int num_cells = 0;
+  for (int i = 0; (i < file->num_elem_blocks) && !use_fe_mesh; ++i)
+  {
+    int elem_block = file->elem_block_ids[i];
+    char elem_type_name[MAX_NAME_LENGTH+1];
+    int num_elem, num_nodes_per_elem;
+    ex_get_block(file->ex_id, EX_ELEM_BLOCK, elem_block, 
+                 elem_type_name, &num_elem,
+                 &num_nodes_per_elem, NULL, NULL, NULL);
+    fe_mesh_element_t elem_type = get_element_type(elem_type_name);
+    if (elem_type == FE_POLYHEDRON)
+      use_fe_mesh = true;
+    else if (elem_type == FE_INVALID)
+    {
+      ex_close(file->ex_id);
+      polymec_error("Block %d contains an invalid (3D) element type.", elem_block);
+    }
+    else
+    {
+      block_types[i] = (int)elem_type;
+      block_nodes_per_elem[i] = num_nodes_per_elem;
+      int num_elem_faces = fe_element_num_faces(elem_type);
+      for (int e = 0; e < num_elem; ++e, ++num_cells)
+        cell_face_offsets[num_cells+1] = cell_face_offsets[num_cells] + num_elem_faces;
+    }
+  }
+  if (use_fe_mesh)
+  {
+    polymec_free(cell_face_offsets);
+    polymec_free(block_nodes_per_elem);
+    polymec_free(block_types);
+    fe_mesh_t* fe_mesh = exodus_file_read_mesh(file);
+    mesh_t* mesh = mesh_from_fe_mesh(fe_mesh);
+    fe_mesh_free(fe_mesh);
+    return mesh;
+  }
+  ASSERT(num_cells == file->num_elem);
+
+  // Stream in the element->node connectivity for each block in chunks, 
+  // identifying the faces of each cell as we go. Most faces are shared by 
+  // two cells, so we start with room for half of the element faces.
+  int num_elem_faces = cell_face_offsets[num_cells];
+  int* cell_faces = polymec_malloc(sizeof(int) * MAX(num_elem_faces, 1));
+  face_builder_t builder;
+  face_builder_init(&builder, file->num_nodes, num_elem_faces/2 + 1);
+  int first_cell = 0;
+  for (int i = 0; i < file->num_elem_blocks; ++i)
+  {
+    int elem_block = file->elem_block_ids[i];
+    fe_mesh_element_t elem_type = (fe_mesh_element_t)block_types[i];
+    int num_nodes_per_elem = block_nodes_per_elem[i];
+    int num_elem_faces_per_elem = fe_element_num_faces(elem_type);
+    char elem_type_name[MAX_NAME_LENGTH+1];
+    int num_elem;
+    ex_get_block(file->ex_id, EX_ELEM_BLOCK, elem_block, 
+                 elem_type_name, &num_elem, NULL, NULL, NULL, NULL);
+    int* node_conn = polymec_malloc(sizeof(int) * MAX(chunk_size * num_nodes_per_elem, 1));
+    for (int first = 0; first < num_elem; first += chunk_size)
+    {
+      int n = MIN(chunk_size, num_elem - first);
+      ex_get_partial_conn(file->ex_id, EX_ELEM_BLOCK, elem_block, first+1, n, 
+                          node_conn, NULL, NULL);
+      for (int j = 0; j < n * num_nodes_per_elem; ++j)
+        node_conn[j] -= 1;
+      for (int e = 0; e < n; ++e)
+      {
+        int cell = first_cell + first + e;
+        const int* elem_nodes = &node_conn[e * num_nodes_per_elem];
+        for (int f = 0; f < num_elem_faces_per_elem; ++f)
+        {
+          int face_nodes[4];
+          int num_face_nodes = fe_element_get_face_nodes(elem_type, f, elem_nodes, face_nodes);
+          cell_faces[cell_face_offsets[cell]+f] = 
+            face_builder_add(&builder, cell, num_face_nodes, face_nodes);
+        }
+      }
+    }
+    polymec_free(node_conn);
+    first_cell += num_elem;
+  }
+  polymec_free(builder.head);
+  polymec_free(builder.next);
+  polymec_free(block_nodes_per_elem);
+
+  // Create the finite volume mesh and hand our connectivity to it, trimmed 
+  // to size, so that it's never held twice. The mesh's own connectivity 
+  // arrays are replaced rather than reserved.
+  int num_faces = builder.num_faces;
+  mesh_t* mesh = mesh_new(file->comm, num_cells, 0, num_faces, file->num_nodes);
+  polymec_free(mesh->cell_face_offsets);
+  mesh->cell_face_offsets = cell_face_offsets;
+  if (mesh->cell_faces != NULL)
+    polymec_free(mesh->cell_faces);
+  mesh->cell_faces = cell_faces;
+  polymec_free(mesh->face_node_offsets);
+  mesh->face_node_offsets = polymec_realloc(builder.face_node_offsets, 
+                                            sizeof(int) * (num_faces+1));
+  if (mesh->face_nodes != NULL)
+    polymec_free(mesh->face_nodes);
+  mesh->face_nodes = polymec_realloc(builder.face_nodes, 
+                                     sizeof(int) * MAX(mesh->face_node_offsets[num_faces], 1));
+  polymec_free(mesh->face_cells);
+  mesh->face_cells = polymec_realloc(builder.face_cells, 
+                                     sizeof(int) * MAX(2 * num_faces, 1));
+
+  // Construct edges, fetch node positions, and calculate geometry.
+  mesh_construct_edges(mesh);
+  fetch_node_positions(file, NULL, mesh->nodes);
+  mesh_compute_geometry(mesh);
+
+  // Sets -> tags. Face and edge sets refer to the file's face and edge 
+  // blocks, whose numbering is unrelated to that of our faces and edges, 
+  // so they're skipped. Side sets identify faces by their elements, so 
+  // they become face tags.
+  for (int i = 1; i <= file->num_elem_sets; ++i)
+    fetch_set_tag(file, EX_ELEM_SET, i, mesh->cell_tags);
+  for (int i = 1; i <= file->num_node_sets; ++i)
+    fetch_set_tag(file, EX_NODE_SET, i, mesh->node_tags);
+  for (int i = 1; i <= file->num_side_sets; ++i)
+    fetch_side_set_tag(file, i, block_types, mesh);
+  polymec_free(block_types);
+
+  return mesh;
+}
+
+// Returns the first of n items in the slab read by the given process when 
+// nprocs processes read n items in contiguous, evenly-sized slabs.
+static inline int slab_start(int rank, int n, int nprocs)
 {
-  ASSERT(file->writing);
+  return (int)(((size_t)rank * n) / nprocs);
+}
+
+// Returns the process whose slab contains item i of n.
+static inline int slab_owner(int i, int n, int nprocs)
+{
+  return (int)(((size_t)(i+1) * nprocs - 1) / n);
+}
 
-  // Find the variable index if it already exists.
-  int index = 0;
-  while (index < file->face_var_names->size)
+// Reads n entries of the given set, starting at the given (0-based) 
+// position, converting them to 0-based indices. For side sets, the sides 
+// of the entries are read into sides. Exodus has partial reads only for 
+// node and side sets, so element sets are read as NetCDF hyperslabs.
+static void fetch_partial_set(exodus_file_t* file, 
+                              ex_entity_type set_type,
+                              int set_id,
+                              int first,
+                              int n,
+                              int* entries,
+                              int* sides)
+{
+  if (n == 0)
+    return;
+  if (set_type == EX_NODE_SET)
+    ex_get_partial_node_set(file->ex_id, (ex_entity_id)set_id, first+1, n, entries);
+  else if (set_type == EX_SIDE_SET)
+    ex_get_partial_side_set(file->ex_id, (ex_entity_id)set_id, first+1, n, entries, sides);
+  else
   {
-    if (strcmp(field_name, file->face_var_names->data[index]) == 0)
-      break;
-    ++index;
+    ASSERT(set_type == EX_ELEM_SET);
+    int var_id, set_index = ex_id_lkup(file->ex_id, EX_ELEM_SET, (ex_entity_id)set_id);
+    size_t start = (size_t)first, count = (size_t)n;
+    nc_inq_varid(file->ex_id, VAR_ELEM_ELS(set_index), &var_id);
+    nc_get_vara_int(file->ex_id, var_id, &start, &count, entries);
   }
+  for (int i = 0; i < n; ++i)
+    entries[i] -= 1;
+}
 
-  // Append the variable to our list if we didn't find it.
-  if (index >= file->face_var_names->size)
-    string_array_append_with_dtor(file->face_var_names, string_dup(field_name), string_free);
+// Orders set tuples by their first values, which are positions within a 
+// set (for qsort).
+static int set_tuple_cmp(const void* l, const void* r)
+{
+  const int* lp = l;
+  const int* rp = r;
+  return (lp[0] < rp[0]) ? -1 : (lp[0] > rp[0]) ? 1 : 0;
+}
 
-  // Insert the data.
-  int offset = 0;
-  for (int i = 0; i < file->num_face_blocks; ++i)
+// Sends the tuples in sends[p] to each process p, returning the tuples 
+// received from all processes in an array. If tuple_size is nonzero, the 
+// received tuples are ordered by their first values.
+static int_array_t* exchange_tuples(MPI_Comm comm, 
+                                    int_array_t** sends, 
+                                    int tuple_size)
+{
+  int nprocs;
+  MPI_Comm_size(comm, &nprocs);
+  int send_counts[nprocs], send_offsets[nprocs], recv_counts[nprocs], recv_offsets[nprocs];
+  int num_sent = 0;
+  for (int p = 0; p < nprocs; ++p)
   {
-    int N;
-    ex_get_block(file->ex_id, EX_FACE_BLOCK, file->face_block_ids[i], NULL, &N, NULL, NULL, NULL, NULL);
-    ex_put_var(file->ex_id, time_index, EX_FACE_BLOCK, index+1, i, N, &field_data[offset]);
-    offset += N;
+    send_counts[p] = (int)sends[p]->size;
+    send_offsets[p] = num_sent;
+    num_sent += send_counts[p];
   }
+  MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, comm);
+  int num_received = 0;
+  for (int p = 0; p < nprocs; ++p)
+  {
+    recv_offsets[p] = num_received;
+    num_received += recv_counts[p];
+  }
+  int* send_data = polymec_malloc(sizeof(int) * (num_sent + 1));
+  for (int p = 0; p < nprocs; ++p)
+    memcpy(&send_data[send_offsets[p]], sends[p]->data, sizeof(int) * send_counts[p]);
+  int_array_t* received = int_array_new();
+  int_array_resize(received, num_received);
+  MPI_Alltoallv(send_data, send_counts, send_offsets, MPI_INT, 
+                received->data, recv_counts, recv_offsets, MPI_INT, comm);
+  polymec_free(send_data);
+  if (tuple_size > 0)
+    qsort(received->data, num_received / tuple_size, sizeof(int) * tuple_size, set_tuple_cmp);
+  return received;
 }
 
-real_t* exodus_file_read_face_field(exodus_file_t* file,
-                                    int time_index,
-                                    const char* field_name)
+// Nodes referenced by a process are read in runs of consecutive nodes, 
+// bridging gaps of up to this many unreferenced nodes, and spanning no more 
+// than the maximum run length.
+static const int node_run_max_gap = 256;
+static const int node_run_max_length = 65536;
+
+fe_mesh_t* exodus_file_read_distributed_mesh(exodus_file_t* file)
 {
-  // Find the variable index.
-  int index = 0;
-  while (index < file->face_var_names->size)
+  finish_async_output(file, "exodus_file_read_distributed_mesh");
+
+  int rank, nprocs;
+  MPI_Comm_rank(file->comm, &rank);
+  MPI_Comm_size(file->comm, &nprocs);
+
+  // We read a contiguous slab of elements [first_elem, end_elem).
+  int first_elem = slab_start(rank, file->num_elem, nprocs);
+  int end_elem = slab_start(rank+1, file->num_elem, nprocs);
+  int num_elem = end_elem - first_elem;
+
+  // Read the portion of each block's element->node connectivity that falls 
+  // within our slab.
+  int num_blocks = file->num_elem_blocks;
+  int block_num_elem[num_blocks], block_num_elem_nodes[num_blocks];
+  fe_mesh_element_t block_elem_types[num_blocks];
+  int* block_conn[num_blocks];
+  int block_start = 0;
+  for (int i = 0; i < num_blocks; ++i)
   {
-    if (strcmp(field_name, file->face_var_names->data[index]) == 0)
-      break;
-    ++index;
+    int elem_block = file->elem_block_ids[i];
+    char elem_type_name[MAX_NAME_LENGTH+1];
+    int num_block_elem, num_nodes_per_elem, num_faces_per_elem;
+    ex_get_block(file->ex_id, EX_ELEM_BLOCK, elem_block, 
+                 elem_type_name, &num_block_elem,
+                 &num_nodes_per_elem, NULL,
+                 &num_faces_per_elem, NULL);
+    fe_mesh_element_t elem_type = get_element_type(elem_type_name);
+    if (elem_type == FE_POLYHEDRON)
+    {
+      ex_close(file->ex_id);
+      polymec_error("exodus_file_read_distributed_mesh: Block %d is polyhedral, and can't be distributed.", elem_block);
+    }
+    else if (elem_type == FE_INVALID)
+    {
+      ex_close(file->ex_id);
+      polymec_error("Block %d contains an invalid (3D) element type.", elem_block);
+    }
+
+    int start = MAX(first_elem, block_start);
+    int end = MIN(end_elem, block_start + num_block_elem);
+    block_num_elem[i] = MAX(end - start, 0);
+    block_num_elem_nodes[i] = num_nodes_per_elem;
+    block_elem_types[i] = elem_type;
+    block_conn[i] = polymec_malloc(sizeof(int) * block_num_elem[i] * num_nodes_per_elem);
+    if (block_num_elem[i] > 0)
+    {
+      ex_get_partial_conn(file->ex_id, EX_ELEM_BLOCK, elem_block, 
+                          start - block_start + 1, block_num_elem[i], 
+                          block_conn[i], NULL, NULL);
+    }
+    block_start += num_block_elem;
+  }
+
+  // Gather the (0-based) indices of the nodes we reference, which become our 
+  // nodes' global indices, in increasing order.
+  int_array_t* node_ids = int_array_new();
+  for (int i = 0; i < num_blocks; ++i)
+  {
+    for (int j = 0; j < block_num_elem[i] * block_num_elem_nodes[i]; ++j)
+      int_array_append(node_ids, block_conn[i][j] - 1);
+  }
+  int_qsort(node_ids->data, node_ids->size);
+  int num_nodes = 0;
+  for (int n = 0; n < node_ids->size; ++n)
+  {
+    if ((n == 0) || (node_ids->data[n] != node_ids->data[num_nodes-1]))
+      node_ids->data[num_nodes++] = node_ids->data[n];
+  }
+  int_array_resize(node_ids, num_nodes);
+  int_int_unordered_map_t* node_map = int_int_unordered_map_new();
+  for (int n = 0; n < num_nodes; ++n)
+    int_int_unordered_map_insert(node_map, node_ids->data[n], n);
+
+  // Create our portion of the mesh, keeping empty blocks so that the blocks 
+  // line up across processes.
+  fe_mesh_t* mesh = fe_mesh_new(file->comm, num_nodes);
+  for (int i = 0; i < num_blocks; ++i)
+  {
+    int* conn = block_conn[i];
+    for (int j = 0; j < block_num_elem[i] * block_num_elem_nodes[i]; ++j)
+      conn[j] = *int_int_unordered_map_get(node_map, conn[j] - 1);
+    fe_block_t* block = fe_block_new(block_num_elem[i], block_elem_types[i], 
+                                     block_num_elem_nodes[i], conn);
+    polymec_free(conn);
+
+    int elem_block = file->elem_block_ids[i];
+    char block_name[MAX_NAME_LENGTH+1];
+    ex_get_name(file->ex_id, EX_ELEM_BLOCK, elem_block, block_name);
+    if (strlen(block_name) == 0)
+      sprintf(block_name, "block_%d", elem_block);
+    fe_mesh_add_block(mesh, block_name, block);
   }
 
-  // Fetch the field data.
-  if (index < file->face_var_names->size)
+  // Read the positions and identifiers of our nodes in runs.
+  point_t* X = fe_mesh_node_positions(mesh);
+  real_t* x = polymec_malloc(sizeof(real_t) * node_run_max_length);
+  real_t* y = polymec_malloc(sizeof(real_t) * node_run_max_length);
+  real_t* z = polymec_malloc(sizeof(real_t) * node_run_max_length);
+  int* run_ids = polymec_malloc(sizeof(int) * node_run_max_length);
+  int* node_labels = polymec_malloc(sizeof(int) * (num_nodes + 1));
+  int n = 0;
+  while (n < num_nodes)
   {
-    int offset = 0;
-    real_t* field = polymec_malloc(sizeof(real_t) * file->num_faces);
-    memset(field, 0, sizeof(real_t) * file->num_faces);
-    for (int i = 0; i < file->num_face_blocks; ++i)
+    int first_node = node_ids->data[n], end = n + 1;
+    while ((end < num_nodes) && 
+           (node_ids->data[end] - node_ids->data[end-1] <= node_run_max_gap) &&
+           (node_ids->data[end] - first_node < node_run_max_length))
+      ++end;
+    int run_length = node_ids->data[end-1] - first_node + 1;
+    ex_get_partial_coord(file->ex_id, first_node + 1, run_length, x, y, z);
+    ex_get_partial_id_map(file->ex_id, EX_NODE_MAP, first_node + 1, run_length, run_ids);
+    for (; n < end; ++n)
     {
-      int N;
-      ex_get_block(file->ex_id, EX_FACE_BLOCK, file->face_block_ids[i], NULL, &N, NULL, NULL, NULL, NULL);
-      ex_get_var(file->ex_id, time_index, EX_FACE_BLOCK, index+1, i, N, &field[offset]);
-      offset += N;
+      int i = node_ids->data[n] - first_node;
+      X[n].x = x[i];
+      X[n].y = y[i];
+      X[n].z = z[i];
+      node_labels[n] = run_ids[i];
     }
-    return field;
   }
-  else
-    return NULL;
+  polymec_free(x);
+  polymec_free(y);
+  polymec_free(z);
+  polymec_free(run_ids);
+  fe_mesh_set_node_ids(mesh, node_labels);
+  polymec_free(node_labels);
+
+  // Our elements' identifiers are those of our slab.
+  int* elem_labels = polymec_malloc(sizeof(int) * (num_elem + 1));
+  fetch_id_map(file, EX_ELEM_MAP, first_elem, num_elem, elem_labels);
+  fe_mesh_set_element_ids(mesh, elem_labels);
+  polymec_free(elem_labels);
+
+  // Fetch element, node, and side sets. Each process reads a slab of each 
+  // set and sends its entries, tagged with their positions in the set, to 
+  // the processes that have the elements and nodes they refer to, which 
+  // keep them in order. Element slabs tell us where elements are. Nodes 
+  // can be on several processes, so each of them has a "home" process (by 
+  // slabs of nodes) that learns which processes have it, and passes node 
+  // set entries along to them.
+  int_array_t** sends = polymec_malloc(sizeof(int_array_t*) * nprocs);
+  for (int p = 0; p < nprocs; ++p)
+    sends[p] = int_array_new();
+  int* set_entries = polymec_malloc(sizeof(int) * 2 * chunk_size);
+  int* set_sides = &set_entries[chunk_size];
+  for (int i = 1; i <= file->num_elem_sets + file->num_side_sets; ++i)
+  {
+    bool is_side_set = (i > file->num_elem_sets);
+    ex_entity_type set_type = is_side_set ? EX_SIDE_SET : EX_ELEM_SET;
+    int set_id = is_side_set ? i - file->num_elem_sets : i;
+    int tuple_size = is_side_set ? 3 : 2;
+    char set_name[MAX_NAME_LENGTH+1];
+    int set_size, num_dist_factors;
+    ex_get_name(file->ex_id, set_type, (ex_entity_id)set_id, set_name);
+    ex_get_set_param(file->ex_id, set_type, (ex_entity_id)set_id, &set_size, &num_dist_factors);
+    int first = slab_start(rank, set_size, nprocs), end = slab_start(rank+1, set_size, nprocs);
+    for (int p = 0; p < nprocs; ++p)
+      int_array_clear(sends[p]);
+    for (int j = first; j < end; j += chunk_size)
+    {
+      int n = MIN(chunk_size, end - j);
+      fetch_partial_set(file, set_type, set_id, j, n, set_entries, set_sides);
+      for (int k = 0; k < n; ++k)
+      {
+        int_array_t* send = sends[slab_owner(set_entries[k], file->num_elem, nprocs)];
+        int_array_append(send, j + k);
+        int_array_append(send, set_entries[k]);
+        if (is_side_set)
+          int_array_append(send, set_sides[k]);
+      }
+    }
+    int_array_t* received = exchange_tuples(file->comm, sends, tuple_size);
+    int num_entries = (int)received->size / tuple_size;
+    int* mesh_set = is_side_set ? fe_mesh_create_side_set(mesh, set_name, num_entries)
+                                : fe_mesh_create_element_set(mesh, set_name, num_entries);
+    for (int k = 0; k < num_entries; ++k)
+    {
+      int* tuple = &received->data[tuple_size*k];
+      if (is_side_set)
+      {
+        mesh_set[2*k] = tuple[1] - first_elem;
+        mesh_set[2*k+1] = tuple[2];
+      }
+      else
+        mesh_set[k] = tuple[1] - first_elem;
+    }
+    int_array_free(received);
+  }
+  if (file->num_node_sets > 0)
+  {
+    // Tell each node's home process that we have it.
+    for (int p = 0; p < nprocs; ++p)
+      int_array_clear(sends[p]);
+    for (int n = 0; n < num_nodes; ++n)
+    {
+      int_array_t* send = sends[slab_owner(node_ids->data[n], file->num_nodes, nprocs)];
+      int_array_append(send, rank);
+      int_array_append(send, node_ids->data[n]);
+    }
+    int_array_t* holdings = exchange_tuples(file->comm, sends, 0);
+    int num_holdings = (int)holdings->size / 2;
+
+    // Make a list of the processes that have each of our home nodes.
+    int first_home_node = slab_start(rank, file->num_nodes, nprocs);
+    int num_home_nodes = slab_start(rank+1, file->num_nodes, nprocs) - first_home_node;
+    int* holder_offsets = polymec_malloc(sizeof(int) * (num_home_nodes + 1));
+    memset(holder_offsets, 0, sizeof(int) * (num_home_nodes + 1));
+    for (int j = 0; j < num_holdings; ++j)
+      ++holder_offsets[holdings->data[2*j+1] - first_home_node + 1];
+    for (int n = 0; n < num_home_nodes; ++n)
+      holder_offsets[n+1] += holder_offsets[n];
+    int* holders = polymec_malloc(sizeof(int) * (num_holdings + 1));
+    for (int j = 0; j < num_holdings; ++j)
+    {
+      int n = holdings->data[2*j+1] - first_home_node;
+      holders[holder_offsets[n]++] = holdings->data[2*j];
+    }
+    for (int n = num_home_nodes; n > 0; --n)
+      holder_offsets[n] = holder_offsets[n-1];
+    holder_offsets[0] = 0;
+    int_array_free(holdings);
+
+    for (int i = 1; i <= file->num_node_sets; ++i)
+    {
+      char set_name[MAX_NAME_LENGTH+1];
+      int set_size, num_dist_factors;
+      ex_get_name(file->ex_id, EX_NODE_SET, (ex_entity_id)i, set_name);
+      ex_get_set_param(file->ex_id, EX_NODE_SET, (ex_entity_id)i, &set_size, &num_dist_factors);
+
+      // Send our slab of the set to the nodes' home processes...
+      int first = slab_start(rank, set_size, nprocs), end = slab_start(rank+1, set_size, nprocs);
+      for (int p = 0; p < nprocs; ++p)
+        int_array_clear(sends[p]);
+      for (int j = first; j < end; j += chunk_size)
+      {
+        int n = MIN(chunk_size, end - j);
+        fetch_partial_set(file, EX_NODE_SET, i, j, n, set_entries, NULL);
+        for (int k = 0; k < n; ++k)
+        {
+          int_array_t* send = sends[slab_owner(set_entries[k], file->num_nodes, nprocs)];
+          int_array_append(send, j + k);
+          int_array_append(send, set_entries[k]);
+        }
+      }
+      int_array_t* home_entries = exchange_tuples(file->comm, sends, 2);
+
+      // ...which pass them along to the processes that have the nodes.
+      for (int p = 0; p < nprocs; ++p)
+        int_array_clear(sends[p]);
+      for (size_t j = 0; j < home_entries->size; j += 2)
+      {
+        int n = home_entries->data[j+1] - first_home_node;
+        for (int k = holder_offsets[n]; k < holder_offsets[n+1]; ++k)
+        {
+          int_array_append(sends[holders[k]], home_entries->data[j]);
+          int_array_append(sends[holders[k]], home_entries->data[j+1]);
+        }
+      }
+      int_array_free(home_entries);
+      int_array_t* received = exchange_tuples(file->comm, sends, 2);
+      int num_entries = (int)received->size / 2;
+      int* mesh_set = fe_mesh_create_node_set(mesh, set_name, num_entries);
+      for (int k = 0; k < num_entries; ++k)
+        mesh_set[k] = *int_int_unordered_map_get(node_map, received->data[2*k+1]);
+      int_array_free(received);
+    }
+    polymec_free(holders);
+    polymec_free(holder_offsets);
+  }
+  polymec_free(set_entries);
+  for (int p = 0; p < nprocs; ++p)
+    int_array_free(sends[p]);
+  polymec_free(sends);
+  int_int_unordered_map_free(node_map);
+
+  // Our elements' global indices are those of our slab.
+  int* elem_ids = polymec_malloc(sizeof(int) * num_elem);
+  for (int e = 0; e < num_elem; ++e)
+    elem_ids[e] = first_elem + e;
+
+  // Add ghost elements and nodes.
+  fe_mesh_add_ghosts(&mesh, elem_ids, node_ids->data);
+  polymec_free(elem_ids);
+  int_array_free(node_ids);
+
+  return mesh;
 }
 
-bool exodus_file_contains_face_field(exodus_file_t* file, 
-                                     int time_index,
-                                     const char* field_name)
+bool exodus_file_join(const char* prefix, 
+                      int num_files,
+                      const char* filename)
 {
-  int index = 0;
-  while (index < file->face_var_names->size)
+  ASSERT(num_files > 0);
+
+  // Read each process's portion of the mesh.
+  fe_mesh_t* parts[num_files];
+  int* part_elem_ids[num_files];
+  int* part_node_ids[num_files];
+  char title[MAX_NAME_LENGTH+1];
+  int num_nodes = 0, num_elem = 0, num_blocks = 0, num_node_sets = 0, num_side_sets = 0;
+  for (int p = 0; p < num_files; ++p)
   {
-    if (strcmp(field_name, file->face_var_names->data[index]) == 0)
-      return true;
+    exodus_file_t* file = open_decomposed_file(MPI_COMM_SELF, prefix, num_files, p, EX_READ);
+    if (file == NULL)
+    {
+      for (int q = 0; q < p; ++q)
+      {
+        fe_mesh_free(parts[q]);
+        polymec_free(part_elem_ids[q]);
+        polymec_free(part_node_ids[q]);
+      }
+      return false;
+    }
+    if (p == 0)
+    {
+      strncpy(title, file->title, MAX_NAME_LENGTH);
+      title[MAX_NAME_LENGTH] = '\0';
+      ex_get_init_global(file->ex_id, &num_nodes, &num_elem, &num_blocks, 
+                         &num_node_sets, &num_side_sets);
+    }
+    parts[p] = read_decomposed_mesh(file, &part_elem_ids[p], &part_node_ids[p]);
+    exodus_file_close(file);
   }
-  return false;
+
+  // Place each node, and find the process, block, and local index of each 
+  // element.
+  fe_mesh_t* mesh = fe_mesh_new(MPI_COMM_SELF, num_nodes);
+  point_t* X = fe_mesh_node_positions(mesh);
+  int* elem_procs = polymec_malloc(sizeof(int) * 4 * num_elem);
+  int* elem_blocks = &elem_procs[num_elem];
+  int* elem_indices = &elem_procs[2*num_elem];
+  int* elem_map = &elem_procs[3*num_elem]; // global index -> joined index
+  for (int id = 0; id < num_elem; ++id)
+    elem_blocks[id] = -1;
+  bool success = true;
+  for (int p = 0; p < num_files; ++p)
+  {
+    point_t* Xp = fe_mesh_node_positions(parts[p]);
+    for (int n = 0; n < fe_mesh_num_nodes(parts[p]); ++n)
+    {
+      ASSERT(part_node_ids[p][n] < num_nodes);
+      X[part_node_ids[p][n]] = Xp[n];
+    }
+
+    int pos = 0, e = 0;
+    char* block_name;
+    fe_block_t* block;
+    while (fe_mesh_next_block(parts[p], &pos, &block_name, &block))
+    {
+      for (int i = 0; i < fe_block_num_elements(block); ++i, ++e)
+      {
+        int id = part_elem_ids[p][e];
+        if ((id < 0) || (id >= num_elem))
+        {
+          success = false;
+          continue;
+        }
+        elem_procs[id] = p;
+        elem_blocks[id] = pos-1;
+        elem_indices[id] = e;
+      }
+    }
+  }
+
+  // Every element in the database must be in one of its files.
+  for (int id = 0; id < num_elem; ++id)
+    success = success && (elem_blocks[id] != -1);
+  if (!success)
+  {
+    polymec_free(elem_procs);
+    fe_mesh_free(mesh);
+    for (int p = 0; p < num_files; ++p)
+    {
+      fe_mesh_free(parts[p]);
+      polymec_free(part_elem_ids[p]);
+      polymec_free(part_node_ids[p]);
+    }
+    return false;
+  }
+
+  // Assemble the blocks, ordering their elements by global index.
+  int pos = 0, offset = 0;
+  char* block_name;
+  fe_block_t* block;
+  while (fe_mesh_next_block(parts[0], &pos, &block_name, &block))
+  {
+    // The block may be empty in some of the files (including the first), 
+    // so we take its element type from the first file that records one, and 
+    // its number of nodes per element from one of its elements.
+    int b = pos-1, num_block_elem = 0, num_elem_nodes = 0;
+    fe_mesh_element_t elem_type = FE_INVALID;
+    for (int p = 0; (p < num_files) && (elem_type == FE_INVALID); ++p)
+    {
+      int part_pos = b;
+      char* part_block_name;
+      fe_block_t* part_block;
+      if (fe_mesh_next_block(parts[p], &part_pos, &part_block_name, &part_block))
+        elem_type = fe_block_element_type(part_block);
+    }
+    for (int id = 0; id < num_elem; ++id)
+    {
+      if (elem_blocks[id] == b)
+      {
+        if (num_block_elem == 0)
+        {
+          int e;
+          fe_block_t* part_block = fe_mesh_element_block(parts[elem_procs[id]], elem_indices[id], &e);
+          num_elem_nodes = fe_block_num_element_nodes(part_block, e);
+        }
+        elem_map[id] = offset + num_block_elem++;
+      }
+    }
+    int* elem_nodes = polymec_malloc(sizeof(int) * (num_block_elem * num_elem_nodes + 1));
+    for (int id = 0; id < num_elem; ++id)
+    {
+      if (elem_blocks[id] == b)
+      {
+        int p = elem_procs[id], n;
+        const int* nodes = fe_mesh_element_nodes(parts[p], elem_indices[id], &n);
+        ASSERT(n == num_elem_nodes);
+        int* joined_nodes = &elem_nodes[num_elem_nodes * (elem_map[id] - offset)];
+        for (int i = 0; i < n; ++i)
+          joined_nodes[i] = part_node_ids[p][nodes[i]];
+      }
+    }
+    fe_mesh_add_block(mesh, block_name, fe_block_new(num_block_elem, elem_type,
+                                                     num_elem_nodes, elem_nodes));
+    polymec_free(elem_nodes);
+    offset += num_block_elem;
+  }
+
+  // Assemble the element, node, and side sets, which are the unions of 
+  // those on each process.
+  int num_elem_sets = fe_mesh_num_element_sets(parts[0]);
+  for (int i = 0; i < num_elem_sets + num_node_sets + num_side_sets; ++i)
+  {
+    bool (*next_set)(fe_mesh_t*, int*, char**, int**, size_t*);
+    int* (*create_set)(fe_mesh_t*, const char*, size_t);
+    int set_index = i, tuple_size = 1;
+    if (i < num_elem_sets)
+    {
+      next_set = fe_mesh_next_element_set;
+      create_set = fe_mesh_create_element_set;
+    }
+    else if (i < num_elem_sets + num_node_sets)
+    {
+      next_set = fe_mesh_next_node_set;
+      create_set = fe_mesh_create_node_set;
+      set_index -= num_elem_sets;
+    }
+    else
+    {
+      next_set = fe_mesh_next_side_set;
+      create_set = fe_mesh_create_side_set;
+      set_index -= num_elem_sets + num_node_sets;
+      tuple_size = 2;
+    }
+
+    int_array_t* entries = int_array_new();
+    char* set_name = NULL;
+    for (int p = 0; p < num_files; ++p)
+    {
+      int set_pos = 0, *set;
+      size_t set_size;
+      for (int j = 0; j <= set_index; ++j)
+        next_set(parts[p], &set_pos, &set_name, &set, &set_size);
+      for (size_t j = 0; j < set_size; j += tuple_size)
+      {
+        if (next_set == fe_mesh_next_node_set)
+          int_array_append(entries, part_node_ids[p][set[j]]);
+        else
+        {
+          int_array_append(entries, elem_map[part_elem_ids[p][set[j]]]);
+          if (tuple_size == 2)
+            int_array_append(entries, set[j+1]);
+        }
+      }
+    }
+
+    // Sort the entries, discarding duplicate (shared) nodes.
+    int num_entries = (int)entries->size / tuple_size;
+    if (tuple_size == 1)
+    {
+      int_qsort(entries->data, num_entries);
+      int num_unique = 0;
+      for (int j = 0; j < num_entries; ++j)
+      {
+        if ((num_unique == 0) || (entries->data[j] != entries->data[num_unique-1]))
+          entries->data[num_unique++] = entries->data[j];
+      }
+      num_entries = num_unique;
+    }
+    else
+      qsort(entries->data, num_entries, 2*sizeof(int), int_pair_cmp);
+    int* set = create_set(mesh, set_name, num_entries);
+    memcpy(set, entries->data, sizeof(int) * tuple_size * num_entries);
+    int_array_free(entries);
+  }
+  polymec_free(elem_procs);
+
+  // Write out the joined mesh.
+  exodus_file_t* file = exodus_file_new(MPI_COMM_SELF, filename);
+  success = (file != NULL);
+  if (success)
+  {
+    exodus_file_set_title(file, title);
+    exodus_file_write_mesh(file, mesh);
+    exodus_file_close(file);
+  }
+
+  // Clean up.
+  fe_mesh_free(mesh);
+  for (int p = 0; p < num_files; ++p)
+  {
+    fe_mesh_free(parts[p]);
+    polymec_free(part_elem_ids[p]);
+    polymec_free(part_node_ids[p]);
+  }
+  return success;
 }
 
-void exodus_file_write_edge_field(exodus_file_t* file,
-                                  int time_index,
-                                  const char* field_name,
-                                  real_t* field_data)
+void exodus_file_split(MPI_Comm comm,
+                       const char* filename,
+                       const char* prefix)
+{
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Read the mesh on rank 0 and distribute it.
+  fe_mesh_t* mesh = NULL;
+  char title[MAX_NAME_LENGTH+1];
+  if (rank == 0)
+  {
+    if (!file_exists(filename))
+      polymec_error("exodus_file_split: %s does not exist.", filename);
+    exodus_file_t* file = open_exodus_file(MPI_COMM_SELF, filename, EX_READ, 0, false);
+    strncpy(title, file->title, MAX_NAME_LENGTH);
+    title[MAX_NAME_LENGTH] = '\0';
+    mesh = exodus_file_read_mesh(file);
+    exodus_file_close(file);
+  }
+  MPI_Bcast(title, MAX_NAME_LENGTH+1, MPI_CHAR, 0, comm);
+  partition_fe_mesh(&mesh, comm, NULL);
+
+  // Write each process's portion.
+  exodus_file_t* file = exodus_file_new_decomposed(comm, prefix);
+  exodus_file_set_title(file, title);
+  exodus_file_write_mesh(file, mesh);
+  exodus_file_close(file);
+  fe_mesh_free(mesh);
+}
+
+int exodus_file_truncate(exodus_file_t* file, real_t restart_time)
 {
   ASSERT(file->writing);
+  finish_async_output(file, "exodus_file_truncate");
+  if (file->last_time_index > 0)
+  {
+    real_t* times = polymec_malloc(sizeof(real_t) * file->last_time_index);
+    if (ex_get_all_times(file->ex_id, times) < 0)
+      polymec_error("exodus_file_truncate: Couldn't read times from %s.", file->filename);
+    while ((file->last_time_index > 0) && 
+           (times[file->last_time_index-1] > restart_time))
+      --file->last_time_index;
+    polymec_free(times);
+  }
+  return file->last_time_index;
+}
+
+int exodus_file_write_time(exodus_file_t* file, real_t time)
+{
+  ASSERT(file->writing);
+  int next_index = file->last_time_index + 1;
+  int status = put_time(file, next_index, time);
+  if (status >= 0)
+    file->last_time_index = next_index;
+  else 
+    next_index = status;
+  return next_index;
+}
+
+bool exodus_file_next_time(exodus_file_t* file,
+                           int* pos,
+                           int* time_index,
+                           real_t* time)
+{
+  finish_async_output(file, "exodus_file_next_time");
+
+  if (*pos >= file->last_time_index)
+    return false;
 
-  // Find the variable index if it already exists.
-  int index = 0;
-  while (index < file->edge_var_names->size)
+  int next_index = *pos + 1;
+  int status = ex_get_time(file->ex_id, next_index, time);
+  if (status >= 0)
   {
-    if (strcmp(field_name, file->edge_var_names->data[index]) == 0)
-      break;
-    ++index;
+    *time_index = *pos = next_index;
+    return true;
   }
+  else
+    return false;
+}
 
-  // Append the variable to our list if we didn't find it.
-  if (index >= file->edge_var_names->size)
-    string_array_append_with_dtor(file->edge_var_names, string_dup(field_name), string_free);
+// Reads the field data for the variable with the given index from the 
+// blocks of the given type, returning a newly-allocated array.
+static real_t* read_block_field(exodus_file_t* file,
+                                int time_index,
+                                ex_entity_type block_type,
+                                int num_blocks,
+                                int* block_ids,
+                                int* block_offsets,
+                                int var_index)
+{
+  int num_entities = (num_blocks > 0) ? block_offsets[num_blocks] : 0;
+  real_t* field = polymec_malloc(sizeof(real_t) * num_entities);
+  memset(field, 0, sizeof(real_t) * num_entities);
+  for (int i = 0; i < num_blocks; ++i)
+  {
+    int offset = block_offsets[i];
+    int N = block_offsets[i+1] - offset;
+    ex_get_var(file->ex_id, time_index, block_type, var_index+1, 
+               block_ids[i], N, &field[offset]);
+  }
+  return field;
+}
 
-  // Insert the data.
-  int offset = 0;
-  for (int i = 0; i < file->num_edge_blocks; ++i)
+// Adds the given names to the given variable table, returning a newly-
+// allocated truth table that defines each of them on all of the given 
+// number of blocks or sets (or NULL if there are no names).
+static int* add_vars(var_table_t* vars, 
+                     string_array_t* names, 
+                     int num_entities,
+                     int* num_vars)
+{
+  *num_vars = (names != NULL) ? (int)names->size : 0;
+  if (*num_vars == 0)
+    return NULL;
+  for (int i = 0; i < *num_vars; ++i)
   {
-    int N;
-    ex_get_block(file->ex_id, EX_EDGE_BLOCK, file->edge_block_ids[i], NULL, &N, NULL, NULL, NULL, NULL);
-    ex_put_var(file->ex_id, time_index, EX_EDGE_BLOCK, index+1, i, N, &field_data[offset]);
-    offset += N;
+    if (var_table_index(vars, names->data[i]) != -1)
+      polymec_error("exodus_file_define_fields: Field %s is defined twice.", names->data[i]);
+    var_table_add(vars, names->data[i]);
   }
+  int* truth_table = polymec_malloc(sizeof(int) * MAX(num_entities * (*num_vars), 1));
+  for (int i = 0; i < num_entities * (*num_vars); ++i)
+    truth_table[i] = 1;
+  return truth_table;
 }
 
-real_t* exodus_file_read_edge_field(exodus_file_t* file,
-                                    int time_index,
-                                    const char* field_name)
+// Writes the names of the variables in the given table to the file.
+static void put_var_names(exodus_file_t* file, 
+                          ex_entity_type obj_type, 
+                          var_table_t* vars)
 {
-  // Find the variable index.
-  int index = 0;
-  while (index < file->edge_var_names->size)
+  if (vars->names->size > 0)
+    ex_put_variable_names(file->ex_id, obj_type, (int)vars->names->size, vars->names->data);
+}
+
+void exodus_file_define_fields(exodus_file_t* file,
+                               string_array_t* global_fields,
+                               string_array_t* node_fields,
+                               string_array_t* element_fields,
+                               string_array_t* face_fields,
+                               string_array_t* edge_fields,
+                               string_array_t* node_set_fields,
+                               string_array_t* element_set_fields,
+                               string_array_t* side_set_fields)
+{
+  ASSERT(file->writing);
+  if (file->vars_defined)
+    polymec_error("exodus_file_define_fields: Fields have already been defined.");
+  if (file->last_time_index > 0)
+    polymec_error("exodus_file_define_fields: Fields must be defined before any times are written.");
+  if ((file->node_starts != NULL) && (node_set_fields != NULL) && (node_set_fields->size > 0))
+    polymec_error("exodus_file_define_fields: Node set fields can't be written for a distributed mesh.");
+  finish_async_output(file, "exodus_file_define_fields");
+
+  // Define all of the variables at once, so the file only enters define 
+  // mode once.
+  ex_var_params params;
+  memset(&params, 0, sizeof(ex_var_params));
+  // Global and nodal variables don't have truth tables.
+  int* no_truth_table = add_vars(file->global_vars, global_fields, 0, &params.num_glob);
+  if (no_truth_table != NULL)
+    polymec_free(no_truth_table);
+  no_truth_table = add_vars(file->node_vars, node_fields, 0, &params.num_node);
+  if (no_truth_table != NULL)
+    polymec_free(no_truth_table);
+  params.elem_var_tab = add_vars(file->elem_vars, element_fields, 
+                                 file->num_elem_blocks, &params.num_elem);
+  params.face_var_tab = add_vars(file->face_vars, face_fields, 
+                                 file->num_face_blocks, &params.num_face);
+  params.edge_var_tab = add_vars(file->edge_vars, edge_fields, 
+                                 file->num_edge_blocks, &params.num_edge);
+  params.nset_var_tab = add_vars(file->node_set_vars, node_set_fields, 
+                                 file->num_node_sets, &params.num_nset);
+  params.elset_var_tab = add_vars(file->elem_set_vars, element_set_fields, 
+                                  file->num_elem_sets, &params.num_elset);
+  params.sset_var_tab = add_vars(file->side_set_vars, side_set_fields, 
+                                 file->num_side_sets, &params.num_sset);
+  int status = ex_put_all_var_param_ext(file->ex_id, &params);
+  int* truth_tables[] = {params.elem_var_tab, params.face_var_tab, 
+                         params.edge_var_tab, params.nset_var_tab, 
+                         params.elset_var_tab, params.sset_var_tab};
+  for (int i = 0; i < 6; ++i)
   {
-    if (strcmp(field_name, file->edge_var_names->data[index]) == 0)
-      break;
-    ++index;
+    if (truth_tables[i] != NULL)
+      polymec_free(truth_tables[i]);
   }
+  if (status < 0)
+    polymec_error("exodus_file_define_fields: Could not define fields.");
 
-  // Fetch the field data.
-  if (index < file->edge_var_names->size)
+  put_var_names(file, EX_GLOBAL, file->global_vars);
+  put_var_names(file, EX_NODAL, file->node_vars);
+  put_var_names(file, EX_ELEM_BLOCK, file->elem_vars);
+  put_var_names(file, EX_FACE_BLOCK, file->face_vars);
+  put_var_names(file, EX_EDGE_BLOCK, file->edge_vars);
+  put_var_names(file, EX_NODE_SET, file->node_set_vars);
+  put_var_names(file, EX_ELEM_SET, file->elem_set_vars);
+  put_var_names(file, EX_SIDE_SET, file->side_set_vars);
+  file->vars_defined = true;
+  use_collective_access(file);
+
+  // Give the new variables the chunk cache we've been asked for.
+  if (file->chunk_cache_size > 0)
+    set_var_chunk_caches(file);
+}
+
+// Writes the data for all the variables in the given table to the blocks 
+// or sets of the given type.
+static void write_entity_fields(exodus_file_t* file,
+                                int time_index,
+                                ex_entity_type obj_type,
+                                var_table_t* vars,
+                                int num_entities,
+                                int* entity_ids,
+                                int* entity_offsets,
+                                real_t** field_data)
+{
+  if (vars->names->size == 0)
+    return;
+  ASSERT(field_data != NULL);
+  for (int i = 0; i < (int)vars->names->size; ++i)
   {
-    int offset = 0;
-    real_t* field = polymec_malloc(sizeof(real_t) * file->num_edges);
-    memset(field, 0, sizeof(real_t) * file->num_edges);
-    for (int i = 0; i < file->num_edge_blocks; ++i)
-    {
-      int N;
-      ex_get_block(file->ex_id, EX_EDGE_BLOCK, file->edge_block_ids[i], NULL, &N, NULL, NULL, NULL, NULL);
-      ex_get_var(file->ex_id, time_index, EX_EDGE_BLOCK, index+1, i, N, &field[offset]);
-      offset += N;
-    }
-    return field;
+    put_block_field(file, time_index, obj_type, num_entities, 
+                    entity_ids, entity_offsets, vars->names->data[i], i, 
+                    field_data[i]);
   }
-  else
+}
+
+// Writes the values of all global variables in one go. Exodus stores them 
+// in a single array per time step, which we treat as one block.
+static void put_global_fields(exodus_file_t* file,
+                              int time_index,
+                              real_t* global_field_data)
+{
+  int num_globals = (int)file->global_vars->names->size;
+  if (num_globals == 0)
+    return;
+  ASSERT(global_field_data != NULL);
+  int global_block_ids[1] = {1}, global_block_offsets[2] = {0, num_globals};
+  put_block_field(file, time_index, EX_GLOBAL, 1, global_block_ids, 
+                  global_block_offsets, "(globals)", 0, global_field_data);
+}
+
+void exodus_file_write_fields(exodus_file_t* file,
+                              int time_index,
+                              real_t* global_field_data,
+                              real_t** node_field_data,
+                              real_t** element_field_data,
+                              real_t** face_field_data,
+                              real_t** edge_field_data,
+                              real_t** node_set_field_data,
+                              real_t** element_set_field_data,
+                              real_t** side_set_field_data)
+{
+  ASSERT(file->writing);
+  if (!file->vars_defined)
+    polymec_error("exodus_file_write_fields: Fields have not been defined.");
+
+  put_global_fields(file, time_index, global_field_data);
+
+  // Nodal variables are all stored in a single block.
+  int node_block_ids[1] = {1}, node_block_offsets[2] = {0, file->num_owned_nodes};
+  write_entity_fields(file, time_index, EX_NODAL, file->node_vars, 
+                      1, node_block_ids, node_block_offsets, node_field_data);
+  write_entity_fields(file, time_index, EX_ELEM_BLOCK, file->elem_vars, 
+                      file->num_elem_blocks, file->elem_block_ids, 
+                      file->elem_block_offsets, element_field_data);
+  write_entity_fields(file, time_index, EX_FACE_BLOCK, file->face_vars, 
+                      file->num_face_blocks, file->face_block_ids, 
+                      file->face_block_offsets, face_field_data);
+  write_entity_fields(file, time_index, EX_EDGE_BLOCK, file->edge_vars, 
+                      file->num_edge_blocks, file->edge_block_ids, 
+                      file->edge_block_offsets, edge_field_data);
+  write_entity_fields(file, time_index, EX_NODE_SET, file->node_set_vars, 
+                      file->num_node_sets, file->node_set_ids, 
+                      file->node_set_offsets, node_set_field_data);
+  write_entity_fields(file, time_index, EX_ELEM_SET, file->elem_set_vars, 
+                      file->num_elem_sets, file->elem_set_ids, 
+                      file->elem_set_offsets, element_set_field_data);
+  write_entity_fields(file, time_index, EX_SIDE_SET, file->side_set_vars, 
+                      file->num_side_sets, file->side_set_ids, 
+                      file->side_set_offsets, side_set_field_data);
+}
+
+// Returns the index of the named variable within the given table, which 
+// must have been defined for writing.
+static int defined_var_index(exodus_file_t* file,
+                             var_table_t* vars, 
+                             const char* name)
+{
+  int index = var_table_index(vars, name);
+  if (index == -1)
+  {
+    if (!file->vars_defined)
+      polymec_error("exodus_file: Fields must be defined with exodus_file_define_fields before writing.");
+    else
+      polymec_error("exodus_file: Field %s was not defined.", name);
+  }
+  return index;
+}
+
+void exodus_file_write_element_field(exodus_file_t* file,
+                                     int time_index,
+                                     const char* field_name,
+                                     real_t* field_data)
+{
+  ASSERT(file->writing);
+  int index = defined_var_index(file, file->elem_vars, field_name);
+  put_block_field(file, time_index, EX_ELEM_BLOCK, file->num_elem_blocks, 
+                  file->elem_block_ids, file->elem_block_offsets, 
+                  field_name, index, field_data);
+}
+
+real_t* exodus_file_read_element_field(exodus_file_t* file,
+                                       int time_index,
+                                       const char* field_name)
+{
+  finish_async_output(file, "exodus_file_read_element_field");
+
+  int index = var_table_index(file->elem_vars, field_name);
+  if (index == -1)
+    return NULL;
+  return read_block_field(file, time_index, EX_ELEM_BLOCK, file->num_elem_blocks, 
+                          file->elem_block_ids, file->elem_block_offsets, index);
+}
+
+bool exodus_file_contains_element_field(exodus_file_t* file, 
+                                        int time_index,
+                                        const char* field_name)
+{
+  return (var_table_index(file->elem_vars, field_name) != -1);
+}
+
+void exodus_file_write_face_field(exodus_file_t* file,
+                                  int time_index,
+                                  const char* field_name,
+                                  real_t* field_data)
+{
+  ASSERT(file->writing);
+  int index = defined_var_index(file, file->face_vars, field_name);
+  put_block_field(file, time_index, EX_FACE_BLOCK, file->num_face_blocks, 
+                  file->face_block_ids, file->face_block_offsets, 
+                  field_name, index, field_data);
+}
+
+real_t* exodus_file_read_face_field(exodus_file_t* file,
+                                    int time_index,
+                                    const char* field_name)
+{
+  finish_async_output(file, "exodus_file_read_face_field");
+
+  int index = var_table_index(file->face_vars, field_name);
+  if (index == -1)
+    return NULL;
+  return read_block_field(file, time_index, EX_FACE_BLOCK, file->num_face_blocks, 
+                          file->face_block_ids, file->face_block_offsets, index);
+}
+
+bool exodus_file_contains_face_field(exodus_file_t* file, 
+                                     int time_index,
+                                     const char* field_name)
+{
+  return (var_table_index(file->face_vars, field_name) != -1);
+}
+
+void exodus_file_write_edge_field(exodus_file_t* file,
+                                  int time_index,
+                                  const char* field_name,
+                                  real_t* field_data)
+{
+  ASSERT(file->writing);
+  int index = defined_var_index(file, file->edge_vars, field_name);
+  put_block_field(file, time_index, EX_EDGE_BLOCK, file->num_edge_blocks, 
+                  file->edge_block_ids, file->edge_block_offsets, 
+                  field_name, index, field_data);
+}
+
+real_t* exodus_file_read_edge_field(exodus_file_t* file,
+                                    int time_index,
+                                    const char* field_name)
+{
+  finish_async_output(file, "exodus_file_read_edge_field");
+
+  int index = var_table_index(file->edge_vars, field_name);
+  if (index == -1)
     return NULL;
+  return read_block_field(file, time_index, EX_EDGE_BLOCK, file->num_edge_blocks, 
+                          file->edge_block_ids, file->edge_block_offsets, index);
 }
 
 bool exodus_file_contains_edge_field(exodus_file_t* file, 
                                      int time_index,
                                      const char* field_name)
 {
-  int index = 0;
-  while (index < file->edge_var_names->size)
+  return (var_table_index(file->edge_vars, field_name) != -1);
+}
+
+void exodus_file_write_global_fields(exodus_file_t* file,
+                                     int time_index,
+                                     real_t* global_field_data)
+{
+  ASSERT(file->writing);
+  if (!file->vars_defined)
+    polymec_error("exodus_file_write_global_fields: Fields have not been defined.");
+  put_global_fields(file, time_index, global_field_data);
+}
+
+real_t* exodus_file_read_global_fields(exodus_file_t* file,
+                                       int time_index)
+{
+  finish_async_output(file, "exodus_file_read_global_fields");
+
+  int num_globals = (int)file->global_vars->names->size;
+  if (num_globals == 0)
+    return NULL;
+  int global_block_ids[1] = {1}, global_block_offsets[2] = {0, num_globals};
+  return read_block_field(file, time_index, EX_GLOBAL, 1, global_block_ids, 
+                          global_block_offsets, 0);
+}
+
+bool exodus_file_contains_global_field(exodus_file_t* file, 
+                                       const char* field_name)
+{
+  return (var_table_index(file->global_vars, field_name) != -1);
+}
+
+real_t* exodus_file_read_global_field_history(exodus_file_t* file,
+                                              const char* field_name,
+                                              int first_time_index,
+                                              int last_time_index)
+{
+  finish_async_output(file, "exodus_file_read_global_field_history");
+
+  int index = var_table_index(file->global_vars, field_name);
+  if (index == -1)
+    return NULL;
+  if ((first_time_index < 1) || (first_time_index > last_time_index) || 
+      (last_time_index > file->last_time_index))
   {
-    if (strcmp(field_name, file->edge_var_names->data[index]) == 0)
-      return true;
+    polymec_error("exodus_file_read_global_field_history: Invalid time index range [%d, %d].", 
+                  first_time_index, last_time_index);
   }
-  return false;
+  int num_times = last_time_index - first_time_index + 1;
+  real_t* history = polymec_malloc(sizeof(real_t) * num_times);
+  int status = ex_get_glob_var_time(file->ex_id, index+1, first_time_index, 
+                                    last_time_index, history);
+  if (status < 0)
+    polymec_error("exodus_file_read_global_field_history: Could not read history of field %s.", field_name);
+  return history;
 }
 
 void exodus_file_write_node_field(exodus_file_t* file,
@@ -1110,59 +4528,397 @@ void exodus_file_write_node_field(exodus_file_t* file,
                                   real_t* field_data)
 {
   ASSERT(file->writing);
+  int index = defined_var_index(file, file->node_vars, field_name);
+  int node_block_ids[1] = {1}, node_block_offsets[2] = {0, file->num_owned_nodes};
+  put_block_field(file, time_index, EX_NODAL, 1, node_block_ids, 
+                  node_block_offsets, field_name, index, field_data);
+}
 
-  // Find the variable index if it already exists.
-  int index = 0;
-  while (index < file->node_var_names->size)
+real_t* exodus_file_read_node_field(exodus_file_t* file,
+                                    int time_index,
+                                    const char* field_name)
+{
+  finish_async_output(file, "exodus_file_read_node_field");
+
+  int index = var_table_index(file->node_vars, field_name);
+  if (index == -1)
+    return NULL;
+  real_t* field = polymec_malloc(sizeof(real_t) * file->num_nodes);
+  memset(field, 0, sizeof(real_t) * file->num_nodes);
+  ex_get_var(file->ex_id, time_index, EX_NODAL, index+1, 1, file->num_nodes, field);
+  return field;
+}
+
+bool exodus_file_contains_node_field(exodus_file_t* file, 
+                                     int time_index,
+                                     const char* field_name)
+{
+  return (var_table_index(file->node_vars, field_name) != -1);
+}
+
+
+real_t* exodus_file_read_node_set_field(exodus_file_t* file,
+                                        int time_index,
+                                        const char* field_name)
+{
+  finish_async_output(file, "exodus_file_read_node_set_field");
+
+  int index = var_table_index(file->node_set_vars, field_name);
+  if (index == -1)
+    return NULL;
+  return read_block_field(file, time_index, EX_NODE_SET, file->num_node_sets, 
+                          file->node_set_ids, file->node_set_offsets, index);
+}
+
+real_t* exodus_file_read_element_set_field(exodus_file_t* file,
+                                           int time_index,
+                                           const char* field_name)
+{
+  finish_async_output(file, "exodus_file_read_element_set_field");
+
+  int index = var_table_index(file->elem_set_vars, field_name);
+  if (index == -1)
+    return NULL;
+  return read_block_field(file, time_index, EX_ELEM_SET, file->num_elem_sets, 
+                          file->elem_set_ids, file->elem_set_offsets, index);
+}
+
+real_t* exodus_file_read_side_set_field(exodus_file_t* file,
+                                        int time_index,
+                                        const char* field_name)
+{
+  finish_async_output(file, "exodus_file_read_side_set_field");
+
+  int index = var_table_index(file->side_set_vars, field_name);
+  if (index == -1)
+    return NULL;
+  return read_block_field(file, time_index, EX_SIDE_SET, file->num_side_sets, 
+                          file->side_set_ids, file->side_set_offsets, index);
+}
+
+// Reads the history of the variable with the given name on the given 
+// entities over the given range of times, returning a newly-allocated 
+// [time x entity] array, or NULL if there's no such variable.
+static real_t* read_field_history(exodus_file_t* file,
+                                  const char* func_name,
+                                  ex_entity_type obj_type,
+                                  var_table_t* vars,
+                                  const char* field_name,
+                                  int num_file_entities,
+                                  int* entities,
+                                  int num_entities,
+                                  int first_time_index,
+                                  int last_time_index)
+{
+  finish_async_output(file, func_name);
+
+  int index = var_table_index(vars, field_name);
+  if (index == -1)
+    return NULL;
+  if ((first_time_index < 1) || (first_time_index > last_time_index) || 
+      (last_time_index > file->last_time_index))
   {
-    if (strcmp(field_name, file->node_var_names->data[index]) == 0)
-      break;
-    ++index;
+    polymec_error("%s: Invalid time index range [%d, %d].", func_name, 
+                  first_time_index, last_time_index);
   }
 
-  // Append the variable to our list if we didn't find it.
-  if (index >= file->node_var_names->size)
-    string_array_append_with_dtor(file->node_var_names, string_dup(field_name), string_free);
+  // Read the history of each entity in one go, and transpose it into place.
+  int num_times = last_time_index - first_time_index + 1;
+  real_t* history = polymec_malloc(sizeof(real_t) * num_times * num_entities);
+  real_t* entity_history = polymec_malloc(sizeof(real_t) * num_times);
+  for (int i = 0; i < num_entities; ++i)
+  {
+    if ((entities[i] < 0) || (entities[i] >= num_file_entities))
+      polymec_error("%s: Invalid index: %d.", func_name, entities[i]);
+    int status = ex_get_var_time(file->ex_id, obj_type, index+1, entities[i]+1,
+                                 first_time_index, last_time_index, 
+                                 entity_history);
+    if (status < 0)
+      polymec_error("%s: Could not read history of field %s.", func_name, field_name);
+    for (int t = 0; t < num_times; ++t)
+      history[num_entities*t + i] = entity_history[t];
+  }
+  polymec_free(entity_history);
+  return history;
+}
 
-  // Insert the data.
-  ex_put_var(file->ex_id, time_index, EX_NODE_BLOCK, index+1, 1, file->num_nodes, field_data);
+real_t* exodus_file_read_element_field_history(exodus_file_t* file,
+                                               const char* field_name,
+                                               int* elements,
+                                               int num_elements,
+                                               int first_time_index,
+                                               int last_time_index)
+{
+  return read_field_history(file, "exodus_file_read_element_field_history", 
+                            EX_ELEM_BLOCK, file->elem_vars, field_name, 
+                            file->num_elem, elements, num_elements, 
+                            first_time_index, last_time_index);
 }
 
-real_t* exodus_file_read_node_field(exodus_file_t* file,
-                                    int time_index,
-                                    const char* field_name)
+real_t* exodus_file_read_face_field_history(exodus_file_t* file,
+                                            const char* field_name,
+                                            int* faces,
+                                            int num_faces,
+                                            int first_time_index,
+                                            int last_time_index)
 {
-  // Find the variable index.
-  int index = 0;
-  while (index < file->node_var_names->size)
+  return read_field_history(file, "exodus_file_read_face_field_history", 
+                            EX_FACE_BLOCK, file->face_vars, field_name, 
+                            file->num_faces, faces, num_faces, 
+                            first_time_index, last_time_index);
+}
+
+real_t* exodus_file_read_edge_field_history(exodus_file_t* file,
+                                            const char* field_name,
+                                            int* edges,
+                                            int num_edges,
+                                            int first_time_index,
+                                            int last_time_index)
+{
+  return read_field_history(file, "exodus_file_read_edge_field_history", 
+                            EX_EDGE_BLOCK, file->edge_vars, field_name, 
+                            file->num_edges, edges, num_edges, 
+                            first_time_index, last_time_index);
+}
+
+real_t* exodus_file_read_node_field_history(exodus_file_t* file,
+                                            const char* field_name,
+                                            int* nodes,
+                                            int num_nodes,
+                                            int first_time_index,
+                                            int last_time_index)
+{
+  return read_field_history(file, "exodus_file_read_node_field_history", 
+                            EX_NODAL, file->node_vars, field_name, 
+                            file->num_nodes, nodes, num_nodes, 
+                            first_time_index, last_time_index);
+}
+
+// Reads the data for the variable with the given index on the entities in 
+// [first, end) within the blocks of the given type, reading only the 
+// portion of each block that overlaps this range.
+static void read_partial_block_field(exodus_file_t* file,
+                                     int time_index,
+                                     ex_entity_type block_type,
+                                     int num_blocks,
+                                     int* block_ids,
+                                     int* block_offsets,
+                                     int var_index,
+                                     int first,
+                                     int end,
+                                     real_t* data)
+{
+  for (int b = 0; b < num_blocks; ++b)
   {
-    if (strcmp(field_name, file->node_var_names->data[index]) == 0)
-      break;
-    ++index;
+    int b_first = MAX(first, block_offsets[b]);
+    int b_end = MIN(end, block_offsets[b+1]);
+    if (b_first < b_end)
+    {
+      ex_get_partial_var(file->ex_id, time_index, block_type, var_index+1, 
+                         block_ids[b], b_first - block_offsets[b] + 1, 
+                         b_end - b_first, &data[b_first - first]);
+    }
+  }
+}
+
+// Reads the data for the variable with the given index on the given 
+// entities, in order. Sorted entities that are close together are read 
+// in runs, and the values in between are discarded.
+static void read_indexed_block_field(exodus_file_t* file,
+                                     int time_index,
+                                     ex_entity_type block_type,
+                                     int num_blocks,
+                                     int* block_ids,
+                                     int* block_offsets,
+                                     int var_index,
+                                     int* entities,
+                                     int num_entities,
+                                     real_t* data)
+{
+  // Runs can span gaps of this many entities.
+  static const int max_gap = 64;
+
+  // Sort the entities, keeping track of where their values go.
+  int* order = polymec_malloc(sizeof(int) * 2 * num_entities);
+  for (int i = 0; i < num_entities; ++i)
+  {
+    order[2*i] = entities[i];
+    order[2*i+1] = i;
   }
+  qsort(order, num_entities, 2*sizeof(int), int_pair_cmp);
 
-  // Fetch the field data.
-  if (index < file->node_var_names->size)
+  real_t* run_data = polymec_malloc(sizeof(real_t) * chunk_size);
+  int i = 0;
+  while (i < num_entities)
   {
-    real_t* field = polymec_malloc(sizeof(real_t) * file->num_nodes);
-    memset(field, 0, sizeof(real_t) * file->num_nodes);
-    ex_get_var(file->ex_id, time_index, EX_NODAL, index+1, 1, file->num_nodes, field);
-    return field;
+    int first = order[2*i], j = i+1;
+    while ((j < num_entities) && (order[2*j] - order[2*(j-1)] <= max_gap) && 
+           (order[2*j] - first < chunk_size))
+      ++j;
+    int end = order[2*(j-1)] + 1;
+    read_partial_block_field(file, time_index, block_type, num_blocks, 
+                             block_ids, block_offsets, var_index, 
+                             first, end, run_data);
+    for (int k = i; k < j; ++k)
+      data[order[2*k+1]] = run_data[order[2*k] - first];
+    i = j;
   }
-  else
-    return NULL;
+  polymec_free(run_data);
+  polymec_free(order);
 }
 
-bool exodus_file_contains_node_field(exodus_file_t* file, 
-                                     int time_index,
-                                     const char* field_name)
+// Returns the position of the block or set of the given type with the given 
+// name among the given identifiers, or -1 if there's no such block or set.
+static int find_named_entity(exodus_file_t* file,
+                             ex_entity_type obj_type,
+                             int num_entities,
+                             int* entity_ids,
+                             const char* name)
+{
+  char entity_name[MAX_NAME_LENGTH+1];
+  for (int i = 0; i < num_entities; ++i)
+  {
+    ex_get_name(file->ex_id, obj_type, (ex_entity_id)entity_ids[i], entity_name);
+    if (strcmp(entity_name, name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+// Reads the data for the variable with the given index on the entries of 
+// the set with the given name into data, returning false if there's no 
+// such set.
+static bool read_set_block_field(exodus_file_t* file,
+                                 int time_index,
+                                 ex_entity_type block_type,
+                                 int num_blocks,
+                                 int* block_ids,
+                                 int* block_offsets,
+                                 int var_index,
+                                 ex_entity_type set_type,
+                                 int num_sets,
+                                 int* set_ids,
+                                 int* set_offsets,
+                                 const char* set_name,
+                                 real_t* data)
 {
-  int index = 0;
-  while (index < file->node_var_names->size)
+  int s = find_named_entity(file, set_type, num_sets, set_ids, set_name);
+  if (s == -1)
+    return false;
+  int set_size = set_offsets[s+1] - set_offsets[s];
+  if (set_size > 0)
   {
-    if (strcmp(field_name, file->node_var_names->data[index]) == 0)
-      return true;
+    int* set = polymec_malloc(sizeof(int) * set_size);
+    ex_get_set(file->ex_id, set_type, (ex_entity_id)set_ids[s], set, NULL);
+    for (int i = 0; i < set_size; ++i)
+      set[i] -= 1;
+    read_indexed_block_field(file, time_index, block_type, num_blocks, 
+                             block_ids, block_offsets, var_index, 
+                             set, set_size, data);
+    polymec_free(set);
   }
-  return false;
+  return true;
+}
+
+bool exodus_file_read_element_field_range(exodus_file_t* file,
+                                          int time_index,
+                                          const char* field_name,
+                                          int first_elem,
+                                          int end_elem,
+                                          real_t* field_data)
+{
+  ASSERT(first_elem >= 0);
+  ASSERT(end_elem <= file->num_elem);
+  finish_async_output(file, "exodus_file_read_element_field_range");
+
+  int index = var_table_index(file->elem_vars, field_name);
+  if (index == -1)
+    return false;
+  read_partial_block_field(file, time_index, EX_ELEM_BLOCK, 
+                           file->num_elem_blocks, file->elem_block_ids, 
+                           file->elem_block_offsets, index, 
+                           first_elem, end_elem, field_data);
+  return true;
+}
+
+bool exodus_file_read_element_block_field(exodus_file_t* file,
+                                          int time_index,
+                                          const char* field_name,
+                                          const char* block_name,
+                                          real_t* field_data)
+{
+  finish_async_output(file, "exodus_file_read_element_block_field");
+
+  int index = var_table_index(file->elem_vars, field_name);
+  if (index == -1)
+    return false;
+  int b = find_named_entity(file, EX_ELEM_BLOCK, file->num_elem_blocks, 
+                            file->elem_block_ids, block_name);
+  if (b == -1)
+    return false;
+  int first = file->elem_block_offsets[b], end = file->elem_block_offsets[b+1];
+  if (first < end)
+  {
+    ex_get_partial_var(file->ex_id, time_index, EX_ELEM_BLOCK, index+1, 
+                       file->elem_block_ids[b], 1, end - first, field_data);
+  }
+  return true;
+}
+
+bool exodus_file_read_element_field_on_set(exodus_file_t* file,
+                                           int time_index,
+                                           const char* field_name,
+                                           const char* set_name,
+                                           real_t* field_data)
+{
+  finish_async_output(file, "exodus_file_read_element_field_on_set");
+
+  int index = var_table_index(file->elem_vars, field_name);
+  if (index == -1)
+    return false;
+  return read_set_block_field(file, time_index, EX_ELEM_BLOCK, 
+                              file->num_elem_blocks, file->elem_block_ids, 
+                              file->elem_block_offsets, index, 
+                              EX_ELEM_SET, file->num_elem_sets, 
+                              file->elem_set_ids, file->elem_set_offsets, 
+                              set_name, field_data);
 }
 
+bool exodus_file_read_node_field_range(exodus_file_t* file,
+                                       int time_index,
+                                       const char* field_name,
+                                       int first_node,
+                                       int end_node,
+                                       real_t* field_data)
+{
+  ASSERT(first_node >= 0);
+  ASSERT(end_node <= file->num_nodes);
+  finish_async_output(file, "exodus_file_read_node_field_range");
+
+  int index = var_table_index(file->node_vars, field_name);
+  if (index == -1)
+    return false;
+  int node_block_ids[1] = {1}, node_block_offsets[2] = {0, file->num_nodes};
+  read_partial_block_field(file, time_index, EX_NODAL, 1, node_block_ids, 
+                           node_block_offsets, index, first_node, end_node, 
+                           field_data);
+  return true;
+}
+
+bool exodus_file_read_node_field_on_set(exodus_file_t* file,
+                                        int time_index,
+                                        const char* field_name,
+                                        const char* set_name,
+                                        real_t* field_data)
+{
+  finish_async_output(file, "exodus_file_read_node_field_on_set");
+
+  int index = var_table_index(file->node_vars, field_name);
+  if (index == -1)
+    return false;
+  int node_block_ids[1] = {1}, node_block_offsets[2] = {0, file->num_nodes};
+  return read_set_block_field(file, time_index, EX_NODAL, 1, node_block_ids, 
+                              node_block_offsets, index, EX_NODE_SET, 
+                              file->num_node_sets, file->node_set_ids, 
+                              file->node_set_offsets, set_name, field_data);
+}
@@ -27,17 +27,129 @@ bool exodus_file_query(const char* filename,
                        int* num_mpi_processes,
                        real_array_t* times);
 
+// This type holds a summary of the metadata in an Exodus file: its sizes, 
+// its element blocks, the names of the fields it defines, and its times.
+typedef struct
+{
+  size_t real_size;        // Size of real numbers stored in the file.
+  float version;           // Version number of the Exodus specification.
+  int num_mpi_processes;   // Number of processes for which the file has data.
+  int num_nodes, num_elem, num_faces, num_edges;
+  int num_elem_sets, num_node_sets, num_side_sets;
+
+  // Element types, numbers of elements, and names of element blocks.
+  int num_elem_blocks;
+  fe_mesh_element_t* elem_block_types;
+  int* elem_block_sizes;
+  string_array_t* elem_block_names;
+
+  // Names of the fields defined in the file.
+  string_array_t* global_fields;
+  string_array_t* node_fields;
+  string_array_t* elem_fields;
+  string_array_t* elem_set_fields;
+  string_array_t* node_set_fields;
+  string_array_t* side_set_fields;
+
+  // Times for which the file contains data.
+  real_array_t* times;
+} exodus_catalog_t;
+
+// Reads the metadata in the Exodus file with the given name, returning a 
+// newly-allocated catalog, or NULL if the file is not a valid Exodus file. 
+// Only the file's header and time values are read, and no MPI communication 
+// takes place. If use_index is true, the catalog is loaded from a small 
+// index file (named by appending ".catalog" to filename) when that index 
+// matches the file's modification time and size, so that the Exodus file 
+// isn't opened at all; otherwise the index is (re)written, if possible.
+exodus_catalog_t* exodus_file_catalog(const char* filename, bool use_index);
+
+// Frees a catalog returned by exodus_file_catalog.
+void exodus_catalog_free(exodus_catalog_t* catalog);
+
 // Creates and opens a new Exodus file for writing simulation data, 
 // returning the Exodus file object. 
 exodus_file_t* exodus_file_new(MPI_Comm comm, const char* filename);
 
+// Creates and opens a new Exodus file for writing simulation data that 
+// stores all of its real numbers (node coordinates, times, and fields) in 
+// single precision (32-bit floats), halving the size of field output. Data 
+// is still passed to and from the file as real_t, and is narrowed as it's 
+// written and widened as it's read. Exodus fixes the precision of a file 
+// when it's created, so it can't be chosen field by field.
+exodus_file_t* exodus_file_new_single_precision(MPI_Comm comm, 
+                                                const char* filename);
+
 // Opens an existing Exodus file for reading simulation data,
 // returning the Exodus file object. 
 exodus_file_t* exodus_file_open(MPI_Comm comm, const char* filename);
 
-// Closes and destroys the given Exodus file.
+// Opens an existing Exodus file for appending simulation data, returning the 
+// Exodus file object. The file's mesh and field definitions are recovered 
+// from the file, so new time steps and their fields can be written without 
+// writing the mesh or defining the fields again. Times are appended after 
+// the last one in the file (see exodus_file_truncate to restart earlier).
+exodus_file_t* exodus_file_open_for_append(MPI_Comm comm, const char* filename);
+
+// Creates and opens this process's file within a new decomposed Exodus 
+// database for writing simulation data, returning the Exodus file object. 
+// A decomposed (Nemesis) database has one file per process in the given 
+// communicator, named <prefix>.<P>.<p> for process p of P, so each process 
+// writes its portion of a distributed mesh and its data independently.
+exodus_file_t* exodus_file_new_decomposed(MPI_Comm comm, const char* prefix);
+
+// Opens this process's file within an existing decomposed Exodus database 
+// with the given prefix for reading simulation data, returning the Exodus 
+// file object. The database must have been decomposed for the number of 
+// processes in the given communicator.
+exodus_file_t* exodus_file_open_decomposed(MPI_Comm comm, const char* prefix);
+
+// Closes and destroys the given Exodus file, waiting for any pending 
+// asynchronous output to be written.
 void exodus_file_close(exodus_file_t* file);
 
+// Enables asynchronous output for the given Exodus file, which must be open 
+// for writing. Times and fields are then copied into staging buffers and 
+// the calls that write them return immediately, while a dedicated I/O thread 
+// writes them to the file in the order they were given. At most 
+// max_staged_bytes bytes are staged at once; a write that doesn't fit waits 
+// for earlier writes to finish, so a limit of two time steps' worth of 
+// fields lets one time step be staged while the last is written. If the 
+// file is shared by several processes and MPI doesn't allow calls from any 
+// thread (MPI_THREAD_MULTIPLE), output remains synchronous.
+//
+// NetCDF and HDF5 aren't thread-safe, so the I/O thread must be the only 
+// one using them while it has pending output. Functions that read from or 
+// otherwise access the file itself wait for its pending output first, but 
+// no other NetCDF I/O in this process (to other Exodus files, to CF files, 
+// or by direct calls) may take place until the file is flushed with 
+// exodus_file_flush or closed.
+void exodus_file_enable_async_output(exodus_file_t* file, 
+                                     size_t max_staged_bytes);
+
+// Waits for all pending asynchronous output to the given Exodus file to be 
+// written. Does nothing if output is synchronous.
+void exodus_file_flush(exodus_file_t* file);
+
+// Enables compression of the data written to the given Exodus file with the 
+// given deflate level (from 0, for no compression, to 9), optionally 
+// shuffling the bytes of each value first, which helps with smooth fields. 
+// This must be called before the mesh is written. Variables are stored in 
+// chunks of one time step each.
+void exodus_file_set_compression(exodus_file_t* file, 
+                                 int deflate_level,
+                                 bool shuffle);
+
+// Sets the size (in bytes) of the chunk cache for each variable in the 
+// given Exodus file. A cache large enough to hold the chunks that span a 
+// range of entities speeds up reading their histories.
+void exodus_file_set_chunk_cache(exodus_file_t* file, size_t cache_size);
+
+// Returns the ratio of the size of the data in the given Exodus file to the 
+// size of the file on disk, which is greater than 1 if the data is 
+// compressed.
+real_t exodus_file_compression_ratio(exodus_file_t* file);
+
 // Returns an internal string containing the title of the Exodus database
 // in the file.
 char* exodus_file_title(exodus_file_t* file);
@@ -47,14 +159,91 @@ void exodus_file_set_title(exodus_file_t* file, const char* title);
 
 // Writes a finite element mesh to the given Exodus file, overwriting 
 // any existing mesh there. All cells (or "elements") are written to a single 
-// element block within the Exodus mesh.
+// element block within the Exodus mesh. If the file belongs to a decomposed 
+// database, the mesh must be distributed (unless there's only one process), 
+// and its owned elements and all of its nodes are written, along with its 
+// global element and node indices and the communication maps that connect 
+// it to the other processes. This is collective in that case. Otherwise, 
+// the mesh's element and node identifiers (if it has them) are written to 
+// the file's element and node id maps.
 void exodus_file_write_mesh(exodus_file_t* file,
                             fe_mesh_t* mesh);
 
+// Writes a distributed finite element mesh to the given (shared) Exodus 
+// file, with each process writing its own owned elements and nodes and its 
+// entries in the mesh's element, node, and side sets. The file positions 
+// at which processes write are found by prefix sums over their numbers of 
+// entities, so the elements of each block appear in process order, and no 
+// process gathers the mesh. Subsequent element, node, element set, side set, 
+// and global fields are written the same way: each process supplies values 
+// for its own entities (owned nodes first, as in the mesh), and the same 
+// global values. This is a collective operation that requires a file 
+// created for parallel I/O when there is more than one process. Polyhedral 
+// blocks, face and edge sets, and node set fields are not supported.
+void exodus_file_write_distributed_mesh(exodus_file_t* file,
+                                        fe_mesh_t* mesh);
+
 // Reads a finite element mesh from the given Exodus file, returning 
-// a newly-allocated object.
+// a newly-allocated object. If the file belongs to a decomposed database, 
+// this process's portion of the distributed mesh is read and its ghost 
+// elements and nodes are added, and its nodes are numbered as they were 
+// when written. This is collective in that case. Otherwise, the element and 
+// node identifiers in the file's id maps are given to the mesh.
 fe_mesh_t* exodus_file_read_mesh(exodus_file_t* file);
 
+// Reads a finite volume mesh directly from the given Exodus file, returning 
+// a newly-allocated object. Element connectivity is streamed in chunks, and 
+// the faces of the mesh are identified as it arrives, so the peak memory 
+// footprint is close to that of the resulting mesh. Cells, faces, and their 
+// nodes are numbered just as they are by mesh_from_fe_mesh. Element and 
+// node sets become cell and node tags, and side sets become face tags. Face 
+// and edge sets, which refer to the file's own face and edge blocks, are 
+// skipped. Decomposed databases and polyhedral element blocks are read by 
+// way of exodus_file_read_mesh and mesh_from_fe_mesh, which carries no sets 
+// over.
+mesh_t* exodus_file_read_fv_mesh(exodus_file_t* file);
+
+// Reads a finite element mesh from the given Exodus file, distributing it 
+// across the processes in the file's communicator. Each process reads only 
+// a contiguous range of elements (in block order), the nodes they reference, 
+// the element, node, and side set entries that refer to them, and their 
+// identifiers from the file's id maps; ghost elements and nodes are then 
+// added with fe_mesh_add_ghosts. This is a collective operation, and does 
+// not support polyhedral element blocks.
+fe_mesh_t* exodus_file_read_distributed_mesh(exodus_file_t* file);
+
+// Joins the num_files files of the decomposed Exodus database with the given 
+// prefix into a single Exodus file with the given name, containing the 
+// global mesh and its element, node, and side sets. This is done by the 
+// calling process alone. Only the mesh is joined: time steps and field data 
+// in the database's files are not carried over, and must be written to the 
+// joined file separately. Returns true if the database was joined, false if 
+// any of its files could not be read or if they don't hold every element 
+// in the database.
+bool exodus_file_join(const char* prefix, 
+                      int num_files,
+                      const char* filename);
+
+// Splits the mesh in the Exodus file with the given name into a decomposed 
+// Exodus database with the given prefix, with one file for each process in 
+// the given communicator. Like exodus_file_join, this carries over only the 
+// mesh and its sets, not time steps or fields; nor does it keep element and 
+// node identifiers, since the id maps of a decomposed database hold global 
+// indices. This is a collective operation.
+void exodus_file_split(MPI_Comm comm,
+                       const char* filename,
+                       const char* prefix);
+
+// Discards the time steps after the given restart time from the given Exodus 
+// file, which must be open for writing, so that subsequently written times 
+// replace them. Returns the index of the last remaining time step (0 if none 
+// remain). NetCDF can't shrink a file's time series, so if fewer steps are 
+// written than were discarded, the extra ones remain at the end of the file; 
+// the number of valid steps is recorded in the file when it's closed, and 
+// the stale steps are hidden from exodus_file_next_time, exodus_file_query, 
+// exodus_file_catalog, and later appends.
+int exodus_file_truncate(exodus_file_t* file, real_t restart_time);
+
 // Writes a time value to the mesh, returning a newly-created time index 
 // that can associate field data to this time.
 int exodus_file_write_time(exodus_file_t* file, real_t time);
@@ -68,8 +257,72 @@ bool exodus_file_next_time(exodus_file_t* file,
                            int* time_index,
                            real_t* time);
 
+// Defines all of the fields that will be written to the given Exodus file, 
+// by name. Any of the arrays of names may be NULL. Global fields are scalars 
+// (energy totals, residual norms, time step sizes, ...). Element, face, and edge 
+// fields are defined on all blocks, and set fields have a value for each 
+// entry in each set of their type (each side in a side set), ordered by set. 
+// This must be called once, after the mesh has been written and before any 
+// times are written, so that the file can lay out all of its variables at 
+// once.
+void exodus_file_define_fields(exodus_file_t* file,
+                               string_array_t* global_fields,
+                               string_array_t* node_fields,
+                               string_array_t* element_fields,
+                               string_array_t* face_fields,
+                               string_array_t* edge_fields,
+                               string_array_t* node_set_fields,
+                               string_array_t* element_set_fields,
+                               string_array_t* side_set_fields);
+
+// Writes the data for all of the fields defined in the given Exodus file, 
+// associating it with the time identified by the given time index. 
+// global_field_data holds the value of each global field, and each other 
+// argument is an array of field data with one entry for each field of its 
+// type, in the order in which the fields were defined. Any of these may be 
+// NULL if no such fields were defined.
+void exodus_file_write_fields(exodus_file_t* file,
+                              int time_index,
+                              real_t* global_field_data,
+                              real_t** node_field_data,
+                              real_t** element_field_data,
+                              real_t** face_field_data,
+                              real_t** edge_field_data,
+                              real_t** node_set_field_data,
+                              real_t** element_set_field_data,
+                              real_t** side_set_field_data);
+
+// Writes the values of all the global fields in the given Exodus file in 
+// the order in which they were defined, associating them with the time 
+// identified by the given time index.
+void exodus_file_write_global_fields(exodus_file_t* file,
+                                     int time_index,
+                                     real_t* global_field_data);
+
+// Reads the values of all the global fields from the Exodus file for the 
+// time with the given index, returning a newly-allocated array of values in 
+// the order in which the fields were defined, or NULL if the file has no 
+// global fields.
+real_t* exodus_file_read_global_fields(exodus_file_t* file,
+                                       int time_index);
+
+// Returns true if the given Exodus file contains a global field with the 
+// given name, false otherwise.
+bool exodus_file_contains_global_field(exodus_file_t* file, 
+                                       const char* field_name);
+
+// Reads the history of a named global field over the times with indices in 
+// [first_time_index, last_time_index] with a single read, returning a 
+// newly-allocated array of values, one per time, or NULL if the file has no 
+// such field.
+real_t* exodus_file_read_global_field_history(exodus_file_t* file,
+                                              const char* field_name,
+                                              int first_time_index,
+                                              int last_time_index);
+
 // Writes a named element field to the given Exodus file, 
-// associated it the time identified by the given time index.
+// associated it the time identified by the given time index. The field 
+// must have been defined with exodus_file_define_fields.
 void exodus_file_write_element_field(exodus_file_t* file,
                                      int time_index,
                                      const char* field_name,
@@ -89,7 +342,8 @@ bool exodus_file_contains_element_field(exodus_file_t* file,
                                         const char* field_name);
 
 // Writes a named face field to the given Exodus file, 
-// associated it the time identified by the given time index.
+// associated it the time identified by the given time index. The field 
+// must have been defined with exodus_file_define_fields.
 void exodus_file_write_face_field(exodus_file_t* file,
                                   int time_index,
                                   const char* field_name,
@@ -109,7 +363,8 @@ bool exodus_file_contains_face_field(exodus_file_t* file,
                                      const char* field_name);
 
 // Writes a named edge field to the given Exodus file, 
-// associated it the time identified by the given time index.
+// associated it the time identified by the given time index. The field 
+// must have been defined with exodus_file_define_fields.
 void exodus_file_write_edge_field(exodus_file_t* file,
                                   int time_index,
                                   const char* field_name,
@@ -129,7 +384,8 @@ bool exodus_file_contains_edge_field(exodus_file_t* file,
                                      const char* field_name);
 
 // Writes a named node field to the given Exodus file, 
-// associated it the time identified by the given time index.
+// associated it the time identified by the given time index. The field 
+// must have been defined with exodus_file_define_fields.
 void exodus_file_write_node_field(exodus_file_t* file,
                                   int time_index,
                                   const char* field_name,
@@ -148,4 +404,116 @@ bool exodus_file_contains_node_field(exodus_file_t* file,
                                      int time_index,
                                      const char* field_name);
 
+// Reads a named node set field from the Exodus file, returning a 
+// newly-allocated array of field data for the entries of all node sets, 
+// ordered by set, or NULL if the file has no such field.
+real_t* exodus_file_read_node_set_field(exodus_file_t* file,
+                                        int time_index,
+                                        const char* field_name);
+
+// Reads a named element set field from the Exodus file, returning a 
+// newly-allocated array of field data for the entries of all element sets, 
+// ordered by set, or NULL if the file has no such field.
+real_t* exodus_file_read_element_set_field(exodus_file_t* file,
+                                           int time_index,
+                                           const char* field_name);
+
+// Reads a named side set field from the Exodus file, returning a 
+// newly-allocated array of field data for the sides in all side sets, 
+// ordered by set, or NULL if the file has no such field.
+real_t* exodus_file_read_side_set_field(exodus_file_t* file,
+                                        int time_index,
+                                        const char* field_name);
+
+// Reads the history of a named element field at the given elements (given 
+// by their indices within the mesh) over the times with indices 
+// first_time_index through last_time_index, returning a newly-allocated 
+// array of field data in which the value for the ith element at the tth 
+// of these times is stored at index t * num_elements + i. Returns NULL if 
+// the file contains no such field.
+real_t* exodus_file_read_element_field_history(exodus_file_t* file,
+                                               const char* field_name,
+                                               int* elements,
+                                               int num_elements,
+                                               int first_time_index,
+                                               int last_time_index);
+
+// Reads the history of a named face field at the given faces over the 
+// given range of times, as exodus_file_read_element_field_history does.
+real_t* exodus_file_read_face_field_history(exodus_file_t* file,
+                                            const char* field_name,
+                                            int* faces,
+                                            int num_faces,
+                                            int first_time_index,
+                                            int last_time_index);
+
+// Reads the history of a named edge field at the given edges over the 
+// given range of times, as exodus_file_read_element_field_history does.
+real_t* exodus_file_read_edge_field_history(exodus_file_t* file,
+                                            const char* field_name,
+                                            int* edges,
+                                            int num_edges,
+                                            int first_time_index,
+                                            int last_time_index);
+
+// Reads the history of a named node field at the given nodes over the 
+// given range of times, as exodus_file_read_element_field_history does.
+real_t* exodus_file_read_node_field_history(exodus_file_t* file,
+                                            const char* field_name,
+                                            int* nodes,
+                                            int num_nodes,
+                                            int first_time_index,
+                                            int last_time_index);
+
+// Reads a named element field on the elements with indices in 
+// [first_elem, end_elem) into the given array, which must have room for 
+// end_elem - first_elem values. Only the portions of the element blocks 
+// that overlap this range are read. Returns true if the field was read, 
+// false if the file contains no such field.
+bool exodus_file_read_element_field_range(exodus_file_t* file,
+                                          int time_index,
+                                          const char* field_name,
+                                          int first_elem,
+                                          int end_elem,
+                                          real_t* field_data);
+
+// Reads a named element field on the elements in the element block with 
+// the given name into the given array, which must have room for a value 
+// for each element in the block. Returns true if the field was read, false 
+// if the file contains no such field or block.
+bool exodus_file_read_element_block_field(exodus_file_t* file,
+                                          int time_index,
+                                          const char* field_name,
+                                          const char* block_name,
+                                          real_t* field_data);
+
+// Reads a named element field on the elements in the element set with the 
+// given name into the given array, in the order of the set's entries. 
+// Returns true if the field was read, false if the file contains no such 
+// field or set.
+bool exodus_file_read_element_field_on_set(exodus_file_t* file,
+                                           int time_index,
+                                           const char* field_name,
+                                           const char* set_name,
+                                           real_t* field_data);
+
+// Reads a named node field on the nodes with indices in 
+// [first_node, end_node) into the given array, returning true if the field 
+// was read and false if the file contains no such field.
+bool exodus_file_read_node_field_range(exodus_file_t* file,
+                                       int time_index,
+                                       const char* field_name,
+                                       int first_node,
+                                       int end_node,
+                                       real_t* field_data);
+
+// Reads a named node field on the nodes in the node set with the given name 
+// into the given array, in the order of the set's entries. Returns true if 
+// the field was read, false if the file contains no such field or set.
+bool exodus_file_read_node_field_on_set(exodus_file_t* file,
+                                        int time_index,
+                                        const char* field_name,
+                                        const char* set_name,
+                                        real_t* field_data);
+
 #endif
@@ -8,8 +8,21 @@
 #include "core/array.h"
 #include "core/array_utils.h"
 #include "core/tagger.h"
+#include "core/unordered_map.h"
 #include "polyglot/fe_mesh.h"
 
+// OpenMP directives are only emitted when we have OpenMP, so that builds 
+// without it don't warn about unknown pragmas.
+#ifdef _OPENMP
+#include <omp.h>
+#define OMP_PRAGMA(directive) _Pragma(#directive)
+#else
+#define OMP_PRAGMA(directive)
+static inline int omp_get_max_threads(void) { return 1; }
+static inline int omp_get_num_threads(void) { return 1; }
+static inline int omp_get_thread_num(void) { return 0; }
+#endif
+
 struct fe_block_t 
 {
   int num_elem;
@@ -27,14 +40,14 @@ fe_block_t* fe_block_new(int num_elem,
                          int num_elem_nodes,
                          int* elem_node_indices)
 {
-  ASSERT(num_elem > 0);
-  ASSERT(elem_node_indices != NULL);
+  ASSERT(num_elem >= 0);
+  ASSERT((num_elem == 0) || (elem_node_indices != NULL));
   fe_block_t* block = polymec_malloc(sizeof(fe_block_t));
   block->num_elem = num_elem;
   block->elem_type = type;
 
   // Element nodes.
-  block->elem_node_offsets = polymec_malloc(sizeof(int) * num_elem_nodes * num_elem);
+  block->elem_node_offsets = polymec_malloc(sizeof(int) * (num_elem+1));
   block->elem_node_offsets[0] = 0;
   for (int i = 0; i < num_elem; ++i)
     block->elem_node_offsets[i+1] = block->elem_node_offsets[i] + num_elem_nodes;
@@ -48,6 +61,40 @@ fe_block_t* fe_block_new(int num_elem,
   return block;
 }
 
+// Creates a block of elements of the given type, taking ownership of the 
+// given element->node connectivity (in compressed row storage). Unlike 
+// fe_block_new, this allows empty blocks.
+static fe_block_t* fe_block_from_node_connectivity(int num_elem,
+                                                   fe_mesh_element_t type,
+                                                   int* elem_node_offsets,
+                                                   int* elem_nodes)
+{
+  ASSERT(num_elem >= 0);
+  fe_block_t* block = polymec_malloc(sizeof(fe_block_t));
+  block->num_elem = num_elem;
+  block->elem_type = type;
+  block->elem_node_offsets = elem_node_offsets;
+  block->elem_nodes = elem_nodes;
+  block->elem_face_offsets = NULL;
+  block->elem_faces = NULL;
+  return block;
+}
+
+fe_block_t* fe_block_from_node_indices(int num_elem,
+                                       fe_mesh_element_t type,
+                                       int num_elem_nodes,
+                                       int* elem_node_indices)
+{
+  ASSERT(num_elem >= 0);
+  ASSERT((num_elem == 0) || (elem_node_indices != NULL));
+  int* elem_node_offsets = polymec_malloc(sizeof(int) * (num_elem+1));
+  elem_node_offsets[0] = 0;
+  for (int i = 0; i < num_elem; ++i)
+    elem_node_offsets[i+1] = elem_node_offsets[i] + num_elem_nodes;
+  return fe_block_from_node_connectivity(num_elem, type, elem_node_offsets, 
+                                         elem_node_indices);
+}
+
 fe_block_t* polyhedral_fe_block_new(int num_elem,
                                     int* num_elem_faces,
                                     int* elem_face_indices)
@@ -63,12 +110,12 @@ fe_block_t* polyhedral_fe_block_new(int num_elem,
   int tot_elem_faces = 0;
   for (int i = 0; i < num_elem; ++i)
     tot_elem_faces += num_elem_faces[i];
-  block->elem_face_offsets = polymec_malloc(sizeof(int) * tot_elem_faces);
+  block->elem_face_offsets = polymec_malloc(sizeof(int) * (num_elem+1));
   block->elem_face_offsets[0] = 0;
   for (int i = 0; i < num_elem; ++i)
     block->elem_face_offsets[i+1] = block->elem_face_offsets[i] + num_elem_faces[i];
-  block->elem_faces = polymec_malloc(sizeof(int) * block->elem_face_offsets[num_elem]);
-  memcpy(block->elem_faces, elem_face_indices, sizeof(int) * block->elem_face_offsets[num_elem]);
+  block->elem_faces = polymec_malloc(sizeof(int) * tot_elem_faces);
+  memcpy(block->elem_faces, elem_face_indices, sizeof(int) * tot_elem_faces);
 
   // Element nodes/edges are not determined until the block is added to 
   // the mesh.
@@ -80,6 +127,16 @@ fe_block_t* polyhedral_fe_block_new(int num_elem,
 
 void fe_block_free(fe_block_t* block)
 {
+  if (block->elem_nodes != NULL)
+  {
+    polymec_free(block->elem_nodes);
+    polymec_free(block->elem_node_offsets);
+  }
+  if (block->elem_faces != NULL)
+  {
+    polymec_free(block->elem_faces);
+    polymec_free(block->elem_face_offsets);
+  }
   polymec_free(block);
 }
 
@@ -88,6 +145,26 @@ fe_block_t* fe_block_clone(fe_block_t* block)
   fe_block_t* copy = polymec_malloc(sizeof(fe_block_t));
   copy->num_elem = block->num_elem;
   copy->elem_type = block->elem_type;
+  copy->elem_node_offsets = NULL;
+  copy->elem_nodes = NULL;
+  copy->elem_face_offsets = NULL;
+  copy->elem_faces = NULL;
+  if (block->elem_nodes != NULL)
+  {
+    int n = block->num_elem;
+    copy->elem_node_offsets = polymec_malloc(sizeof(int) * (n+1));
+    memcpy(copy->elem_node_offsets, block->elem_node_offsets, sizeof(int) * (n+1));
+    copy->elem_nodes = polymec_malloc(sizeof(int) * block->elem_node_offsets[n]);
+    memcpy(copy->elem_nodes, block->elem_nodes, sizeof(int) * block->elem_node_offsets[n]);
+  }
+  if (block->elem_faces != NULL)
+  {
+    int n = block->num_elem;
+    copy->elem_face_offsets = polymec_malloc(sizeof(int) * (n+1));
+    memcpy(copy->elem_face_offsets, block->elem_face_offsets, sizeof(int) * (n+1));
+    copy->elem_faces = polymec_malloc(sizeof(int) * block->elem_face_offsets[n]);
+    memcpy(copy->elem_faces, block->elem_faces, sizeof(int) * block->elem_face_offsets[n]);
+  }
   return copy;
 }
 
@@ -147,6 +224,211 @@ void fe_block_get_element_faces(fe_block_t* block,
   }
 }
 
+const int* fe_block_element_nodes(fe_block_t* block, 
+                                  int elem_index,
+                                  int* num_elem_nodes)
+{
+  if (block->elem_nodes != NULL)
+  {
+    int offset = block->elem_node_offsets[elem_index];
+    *num_elem_nodes = block->elem_node_offsets[elem_index+1] - offset;
+    return &block->elem_nodes[offset];
+  }
+  else
+  {
+    *num_elem_nodes = -1;
+    return NULL;
+  }
+}
+
+const int* fe_block_element_faces(fe_block_t* block, 
+                                  int elem_index,
+                                  int* num_elem_faces)
+{
+  if (block->elem_faces != NULL)
+  {
+    int offset = block->elem_face_offsets[elem_index];
+    *num_elem_faces = block->elem_face_offsets[elem_index+1] - offset;
+    return &block->elem_faces[offset];
+  }
+  else
+  {
+    *num_elem_faces = -1;
+    return NULL;
+  }
+}
+
+void fe_block_get_node_connectivity(fe_block_t* block, 
+                                    const int** elem_node_offsets,
+                                    const int** elem_nodes)
+{
+  *elem_node_offsets = block->elem_node_offsets;
+  *elem_nodes = block->elem_nodes;
+}
+
+void fe_block_get_face_connectivity(fe_block_t* block, 
+                                    const int** elem_face_offsets,
+                                    const int** elem_faces)
+{
+  *elem_face_offsets = block->elem_face_offsets;
+  *elem_faces = block->elem_faces;
+}
+
+// Serialization format versions. Bump these whenever the corresponding 
+// binary layouts change.
+#define FE_BLOCK_SERIALIZER_VERSION 1
+#define FE_MESH_SERIALIZER_VERSION 2
+
+// Connectivity in compressed row storage is written as a contiguous array 
+// of offsets followed by a contiguous array of values.
+static size_t csr_byte_size(int num_rows, const int* offsets)
+{
+  if (offsets == NULL)
+    return 0;
+  return sizeof(int) * (num_rows + 1 + offsets[num_rows]);
+}
+
+static void csr_byte_write(int num_rows, 
+                           int* offsets, 
+                           int* values, 
+                           byte_array_t* bytes, 
+                           size_t* offset)
+{
+  byte_array_write_ints(bytes, num_rows+1, offsets, offset);
+  byte_array_write_ints(bytes, offsets[num_rows], values, offset);
+}
+
+static void csr_byte_read(int num_rows, 
+                          int** offsets, 
+                          int** values, 
+                          byte_array_t* bytes, 
+                          size_t* offset)
+{
+  *offsets = polymec_malloc(sizeof(int) * (num_rows+1));
+  byte_array_read_ints(bytes, num_rows+1, *offsets, offset);
+  *values = polymec_malloc(sizeof(int) * (*offsets)[num_rows]);
+  byte_array_read_ints(bytes, (*offsets)[num_rows], *values, offset);
+}
+
+// A block is written as a header of 5 ints (version, number of elements, 
+// element type, and flags for element->node and element->face 
+// connectivity), followed by the connectivity that is present.
+static size_t fe_block_byte_size(void* obj)
+{
+  fe_block_t* block = obj;
+  return 5 * sizeof(int) + 
+         csr_byte_size(block->num_elem, block->elem_node_offsets) + 
+         csr_byte_size(block->num_elem, block->elem_face_offsets);
+}
+
+static void* fe_block_byte_read(byte_array_t* bytes, size_t* offset)
+{
+  int header[5];
+  byte_array_read_ints(bytes, 5, header, offset);
+  if (header[0] != FE_BLOCK_SERIALIZER_VERSION)
+  {
+    polymec_error("fe_block_serializer: unsupported format version: %d (expected %d).", 
+                  header[0], FE_BLOCK_SERIALIZER_VERSION);
+  }
+
+  fe_block_t* block = polymec_malloc(sizeof(fe_block_t));
+  block->num_elem = header[1];
+  block->elem_type = (fe_mesh_element_t)header[2];
+  block->elem_node_offsets = NULL;
+  block->elem_nodes = NULL;
+  block->elem_face_offsets = NULL;
+  block->elem_faces = NULL;
+  if (header[3] != 0)
+    csr_byte_read(block->num_elem, &block->elem_node_offsets, &block->elem_nodes, bytes, offset);
+  if (header[4] != 0)
+    csr_byte_read(block->num_elem, &block->elem_face_offsets, &block->elem_faces, bytes, offset);
+  return block;
+}
+
+static void fe_block_byte_write(void* obj, byte_array_t* bytes, size_t* offset)
+{
+  fe_block_t* block = obj;
+  int header[5] = {FE_BLOCK_SERIALIZER_VERSION, block->num_elem, 
+                   (int)block->elem_type, 
+                   (block->elem_nodes != NULL) ? 1 : 0,
+                   (block->elem_faces != NULL) ? 1 : 0};
+  byte_array_write_ints(bytes, 5, header, offset);
+  if (block->elem_nodes != NULL)
+    csr_byte_write(block->num_elem, block->elem_node_offsets, block->elem_nodes, bytes, offset);
+  if (block->elem_faces != NULL)
+    csr_byte_write(block->num_elem, block->elem_face_offsets, block->elem_faces, bytes, offset);
+}
+
+serializer_t* fe_block_serializer()
+{
+  return serializer_new("fe_block", fe_block_byte_size, 
+                        fe_block_byte_read, fe_block_byte_write, 
+                        DTOR(fe_block_free));
+}
+
+// A halo describes the exchange of entity data between this process and the 
+// others in a communicator. The local indices of the entities sent to process 
+// p are send_indices[send_offsets[p]] through send_indices[send_offsets[p+1]-1],
+// and likewise for received entities.
+typedef struct
+{
+  int* send_offsets;
+  int* send_indices;
+  int* recv_offsets;
+  int* recv_indices;
+} halo_t;
+
+static void halo_free(halo_t* halo)
+{
+  polymec_free(halo->send_offsets);
+  polymec_free(halo->send_indices);
+  polymec_free(halo->recv_offsets);
+  polymec_free(halo->recv_indices);
+  polymec_free(halo);
+}
+
+// Returns a copy of the given halo on the given communicator, or NULL if 
+// halo is NULL.
+static halo_t* halo_clone(halo_t* halo, MPI_Comm comm)
+{
+  if (halo == NULL)
+    return NULL;
+  int nprocs;
+  MPI_Comm_size(comm, &nprocs);
+  halo_t* copy = polymec_malloc(sizeof(halo_t));
+  copy->send_offsets = polymec_malloc(sizeof(int) * (nprocs+1));
+  memcpy(copy->send_offsets, halo->send_offsets, sizeof(int) * (nprocs+1));
+  copy->send_indices = polymec_malloc(sizeof(int) * halo->send_offsets[nprocs]);
+  memcpy(copy->send_indices, halo->send_indices, sizeof(int) * halo->send_offsets[nprocs]);
+  copy->recv_offsets = polymec_malloc(sizeof(int) * (nprocs+1));
+  memcpy(copy->recv_offsets, halo->recv_offsets, sizeof(int) * (nprocs+1));
+  copy->recv_indices = polymec_malloc(sizeof(int) * halo->recv_offsets[nprocs]);
+  memcpy(copy->recv_indices, halo->recv_indices, sizeof(int) * halo->recv_offsets[nprocs]);
+  return copy;
+}
+
+// Creates an exchanger that carries out the exchange described by the given 
+// halo (or that does nothing if halo is NULL).
+static exchanger_t* halo_exchanger(halo_t* halo, MPI_Comm comm)
+{
+  exchanger_t* ex = exchanger_new(comm);
+  if (halo != NULL)
+  {
+    int nprocs;
+    MPI_Comm_size(comm, &nprocs);
+    for (int p = 0; p < nprocs; ++p)
+    {
+      int num_sent = halo->send_offsets[p+1] - halo->send_offsets[p];
+      if (num_sent > 0)
+        exchanger_set_send(ex, p, &halo->send_indices[halo->send_offsets[p]], num_sent, true);
+      int num_received = halo->recv_offsets[p+1] - halo->recv_offsets[p];
+      if (num_received > 0)
+        exchanger_set_receive(ex, p, &halo->recv_indices[halo->recv_offsets[p]], num_received, true);
+    }
+  }
+  return ex;
+}
+
 struct fe_mesh_t 
 {
   MPI_Comm comm;
@@ -178,11 +460,35 @@ struct fe_mesh_t
   tagger_t* edge_sets;
   tagger_t* node_sets;
   tagger_t* side_sets;
+
+  // Ghost elements (stored in blocks corresponding to those above) and 
+  // ghost -> block element index mapping.
+  ptr_array_t* ghost_blocks;
+  int_array_t* ghost_block_elem_offsets;
+
+  // Nodes [0, num_owned_nodes) are owned by this process; the rest are ghosts.
+  int num_owned_nodes;
+
+  // Global indices of (owned and ghost) elements and nodes, or NULL if the 
+  // mesh has not been distributed.
+  int* elem_global_ids;
+  int* node_global_ids;
+
+  // Identifiers of (owned and ghost) elements and nodes (such as those in an 
+  // Exodus file's number maps), or NULL if they have none.
+  int* elem_ids;
+  int* node_ids;
+
+  // Halo exchange plans for element and node data, and their exchangers.
+  halo_t* elem_halo;
+  halo_t* node_halo;
+  exchanger_t* elem_exchanger;
+  exchanger_t* node_exchanger;
 };
 
 fe_mesh_t* fe_mesh_new(MPI_Comm comm, int num_nodes)
 {
-  ASSERT(num_nodes >= 4);
+  ASSERT(num_nodes >= 0);
   fe_mesh_t* mesh = polymec_malloc(sizeof(fe_mesh_t));
   mesh->comm = comm;
   mesh->num_nodes = num_nodes;
@@ -209,6 +515,19 @@ fe_mesh_t* fe_mesh_new(MPI_Comm comm, int num_nodes)
   mesh->node_sets = tagger_new();
   mesh->side_sets = tagger_new();
 
+  mesh->ghost_blocks = ptr_array_new();
+  mesh->ghost_block_elem_offsets = int_array_new();
+  int_array_append(mesh->ghost_block_elem_offsets, 0);
+  mesh->num_owned_nodes = num_nodes;
+  mesh->elem_global_ids = NULL;
+  mesh->node_global_ids = NULL;
+  mesh->elem_ids = NULL;
+  mesh->node_ids = NULL;
+  mesh->elem_halo = NULL;
+  mesh->node_halo = NULL;
+  mesh->elem_exchanger = NULL;
+  mesh->node_exchanger = NULL;
+
   return mesh;
 }
 
@@ -225,6 +544,35 @@ void fe_mesh_free(fe_mesh_t* mesh)
     polymec_free(mesh->face_nodes);
     polymec_free(mesh->face_node_offsets);
   }
+  if (mesh->face_edges != NULL)
+  {
+    polymec_free(mesh->face_edges);
+    polymec_free(mesh->face_edge_offsets);
+  }
+  if (mesh->edge_nodes != NULL)
+  {
+    polymec_free(mesh->edge_nodes);
+    polymec_free(mesh->edge_node_offsets);
+  }
+
+  if (mesh->elem_global_ids != NULL)
+    polymec_free(mesh->elem_global_ids);
+  if (mesh->node_global_ids != NULL)
+    polymec_free(mesh->node_global_ids);
+  if (mesh->elem_halo != NULL)
+    halo_free(mesh->elem_halo);
+  if (mesh->node_halo != NULL)
+    halo_free(mesh->node_halo);
+  if (mesh->elem_ids != NULL)
+    polymec_free(mesh->elem_ids);
+  if (mesh->node_ids != NULL)
+    polymec_free(mesh->node_ids);
+  if (mesh->elem_exchanger != NULL)
+    exchanger_free(mesh->elem_exchanger);
+  if (mesh->node_exchanger != NULL)
+    exchanger_free(mesh->node_exchanger);
+  ptr_array_free(mesh->ghost_blocks);
+  int_array_free(mesh->ghost_block_elem_offsets);
 
   ptr_array_free(mesh->blocks);
   string_array_free(mesh->block_names);
@@ -233,22 +581,87 @@ void fe_mesh_free(fe_mesh_t* mesh)
   polymec_free(mesh);
 }
 
+// Copies the sets in src to dest, mapping their contents through index_map 
+// if it is given.
+static void copy_sets(tagger_t* src, tagger_t* dest, int* index_map)
+{
+  int pos = 0, *set;
+  size_t set_size;
+  char* set_name;
+  while (tagger_next_tag(src, &pos, &set_name, &set, &set_size))
+  {
+    int* dest_set = tagger_create_tag(dest, set_name, set_size);
+    for (size_t i = 0; i < set_size; ++i)
+      dest_set[i] = (index_map != NULL) ? index_map[set[i]] : set[i];
+  }
+}
+
+// Returns a newly-allocated copy of the n entries of the given array, or 
+// NULL if it is NULL.
+static int* copy_ints(const int* array, int n)
+{
+  if (array == NULL)
+    return NULL;
+  int* copy = polymec_malloc(sizeof(int) * n);
+  memcpy(copy, array, sizeof(int) * n);
+  return copy;
+}
+
 fe_mesh_t* fe_mesh_clone(fe_mesh_t* mesh)
 {
-  fe_mesh_t* copy = polymec_malloc(sizeof(fe_mesh_t));
-  copy->comm = mesh->comm;
-  copy->num_nodes = mesh->num_nodes;
-  copy->blocks = ptr_array_new();
+  fe_mesh_t* copy = fe_mesh_new(mesh->comm, mesh->num_nodes);
+  memcpy(copy->node_coords, mesh->node_coords, sizeof(point_t) * mesh->num_nodes);
   for (int i = 0; i < mesh->blocks->size; ++i)
-    copy->blocks->data[i] = fe_block_clone(mesh->blocks->data[i]);
-  copy->block_names = string_array_new();
-  for (int i = 0; i < mesh->block_names->size; ++i)
-    copy->block_names->data[i] = string_dup(mesh->block_names->data[i]);
-  copy->block_elem_offsets = int_array_new();
-  for (int i = 0; i < mesh->block_elem_offsets->size; ++i)
-    int_array_append(copy->block_elem_offsets, mesh->block_elem_offsets->data[i]);
-  copy->node_coords = polymec_malloc(sizeof(point_t) * copy->num_nodes);
-  memcpy(copy->node_coords, mesh->node_coords, sizeof(point_t) * copy->num_nodes);
+    fe_mesh_add_block(copy, mesh->block_names->data[i], fe_block_clone(mesh->blocks->data[i]));
+
+  // Face and edge connectivity.
+  copy->num_faces = mesh->num_faces;
+  if (mesh->face_nodes != NULL)
+  {
+    copy->face_node_offsets = copy_ints(mesh->face_node_offsets, mesh->num_faces+1);
+    copy->face_nodes = copy_ints(mesh->face_nodes, mesh->face_node_offsets[mesh->num_faces]);
+  }
+  if (mesh->face_edges != NULL)
+  {
+    copy->face_edge_offsets = copy_ints(mesh->face_edge_offsets, mesh->num_faces+1);
+    copy->face_edges = copy_ints(mesh->face_edges, mesh->face_edge_offsets[mesh->num_faces]);
+  }
+  copy->num_edges = mesh->num_edges;
+  if (mesh->edge_nodes != NULL)
+  {
+    copy->edge_node_offsets = copy_ints(mesh->edge_node_offsets, mesh->num_edges+1);
+    copy->edge_nodes = copy_ints(mesh->edge_nodes, mesh->edge_node_offsets[mesh->num_edges]);
+  }
+
+  // Sets.
+  copy_sets(mesh->elem_sets, copy->elem_sets, NULL);
+  copy_sets(mesh->face_sets, copy->face_sets, NULL);
+  copy_sets(mesh->edge_sets, copy->edge_sets, NULL);
+  copy_sets(mesh->node_sets, copy->node_sets, NULL);
+  copy_sets(mesh->side_sets, copy->side_sets, NULL);
+
+  // Ghost elements and nodes.
+  for (int i = 0; i < mesh->ghost_blocks->size; ++i)
+  {
+    ptr_array_append_with_dtor(copy->ghost_blocks, 
+                               fe_block_clone(mesh->ghost_blocks->data[i]),
+                               DTOR(fe_block_free));
+    int_array_append(copy->ghost_block_elem_offsets, 
+                     mesh->ghost_block_elem_offsets->data[i+1]);
+  }
+  copy->num_owned_nodes = mesh->num_owned_nodes;
+
+  // Global indices, identifiers, and halos. Exchangers are created when 
+  // they're first needed.
+  int num_elem = fe_mesh_num_elements(mesh) + fe_mesh_num_ghost_elements(mesh);
+  copy->elem_global_ids = copy_ints(mesh->elem_global_ids, num_elem);
+  copy->node_global_ids = copy_ints(mesh->node_global_ids, mesh->num_nodes);
+  if (mesh->elem_ids != NULL)
+    fe_mesh_set_element_ids(copy, mesh->elem_ids);
+  if (mesh->node_ids != NULL)
+    fe_mesh_set_node_ids(copy, mesh->node_ids);
+  copy->elem_halo = halo_clone(mesh->elem_halo, mesh->comm);
+  copy->node_halo = halo_clone(mesh->node_halo, mesh->comm);
   return copy;
 }
 
@@ -302,24 +715,57 @@ int fe_mesh_num_elements(fe_mesh_t* mesh)
   return mesh->block_elem_offsets->data[mesh->block_elem_offsets->size-1];
 }
 
-int fe_mesh_num_element_nodes(fe_mesh_t* mesh, int elem_index)
+bool fe_mesh_next_block_range(fe_mesh_t* mesh, 
+                              int* pos, 
+                              fe_block_t** block, 
+                              int* first_elem,
+                              int* end_elem)
+{
+  if (*pos >= mesh->blocks->size)
+    return false;
+
+  *block = mesh->blocks->data[*pos];
+  *first_elem = mesh->block_elem_offsets->data[*pos];
+  *end_elem = mesh->block_elem_offsets->data[*pos+1];
+  ++(*pos);
+  return true;
+}
+
+// Returns the index of the block containing the element with the given 
+// (mesh) index. Block element offsets are non-decreasing (blocks may be 
+// empty), so we do a branch-free binary search for the last block whose 
+// offset does not exceed elem_index. That block contains the element: any 
+// empty blocks before it share its offset, and the next block's offset is 
+// greater than elem_index. This costs O(log B) for B blocks with no 
+// per-element storage.
+static inline int find_element_block(fe_mesh_t* mesh, int elem_index)
 {
   ASSERT(elem_index >= 0);
   ASSERT(elem_index < fe_mesh_num_elements(mesh));
-
-  // Find the block that houses this element.
-  int b = 0;
-  if (mesh->blocks->size > 1)
+  int* offsets = mesh->block_elem_offsets->data;
+  int b = 0, n = (int)mesh->blocks->size;
+  while (n > 1)
   {
-    while ((mesh->block_elem_offsets->data[b] < elem_index) && 
-           ((b+1) <= mesh->block_elem_offsets->size)) ++b;
-    if (b == mesh->block_elem_offsets->size-1)
-      return -1;
+    int half = n / 2;
+    b = (offsets[b + half] <= elem_index) ? b + half : b;
+    n -= half;
   }
+  return b;
+}
+
+fe_block_t* fe_mesh_element_block(fe_mesh_t* mesh, 
+                                  int elem_index, 
+                                  int* block_elem_index)
+{
+  int b = find_element_block(mesh, elem_index);
+  *block_elem_index = elem_index - mesh->block_elem_offsets->data[b];
+  return mesh->blocks->data[b];
+}
 
-  // Now ask the block about the element.
-  fe_block_t* block = mesh->blocks->data[b];
-  int e = elem_index - mesh->block_elem_offsets->data[b];
+int fe_mesh_num_element_nodes(fe_mesh_t* mesh, int elem_index)
+{
+  int e;
+  fe_block_t* block = fe_mesh_element_block(mesh, elem_index, &e);
   return fe_block_num_element_nodes(block, e);
 }
 
@@ -327,37 +773,15 @@ void fe_mesh_get_element_nodes(fe_mesh_t* mesh,
                                int elem_index, 
                                int* elem_nodes)
 {
-  // Find the block that houses this element.
-  int b = 0;
-  if (mesh->blocks->size > 1)
-  {
-    while ((mesh->block_elem_offsets->data[b] < elem_index) && 
-           ((b+1) <= mesh->block_elem_offsets->size)) ++b;
-    if (b == mesh->block_elem_offsets->size-1)
-      return;
-  }
-
-  // Now ask the block about the element.
-  fe_block_t* block = mesh->blocks->data[b];
-  int e = elem_index - mesh->block_elem_offsets->data[b];
+  int e;
+  fe_block_t* block = fe_mesh_element_block(mesh, elem_index, &e);
   fe_block_get_element_nodes(block, e, elem_nodes);
 }
 
 int fe_mesh_num_element_faces(fe_mesh_t* mesh, int elem_index)
 {
-  // Find the block that houses this element.
-  int b = 0;
-  if (mesh->blocks->size > 1)
-  {
-    while ((mesh->block_elem_offsets->data[b] < elem_index) && 
-           ((b+1) <= mesh->block_elem_offsets->size)) ++b;
-    if (b == mesh->block_elem_offsets->size-1)
-      return -1;
-  }
-
-  // Now ask the block about the element.
-  fe_block_t* block = mesh->blocks->data[b];
-  int e = elem_index - mesh->block_elem_offsets->data[b];
+  int e;
+  fe_block_t* block = fe_mesh_element_block(mesh, elem_index, &e);
   return fe_block_num_element_faces(block, e);
 }
 
@@ -365,22 +789,29 @@ void fe_mesh_get_element_faces(fe_mesh_t* mesh,
                                int elem_index, 
                                int* elem_faces)
 {
-  // Find the block that houses this element.
-  int b = 0;
-  if (mesh->blocks->size > 1)
-  {
-    while ((mesh->block_elem_offsets->data[b] < elem_index) && 
-           ((b+1) <= mesh->block_elem_offsets->size)) ++b;
-    if (b == mesh->block_elem_offsets->size-1)
-      return;
-  }
-
-  // Now ask the block about the element.
-  fe_block_t* block = mesh->blocks->data[b];
-  int e = elem_index - mesh->block_elem_offsets->data[b];
+  int e;
+  fe_block_t* block = fe_mesh_element_block(mesh, elem_index, &e);
   fe_block_get_element_faces(block, e, elem_faces);
 }
 
+const int* fe_mesh_element_nodes(fe_mesh_t* mesh, 
+                                 int elem_index,
+                                 int* num_elem_nodes)
+{
+  int e;
+  fe_block_t* block = fe_mesh_element_block(mesh, elem_index, &e);
+  return fe_block_element_nodes(block, e, num_elem_nodes);
+}
+
+const int* fe_mesh_element_faces(fe_mesh_t* mesh, 
+                                 int elem_index,
+                                 int* num_elem_faces)
+{
+  int e;
+  fe_block_t* block = fe_mesh_element_block(mesh, elem_index, &e);
+  return fe_block_element_faces(block, e, num_elem_faces);
+}
+
 int fe_mesh_num_faces(fe_mesh_t* mesh)
 {
   return mesh->num_faces;
@@ -410,6 +841,31 @@ void fe_mesh_get_face_nodes(fe_mesh_t* mesh,
   }
 }
 
+const int* fe_mesh_face_nodes(fe_mesh_t* mesh, 
+                              int face_index,
+                              int* num_face_nodes)
+{
+  if (mesh->face_nodes != NULL)
+  {
+    int offset = mesh->face_node_offsets[face_index];
+    *num_face_nodes = mesh->face_node_offsets[face_index+1] - offset;
+    return &mesh->face_nodes[offset];
+  }
+  else
+  {
+    *num_face_nodes = -1;
+    return NULL;
+  }
+}
+
+void fe_mesh_get_face_node_connectivity(fe_mesh_t* mesh, 
+                                        const int** face_node_offsets,
+                                        const int** face_nodes)
+{
+  *face_node_offsets = mesh->face_node_offsets;
+  *face_nodes = mesh->face_nodes;
+}
+
 int fe_mesh_num_face_edges(fe_mesh_t* mesh,
                            int face_index)
 {
@@ -434,6 +890,31 @@ void fe_mesh_get_face_edges(fe_mesh_t* mesh,
   }
 }
 
+const int* fe_mesh_face_edges(fe_mesh_t* mesh, 
+                              int face_index,
+                              int* num_face_edges)
+{
+  if (mesh->face_edges != NULL)
+  {
+    int offset = mesh->face_edge_offsets[face_index];
+    *num_face_edges = mesh->face_edge_offsets[face_index+1] - offset;
+    return &mesh->face_edges[offset];
+  }
+  else
+  {
+    *num_face_edges = -1;
+    return NULL;
+  }
+}
+
+void fe_mesh_get_face_edge_connectivity(fe_mesh_t* mesh, 
+                                        const int** face_edge_offsets,
+                                        const int** face_edges)
+{
+  *face_edge_offsets = mesh->face_edge_offsets;
+  *face_edges = mesh->face_edges;
+}
+
 int fe_mesh_num_edges(fe_mesh_t* mesh)
 {
   return mesh->num_edges;
@@ -478,6 +959,31 @@ void fe_mesh_get_edge_nodes(fe_mesh_t* mesh,
   }
 }
 
+const int* fe_mesh_edge_nodes(fe_mesh_t* mesh, 
+                              int edge_index,
+                              int* num_edge_nodes)
+{
+  if (mesh->edge_nodes != NULL)
+  {
+    int offset = mesh->edge_node_offsets[edge_index];
+    *num_edge_nodes = mesh->edge_node_offsets[edge_index+1] - offset;
+    return &mesh->edge_nodes[offset];
+  }
+  else
+  {
+    *num_edge_nodes = -1;
+    return NULL;
+  }
+}
+
+void fe_mesh_get_edge_node_connectivity(fe_mesh_t* mesh, 
+                                        const int** edge_node_offsets,
+                                        const int** edge_nodes)
+{
+  *edge_node_offsets = mesh->edge_node_offsets;
+  *edge_nodes = mesh->edge_nodes;
+}
+
 int fe_mesh_num_nodes(fe_mesh_t* mesh)
 {
   return mesh->num_nodes;
@@ -593,193 +1099,1505 @@ bool fe_mesh_next_side_set(fe_mesh_t* mesh, int* pos, char** name, int** set, si
   return tagger_next_tag(mesh->side_sets, pos, name, set, size);
 }
 
-//------------------------------------------------------------------------
-//              Finite Element -> Finite Volume Mesh Translation
-//------------------------------------------------------------------------
-
-// Non-polyhedral face construction information.
-static int get_num_cell_faces(fe_mesh_element_t elem_type)
+// Strings are written as a length followed by their characters.
+static size_t string_byte_size(const char* s)
 {
-  ASSERT(elem_type != FE_INVALID);
-  ASSERT(elem_type != FE_POLYHEDRON);
-  if (elem_type == FE_TETRAHEDRON)
-    return 4;
-  else if ((elem_type == FE_PYRAMID) || (elem_type == FE_WEDGE))
-    return 5;
-  else 
-  {
-    ASSERT(elem_type == FE_HEXAHEDRON);
-    return 6;
-  }
+  return sizeof(int) + sizeof(char) * strlen(s);
 }
 
-#if 0
-// Returns true if t1 and t2 are the same size and contain the same numbers 
-// (regardless of order). Specific to 3- and 4-tuples.
-static bool tuples_are_equivalent(int* t1, int* t2)
+static void string_byte_write(char* s, byte_array_t* bytes, size_t* offset)
 {
-  int l1 = int_tuple_length(t1);
-  ASSERT((l1 == 3) || (l1 == 4));
-  if (l1 == int_tuple_length(t2))
-  {
-    if (l1 == 3)
-    {
-      return (((t1[0] == t2[0]) || (t1[0] == t2[1]) || (t1[0] == t2[2])) &&
-              ((t1[1] == t2[0]) || (t1[1] == t2[1]) || (t1[1] == t2[2])) &&
-              ((t1[2] == t2[0]) || (t1[2] == t2[1]) || (t1[2] == t2[2])));
-    }
-    else
-    {
-      return (((t1[0] == t2[0]) || (t1[0] == t2[1]) || (t1[0] == t2[2]) || (t1[0] == t2[3])) &&
-              ((t1[1] == t2[0]) || (t1[1] == t2[1]) || (t1[1] == t2[2]) || (t1[1] == t2[3])) &&
-              ((t1[2] == t2[0]) || (t1[2] == t2[1]) || (t1[2] == t2[2]) || (t1[2] == t2[3])) &&
-              ((t1[3] == t2[0]) || (t1[3] == t2[1]) || (t1[3] == t2[2]) || (t1[3] == t2[3])));
-    }
-  }
-  else
-    return false;
+  int len = (int)strlen(s);
+  byte_array_write_ints(bytes, 1, &len, offset);
+  byte_array_write_chars(bytes, len, s, offset);
 }
-#endif
-
-static int map_nodes_to_face(int_tuple_int_unordered_map_t* node_face_map,
-                             int* nodes,
-                             int num_nodes,
-                             int_array_t* face_node_offsets,
-                             int_array_t* face_nodes)
-{
-  // Sort the nodes and see if they appear in the node face map.
-  int* sorted_nodes = int_tuple_new(num_nodes);
-  memcpy(sorted_nodes, nodes, sizeof(int) * num_nodes);
-  int_qsort(sorted_nodes, num_nodes);
-  int* entry = int_tuple_int_unordered_map_get(node_face_map, sorted_nodes);
-  int face_index;
-  if (entry == NULL)
-  {
-    // Add a new face!
-    face_index = node_face_map->size;
-    int_tuple_int_unordered_map_insert_with_k_dtor(node_face_map, sorted_nodes, face_index, int_tuple_free);
-
-    // Record the face->node connectivity.
-    int last_offset = face_node_offsets->data[face_node_offsets->size-1];
-    int_array_append(face_node_offsets, last_offset + num_nodes);
-    for (int n = 0; n < num_nodes; ++n)
-      int_array_append(face_nodes, nodes[n]);
-  }
-  else
-  {
-    face_index = *entry;
-    int_tuple_free(sorted_nodes);
-  }
 
-  return face_index;
+static char* string_byte_read(byte_array_t* bytes, size_t* offset)
+{
+  int len;
+  byte_array_read_ints(bytes, 1, &len, offset);
+  char* s = polymec_malloc(sizeof(char) * (len+1));
+  byte_array_read_chars(bytes, len, s, offset);
+  s[len] = '\0';
+  return s;
 }
 
-static void get_cell_faces(fe_mesh_element_t elem_type,
-                           int* elem_nodes,
-                           int_tuple_int_unordered_map_t* node_face_map,
-                           int* cell_faces,
-                           int_array_t* face_node_offsets,
-                           int_array_t* face_nodes)
+// Entity sets are written as a number of sets followed by the name, size, 
+// and contents of each set.
+static size_t sets_byte_size(tagger_t* sets)
 {
-  ASSERT(elem_type != FE_INVALID);
-  ASSERT(elem_type != FE_POLYHEDRON);
-  if (elem_type == FE_TETRAHEDRON)
+  size_t size = sizeof(int);
+  int pos = 0, *set;
+  size_t set_size;
+  char* set_name;
+  while (tagger_next_tag(sets, &pos, &set_name, &set, &set_size))
+    size += string_byte_size(set_name) + sizeof(size_t) + sizeof(int) * set_size;
+  return size;
+}
+
+static void sets_byte_write(tagger_t* sets, byte_array_t* bytes, size_t* offset)
+{
+  int pos = 0, *set, num_sets = 0;
+  size_t set_size;
+  char* set_name;
+  while (tagger_next_tag(sets, &pos, &set_name, &set, &set_size))
+    ++num_sets;
+  byte_array_write_ints(bytes, 1, &num_sets, offset);
+  pos = 0;
+  while (tagger_next_tag(sets, &pos, &set_name, &set, &set_size))
+  {
+    string_byte_write(set_name, bytes, offset);
+    byte_array_write_size_ts(bytes, 1, &set_size, offset);
+    byte_array_write_ints(bytes, set_size, set, offset);
+  }
+}
+
+static void sets_byte_read(tagger_t* sets, byte_array_t* bytes, size_t* offset)
+{
+  int num_sets;
+  byte_array_read_ints(bytes, 1, &num_sets, offset);
+  for (int i = 0; i < num_sets; ++i)
+  {
+    char* set_name = string_byte_read(bytes, offset);
+    size_t set_size;
+    byte_array_read_size_ts(bytes, 1, &set_size, offset);
+    int* set = tagger_create_tag(sets, set_name, set_size);
+    byte_array_read_ints(bytes, set_size, set, offset);
+    string_free(set_name);
+  }
+}
+
+// A mesh is written as a header of 10 ints (version, numbers of nodes, 
+// blocks, faces, and edges, and flags for face->node, face->edge, and 
+// edge->node connectivity and element and node identifiers), followed by 
+// node positions, named blocks, the connectivity that is present, 
+// element/face/edge/node/side sets, and any element and node identifiers.
+static size_t fe_mesh_byte_size(void* obj)
+{
+  fe_mesh_t* mesh = obj;
+  size_t size = 10 * sizeof(int) + sizeof(point_t) * mesh->num_nodes;
+  for (int b = 0; b < mesh->blocks->size; ++b)
+  {
+    size += string_byte_size(mesh->block_names->data[b]);
+    size += fe_block_byte_size(mesh->blocks->data[b]);
+  }
+  size += csr_byte_size(mesh->num_faces, mesh->face_node_offsets);
+  size += csr_byte_size(mesh->num_faces, mesh->face_edge_offsets);
+  size += csr_byte_size(mesh->num_edges, mesh->edge_node_offsets);
+  size += sets_byte_size(mesh->elem_sets);
+  size += sets_byte_size(mesh->face_sets);
+  size += sets_byte_size(mesh->edge_sets);
+  size += sets_byte_size(mesh->node_sets);
+  size += sets_byte_size(mesh->side_sets);
+  if (mesh->elem_ids != NULL)
+    size += sizeof(int) * fe_mesh_num_elements(mesh);
+  if (mesh->node_ids != NULL)
+    size += sizeof(int) * mesh->num_nodes;
+  return size;
+}
+
+static void* fe_mesh_byte_read(byte_array_t* bytes, size_t* offset)
+{
+  int header[10];
+  byte_array_read_ints(bytes, 10, header, offset);
+  if (header[0] != FE_MESH_SERIALIZER_VERSION)
+  {
+    polymec_error("fe_mesh_serializer: unsupported format version: %d (expected %d).", 
+                  header[0], FE_MESH_SERIALIZER_VERSION);
+  }
+
+  fe_mesh_t* mesh = fe_mesh_new(MPI_COMM_WORLD, header[1]);
+  byte_array_read_points(bytes, mesh->num_nodes, mesh->node_coords, offset);
+  int num_blocks = header[2];
+  for (int b = 0; b < num_blocks; ++b)
+  {
+    char* block_name = string_byte_read(bytes, offset);
+    fe_block_t* block = fe_block_byte_read(bytes, offset);
+    fe_mesh_add_block(mesh, block_name, block);
+    string_free(block_name);
+  }
+
+  mesh->num_faces = header[3];
+  mesh->num_edges = header[4];
+  if (header[5] != 0)
+    csr_byte_read(mesh->num_faces, &mesh->face_node_offsets, &mesh->face_nodes, bytes, offset);
+  if (header[6] != 0)
+    csr_byte_read(mesh->num_faces, &mesh->face_edge_offsets, &mesh->face_edges, bytes, offset);
+  if (header[7] != 0)
+    csr_byte_read(mesh->num_edges, &mesh->edge_node_offsets, &mesh->edge_nodes, bytes, offset);
+
+  sets_byte_read(mesh->elem_sets, bytes, offset);
+  sets_byte_read(mesh->face_sets, bytes, offset);
+  sets_byte_read(mesh->edge_sets, bytes, offset);
+  sets_byte_read(mesh->node_sets, bytes, offset);
+  sets_byte_read(mesh->side_sets, bytes, offset);
+  if (header[8] != 0)
+  {
+    mesh->elem_ids = polymec_malloc(sizeof(int) * fe_mesh_num_elements(mesh));
+    byte_array_read_ints(bytes, fe_mesh_num_elements(mesh), mesh->elem_ids, offset);
+  }
+  if (header[9] != 0)
+  {
+    mesh->node_ids = polymec_malloc(sizeof(int) * mesh->num_nodes);
+    byte_array_read_ints(bytes, mesh->num_nodes, mesh->node_ids, offset);
+  }
+  return mesh;
+}
+
+static void fe_mesh_byte_write(void* obj, byte_array_t* bytes, size_t* offset)
+{
+  fe_mesh_t* mesh = obj;
+  int header[10] = {FE_MESH_SERIALIZER_VERSION, mesh->num_nodes, 
+                    (int)mesh->blocks->size, mesh->num_faces, mesh->num_edges,
+                    (mesh->face_nodes != NULL) ? 1 : 0,
+                    (mesh->face_edges != NULL) ? 1 : 0,
+                    (mesh->edge_nodes != NULL) ? 1 : 0,
+                    (mesh->elem_ids != NULL) ? 1 : 0,
+                    (mesh->node_ids != NULL) ? 1 : 0};
+  byte_array_write_ints(bytes, 10, header, offset);
+  byte_array_write_points(bytes, mesh->num_nodes, mesh->node_coords, offset);
+  for (int b = 0; b < mesh->blocks->size; ++b)
   {
-    // We have 4 significant nodes. Craft the faces for this element.
-    int face_node_indices[4][3] = {{elem_nodes[0], elem_nodes[1], elem_nodes[2]},
-                                   {elem_nodes[0], elem_nodes[1], elem_nodes[3]},
-                                   {elem_nodes[1], elem_nodes[2], elem_nodes[3]},
-                                   {elem_nodes[2], elem_nodes[0], elem_nodes[3]}};
-    for (int f = 0; f < 4; ++f)
+    string_byte_write(mesh->block_names->data[b], bytes, offset);
+    fe_block_byte_write(mesh->blocks->data[b], bytes, offset);
+  }
+
+  if (mesh->face_nodes != NULL)
+    csr_byte_write(mesh->num_faces, mesh->face_node_offsets, mesh->face_nodes, bytes, offset);
+  if (mesh->face_edges != NULL)
+    csr_byte_write(mesh->num_faces, mesh->face_edge_offsets, mesh->face_edges, bytes, offset);
+  if (mesh->edge_nodes != NULL)
+    csr_byte_write(mesh->num_edges, mesh->edge_node_offsets, mesh->edge_nodes, bytes, offset);
+
+  sets_byte_write(mesh->elem_sets, bytes, offset);
+  sets_byte_write(mesh->face_sets, bytes, offset);
+  sets_byte_write(mesh->edge_sets, bytes, offset);
+  sets_byte_write(mesh->node_sets, bytes, offset);
+  sets_byte_write(mesh->side_sets, bytes, offset);
+  if (mesh->elem_ids != NULL)
+    byte_array_write_ints(bytes, fe_mesh_num_elements(mesh), mesh->elem_ids, offset);
+  if (mesh->node_ids != NULL)
+    byte_array_write_ints(bytes, mesh->num_nodes, mesh->node_ids, offset);
+}
+
+serializer_t* fe_mesh_serializer()
+{
+  return serializer_new("fe_mesh", fe_mesh_byte_size, 
+                        fe_mesh_byte_read, fe_mesh_byte_write, 
+                        DTOR(fe_mesh_free));
+}
+
+//------------------------------------------------------------------------
+//                    Distributed Finite Element Meshes
+//------------------------------------------------------------------------
+
+int fe_mesh_num_ghost_elements(fe_mesh_t* mesh)
+{
+  return mesh->ghost_block_elem_offsets->data[mesh->ghost_block_elem_offsets->size-1];
+}
+
+bool fe_mesh_next_ghost_block_range(fe_mesh_t* mesh, 
+                                    int* pos, 
+                                    fe_block_t** block, 
+                                    int* first_elem,
+                                    int* end_elem)
+{
+  if (*pos >= mesh->ghost_blocks->size)
+    return false;
+
+  int num_elem = fe_mesh_num_elements(mesh);
+  *block = mesh->ghost_blocks->data[*pos];
+  *first_elem = num_elem + mesh->ghost_block_elem_offsets->data[*pos];
+  *end_elem = num_elem + mesh->ghost_block_elem_offsets->data[*pos+1];
+  ++(*pos);
+  return true;
+}
+
+int fe_mesh_num_owned_nodes(fe_mesh_t* mesh)
+{
+  return mesh->num_owned_nodes;
+}
+
+const int* fe_mesh_element_global_ids(fe_mesh_t* mesh)
+{
+  return mesh->elem_global_ids;
+}
+
+const int* fe_mesh_node_global_ids(fe_mesh_t* mesh)
+{
+  return mesh->node_global_ids;
+}
+
+void fe_mesh_set_element_ids(fe_mesh_t* mesh, const int* ids)
+{
+  int num_elem = fe_mesh_num_elements(mesh) + fe_mesh_num_ghost_elements(mesh);
+  mesh->elem_ids = polymec_realloc(mesh->elem_ids, sizeof(int) * (num_elem + 1));
+  memcpy(mesh->elem_ids, ids, sizeof(int) * num_elem);
+}
+
+const int* fe_mesh_element_ids(fe_mesh_t* mesh)
+{
+  return mesh->elem_ids;
+}
+
+void fe_mesh_set_node_ids(fe_mesh_t* mesh, const int* ids)
+{
+  mesh->node_ids = polymec_realloc(mesh->node_ids, sizeof(int) * (mesh->num_nodes + 1));
+  memcpy(mesh->node_ids, ids, sizeof(int) * mesh->num_nodes);
+}
+
+const int* fe_mesh_node_ids(fe_mesh_t* mesh)
+{
+  return mesh->node_ids;
+}
+
+exchanger_t* fe_mesh_element_exchanger(fe_mesh_t* mesh)
+{
+  if (mesh->elem_exchanger == NULL)
+    mesh->elem_exchanger = halo_exchanger(mesh->elem_halo, mesh->comm);
+  return mesh->elem_exchanger;
+}
+
+exchanger_t* fe_mesh_node_exchanger(fe_mesh_t* mesh)
+{
+  if (mesh->node_exchanger == NULL)
+    mesh->node_exchanger = halo_exchanger(mesh->node_halo, mesh->comm);
+  return mesh->node_exchanger;
+}
+
+// Concatenates the given per-process arrays, returning the result and 
+// allocating offsets (of length nprocs+1) to mark each process's portion.
+static int* concat_int_arrays(int nprocs, int_array_t** arrays, int** offsets)
+{
+  *offsets = polymec_malloc(sizeof(int) * (nprocs+1));
+  (*offsets)[0] = 0;
+  for (int p = 0; p < nprocs; ++p)
+    (*offsets)[p+1] = (*offsets)[p] + (int)arrays[p]->size;
+  int* data = polymec_malloc(sizeof(int) * (*offsets)[nprocs]);
+  for (int p = 0; p < nprocs; ++p)
+    memcpy(&data[(*offsets)[p]], arrays[p]->data, sizeof(int) * arrays[p]->size);
+  return data;
+}
+
+static real_t* concat_real_arrays(int nprocs, real_array_t** arrays, int** offsets)
+{
+  *offsets = polymec_malloc(sizeof(int) * (nprocs+1));
+  (*offsets)[0] = 0;
+  for (int p = 0; p < nprocs; ++p)
+    (*offsets)[p+1] = (*offsets)[p] + (int)arrays[p]->size;
+  real_t* data = polymec_malloc(sizeof(real_t) * (*offsets)[nprocs]);
+  for (int p = 0; p < nprocs; ++p)
+    memcpy(&data[(*offsets)[p]], arrays[p]->data, sizeof(real_t) * arrays[p]->size);
+  return data;
+}
+
+// Sends the portions of send_data marked by send_offsets to the respective 
+// processes in comm, returning the data received from all processes and 
+// allocating recv_offsets to mark the portion from each one.
+static void* exchange_data(MPI_Comm comm, 
+                           MPI_Datatype type, 
+                           size_t type_size, 
+                           int* send_offsets, 
+                           void* send_data, 
+                           int** recv_offsets)
+{
+  int nprocs;
+  MPI_Comm_size(comm, &nprocs);
+  int* send_counts = polymec_malloc(sizeof(int) * nprocs);
+  int* recv_counts = polymec_malloc(sizeof(int) * nprocs);
+  for (int p = 0; p < nprocs; ++p)
+    send_counts[p] = send_offsets[p+1] - send_offsets[p];
+  MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, comm);
+  *recv_offsets = polymec_malloc(sizeof(int) * (nprocs+1));
+  (*recv_offsets)[0] = 0;
+  for (int p = 0; p < nprocs; ++p)
+    (*recv_offsets)[p+1] = (*recv_offsets)[p] + recv_counts[p];
+  void* recv_data = polymec_malloc(type_size * (*recv_offsets)[nprocs]);
+  MPI_Alltoallv(send_data, send_counts, send_offsets, type, 
+                recv_data, recv_counts, *recv_offsets, type, comm);
+  polymec_free(send_counts);
+  polymec_free(recv_counts);
+  return recv_data;
+}
+
+static int* exchange_int_arrays(MPI_Comm comm, 
+                                int_array_t** arrays, 
+                                int** recv_offsets)
+{
+  int nprocs;
+  MPI_Comm_size(comm, &nprocs);
+  int* send_offsets;
+  int* send_data = concat_int_arrays(nprocs, arrays, &send_offsets);
+  int* recv_data = exchange_data(comm, MPI_INT, sizeof(int), 
+                                 send_offsets, send_data, recv_offsets);
+  polymec_free(send_data);
+  polymec_free(send_offsets);
+  return recv_data;
+}
+
+static real_t* exchange_real_arrays(MPI_Comm comm, 
+                                    real_array_t** arrays, 
+                                    int** recv_offsets)
+{
+  int nprocs;
+  MPI_Comm_size(comm, &nprocs);
+  int* send_offsets;
+  real_t* send_data = concat_real_arrays(nprocs, arrays, &send_offsets);
+  real_t* recv_data = exchange_data(comm, MPI_REAL_T, sizeof(real_t), 
+                                    send_offsets, send_data, recv_offsets);
+  polymec_free(send_data);
+  polymec_free(send_offsets);
+  return recv_data;
+}
+
+static int_array_t** int_arrays_new(int n)
+{
+  int_array_t** arrays = polymec_malloc(sizeof(int_array_t*) * n);
+  for (int i = 0; i < n; ++i)
+    arrays[i] = int_array_new();
+  return arrays;
+}
+
+static void int_arrays_free(int_array_t** arrays, int n)
+{
+  for (int i = 0; i < n; ++i)
+    int_array_free(arrays[i]);
+  polymec_free(arrays);
+}
+
+// Orders int pairs lexicographically (for qsort).
+static int int_pair_cmp(const void* l, const void* r)
+{
+  const int* lp = l;
+  const int* rp = r;
+  if (lp[0] != rp[0])
+    return (lp[0] < rp[0]) ? -1 : 1;
+  else
+    return (lp[1] < rp[1]) ? -1 : (lp[1] > rp[1]) ? 1 : 0;
+}
+
+void fe_mesh_add_ghosts(fe_mesh_t** mesh, 
+                        int* elem_global_ids, 
+                        int* node_global_ids)
+{
+  fe_mesh_t* m = *mesh;
+  MPI_Comm comm = m->comm;
+  int rank, nprocs;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nprocs);
+
+  int num_blocks = (int)m->blocks->size;
+  for (int b = 0; b < num_blocks; ++b)
+  {
+    fe_block_t* block = m->blocks->data[b];
+    if (block->elem_nodes == NULL)
     {
-      // Get the index of the face.
-      int face_index = map_nodes_to_face(node_face_map, face_node_indices[f], 3,
-                                         face_node_offsets, face_nodes);
+      polymec_error("fe_mesh_add_ghosts: block '%s' has no element->node connectivity.", 
+                    m->block_names->data[b]);
+    }
+  }
+  int num_elem = fe_mesh_num_elements(m);
+  int num_nodes = m->num_nodes;
+
+  // Each node is assigned to a "rendezvous" process (by its global index), 
+  // which finds out which processes share the node and tells them. A node 
+  // is owned by the lowest-ranked process that shares it.
+  int_array_t** bufs = int_arrays_new(nprocs);
+  for (int n = 0; n < num_nodes; ++n)
+    int_array_append(bufs[node_global_ids[n] % nprocs], node_global_ids[n]);
+  int* rv_offsets;
+  int* rv_nodes = exchange_int_arrays(comm, bufs, &rv_offsets);
+  int num_rv_nodes = rv_offsets[nprocs];
+
+  // Sort (node, process) pairs so that the processes sharing each node are 
+  // adjacent, in increasing order.
+  int* rv_pairs = polymec_malloc(sizeof(int) * 2 * num_rv_nodes);
+  for (int p = 0; p < nprocs; ++p)
+  {
+    for (int i = rv_offsets[p]; i < rv_offsets[p+1]; ++i)
+    {
+      rv_pairs[2*i] = rv_nodes[i];
+      rv_pairs[2*i+1] = p;
+    }
+  }
+  qsort(rv_pairs, num_rv_nodes, 2*sizeof(int), int_pair_cmp);
 
-      // Record the cell->face connectivity.
-      cell_faces[f] = face_index;
+  // Reply to each process in the order of its request with the owner of 
+  // each node, the number of other processes sharing it, and their ranks.
+  int_int_unordered_map_t* rv_first = int_int_unordered_map_new();
+  for (int i = 0; i < num_rv_nodes; ++i)
+  {
+    if ((i == 0) || (rv_pairs[2*i] != rv_pairs[2*(i-1)]))
+      int_int_unordered_map_insert(rv_first, rv_pairs[2*i], i);
+  }
+  for (int p = 0; p < nprocs; ++p)
+  {
+    int_array_clear(bufs[p]);
+    for (int i = rv_offsets[p]; i < rv_offsets[p+1]; ++i)
+    {
+      int first = *int_int_unordered_map_get(rv_first, rv_nodes[i]);
+      int end = first + 1;
+      while ((end < num_rv_nodes) && (rv_pairs[2*end] == rv_nodes[i]))
+        ++end;
+      int_array_append(bufs[p], rv_pairs[2*first+1]);
+      int_array_append(bufs[p], end - first - 1);
+      for (int j = first; j < end; ++j)
+      {
+        if (rv_pairs[2*j+1] != p)
+          int_array_append(bufs[p], rv_pairs[2*j+1]);
+      }
     }
   }
-  else if (elem_type == FE_PYRAMID)
+  int_int_unordered_map_free(rv_first);
+  polymec_free(rv_pairs);
+  polymec_free(rv_nodes);
+  polymec_free(rv_offsets);
+  int* reply_offsets;
+  int* reply = exchange_int_arrays(comm, bufs, &reply_offsets);
+
+  // Unpack the owners of our nodes and the other processes sharing them.
+  int* node_owners = polymec_malloc(sizeof(int) * num_nodes);
+  int* node_share_offsets = polymec_malloc(sizeof(int) * (num_nodes+1));
+  int_array_t* node_shares = int_array_new();
+  node_share_offsets[0] = 0;
+  for (int n = 0; n < num_nodes; ++n)
+  {
+    int p = node_global_ids[n] % nprocs;
+    int* r = &reply[reply_offsets[p]];
+    node_owners[n] = r[0];
+    for (int i = 0; i < r[1]; ++i)
+      int_array_append(node_shares, r[2+i]);
+    node_share_offsets[n+1] = (int)node_shares->size;
+    reply_offsets[p] += 2 + r[1];
+  }
+  polymec_free(reply);
+  polymec_free(reply_offsets);
+
+  // Each of our elements that touches a node shared with another process 
+  // is a ghost element on that process. We send each such process the 
+  // global index, block, and nodes of each of these elements, along with the 
+  // global index, owner, and position of each of their nodes.
+  int_array_t** elem_sends = int_arrays_new(nprocs);
+  int* proc_marks = polymec_malloc(sizeof(int) * nprocs);
+  for (int p = 0; p < nprocs; ++p)
+    proc_marks[p] = -1;
+  for (int e = 0; e < num_elem; ++e)
+  {
+    int num_elem_nodes;
+    const int* elem_nodes = fe_mesh_element_nodes(m, e, &num_elem_nodes);
+    for (int i = 0; i < num_elem_nodes; ++i)
+    {
+      int n = elem_nodes[i];
+      for (int j = node_share_offsets[n]; j < node_share_offsets[n+1]; ++j)
+      {
+        int p = node_shares->data[j];
+        if (proc_marks[p] != e)
+        {
+          proc_marks[p] = e;
+          int_array_append(elem_sends[p], e);
+        }
+      }
+    }
+  }
+  polymec_free(proc_marks);
+  polymec_free(node_share_offsets);
+  int_array_free(node_shares);
+
+  int_array_t** node_bufs = int_arrays_new(nprocs);
+  real_array_t** coord_bufs = polymec_malloc(sizeof(real_array_t*) * nprocs);
+  int* node_marks = polymec_malloc(sizeof(int) * num_nodes);
+  for (int n = 0; n < num_nodes; ++n)
+    node_marks[n] = -1;
+  for (int p = 0; p < nprocs; ++p)
+  {
+    int_array_clear(bufs[p]);
+    coord_bufs[p] = real_array_new();
+    for (int i = 0; i < elem_sends[p]->size; ++i)
+    {
+      int e = elem_sends[p]->data[i];
+      int b = find_element_block(m, e);
+      int num_elem_nodes;
+      const int* elem_nodes = fe_mesh_element_nodes(m, e, &num_elem_nodes);
+      int_array_append(bufs[p], elem_global_ids[e]);
+      int_array_append(bufs[p], b);
+      int_array_append(bufs[p], num_elem_nodes);
+      for (int j = 0; j < num_elem_nodes; ++j)
+      {
+        int n = elem_nodes[j];
+        int_array_append(bufs[p], node_global_ids[n]);
+        if (node_marks[n] != p)
+        {
+          node_marks[n] = p;
+          int_array_append(node_bufs[p], node_global_ids[n]);
+          int_array_append(node_bufs[p], node_owners[n]);
+          real_array_append(coord_bufs[p], m->node_coords[n].x);
+          real_array_append(coord_bufs[p], m->node_coords[n].y);
+          real_array_append(coord_bufs[p], m->node_coords[n].z);
+        }
+      }
+    }
+  }
+  polymec_free(node_marks);
+  int *ghost_offsets, *ghost_node_offsets, *ghost_coord_offsets;
+  int* ghost_data = exchange_int_arrays(comm, bufs, &ghost_offsets);
+  int* ghost_node_data = exchange_int_arrays(comm, node_bufs, &ghost_node_offsets);
+  real_t* ghost_coords = exchange_real_arrays(comm, coord_bufs, &ghost_coord_offsets);
+  int_arrays_free(node_bufs, nprocs);
+  for (int p = 0; p < nprocs; ++p)
+    real_array_free(coord_bufs[p]);
+  polymec_free(coord_bufs);
+
+  // Our element halo sends the elements above.
+  halo_t* elem_halo = polymec_malloc(sizeof(halo_t));
+  elem_halo->send_indices = concat_int_arrays(nprocs, elem_sends, &elem_halo->send_offsets);
+  int_arrays_free(elem_sends, nprocs);
+
+  // Our ghost elements are grouped by block in the order in which they 
+  // arrive. Figure out where each one goes.
+  int_array_t* ghost_positions = int_array_new(); // position in ghost_data
+  int_array_t* ghost_block_indices = int_array_new(); // index within block
+  int* ghost_block_offsets = polymec_malloc(sizeof(int) * (num_blocks+1));
+  memset(ghost_block_offsets, 0, sizeof(int) * (num_blocks+1));
+  elem_halo->recv_offsets = polymec_malloc(sizeof(int) * (nprocs+1));
+  elem_halo->recv_offsets[0] = 0;
+  for (int p = 0; p < nprocs; ++p)
+  {
+    int i = ghost_offsets[p];
+    while (i < ghost_offsets[p+1])
+    {
+      int b = ghost_data[i+1];
+      int_array_append(ghost_positions, i);
+      int_array_append(ghost_block_indices, ghost_block_offsets[b+1]);
+      ++ghost_block_offsets[b+1];
+      i += 3 + ghost_data[i+2];
+    }
+    elem_halo->recv_offsets[p+1] = (int)ghost_positions->size;
+  }
+  for (int b = 0; b < num_blocks; ++b)
+    ghost_block_offsets[b+1] += ghost_block_offsets[b];
+  int num_ghosts = ghost_block_offsets[num_blocks];
+  elem_halo->recv_indices = polymec_malloc(sizeof(int) * num_ghosts);
+  int* ghost_indices = polymec_malloc(sizeof(int) * num_ghosts);
+  for (int g = 0; g < num_ghosts; ++g)
+  {
+    int b = ghost_data[ghost_positions->data[g]+1];
+    ghost_indices[g] = ghost_block_offsets[b] + ghost_block_indices->data[g];
+    elem_halo->recv_indices[g] = num_elem + ghost_indices[g];
+  }
+  int_array_free(ghost_block_indices);
+
+  // Gather our nodes and any new ones introduced by ghost elements.
+  int num_received_nodes = ghost_node_offsets[nprocs] / 2;
+  int max_num_nodes = num_nodes + num_received_nodes;
+  int* all_node_ids = polymec_malloc(sizeof(int) * max_num_nodes);
+  int* all_node_owners = polymec_malloc(sizeof(int) * max_num_nodes);
+  point_t* all_node_coords = polymec_malloc(sizeof(point_t) * max_num_nodes);
+  int_int_unordered_map_t* node_map = int_int_unordered_map_new();
+  for (int n = 0; n < num_nodes; ++n)
+  {
+    all_node_ids[n] = node_global_ids[n];
+    all_node_owners[n] = node_owners[n];
+    all_node_coords[n] = m->node_coords[n];
+    int_int_unordered_map_insert(node_map, node_global_ids[n], n);
+  }
+  polymec_free(node_owners);
+  int num_all_nodes = num_nodes;
+  for (int i = 0; i < num_received_nodes; ++i)
+  {
+    int id = ghost_node_data[2*i];
+    if (int_int_unordered_map_get(node_map, id) == NULL)
+    {
+      int n = num_all_nodes++;
+      all_node_ids[n] = id;
+      all_node_owners[n] = ghost_node_data[2*i+1];
+      all_node_coords[n].x = ghost_coords[3*i];
+      all_node_coords[n].y = ghost_coords[3*i+1];
+      all_node_coords[n].z = ghost_coords[3*i+2];
+      int_int_unordered_map_insert(node_map, id, n);
+    }
+  }
+  polymec_free(ghost_node_data);
+  polymec_free(ghost_node_offsets);
+  polymec_free(ghost_coords);
+  polymec_free(ghost_coord_offsets);
+
+  // Number our owned nodes first (in their original order), followed by 
+  // ghost nodes in order of global index.
+  int* node_index = polymec_malloc(sizeof(int) * num_all_nodes);
+  int num_owned_nodes = 0;
+  for (int n = 0; n < num_nodes; ++n)
+  {
+    if (all_node_owners[n] == rank)
+      node_index[n] = num_owned_nodes++;
+  }
+  int num_ghost_nodes = num_all_nodes - num_owned_nodes;
+  int* ghost_nodes = polymec_malloc(sizeof(int) * 2 * num_ghost_nodes);
+  for (int n = 0, g = 0; n < num_all_nodes; ++n)
   {
-    // We have 5 significant nodes. Craft the faces for this element.
-    int base_face_nodes[4] = {elem_nodes[0], elem_nodes[1], elem_nodes[2], elem_nodes[3]};
-    int side_face_nodes[4][3] = {{elem_nodes[0], elem_nodes[1], elem_nodes[4]},
-                                 {elem_nodes[1], elem_nodes[2], elem_nodes[4]},
-                                 {elem_nodes[2], elem_nodes[3], elem_nodes[4]},
-                                 {elem_nodes[3], elem_nodes[0], elem_nodes[4]}};
-    // Base face.
+    if (all_node_owners[n] != rank)
     {
-      // Get the index of the face.
-      int face_index = map_nodes_to_face(node_face_map, base_face_nodes, 4,
-                                         face_node_offsets, face_nodes);
+      ghost_nodes[2*g] = all_node_ids[n];
+      ghost_nodes[2*g+1] = n;
+      ++g;
+    }
+  }
+  qsort(ghost_nodes, num_ghost_nodes, 2*sizeof(int), int_pair_cmp);
+  for (int g = 0; g < num_ghost_nodes; ++g)
+    node_index[ghost_nodes[2*g+1]] = num_owned_nodes + g;
+
+  // Ask the owners of our ghost nodes for them. Our node halo receives them 
+  // in the order requested.
+  halo_t* node_halo = polymec_malloc(sizeof(halo_t));
+  int_array_t** recv_nodes = int_arrays_new(nprocs);
+  for (int p = 0; p < nprocs; ++p)
+    int_array_clear(bufs[p]);
+  for (int g = 0; g < num_ghost_nodes; ++g)
+  {
+    int n = ghost_nodes[2*g+1];
+    int_array_append(bufs[all_node_owners[n]], all_node_ids[n]);
+    int_array_append(recv_nodes[all_node_owners[n]], num_owned_nodes + g);
+  }
+  polymec_free(ghost_nodes);
+  node_halo->recv_indices = concat_int_arrays(nprocs, recv_nodes, &node_halo->recv_offsets);
+  int_arrays_free(recv_nodes, nprocs);
+  int* requests = exchange_int_arrays(comm, bufs, &node_halo->send_offsets);
+  int num_requests = node_halo->send_offsets[nprocs];
+  node_halo->send_indices = polymec_malloc(sizeof(int) * num_requests);
+  for (int i = 0; i < num_requests; ++i)
+  {
+    int n = node_index[*int_int_unordered_map_get(node_map, requests[i])];
+    ASSERT(n < num_owned_nodes);
+    node_halo->send_indices[i] = n;
+  }
+  polymec_free(requests);
+  int_arrays_free(bufs, nprocs);
+
+  // Now assemble the distributed mesh.
+  fe_mesh_t* dmesh = fe_mesh_new(comm, num_all_nodes);
+  dmesh->num_owned_nodes = num_owned_nodes;
+  dmesh->node_global_ids = polymec_malloc(sizeof(int) * num_all_nodes);
+  for (int n = 0; n < num_all_nodes; ++n)
+  {
+    dmesh->node_coords[node_index[n]] = all_node_coords[n];
+    dmesh->node_global_ids[node_index[n]] = all_node_ids[n];
+  }
+  polymec_free(all_node_ids);
+  polymec_free(all_node_owners);
+  polymec_free(all_node_coords);
 
-      // Record the cell->face connectivity.
-      cell_faces[0] = face_index;
+  // Owned elements.
+  for (int b = 0; b < num_blocks; ++b)
+  {
+    fe_block_t* block = m->blocks->data[b];
+    int n = block->num_elem;
+    int* elem_node_offsets = polymec_malloc(sizeof(int) * (n+1));
+    memcpy(elem_node_offsets, block->elem_node_offsets, sizeof(int) * (n+1));
+    int* elem_nodes = polymec_malloc(sizeof(int) * elem_node_offsets[n]);
+    for (int i = 0; i < elem_node_offsets[n]; ++i)
+      elem_nodes[i] = node_index[block->elem_nodes[i]];
+    fe_mesh_add_block(dmesh, m->block_names->data[b], 
+                      fe_block_from_node_connectivity(n, block->elem_type, 
+                                                      elem_node_offsets, elem_nodes));
+  }
+
+  // Ghost elements.
+  dmesh->elem_global_ids = polymec_malloc(sizeof(int) * (num_elem + num_ghosts));
+  memcpy(dmesh->elem_global_ids, elem_global_ids, sizeof(int) * num_elem);
+  int* ghost_elem_node_offsets = polymec_malloc(sizeof(int) * (num_ghosts + 1));
+  ghost_elem_node_offsets[0] = 0;
+  for (int g = 0; g < num_ghosts; ++g)
+  {
+    int i = ghost_positions->data[g];
+    dmesh->elem_global_ids[num_elem + ghost_indices[g]] = ghost_data[i];
+    ghost_elem_node_offsets[ghost_indices[g]+1] = ghost_data[i+2];
+  }
+  for (int g = 0; g < num_ghosts; ++g)
+    ghost_elem_node_offsets[g+1] += ghost_elem_node_offsets[g];
+  for (int b = 0; b < num_blocks; ++b)
+  {
+    int first = ghost_block_offsets[b], n = ghost_block_offsets[b+1] - first;
+    int* elem_node_offsets = polymec_malloc(sizeof(int) * (n+1));
+    for (int i = 0; i <= n; ++i)
+      elem_node_offsets[i] = ghost_elem_node_offsets[first+i] - ghost_elem_node_offsets[first];
+    int* elem_nodes = polymec_malloc(sizeof(int) * elem_node_offsets[n]);
+    fe_block_t* block = m->blocks->data[b];
+    ptr_array_append_with_dtor(dmesh->ghost_blocks, 
+                               fe_block_from_node_connectivity(n, block->elem_type, 
+                                                               elem_node_offsets, elem_nodes),
+                               DTOR(fe_block_free));
+    int_array_append(dmesh->ghost_block_elem_offsets, ghost_block_offsets[b+1]);
+  }
+  for (int g = 0; g < num_ghosts; ++g)
+  {
+    int i = ghost_positions->data[g];
+    int b = ghost_data[i+1], num_elem_nodes = ghost_data[i+2];
+    fe_block_t* block = dmesh->ghost_blocks->data[b];
+    int* elem_nodes = &block->elem_nodes[ghost_elem_node_offsets[ghost_indices[g]] - ghost_elem_node_offsets[ghost_block_offsets[b]]];
+    for (int j = 0; j < num_elem_nodes; ++j)
+      elem_nodes[j] = node_index[*int_int_unordered_map_get(node_map, ghost_data[i+3+j])];
+  }
+  polymec_free(ghost_elem_node_offsets);
+  polymec_free(ghost_indices);
+  polymec_free(ghost_block_offsets);
+  int_array_free(ghost_positions);
+  polymec_free(ghost_data);
+  polymec_free(ghost_offsets);
+  int_int_unordered_map_free(node_map);
+
+  // Halos.
+  dmesh->elem_halo = elem_halo;
+  dmesh->node_halo = node_halo;
+
+  // Sets. Element and side sets refer only to owned elements, whose indices 
+  // haven't changed.
+  copy_sets(m->elem_sets, dmesh->elem_sets, NULL);
+  copy_sets(m->face_sets, dmesh->face_sets, NULL);
+  copy_sets(m->edge_sets, dmesh->edge_sets, NULL);
+  copy_sets(m->node_sets, dmesh->node_sets, node_index);
+  copy_sets(m->side_sets, dmesh->side_sets, NULL);
+
+  // Identifiers of owned elements and of nodes we already had carry over, 
+  // and those of ghosts come from their owners. Every process must have 
+  // them for them to be exchanged.
+  int have_ids[2] = {(m->elem_ids != NULL) ? 1 : 0, (m->node_ids != NULL) ? 1 : 0};
+  MPI_Allreduce(MPI_IN_PLACE, have_ids, 2, MPI_INT, MPI_MIN, comm);
+  if (have_ids[0] != 0)
+  {
+    dmesh->elem_ids = polymec_malloc(sizeof(int) * (num_elem + num_ghosts + 1));
+    memcpy(dmesh->elem_ids, m->elem_ids, sizeof(int) * num_elem);
+    exchanger_exchange(fe_mesh_element_exchanger(dmesh), dmesh->elem_ids, 1, 0, MPI_INT);
+  }
+  if (have_ids[1] != 0)
+  {
+    dmesh->node_ids = polymec_malloc(sizeof(int) * (num_all_nodes + 1));
+    for (int n = 0; n < num_nodes; ++n)
+      dmesh->node_ids[node_index[n]] = m->node_ids[n];
+    exchanger_exchange(fe_mesh_node_exchanger(dmesh), dmesh->node_ids, 1, 0, MPI_INT);
+  }
+  polymec_free(node_index);
+
+  fe_mesh_free(m);
+  *mesh = dmesh;
+}
+
+// Extracts the elements of the global mesh that are assigned to a process 
+// (given in elems, in increasing order), along with the nodes and sets they 
+// reference, into a new mesh with local numbering. elem_map and node_map 
+// are work arrays, sized to the global mesh's elements and nodes and filled 
+// with -1. The global indices of the mesh's elements and nodes are stored 
+// in elem_global_ids and node_global_ids.
+static fe_mesh_t* fe_submesh(fe_mesh_t* global_mesh,
+                             int num_elems,
+                             int* elems,
+                             int* elem_map,
+                             int* node_map,
+                             int** elem_global_ids,
+                             int** node_global_ids)
+{
+  // Gather the nodes we need, numbering them in order of global index.
+  int_array_t* nodes = int_array_new();
+  for (int i = 0; i < num_elems; ++i)
+  {
+    int num_elem_nodes;
+    const int* elem_nodes = fe_mesh_element_nodes(global_mesh, elems[i], &num_elem_nodes);
+    for (int j = 0; j < num_elem_nodes; ++j)
+    {
+      if (node_map[elem_nodes[j]] == -1)
+      {
+        node_map[elem_nodes[j]] = 0;
+        int_array_append(nodes, elem_nodes[j]);
+      }
     }
+  }
+  int_qsort(nodes->data, nodes->size);
+  int num_nodes = (int)nodes->size;
+  for (int n = 0; n < num_nodes; ++n)
+    node_map[nodes->data[n]] = n;
+
+  fe_mesh_t* mesh = fe_mesh_new(global_mesh->comm, num_nodes);
+  for (int n = 0; n < num_nodes; ++n)
+    mesh->node_coords[n] = global_mesh->node_coords[nodes->data[n]];
+  if (global_mesh->node_ids != NULL)
+  {
+    mesh->node_ids = polymec_malloc(sizeof(int) * (num_nodes + 1));
+    for (int n = 0; n < num_nodes; ++n)
+      mesh->node_ids[n] = global_mesh->node_ids[nodes->data[n]];
+  }
+  if (global_mesh->elem_ids != NULL)
+  {
+    mesh->elem_ids = polymec_malloc(sizeof(int) * (num_elems + 1));
+    for (int e = 0; e < num_elems; ++e)
+      mesh->elem_ids[e] = global_mesh->elem_ids[elems[e]];
+  }
 
-    // Side faces.
-    for (int f = 0; f < 4; ++f)
+  // Every block appears in the submesh, even if it's empty.
+  int pos = 0, first_elem, end_elem, i = 0;
+  fe_block_t* block;
+  while (fe_mesh_next_block_range(global_mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    int first = i;
+    while ((i < num_elems) && (elems[i] < end_elem))
+    {
+      elem_map[elems[i]] = i;
+      ++i;
+    }
+    int n = i - first;
+    int* elem_node_offsets = polymec_malloc(sizeof(int) * (n+1));
+    elem_node_offsets[0] = 0;
+    for (int e = 0; e < n; ++e)
+    {
+      int be = elems[first+e] - first_elem;
+      elem_node_offsets[e+1] = elem_node_offsets[e] + 
+        block->elem_node_offsets[be+1] - block->elem_node_offsets[be];
+    }
+    int* elem_nodes = polymec_malloc(sizeof(int) * elem_node_offsets[n]);
+    for (int e = 0; e < n; ++e)
     {
-      // Get the index of the face.
-      int face_index = map_nodes_to_face(node_face_map, side_face_nodes[f], 3,
-                                         face_node_offsets, face_nodes);
+      int be = elems[first+e] - first_elem;
+      int offset = block->elem_node_offsets[be];
+      for (int j = 0; j < elem_node_offsets[e+1] - elem_node_offsets[e]; ++j)
+        elem_nodes[elem_node_offsets[e]+j] = node_map[block->elem_nodes[offset+j]];
+    }
+    fe_mesh_add_block(mesh, global_mesh->block_names->data[pos-1], 
+                      fe_block_from_node_connectivity(n, block->elem_type, 
+                                                      elem_node_offsets, elem_nodes));
+  }
 
-      // Record the cell->face connectivity.
-      cell_faces[1+f] = face_index;
+  // Element, node, and side sets (restricted to this submesh).
+  int_array_t* subset = int_array_new();
+  int *set;
+  size_t set_size;
+  char* set_name;
+  pos = 0;
+  while (fe_mesh_next_element_set(global_mesh, &pos, &set_name, &set, &set_size))
+  {
+    int_array_clear(subset);
+    for (size_t j = 0; j < set_size; ++j)
+    {
+      if (elem_map[set[j]] != -1)
+        int_array_append(subset, elem_map[set[j]]);
     }
+    int* subset_data = tagger_create_tag(mesh->elem_sets, set_name, subset->size);
+    memcpy(subset_data, subset->data, sizeof(int) * subset->size);
   }
-  else if (elem_type == FE_WEDGE)
+  pos = 0;
+  while (fe_mesh_next_node_set(global_mesh, &pos, &set_name, &set, &set_size))
   {
-    // We have 6 significant nodes. Craft the faces for this element.
-    int base_face_nodes[2][3] = {{elem_nodes[0], elem_nodes[1], elem_nodes[2]},
-                                 {elem_nodes[3], elem_nodes[4], elem_nodes[5]}};
-    int side_face_nodes[3][4] = {{elem_nodes[0], elem_nodes[1], elem_nodes[4], elem_nodes[3]},
-                                 {elem_nodes[1], elem_nodes[2], elem_nodes[5], elem_nodes[4]},
-                                 {elem_nodes[2], elem_nodes[0], elem_nodes[3], elem_nodes[5]}};
-    // Base faces.
-    for (int f = 0; f < 2; ++f)
+    int_array_clear(subset);
+    for (size_t j = 0; j < set_size; ++j)
     {
-      // Get the index of the face.
-      int face_index = map_nodes_to_face(node_face_map, base_face_nodes[f], 3,
-                                         face_node_offsets, face_nodes);
+      if (node_map[set[j]] != -1)
+        int_array_append(subset, node_map[set[j]]);
+    }
+    int* subset_data = tagger_create_tag(mesh->node_sets, set_name, subset->size);
+    memcpy(subset_data, subset->data, sizeof(int) * subset->size);
+  }
+  pos = 0;
+  while (fe_mesh_next_side_set(global_mesh, &pos, &set_name, &set, &set_size))
+  {
+    int_array_clear(subset);
+    for (size_t j = 0; j < set_size/2; ++j)
+    {
+      if (elem_map[set[2*j]] != -1)
+      {
+        int_array_append(subset, elem_map[set[2*j]]);
+        int_array_append(subset, set[2*j+1]);
+      }
+    }
+    int* subset_data = tagger_create_tag(mesh->side_sets, set_name, subset->size);
+    memcpy(subset_data, subset->data, sizeof(int) * subset->size);
+  }
+  int_array_free(subset);
+
+  // Record global indices and reset our work arrays.
+  *elem_global_ids = polymec_malloc(sizeof(int) * num_elems);
+  memcpy(*elem_global_ids, elems, sizeof(int) * num_elems);
+  for (int e = 0; e < num_elems; ++e)
+    elem_map[elems[e]] = -1;
+  *node_global_ids = nodes->data;
+  for (int n = 0; n < num_nodes; ++n)
+    node_map[nodes->data[n]] = -1;
+  int_array_release_data_and_free(nodes);
+
+  return mesh;
+}
 
-      // Record the cell->face connectivity.
-      cell_faces[f] = face_index;
+void partition_fe_mesh(fe_mesh_t** mesh, MPI_Comm comm, int* partition)
+{
+  int rank, nprocs;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nprocs);
+  ASSERT((rank != 0) || (*mesh != NULL));
+  ASSERT((rank == 0) || (*mesh == NULL));
+
+  fe_mesh_t* local_mesh = NULL;
+  int* elem_global_ids = NULL;
+  int* node_global_ids = NULL;
+  if (rank == 0)
+  {
+    fe_mesh_t* global_mesh = *mesh;
+    int num_elems = fe_mesh_num_elements(global_mesh);
+
+    // Sort the elements by process.
+    int* proc_offsets = polymec_malloc(sizeof(int) * (nprocs+1));
+    memset(proc_offsets, 0, sizeof(int) * (nprocs+1));
+    int* elem_procs = polymec_malloc(sizeof(int) * num_elems);
+    for (int e = 0; e < num_elems; ++e)
+    {
+      elem_procs[e] = (partition != NULL) ? partition[e] 
+                                          : (int)(((size_t)e * nprocs) / num_elems);
+      ASSERT((elem_procs[e] >= 0) && (elem_procs[e] < nprocs));
+      ++proc_offsets[elem_procs[e]+1];
     }
+    for (int p = 0; p < nprocs; ++p)
+      proc_offsets[p+1] += proc_offsets[p];
+    int* proc_elems = polymec_malloc(sizeof(int) * num_elems);
+    int* proc_counts = polymec_malloc(sizeof(int) * nprocs);
+    memset(proc_counts, 0, sizeof(int) * nprocs);
+    for (int e = 0; e < num_elems; ++e)
+    {
+      int p = elem_procs[e];
+      proc_elems[proc_offsets[p] + proc_counts[p]++] = e;
+    }
+    polymec_free(proc_counts);
+    polymec_free(elem_procs);
+
+    // Extract and send each process its portion of the mesh.
+    int* elem_map = polymec_malloc(sizeof(int) * num_elems);
+    for (int e = 0; e < num_elems; ++e)
+      elem_map[e] = -1;
+    int* node_map = polymec_malloc(sizeof(int) * global_mesh->num_nodes);
+    for (int n = 0; n < global_mesh->num_nodes; ++n)
+      node_map[n] = -1;
+    for (int p = 0; p < nprocs; ++p)
+    {
+      int *p_elem_ids, *p_node_ids;
+      fe_mesh_t* p_mesh = fe_submesh(global_mesh, 
+                                     proc_offsets[p+1] - proc_offsets[p], 
+                                     &proc_elems[proc_offsets[p]], 
+                                     elem_map, node_map,
+                                     &p_elem_ids, &p_node_ids);
+      if (p == 0)
+      {
+        local_mesh = p_mesh;
+        elem_global_ids = p_elem_ids;
+        node_global_ids = p_node_ids;
+      }
+      else
+      {
+        byte_array_t* bytes = byte_array_new();
+        size_t offset = 0;
+        fe_mesh_byte_write(p_mesh, bytes, &offset);
+        byte_array_write_ints(bytes, fe_mesh_num_elements(p_mesh), p_elem_ids, &offset);
+        byte_array_write_ints(bytes, p_mesh->num_nodes, p_node_ids, &offset);
+        uint64_t size = (uint64_t)offset;
+        MPI_Send(&size, 1, MPI_UINT64_T, p, 0, comm);
+        MPI_Send(bytes->data, (int)size, MPI_BYTE, p, 0, comm);
+        byte_array_free(bytes);
+        polymec_free(p_elem_ids);
+        polymec_free(p_node_ids);
+        fe_mesh_free(p_mesh);
+      }
+    }
+    polymec_free(elem_map);
+    polymec_free(node_map);
+    polymec_free(proc_elems);
+    polymec_free(proc_offsets);
+    fe_mesh_free(global_mesh);
+  }
+  else
+  {
+    uint64_t size;
+    MPI_Recv(&size, 1, MPI_UINT64_T, 0, 0, comm, MPI_STATUS_IGNORE);
+    byte_array_t* bytes = byte_array_new();
+    byte_array_resize(bytes, (size_t)size);
+    MPI_Recv(bytes->data, (int)size, MPI_BYTE, 0, 0, comm, MPI_STATUS_IGNORE);
+    size_t offset = 0;
+    local_mesh = fe_mesh_byte_read(bytes, &offset);
+    elem_global_ids = polymec_malloc(sizeof(int) * fe_mesh_num_elements(local_mesh));
+    byte_array_read_ints(bytes, fe_mesh_num_elements(local_mesh), elem_global_ids, &offset);
+    node_global_ids = polymec_malloc(sizeof(int) * local_mesh->num_nodes);
+    byte_array_read_ints(bytes, local_mesh->num_nodes, node_global_ids, &offset);
+    byte_array_free(bytes);
+  }
+  local_mesh->comm = comm;
+
+  // Now construct ghost elements and nodes.
+  fe_mesh_add_ghosts(&local_mesh, elem_global_ids, node_global_ids);
+  polymec_free(elem_global_ids);
+  polymec_free(node_global_ids);
+  *mesh = local_mesh;
+}
+
+//------------------------------------------------------------------------
+//              Finite Element -> Finite Volume Mesh Translation
+//------------------------------------------------------------------------
 
-    // Side faces.
-    for (int f = 0; f < 3; ++f)
+// Given a leading value in offsets[0] and counts in offsets[1..n], replaces 
+// each offsets[i] with the sum of offsets[0..i]. Each thread sums a 
+// contiguous chunk, so the results don't depend on the number of threads.
+static void accumulate_offsets(int* offsets, int n)
+{
+  int* chunk_sums = polymec_malloc(sizeof(int) * (omp_get_max_threads() + 1));
+  OMP_PRAGMA(omp parallel)
+  {
+    int t = omp_get_thread_num(), nt = omp_get_num_threads();
+    int begin = 1 + (int)(((size_t)n * t) / nt);
+    int end = 1 + (int)(((size_t)n * (t+1)) / nt);
+    int sum = 0;
+    for (int i = begin; i < end; ++i)
     {
-      // Get the index of the face.
-      int face_index = map_nodes_to_face(node_face_map, side_face_nodes[f], 4,
-                                         face_node_offsets, face_nodes);
+      sum += offsets[i];
+      offsets[i] = sum;
+    }
+    chunk_sums[t+1] = sum;
+    OMP_PRAGMA(omp barrier)
 
-      // Record the cell->face connectivity.
-      cell_faces[2+f] = face_index;
+    OMP_PRAGMA(omp single)
+    {
+      chunk_sums[0] = offsets[0];
+      for (int tt = 1; tt <= nt; ++tt)
+        chunk_sums[tt] += chunk_sums[tt-1];
     }
+
+    for (int i = begin; i < end; ++i)
+      offsets[i] += chunk_sums[t];
+  }
+  polymec_free(chunk_sums);
+}
+
+// Copies size bytes from src to dest, dividing the work among threads.
+static void copy_data(void* dest, const void* src, size_t size)
+{
+  OMP_PRAGMA(omp parallel)
+  {
+    int t = omp_get_thread_num(), nt = omp_get_num_threads();
+    size_t begin = (size * t) / nt, end = (size * (t+1)) / nt;
+    memcpy((char*)dest + begin, (const char*)src + begin, end - begin);
   }
+}
+
+// Non-polyhedral face construction information. Each element type lists the 
+// (corner) nodes of each of its faces in terms of node indices local to the 
+// element.
+typedef struct 
+{
+  int num_faces;
+  int num_face_nodes[6];
+  int face_nodes[6][4];
+} elem_face_info_t;
+
+static const elem_face_info_t tet_face_info = 
+  {4, {3, 3, 3, 3}, {{0, 1, 2}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3}}};
+
+static const elem_face_info_t pyramid_face_info = 
+  {5, {4, 3, 3, 3, 3}, {{0, 1, 2, 3},                          // base
+                        {0, 1, 4}, {1, 2, 4}, {2, 3, 4}, {3, 0, 4}}}; // sides
+
+static const elem_face_info_t wedge_face_info = 
+  {5, {3, 3, 4, 4, 4}, {{0, 1, 2}, {3, 4, 5},                    // bases
+                        {0, 1, 4, 3}, {1, 2, 5, 4}, {2, 0, 3, 5}}}; // sides
+
+static const elem_face_info_t hex_face_info = 
+  {6, {4, 4, 4, 4, 4, 4}, {{0, 1, 2, 3},  // -z
+                           {4, 5, 6, 7},  // +z
+                           {0, 1, 5, 4},  // -x
+                           {2, 3, 7, 6},  // +x
+                           {1, 2, 6, 5},  // -y
+                           {3, 0, 4, 7}}}; // +y
+
+static const elem_face_info_t* get_elem_face_info(fe_mesh_element_t elem_type)
+{
+  ASSERT(elem_type != FE_INVALID);
+  ASSERT(elem_type != FE_POLYHEDRON);
+  if (elem_type == FE_TETRAHEDRON)
+    return &tet_face_info;
+  else if (elem_type == FE_PYRAMID)
+    return &pyramid_face_info;
+  else if (elem_type == FE_WEDGE)
+    return &wedge_face_info;
   else 
   {
     ASSERT(elem_type == FE_HEXAHEDRON);
+    return &hex_face_info;
+  }
+}
+
+static int get_num_cell_faces(fe_mesh_element_t elem_type)
+{
+  return get_elem_face_info(elem_type)->num_faces;
+}
+
+int fe_element_num_faces(fe_mesh_element_t elem_type)
+{
+  return get_num_cell_faces(elem_type);
+}
+
+int fe_element_get_face_nodes(fe_mesh_element_t elem_type,
+                              int face,
+                              const int* elem_nodes,
+                              int* face_nodes)
+{
+  const elem_face_info_t* info = get_elem_face_info(elem_type);
+  ASSERT(face >= 0);
+  ASSERT(face < info->num_faces);
+  int num_face_nodes = info->num_face_nodes[face];
+  for (int n = 0; n < num_face_nodes; ++n)
+    face_nodes[n] = elem_nodes[info->face_nodes[face][n]];
+  return num_face_nodes;
+}
+
+#if 0
+// Returns true if t1 and t2 are the same size and contain the same numbers 
+// (regardless of order). Specific to 3- and 4-tuples.
+static bool tuples_are_equivalent(int* t1, int* t2)
+{
+  int l1 = int_tuple_length(t1);
+  ASSERT((l1 == 3) || (l1 == 4));
+  if (l1 == int_tuple_length(t2))
+  {
+    if (l1 == 3)
+    {
+      return (((t1[0] == t2[0]) || (t1[0] == t2[1]) || (t1[0] == t2[2])) &&
+              ((t1[1] == t2[0]) || (t1[1] == t2[1]) || (t1[1] == t2[2])) &&
+              ((t1[2] == t2[0]) || (t1[2] == t2[1]) || (t1[2] == t2[2])));
+    }
+    else
+    {
+      return (((t1[0] == t2[0]) || (t1[0] == t2[1]) || (t1[0] == t2[2]) || (t1[0] == t2[3])) &&
+              ((t1[1] == t2[0]) || (t1[1] == t2[1]) || (t1[1] == t2[2]) || (t1[1] == t2[3])) &&
+              ((t1[2] == t2[0]) || (t1[2] == t2[1]) || (t1[2] == t2[2]) || (t1[2] == t2[3])) &&
+              ((t1[3] == t2[0]) || (t1[3] == t2[1]) || (t1[3] == t2[2]) || (t1[3] == t2[3])));
+    }
+  }
+  else
+    return false;
+}
+#endif
+
+// A face key identifies an element face by its sorted node indices, padded 
+// to 4 entries, along with the index of the element face (its position in 
+// the cell->face connectivity array).
+typedef struct 
+{
+  int nodes[4];
+  int elem_face;
+} face_key_t;
+
+static inline void sort_swap(int* a, int* b)
+{
+  int lo = (*a < *b) ? *a : *b;
+  int hi = (*a < *b) ? *b : *a;
+  *a = lo;
+  *b = hi;
+}
+
+static inline void make_face_key(const elem_face_info_t* info, 
+                                 int face, 
+                                 const int* elem_nodes, 
+                                 int pad,
+                                 int elem_face,
+                                 face_key_t* key)
+{
+  const int* f_nodes = info->face_nodes[face];
+  int* k = key->nodes;
+  k[0] = elem_nodes[f_nodes[0]];
+  k[1] = elem_nodes[f_nodes[1]];
+  k[2] = elem_nodes[f_nodes[2]];
+  k[3] = (info->num_face_nodes[face] == 4) ? elem_nodes[f_nodes[3]] : pad;
+
+  // Sort the 4 entries with a sorting network. Padding sorts to the end, 
+  // since pad exceeds all node indices.
+  sort_swap(&k[0], &k[1]);
+  sort_swap(&k[2], &k[3]);
+  sort_swap(&k[0], &k[2]);
+  sort_swap(&k[1], &k[3]);
+  sort_swap(&k[1], &k[2]);
+
+  key->elem_face = elem_face;
+}
+
+static inline bool face_keys_equal(const face_key_t* k1, const face_key_t* k2)
+{
+  return ((k1->nodes[0] == k2->nodes[0]) && (k1->nodes[1] == k2->nodes[1]) &&
+          (k1->nodes[2] == k2->nodes[2]) && (k1->nodes[3] == k2->nodes[3]));
+}
+
+#define FACE_KEY_RADIX_BITS 11
+#define FACE_KEY_RADIX (1 << FACE_KEY_RADIX_BITS)
+
+// Sorts the given face keys by their nodes using a least-significant-digit 
+// radix sort. All node indices must lie in [0, max_node]. The sort is stable, 
+// so keys with identical nodes retain their original relative order. work 
+// must be able to hold num_keys keys.
+static void sort_face_keys(face_key_t* keys, 
+                           int num_keys, 
+                           int max_node, 
+                           face_key_t* work)
+{
+  if (num_keys == 0)
+    return;
+
+  // We only need enough digits to cover [0, max_node].
+  int num_bits = 1;
+  while ((num_bits < 31) && ((max_node >> num_bits) > 0)) 
+    ++num_bits;
+  int num_digits = (num_bits + FACE_KEY_RADIX_BITS - 1) / FACE_KEY_RADIX_BITS;
+
+  // Each thread counts digits within its own contiguous range of keys.
+  int max_num_threads = omp_get_max_threads();
+  int* counts = polymec_malloc(sizeof(int) * FACE_KEY_RADIX * max_num_threads);
+  face_key_t* src = keys;
+  face_key_t* dest = work;
+  for (int n = 3; n >= 0; --n)
+  {
+    for (int d = 0; d < num_digits; ++d)
+    {
+      int shift = d * FACE_KEY_RADIX_BITS;
+      bool skip_pass = false;
+      OMP_PRAGMA(omp parallel)
+      {
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        int begin = (int)(((size_t)num_keys * t) / nt);
+        int end = (int)(((size_t)num_keys * (t+1)) / nt);
+        int* thread_counts = &counts[FACE_KEY_RADIX * t];
+        memset(thread_counts, 0, sizeof(int) * FACE_KEY_RADIX);
+        for (int i = begin; i < end; ++i)
+          ++thread_counts[(src[i].nodes[n] >> shift) & (FACE_KEY_RADIX-1)];
+        OMP_PRAGMA(omp barrier)
+
+        OMP_PRAGMA(omp single)
+        {
+          // If every key has the same digit, this pass is a no-op.
+          int r0 = (src[0].nodes[n] >> shift) & (FACE_KEY_RADIX-1);
+          int count = 0;
+          for (int tt = 0; tt < nt; ++tt)
+            count += counts[FACE_KEY_RADIX * tt + r0];
+          skip_pass = (count == num_keys);
+
+          // Each thread places its keys after those of preceding threads 
+          // with the same digit, which keeps the sort stable.
+          int offset = 0;
+          for (int r = 0; r < FACE_KEY_RADIX; ++r)
+          {
+            for (int tt = 0; tt < nt; ++tt)
+            {
+              int c = counts[FACE_KEY_RADIX * tt + r];
+              counts[FACE_KEY_RADIX * tt + r] = offset;
+              offset += c;
+            }
+          }
+        }
+
+        if (!skip_pass)
+        {
+          for (int i = begin; i < end; ++i)
+            dest[thread_counts[(src[i].nodes[n] >> shift) & (FACE_KEY_RADIX-1)]++] = src[i];
+        }
+      }
+
+      if (!skip_pass)
+      {
+        face_key_t* tmp = src;
+        src = dest;
+        dest = tmp;
+      }
+    }
+  }
+  polymec_free(counts);
+
+  if (src != keys)
+    copy_data(keys, src, sizeof(face_key_t) * num_keys);
+}
+
+// Identifies the faces of the (non-polyhedral) elements in the given mesh, 
+// filling in cell_faces (sized by cell_face_offsets) and allocating and 
+// filling face->node and face->cell connectivity. Element faces sharing the 
+// same nodes are found by radix-sorting a flat array of face keys and 
+// detecting runs of identical keys. Faces are numbered in the order in which 
+// they are first encountered, and take their node ordering from that first 
+// encounter. Returns the number of faces.
+static int find_cell_faces(fe_mesh_t* fe_mesh,
+                           const int* cell_face_offsets,
+                           int* cell_faces,
+                           int** face_node_offsets,
+                           int** face_nodes,
+                           int** face_cells)
+{
+  int num_cells = fe_mesh_num_elements(fe_mesh);
+  int num_owned_faces = cell_face_offsets[num_cells];
+  int pad = fe_mesh_num_nodes(fe_mesh);
+
+  // Faces of ghost elements get keys after those of owned elements, so that 
+  // faces shared with ghosts are identified along with the others. 
+  int num_ghost_blocks = (int)fe_mesh->ghost_blocks->size;
+  int* ghost_face_offsets = polymec_malloc(sizeof(int) * (num_ghost_blocks+1));
+  ghost_face_offsets[0] = num_owned_faces;
+  for (int b = 0; b < num_ghost_blocks; ++b)
+  {
+    fe_block_t* block = fe_mesh->ghost_blocks->data[b];
+    int num_faces = get_num_cell_faces(fe_block_element_type(block));
+    ghost_face_offsets[b+1] = ghost_face_offsets[b] + 
+                              fe_block_num_elements(block) * num_faces;
+  }
+  int num_elem_faces = ghost_face_offsets[num_ghost_blocks];
 
-    // We have 8 significant nodes. Craft the faces for this element.
-    int face_node_indices[8][6] = {{elem_nodes[0], elem_nodes[1], elem_nodes[2], elem_nodes[3]}, // -z
-                                   {elem_nodes[4], elem_nodes[5], elem_nodes[6], elem_nodes[7]}, // +z
-                                   {elem_nodes[0], elem_nodes[1], elem_nodes[5], elem_nodes[4]}, // -x
-                                   {elem_nodes[2], elem_nodes[3], elem_nodes[7], elem_nodes[6]}, // +x
-                                   {elem_nodes[1], elem_nodes[2], elem_nodes[6], elem_nodes[5]}, // -y
-                                   {elem_nodes[3], elem_nodes[0], elem_nodes[4], elem_nodes[7]}}; // +y
-    for (int f = 0; f < 6; ++f)
+  // Generate a key for each element face.
+  face_key_t* keys = polymec_malloc(sizeof(face_key_t) * num_elem_faces);
+  int pos = 0, first_elem, end_elem;
+  fe_block_t* block;
+  while (fe_mesh_next_block_range(fe_mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    const elem_face_info_t* info = get_elem_face_info(fe_block_element_type(block));
+    const int *elem_node_offsets, *elem_nodes;
+    fe_block_get_node_connectivity(block, &elem_node_offsets, &elem_nodes);
+    OMP_PRAGMA(omp parallel for)
+    for (int e = first_elem; e < end_elem; ++e)
+    {
+      const int* nodes = &elem_nodes[elem_node_offsets[e-first_elem]];
+      int offset = cell_face_offsets[e];
+      for (int f = 0; f < info->num_faces; ++f)
+        make_face_key(info, f, nodes, pad, offset+f, &keys[offset+f]);
+    }
+  }
+  // Ghost element indices follow those of owned elements, so they're also 
+  // the indices of the corresponding ghost cells.
+  int* ghost_face_cells = polymec_malloc(sizeof(int) * (num_elem_faces - num_owned_faces));
+  pos = 0;
+  while (fe_mesh_next_ghost_block_range(fe_mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    const elem_face_info_t* info = get_elem_face_info(fe_block_element_type(block));
+    const int *elem_node_offsets, *elem_nodes;
+    fe_block_get_node_connectivity(block, &elem_node_offsets, &elem_nodes);
+    int block_offset = ghost_face_offsets[pos-1];
+    OMP_PRAGMA(omp parallel for)
+    for (int e = first_elem; e < end_elem; ++e)
+    {
+      const int* nodes = &elem_nodes[elem_node_offsets[e-first_elem]];
+      int offset = block_offset + (e-first_elem) * info->num_faces;
+      for (int f = 0; f < info->num_faces; ++f)
+      {
+        make_face_key(info, f, nodes, pad, offset+f, &keys[offset+f]);
+        ghost_face_cells[offset+f-num_owned_faces] = e;
+      }
+    }
+  }
+  polymec_free(ghost_face_offsets);
+
+  // Sort the keys so that instances of the same face are adjacent.
+  face_key_t* work = polymec_malloc(sizeof(face_key_t) * num_elem_faces);
+  sort_face_keys(keys, num_elem_faces, pad, work);
+  polymec_free(work);
+
+  // Each run of identical keys is a face. Since the sort is stable, the first 
+  // key in a run is the face's first encounter, and the last key is its last 
+  // encounter. For now, we point every element face at the first encounter 
+  // of its face, and record the last encounter for each first encounter.
+  // Runs that begin with a ghost element face belong only to ghosts, and 
+  // are skipped.
+  int* last_encounter = polymec_malloc(sizeof(int) * num_owned_faces);
+  OMP_PRAGMA(omp parallel for)
+  for (int i = 0; i < num_elem_faces; ++i)
+  {
+    if (keys[i].elem_face >= num_owned_faces)
+      continue;
+    int first = i;
+    while ((first > 0) && face_keys_equal(&keys[first], &keys[first-1]))
+      --first;
+    int first_encounter = keys[first].elem_face;
+    cell_faces[keys[i].elem_face] = first_encounter;
+    if (first == i)
+    {
+      int last = i;
+      while ((last < num_elem_faces-1) && face_keys_equal(&keys[last+1], &keys[last]))
+        ++last;
+      last_encounter[first_encounter] = (last > i) ? keys[last].elem_face : -1;
+    }
+  }
+  polymec_free(keys);
+
+  // Faces are numbered in order of first encounter, so the index of a face 
+  // is the number of first encounters that precede it.
+  int* face_index = polymec_malloc(sizeof(int) * (num_owned_faces+1));
+  face_index[0] = 0;
+  OMP_PRAGMA(omp parallel for)
+  for (int i = 0; i < num_owned_faces; ++i)
+    face_index[i+1] = (cell_faces[i] == i) ? 1 : 0;
+  accumulate_offsets(face_index, num_owned_faces);
+  int num_faces = face_index[num_owned_faces];
+
+  // Count up the nodes for each face and set up face->cell connectivity. 
+  // A face's first cell is the one that first encounters it, and its second 
+  // is the one that last encounters it (if any), which may be a ghost.
+  *face_node_offsets = polymec_malloc(sizeof(int) * (num_faces+1));
+  *face_cells = polymec_malloc(sizeof(int) * 2 * num_faces);
+  int* fn_offsets = *face_node_offsets;
+  int* fc = *face_cells;
+  fn_offsets[0] = 0;
+  pos = 0;
+  while (fe_mesh_next_block_range(fe_mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    const elem_face_info_t* info = get_elem_face_info(fe_block_element_type(block));
+    OMP_PRAGMA(omp parallel for)
+    for (int e = first_elem; e < end_elem; ++e)
     {
-      // Get the index of the face.
-      int face_index = map_nodes_to_face(node_face_map, face_node_indices[f], 4,
-                                         face_node_offsets, face_nodes);
+      int offset = cell_face_offsets[e];
+      for (int f = 0; f < info->num_faces; ++f)
+      {
+        int i = offset + f;
+        if (cell_faces[i] == i)
+        {
+          int face = face_index[i];
+          fn_offsets[face+1] = info->num_face_nodes[f];
+          fc[2*face] = e;
+          if (last_encounter[i] == -1)
+            fc[2*face+1] = -1;
+          else if (last_encounter[i] >= num_owned_faces)
+            fc[2*face+1] = ghost_face_cells[last_encounter[i]-num_owned_faces];
+        }
+        else if (last_encounter[cell_faces[i]] == i)
+          fc[2*face_index[cell_faces[i]]+1] = e;
+      }
+    }
+  }
+  polymec_free(last_encounter);
+  polymec_free(ghost_face_cells);
+  accumulate_offsets(fn_offsets, num_faces);
 
-      // Record the cell->face connectivity.
-      cell_faces[f] = face_index;
+  // Record face->node connectivity from the first encounter of each face.
+  *face_nodes = polymec_malloc(sizeof(int) * fn_offsets[num_faces]);
+  int* fn = *face_nodes;
+  pos = 0;
+  while (fe_mesh_next_block_range(fe_mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    const elem_face_info_t* info = get_elem_face_info(fe_block_element_type(block));
+    const int *elem_node_offsets, *elem_nodes;
+    fe_block_get_node_connectivity(block, &elem_node_offsets, &elem_nodes);
+    OMP_PRAGMA(omp parallel for)
+    for (int e = first_elem; e < end_elem; ++e)
+    {
+      const int* nodes = &elem_nodes[elem_node_offsets[e-first_elem]];
+      int offset = cell_face_offsets[e];
+      for (int f = 0; f < info->num_faces; ++f)
+      {
+        int i = offset + f;
+        if (cell_faces[i] == i)
+        {
+          int face = face_index[i];
+          for (int n = 0; n < info->num_face_nodes[f]; ++n)
+            fn[fn_offsets[face]+n] = nodes[info->face_nodes[f][n]];
+        }
+      }
     }
   }
+
+  // Finally, point each element face at its face.
+  OMP_PRAGMA(omp parallel for)
+  for (int i = 0; i < num_owned_faces; ++i)
+    cell_faces[i] = face_index[cell_faces[i]];
+  polymec_free(face_index);
+
+  return num_faces;
 }
 
 mesh_t* mesh_from_fe_mesh(fe_mesh_t* fe_mesh)
@@ -793,81 +2611,53 @@ mesh_t* mesh_from_fe_mesh(fe_mesh_t* fe_mesh)
   int* cell_faces = NULL;
   int* face_node_offsets = NULL;
   int* face_nodes = NULL;
+  int* face_cells = NULL;
   if (num_faces == 0)
   {
     // Traverse the element blocks and figure out the number of faces per cell.
-    int pos = 0, elem_offset = 0;
-    char* block_name;
+    int pos = 0, first_elem, end_elem;
     fe_block_t* block;
-    while (fe_mesh_next_block(fe_mesh, &pos, &block_name, &block))
+    while (fe_mesh_next_block_range(fe_mesh, &pos, &block, &first_elem, &end_elem))
     {
-      int num_block_elem = fe_block_num_elements(block);
       fe_mesh_element_t elem_type = fe_block_element_type(block);
       int num_elem_faces = get_num_cell_faces(elem_type);
-      for (int i = 0; i < num_block_elem; ++i)
-        cell_face_offsets[elem_offset+i+1] = cell_face_offsets[elem_offset+i] + num_elem_faces;
-      elem_offset += num_block_elem;
+      int block_offset = cell_face_offsets[first_elem];
+      OMP_PRAGMA(omp parallel for)
+      for (int e = first_elem; e < end_elem; ++e)
+        cell_face_offsets[e+1] = block_offset + (e+1-first_elem) * num_elem_faces;
     }
 
-    // Now assemble the faces for each cell.
-    int_tuple_int_unordered_map_t* node_face_map = int_tuple_int_unordered_map_new();
+    // Now identify the faces of each cell.
     cell_faces = polymec_malloc(sizeof(int) * cell_face_offsets[num_cells]);
-
-    // We build the face->node connectivity data on-the-fly.
-    int_array_t* face_node_offsets_array = int_array_new();
-    int_array_append(face_node_offsets_array, 0);
-    int_array_t* face_nodes_array = int_array_new();
-
-    pos = 0, elem_offset = 0;
-    while (fe_mesh_next_block(fe_mesh, &pos, &block_name, &block))
-    {
-      int num_block_elem = fe_block_num_elements(block);
-      fe_mesh_element_t elem_type = fe_block_element_type(block);
-      int num_elem_nodes = fe_block_num_element_nodes(block, 0);
-      int elem_nodes[num_elem_nodes];
-      for (int i = 0; i < num_block_elem; ++i)
-      {
-        fe_block_get_element_nodes(block, i, elem_nodes);
-        int offset = cell_face_offsets[elem_offset+i];
-        get_cell_faces(elem_type, elem_nodes, node_face_map, 
-                       &cell_faces[offset], face_node_offsets_array,
-                       face_nodes_array);
-      }
-      elem_offset += num_block_elem;
-    }
-
-    // Record the total number of faces and discard the map.
-    num_faces = node_face_map->size;
-    int_tuple_int_unordered_map_free(node_face_map);
-
-    // Gift the contents of the arrays to our pointers.
-    face_node_offsets = face_node_offsets_array->data;
-    int_array_release_data_and_free(face_node_offsets_array);
-    face_nodes = face_nodes_array->data;
-    int_array_release_data_and_free(face_nodes_array);
+    num_faces = find_cell_faces(fe_mesh, cell_face_offsets, cell_faces, 
+                                &face_node_offsets, &face_nodes, &face_cells);
   }
   else
   {
     // Fill in these arrays block by block.
-    int pos = 0;
-    char* block_name;
+    int pos = 0, first_elem, end_elem;
     fe_block_t* block;
-    int block_cell_offset = 0;
-    while (fe_mesh_next_block(fe_mesh, &pos, &block_name, &block))
+    while (fe_mesh_next_block_range(fe_mesh, &pos, &block, &first_elem, &end_elem))
     {
-      int num_block_elem = fe_block_num_elements(block);
-      for (int i = 0; i < num_block_elem; ++i)
-        cell_face_offsets[block_cell_offset+i] = cell_face_offsets[block_cell_offset+i-1] + block->elem_face_offsets[i];
-      block_cell_offset += num_block_elem;
+      const int *elem_face_offsets, *elem_faces;
+      fe_block_get_face_connectivity(block, &elem_face_offsets, &elem_faces);
+      OMP_PRAGMA(omp parallel for)
+      for (int e = first_elem; e < end_elem; ++e)
+      {
+        int i = e - first_elem;
+        cell_face_offsets[e+1] = elem_face_offsets[i+1] - elem_face_offsets[i];
+      }
     }
+    accumulate_offsets(cell_face_offsets, num_cells);
 
     cell_faces = polymec_malloc(sizeof(int) * cell_face_offsets[num_cells]);
-    pos = 0, block_cell_offset = 0;
-    while (fe_mesh_next_block(fe_mesh, &pos, &block_name, &block))
+    pos = 0;
+    while (fe_mesh_next_block_range(fe_mesh, &pos, &block, &first_elem, &end_elem))
     {
-      int num_block_elem = fe_block_num_elements(block);
-      memcpy(&cell_faces[cell_face_offsets[block_cell_offset]], block->elem_faces, sizeof(int) * block->elem_face_offsets[num_block_elem]);
-      block_cell_offset += num_block_elem;
+      const int *elem_face_offsets, *elem_faces;
+      fe_block_get_face_connectivity(block, &elem_face_offsets, &elem_faces);
+      copy_data(&cell_faces[cell_face_offsets[first_elem]], elem_faces, 
+                sizeof(int) * elem_face_offsets[end_elem-first_elem]);
     }
 
     // We just borrow these from the mesh. Theeenks!
@@ -880,7 +2670,7 @@ mesh_t* mesh_from_fe_mesh(fe_mesh_t* fe_mesh)
 
   // Create the finite volume mesh and set up its cell->face and face->node 
   // connectivity.
-  int num_ghost_cells = 0; // FIXME!
+  int num_ghost_cells = fe_mesh_num_ghost_elements(fe_mesh);
   mesh_t* mesh = mesh_new(fe_mesh_comm(fe_mesh), 
                           num_cells, num_ghost_cells, 
                           num_faces,
@@ -888,19 +2678,28 @@ mesh_t* mesh_from_fe_mesh(fe_mesh_t* fe_mesh)
   memcpy(mesh->cell_face_offsets, cell_face_offsets, sizeof(int) * (mesh->num_cells+1));
   memcpy(mesh->face_node_offsets, face_node_offsets, sizeof(int) * (mesh->num_faces+1));
   mesh_reserve_connectivity_storage(mesh);
-  memcpy(mesh->cell_faces, cell_faces, sizeof(int) * (mesh->cell_face_offsets[mesh->num_cells]));
-  memcpy(mesh->face_nodes, face_nodes, sizeof(int) * (mesh->face_node_offsets[mesh->num_faces]));
+  copy_data(mesh->cell_faces, cell_faces, sizeof(int) * (mesh->cell_face_offsets[mesh->num_cells]));
+  copy_data(mesh->face_nodes, face_nodes, sizeof(int) * (mesh->face_node_offsets[mesh->num_faces]));
 
-  // Set up face->cell connectivity.
-  for (int c = 0; c < mesh->num_cells; ++c)
+  // Set up face->cell connectivity. If we identified the faces ourselves, 
+  // we already have it.
+  if (face_cells != NULL)
   {
-    for (int f = mesh->cell_face_offsets[c]; f < mesh->cell_face_offsets[c+1]; ++f)
+    copy_data(mesh->face_cells, face_cells, sizeof(int) * 2 * mesh->num_faces);
+    polymec_free(face_cells);
+  }
+  else
+  {
+    for (int c = 0; c < mesh->num_cells; ++c)
     {
-      int face = mesh->cell_faces[f];
-      if (mesh->face_cells[2*face] == -1)
-        mesh->face_cells[2*face] = c;
-      else
-        mesh->face_cells[2*face+1] = c;
+      for (int f = mesh->cell_face_offsets[c]; f < mesh->cell_face_offsets[c+1]; ++f)
+      {
+        int face = mesh->cell_faces[f];
+        if (mesh->face_cells[2*face] == -1)
+          mesh->face_cells[2*face] = c;
+        else
+          mesh->face_cells[2*face+1] = c;
+      }
     }
   }
 
@@ -923,6 +2722,11 @@ mesh_t* mesh_from_fe_mesh(fe_mesh_t* fe_mesh)
   // Calculate geometry.
   mesh_compute_geometry(mesh);
 
+  // Ghost cells in a distributed mesh are ghost elements, so they're 
+  // exchanged the same way.
+  if (fe_mesh->elem_halo != NULL)
+    mesh_set_exchanger(mesh, halo_exchanger(fe_mesh->elem_halo, fe_mesh->comm));
+
   // Sets -> tags.
   int pos = 0, *set;
   size_t set_size;
@@ -930,25 +2734,25 @@ mesh_t* mesh_from_fe_mesh(fe_mesh_t* fe_mesh)
   while (fe_mesh_next_element_set(fe_mesh, &pos, &set_name, &set, &set_size))
   {
     int* tag = mesh_create_tag(mesh->cell_tags, set_name, set_size);
-    memcpy(tag, set, sizeof(int) * set_size);
+    copy_data(tag, set, sizeof(int) * set_size);
   }
   pos = 0;
   while (fe_mesh_next_face_set(fe_mesh, &pos, &set_name, &set, &set_size))
   {
     int* tag = mesh_create_tag(mesh->face_tags, set_name, set_size);
-    memcpy(tag, set, sizeof(int) * set_size);
+    copy_data(tag, set, sizeof(int) * set_size);
   }
   pos = 0;
   while (fe_mesh_next_edge_set(fe_mesh, &pos, &set_name, &set, &set_size))
   {
     int* tag = mesh_create_tag(mesh->edge_tags, set_name, set_size);
-    memcpy(tag, set, sizeof(int) * set_size);
+    copy_data(tag, set, sizeof(int) * set_size);
   }
   pos = 0;
   while (fe_mesh_next_node_set(fe_mesh, &pos, &set_name, &set, &set_size))
   {
     int* tag = mesh_create_tag(mesh->node_tags, set_name, set_size);
-    memcpy(tag, set, sizeof(int) * set_size);
+    copy_data(tag, set, sizeof(int) * set_size);
   }
 
   // Clean up.
@@ -23,6 +23,19 @@ typedef enum
   FE_POLYHEDRON
 } fe_mesh_element_t;
 
+// Returns the number of faces of a (non-polyhedral) element of the given 
+// type.
+int fe_element_num_faces(fe_mesh_element_t elem_type);
+
+// Fills face_nodes with the nodes of the given face of a (non-polyhedral) 
+// element of the given type whose nodes are elem_nodes, returning the number 
+// of nodes in the face (3 or 4). Element faces are numbered and oriented the 
+// same way they are in mesh_from_fe_mesh.
+int fe_element_get_face_nodes(fe_mesh_element_t elem_type,
+                              int face,
+                              const int* elem_nodes,
+                              int* face_nodes);
+
 // This type represents a block of finite elements consisting of a single 
 // given type. Element blocks can be used to construct or edit finite element 
 // meshes. Note that elements are numbered from 0 to N-1 within an N-element 
@@ -33,12 +46,23 @@ typedef struct fe_block_t fe_block_t;
 // Constructs a new finite element block of the given non-polyhedral type 
 // by specifying the nodes that make up each element. elem_node_indices 
 // is an array that lists the node indices for each element, in order. The 
-// number of nodes per element is defined by the element type.
+// number of nodes per element is defined by the element type. A block may 
+// be empty (num_elem == 0), as it can be on some processes in a distributed 
+// mesh.
 fe_block_t* fe_block_new(int num_elem,
                          fe_mesh_element_t type,
                          int num_elem_nodes,
                          int* elem_node_indices);
 
+// Constructs a new finite element block of the given non-polyhedral type 
+// like fe_block_new, but takes ownership of elem_node_indices (allocated 
+// with polymec_malloc) instead of copying it, so that large blocks can be 
+// read straight into place.
+fe_block_t* fe_block_from_node_indices(int num_elem,
+                                       fe_mesh_element_t type,
+                                       int num_elem_nodes,
+                                       int* elem_node_indices);
+
 // Constructs a new finite element block of polyhedra
 // by specifying the faces that make up each element, their types, and the
 // indices of the nodes for each face. num_elem_faces is an array defining the 
@@ -86,6 +110,38 @@ void fe_block_get_element_faces(fe_block_t* block,
                                 int elem_index, 
                                 int* elem_faces);
 
+// Returns an internal (read-only) pointer to the indices of nodes for the 
+// given element within the block, storing the number of nodes in 
+// *num_elem_nodes. If the block does not contain element->node connectivity, 
+// NULL is returned and *num_elem_nodes is set to -1.
+const int* fe_block_element_nodes(fe_block_t* block, 
+                                  int elem_index,
+                                  int* num_elem_nodes);
+
+// Returns an internal (read-only) pointer to the indices of faces for the 
+// given element within the block, storing the number of faces in 
+// *num_elem_faces. If the block does not contain element->face connectivity, 
+// NULL is returned and *num_elem_faces is set to -1.
+const int* fe_block_element_faces(fe_block_t* block, 
+                                  int elem_index,
+                                  int* num_elem_faces);
+
+// Provides internal (read-only) pointers to the element->node connectivity 
+// of the whole block in compressed row storage: the nodes of element i are 
+// (*elem_nodes)[(*elem_node_offsets)[i]] through 
+// (*elem_nodes)[(*elem_node_offsets)[i+1]-1]. Both pointers are set to NULL 
+// if the block does not contain element->node connectivity.
+void fe_block_get_node_connectivity(fe_block_t* block, 
+                                    const int** elem_node_offsets,
+                                    const int** elem_nodes);
+
+// Provides internal (read-only) pointers to the element->face connectivity 
+// of the whole block in compressed row storage, as above. Both pointers are 
+// set to NULL if the block does not contain element->face connectivity.
+void fe_block_get_face_connectivity(fe_block_t* block, 
+                                    const int** elem_face_offsets,
+                                    const int** elem_faces);
+
 // Returns a serializer object that can read/write finite element blocks 
 // from/to byte arrays.
 serializer_t* fe_block_serializer();
@@ -130,6 +186,23 @@ bool fe_mesh_next_block(fe_mesh_t* mesh,
 // Returns the number of elements in the fe_mesh.
 int fe_mesh_num_elements(fe_mesh_t* mesh);
 
+// Traverses the element blocks in the fe_mesh, providing the range 
+// [*first_elem, *end_elem) of mesh element indices occupied by each block. 
+// Element i of the block has the mesh index *first_elem + i. Use this 
+// instead of per-element queries to traverse all elements in the mesh. 
+// Reset the traversal by setting *pos to 0.
+bool fe_mesh_next_block_range(fe_mesh_t* mesh, 
+                              int* pos, 
+                              fe_block_t** block, 
+                              int* first_elem,
+                              int* end_elem);
+
+// Returns the block containing the element with the given (mesh) index, 
+// storing the index of the element within that block in *block_elem_index.
+fe_block_t* fe_mesh_element_block(fe_mesh_t* mesh, 
+                                  int elem_index, 
+                                  int* block_elem_index);
+
 // Returns the number of nodes in the given element within the mesh. If the 
 // mesh does not contain element->node connectivity, -1 is returned.
 int fe_mesh_num_element_nodes(fe_mesh_t* mesh, int elem_index);
@@ -154,6 +227,22 @@ void fe_mesh_get_element_faces(fe_mesh_t* mesh,
                                int elem_index, 
                                int* elem_faces);
 
+// Returns an internal (read-only) pointer to the indices of nodes for the 
+// given element within the mesh, storing the number of nodes in 
+// *num_elem_nodes. If the mesh does not contain element->node connectivity, 
+// NULL is returned and *num_elem_nodes is set to -1.
+const int* fe_mesh_element_nodes(fe_mesh_t* mesh, 
+                                 int elem_index,
+                                 int* num_elem_nodes);
+
+// Returns an internal (read-only) pointer to the indices of faces for the 
+// given element within the mesh, storing the number of faces in 
+// *num_elem_faces. If the mesh does not contain element->face connectivity, 
+// NULL is returned and *num_elem_faces is set to -1.
+const int* fe_mesh_element_faces(fe_mesh_t* mesh, 
+                                 int elem_index,
+                                 int* num_elem_faces);
+
 // Returns the number of faces in the fe_mesh.
 int fe_mesh_num_faces(fe_mesh_t* mesh);
 
@@ -183,6 +272,38 @@ void fe_mesh_get_face_edges(fe_mesh_t* mesh,
                             int face_index, 
                             int* face_edges);
 
+// Returns an internal (read-only) pointer to the indices of nodes for the 
+// given face within the mesh, storing the number of nodes in *num_face_nodes.
+// If the mesh does not contain face->node connectivity, NULL is returned 
+// and *num_face_nodes is set to -1.
+const int* fe_mesh_face_nodes(fe_mesh_t* mesh, 
+                              int face_index,
+                              int* num_face_nodes);
+
+// Returns an internal (read-only) pointer to the indices of edges for the 
+// given face within the mesh, storing the number of edges in *num_face_edges.
+// If the mesh does not contain face->edge connectivity, NULL is returned 
+// and *num_face_edges is set to -1.
+const int* fe_mesh_face_edges(fe_mesh_t* mesh, 
+                              int face_index,
+                              int* num_face_edges);
+
+// Provides internal (read-only) pointers to the face->node connectivity of 
+// the mesh in compressed row storage: the nodes of face i are 
+// (*face_nodes)[(*face_node_offsets)[i]] through 
+// (*face_nodes)[(*face_node_offsets)[i+1]-1]. Both pointers are set to NULL 
+// if the mesh does not contain face->node connectivity.
+void fe_mesh_get_face_node_connectivity(fe_mesh_t* mesh, 
+                                        const int** face_node_offsets,
+                                        const int** face_nodes);
+
+// Provides internal (read-only) pointers to the face->edge connectivity of 
+// the mesh in compressed row storage, as above. Both pointers are set to 
+// NULL if the mesh does not contain face->edge connectivity.
+void fe_mesh_get_face_edge_connectivity(fe_mesh_t* mesh, 
+                                        const int** face_edge_offsets,
+                                        const int** face_edges);
+
 // Returns the number of edges in the fe_mesh.
 int fe_mesh_num_edges(fe_mesh_t* mesh);
 
@@ -199,6 +320,21 @@ void fe_mesh_get_edge_nodes(fe_mesh_t* mesh,
                             int edge_index, 
                             int* edge_nodes);
 
+// Returns an internal (read-only) pointer to the indices of nodes for the 
+// given edge within the mesh, storing the number of nodes in *num_edge_nodes.
+// If the mesh does not contain edge->node connectivity, NULL is returned 
+// and *num_edge_nodes is set to -1.
+const int* fe_mesh_edge_nodes(fe_mesh_t* mesh, 
+                              int edge_index,
+                              int* num_edge_nodes);
+
+// Provides internal (read-only) pointers to the edge->node connectivity of 
+// the mesh in compressed row storage, as above. Both pointers are set to 
+// NULL if the mesh does not contain edge->node connectivity.
+void fe_mesh_get_edge_node_connectivity(fe_mesh_t* mesh, 
+                                        const int** edge_node_offsets,
+                                        const int** edge_nodes);
+
 // Returns the number of nodes in the fe_mesh.
 int fe_mesh_num_nodes(fe_mesh_t* mesh);
 
@@ -272,11 +408,90 @@ int* fe_mesh_create_side_set(fe_mesh_t* mesh, const char* name, size_t size);
 bool fe_mesh_next_side_set(fe_mesh_t* mesh, int* pos, char** name, int** set, size_t* size);
 
 // Returns a serializer object that can read/write finite element meshes 
-// from/to byte arrays.
+// from/to byte arrays. The (versioned) binary format stores node positions, 
+// named blocks, connectivity, and all entity sets in contiguous arrays. 
+// Meshes read by this serializer are assigned to MPI_COMM_WORLD.
 serializer_t* fe_mesh_serializer();
 
+// Distributes the finite element mesh *mesh (which exists on rank 0 of the 
+// given communicator, and is NULL on all other ranks) to all processes in 
+// comm. partition[e] gives the rank that receives element e of the mesh; 
+// if partition is NULL, elements are assigned to processes in contiguous, 
+// evenly-sized ranges. On return, *mesh holds each process's portion of the 
+// mesh, with ghost elements and nodes added by fe_mesh_add_ghosts. Element, 
+// node, and side sets are distributed with the elements; face and edge sets 
+// are not.
+void partition_fe_mesh(fe_mesh_t** mesh, MPI_Comm comm, int* partition);
+
+// Given a portion *mesh of a distributed finite element mesh and the global 
+// indices of its elements and nodes, replaces *mesh with a copy that 
+// includes ghost elements (elements on other processes that share a node 
+// with this one) and ghost nodes, along with halo exchange plans for 
+// element and node data. Locally-owned nodes are numbered first, followed 
+// by ghost nodes in order of increasing global index. This is a collective 
+// operation on the mesh's communicator, and requires element->node 
+// connectivity for every block.
+void fe_mesh_add_ghosts(fe_mesh_t** mesh, 
+                        int* elem_global_ids, 
+                        int* node_global_ids);
+
+// Returns the number of ghost elements in the fe_mesh. Ghost elements have 
+// mesh indices that follow those of locally-owned elements.
+int fe_mesh_num_ghost_elements(fe_mesh_t* mesh);
+
+// Traverses the blocks of ghost elements in the fe_mesh, providing the 
+// range [*first_elem, *end_elem) of mesh element indices occupied by the 
+// ghosts in each block. Ghost blocks correspond one-to-one with the 
+// element blocks in the mesh. Reset the traversal by setting *pos to 0.
+bool fe_mesh_next_ghost_block_range(fe_mesh_t* mesh, 
+                                    int* pos, 
+                                    fe_block_t** block, 
+                                    int* first_elem,
+                                    int* end_elem);
+
+// Returns the number of nodes in the fe_mesh owned by this process. These 
+// are nodes [0, N) for N owned nodes; the remainder are ghost nodes.
+int fe_mesh_num_owned_nodes(fe_mesh_t* mesh);
+
+// Returns an internal array of the global indices of the (owned and ghost) 
+// elements in the fe_mesh, or NULL if the mesh is not distributed.
+const int* fe_mesh_element_global_ids(fe_mesh_t* mesh);
+
+// Returns an internal array of the global indices of the (owned and ghost) 
+// nodes in the fe_mesh, or NULL if the mesh is not distributed.
+const int* fe_mesh_node_global_ids(fe_mesh_t* mesh);
+
+// Sets identifiers for the (owned and ghost) elements in the fe_mesh, 
+// copying them from the given array. Unlike global indices, identifiers 
+// are arbitrary labels (like the numbers in an Exodus element map) that 
+// stay with elements as the mesh is partitioned and written.
+void fe_mesh_set_element_ids(fe_mesh_t* mesh, const int* ids);
+
+// Returns an internal array of the identifiers of the (owned and ghost) 
+// elements in the fe_mesh, or NULL if they have none.
+const int* fe_mesh_element_ids(fe_mesh_t* mesh);
+
+// Sets identifiers for the (owned and ghost) nodes in the fe_mesh, copying 
+// them from the given array.
+void fe_mesh_set_node_ids(fe_mesh_t* mesh, const int* ids);
+
+// Returns an internal array of the identifiers of the (owned and ghost) 
+// nodes in the fe_mesh, or NULL if they have none.
+const int* fe_mesh_node_ids(fe_mesh_t* mesh);
+
+// Returns an exchanger that fills ghost element data from the processes 
+// that own those elements. The exchanger is created once and reused, and 
+// belongs to the mesh.
+exchanger_t* fe_mesh_element_exchanger(fe_mesh_t* mesh);
+
+// Returns an exchanger that fills ghost node data from the processes that 
+// own those nodes. The exchanger is created once and reused, and belongs 
+// to the mesh.
+exchanger_t* fe_mesh_node_exchanger(fe_mesh_t* mesh);
+
 // This function creates a (finite volume arbitrary polyhedral) mesh from
-// the given finite element mesh. 
+// the given finite element mesh. Ghost elements in a distributed mesh 
+// become ghost cells, and the resulting mesh's exchanger fills them.
 mesh_t* mesh_from_fe_mesh(fe_mesh_t* fe_mesh);
 
 // This function creates a finite element mesh from the given (finite volume 
@@ -70,15 +70,68 @@ static int lua_read_exodus_mesh(lua_State* lua)
 
   // Do our business.
   exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, filename);
-  fe_mesh_t* fe_mesh = exodus_file_read_mesh(file);
+  mesh_t* mesh = exodus_file_read_fv_mesh(file);
   exodus_file_close(file);
-  mesh_t* mesh = mesh_from_fe_mesh(fe_mesh);
-  fe_mesh_free(fe_mesh);
 
   lua_pushmesh(lua, mesh);
   return 1;
 }
 
+// join_exodus_files(args) -- This function joins the files of a decomposed 
+// Exodus database into a single Exodus file.
+static int lua_join_exodus_files(lua_State* lua)
+{
+  // Check the arguments.
+  int num_args = lua_gettop(lua);
+  if ((num_args != 3) || !lua_isstring(lua, 1) || 
+      !lua_isnumber(lua, 2) || !lua_isstring(lua, 3))
+  {
+    return luaL_error(lua, "join_exodus_files: invalid arguments. Usage:\n"
+                      "join_exodus_files(prefix, num_files, filename)");
+  }
+
+  // Get the argument(s).
+  const char* prefix = lua_tostring(lua, 1);
+  int num_files = (int)lua_tointeger(lua, 2);
+  const char* filename = lua_tostring(lua, 3);
+  if (num_files <= 0)
+    return luaL_error(lua, "join_exodus_files: num_files must be positive.");
+
+  // Do our business on rank 0.
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  int success = 1;
+  if (rank == 0)
+    success = exodus_file_join(prefix, num_files, filename) ? 1 : 0;
+  MPI_Bcast(&success, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (!success)
+    return luaL_error(lua, "join_exodus_files: could not read %s.%d.*.", prefix, num_files);
+  return 0;
+}
+
+// split_exodus_file(args) -- This function splits an Exodus file into a 
+// decomposed database with one file per process.
+static int lua_split_exodus_file(lua_State* lua)
+{
+  // Check the arguments.
+  int num_args = lua_gettop(lua);
+  if ((num_args != 2) || !lua_isstring(lua, 1) || !lua_isstring(lua, 2))
+  {
+    return luaL_error(lua, "split_exodus_file: invalid arguments. Usage:\n"
+                      "split_exodus_file(filename, prefix)");
+  }
+
+  // Get the argument(s).
+  const char* filename = lua_tostring(lua, 1);
+  const char* prefix = lua_tostring(lua, 2);
+  if (!file_exists(filename))
+    return luaL_error(lua, "split_exodus_file: file does not exist.");
+
+  // Do our business.
+  exodus_file_split(MPI_COMM_WORLD, filename, prefix);
+  return 0;
+}
+
 #if 0
 int mesh_factory_pebi(lua_State* lua)
 {
@@ -272,5 +325,7 @@ void interpreter_register_polyglot_functions(interpreter_t* interp)
 //  interpreter_register_global_method(interp, "mesh_factory", "pebi", mesh_factory_pebi, NULL);
 //  interpreter_register_global_method(interp, "mesh_factory", "dual", mesh_factory_dual, NULL);
   interpreter_register_function(interp, "read_exodus_mesh", lua_read_exodus_mesh, NULL);
+  interpreter_register_function(interp, "join_exodus_files", lua_join_exodus_files, NULL);
+  interpreter_register_function(interp, "split_exodus_file", lua_split_exodus_file, NULL);
 }
 
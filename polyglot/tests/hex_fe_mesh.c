@@ -0,0 +1,50 @@
+// Copyright (c) 2015-2016, Jeffrey N. Johnson
+// All rights reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "hex_fe_mesh.h"
+
+int hex_fe_mesh_node(int nx, int ny, int i, int j, int k)
+{
+  return (nx+1)*((ny+1)*k + j) + i;
+}
+
+void hex_fe_mesh_get_element_nodes(int nx, int ny, int elem_index, int* elem_nodes)
+{
+  int i = elem_index % nx, j = (elem_index / nx) % ny, k = elem_index / (nx*ny);
+  elem_nodes[0] = hex_fe_mesh_node(nx, ny, i, j, k);
+  elem_nodes[1] = hex_fe_mesh_node(nx, ny, i+1, j, k);
+  elem_nodes[2] = hex_fe_mesh_node(nx, ny, i+1, j+1, k);
+  elem_nodes[3] = hex_fe_mesh_node(nx, ny, i, j+1, k);
+  elem_nodes[4] = hex_fe_mesh_node(nx, ny, i, j, k+1);
+  elem_nodes[5] = hex_fe_mesh_node(nx, ny, i+1, j, k+1);
+  elem_nodes[6] = hex_fe_mesh_node(nx, ny, i+1, j+1, k+1);
+  elem_nodes[7] = hex_fe_mesh_node(nx, ny, i, j+1, k+1);
+}
+
+fe_mesh_t* create_hex_fe_mesh(MPI_Comm comm, int nx, int ny, int nz, int num_lower)
+{
+  int num_elem = nx*ny*nz;
+  ASSERT(num_lower > 0);
+  ASSERT(num_lower < num_elem);
+
+  int num_nodes = (nx+1)*(ny+1)*(nz+1);
+  fe_mesh_t* mesh = fe_mesh_new(comm, num_nodes);
+  point_t* x = fe_mesh_node_positions(mesh);
+  for (int k = 0; k <= nz; ++k)
+    for (int j = 0; j <= ny; ++j)
+      for (int i = 0; i <= nx; ++i)
+        x[hex_fe_mesh_node(nx, ny, i, j, k)] = (point_t){.x = 1.0*i, .y = 1.0*j, .z = 1.0*k};
+
+  int* elem_nodes = polymec_malloc(sizeof(int) * 8 * num_elem);
+  for (int e = 0; e < num_elem; ++e)
+    hex_fe_mesh_get_element_nodes(nx, ny, e, &elem_nodes[8*e]);
+  fe_mesh_add_block(mesh, "lower", fe_block_new(num_lower, FE_HEXAHEDRON, 8, elem_nodes));
+  fe_mesh_add_block(mesh, "upper", fe_block_new(num_elem - num_lower, FE_HEXAHEDRON, 8, 
+                                                &elem_nodes[8*num_lower]));
+  polymec_free(elem_nodes);
+  return mesh;
+}
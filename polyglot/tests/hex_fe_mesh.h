@@ -0,0 +1,29 @@
+// Copyright (c) 2015-2016, Jeffrey N. Johnson
+// All rights reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef POLYGLOT_HEX_FE_MESH_H
+#define POLYGLOT_HEX_FE_MESH_H
+
+#include "polyglot/fe_mesh.h"
+
+// This is a test fixture shared by the finite element mesh tests: an 
+// nx x ny x nz block of unit hexahedra. Node (i, j, k) sits at (i, j, k), 
+// and element (i, j, k) has index nx*(ny*k + j) + i.
+
+// Returns the index of node (i, j, k) in an nx x ny x nz hex mesh.
+int hex_fe_mesh_node(int nx, int ny, int i, int j, int k);
+
+// Fills elem_nodes with the indices of the 8 nodes of the element with the 
+// given index in an nx x ny x nz hex mesh, in Exodus order.
+void hex_fe_mesh_get_element_nodes(int nx, int ny, int elem_index, int* elem_nodes);
+
+// Creates an nx x ny x nz hex mesh on the given communicator. Its first 
+// num_lower elements form the block "lower" and the rest form the block 
+// "upper". The mesh has no sets or identifiers.
+fe_mesh_t* create_hex_fe_mesh(MPI_Comm comm, int nx, int ny, int nz, int num_lower);
+
+#endif
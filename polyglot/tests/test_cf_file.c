@@ -9,7 +9,9 @@
 #include <stddef.h>
 #include <setjmp.h>
 #include <string.h>
+#include <sys/stat.h>
 #include "cmocka.h"
+#include "netcdf.h"
 #include "polyglot/cf_file.h"
 
 static void test_cf_file_open(void** state)
@@ -77,6 +79,381 @@ static void test_cf_file_write(void** state)
   cf_file_close(cf);
 }
 
+static void test_cf_file_write_single_precision(void** state)
+{
+  cf_file_t* cf = cf_file_new("cf_test_write_float.nc");
+  int nlat = 20, nlon = 40, nlev = 5;
+  real_t lat[nlat], lon[nlon], lev[nlev];
+  for (int i = 0; i < nlat; ++i)
+    lat[i] = -90.0 + 180.0*i/(nlat-1);
+  for (int i = 0; i < nlon; ++i)
+    lon[i] = 360.0*i/(nlon-1);
+  for (int i = 0; i < nlev; ++i)
+    lev[i] = 20000.0*i/(nlev-1);
+  cf_file_define_latlon_grid(cf, 
+                             nlat, "degree_north",
+                             nlon, "degree_east",
+                             nlev, "meter", "up");
+  cf_file_define_time(cf, "days since 0000-1-1", "noleap");
+
+  // Temperature and surface pressure are stored in single precision, 
+  // topography at full precision.
+  cf_file_set_single_precision(cf, true);
+  cf_file_define_latlon_var(cf, "ta", true, "ta", "air_temperature", "K");
+  cf_file_define_latlon_surface_var(cf, "ps", true, "ps", "surface_air_pressure", "Pa");
+  cf_file_set_single_precision(cf, false);
+  cf_file_define_latlon_surface_var(cf, "orog", false, "orog", "surface_altitude", "m");
+  cf_file_write_latlon_grid(cf, lat, lon, lev);
+
+  int n3 = nlev*nlat*nlon, n2 = nlat*nlon;
+  real_t* ta = polymec_malloc(sizeof(real_t) * n3);
+  real_t ps[n2], orog[n2];
+  for (int i = 0; i < n2; ++i)
+    orog[i] = 0.1 * i;
+  cf_file_write_latlon_surface_var(cf, "orog", 0, orog);
+  for (int t = 0; t < 2; ++t)
+  {
+    int time_index = cf_file_append_time(cf, 1.0*t);
+    for (int i = 0; i < n3; ++i)
+      ta[i] = 250.0 + 0.1*i + t;
+    for (int i = 0; i < n2; ++i)
+      ps[i] = 1e5 + 0.3*i + t;
+    cf_file_write_latlon_var(cf, "ta", time_index, ta);
+    cf_file_write_latlon_surface_var(cf, "ps", time_index, ps);
+  }
+  cf_file_close(cf);
+
+  // Single-precision data should come back rounded to the nearest float, 
+  // and full-precision data should come back exactly.
+  cf = cf_file_open("cf_test_write_float.nc");
+  assert_int_equal(2, cf_file_num_times(cf));
+  real_t* ta1 = polymec_malloc(sizeof(real_t) * n3);
+  real_t ps1[n2], orog1[n2];
+  cf_file_read_latlon_var(cf, "ta", 1, ta1);
+  for (int i = 0; i < n3; ++i)
+    assert_true(ta1[i] == (real_t)((float)(250.0 + 0.1*i + 1)));
+  cf_file_read_latlon_surface_var(cf, "ps", 1, ps1);
+  for (int i = 0; i < n2; ++i)
+    assert_true(ps1[i] == (real_t)((float)(1e5 + 0.3*i + 1)));
+  cf_file_read_latlon_surface_var(cf, "orog", 0, orog1);
+  for (int i = 0; i < n2; ++i)
+    assert_true(orog1[i] == orog[i]);
+  cf_file_close(cf);
+  polymec_free(ta1);
+  polymec_free(ta);
+}
+
+static void test_cf_file_read_region(void** state)
+{
+  cf_file_t* cf = cf_file_new("cf_test_region.nc");
+  int nlat = 19, nlon = 36, nlev = 4;
+  real_t lat[nlat], lon[nlon], lev[nlev];
+  for (int j = 0; j < nlat; ++j)
+    lat[j] = -90.0 + 10.0*j;
+  for (int i = 0; i < nlon; ++i)
+    lon[i] = 10.0*i;
+  for (int k = 0; k < nlev; ++k)
+    lev[k] = 1000.0*k;
+  cf_file_define_latlon_grid(cf, 
+                             nlat, "degree_north",
+                             nlon, "degree_east",
+                             nlev, "meter", "up");
+  cf_file_define_time(cf, "days since 0000-1-1", "noleap");
+  cf_file_define_latlon_var(cf, "ta", true, "ta", "air_temperature", "K");
+  cf_file_set_single_precision(cf, true);
+  cf_file_define_latlon_surface_var(cf, "ps", true, "ps", "surface_air_pressure", "Pa");
+  cf_file_write_latlon_grid(cf, lat, lon, lev);
+
+  // Each value encodes its level, latitude, and longitude indices.
+  real_t* ta = polymec_malloc(sizeof(real_t) * nlev*nlat*nlon);
+  real_t ps[nlat*nlon];
+  for (int k = 0; k < nlev; ++k)
+    for (int j = 0; j < nlat; ++j)
+      for (int i = 0; i < nlon; ++i)
+        ta[(k*nlat + j)*nlon + i] = 10000.0*k + 100.0*j + i;
+  for (int j = 0; j < nlat; ++j)
+    for (int i = 0; i < nlon; ++i)
+      ps[j*nlon + i] = 100.0*j + i;
+  for (int t = 0; t < 2; ++t)
+  {
+    int time_index = cf_file_append_time(cf, 1.0*t);
+    cf_file_write_latlon_var(cf, "ta", time_index, ta);
+    cf_file_write_latlon_surface_var(cf, "ps", time_index, ps);
+  }
+  cf_file_close(cf);
+  polymec_free(ta);
+
+  cf = cf_file_open("cf_test_region.nc");
+
+  // A box that crosses the dateline.
+  cf_latlon_region_t region;
+  cf_file_find_latlon_region(cf, 20.0, 50.0, 340.0, 30.0, &region);
+  assert_int_equal(0, region.first_level);
+  assert_int_equal(nlev, region.num_levels);
+  assert_int_equal(11, region.first_lat);
+  assert_int_equal(4, region.num_lats);
+  assert_int_equal(34, region.first_lon);
+  assert_int_equal(6, region.num_lons);
+
+  // Read a subset of its levels and every other latitude.
+  region.first_level = 1;
+  region.num_levels = 2;
+  region.lat_stride = 2;
+  region.num_lats = 2;
+  real_t data[2*2*6];
+  cf_file_read_latlon_var_region(cf, "ta", 1, &region, data);
+  for (int k = 0; k < 2; ++k)
+    for (int j = 0; j < 2; ++j)
+      for (int i = 0; i < 6; ++i)
+        assert_true(data[(k*2 + j)*6 + i] == 10000.0*(k+1) + 100.0*(11+2*j) + (34+i) % nlon);
+
+  // Decimated longitudes that wrap around the end of the grid.
+  region.first_lat = 0;
+  region.num_lats = 3;
+  region.lat_stride = 9;
+  region.first_lon = 30;
+  region.num_lons = 5;
+  region.lon_stride = 3;
+  real_t surf_data[3*5];
+  cf_file_read_latlon_surface_var_region(cf, "ps", 0, &region, surf_data);
+  for (int j = 0; j < 3; ++j)
+    for (int i = 0; i < 5; ++i)
+      assert_true(surf_data[j*5 + i] == 100.0*(9*j) + (30+3*i) % nlon);
+
+  // A box that contains the whole globe.
+  cf_file_find_latlon_region(cf, -90.0, 90.0, -180.0, 180.0, &region);
+  assert_int_equal(0, region.first_lat);
+  assert_int_equal(nlat, region.num_lats);
+  assert_int_equal(0, region.first_lon);
+  assert_int_equal(nlon, region.num_lons);
+
+  cf_file_close(cf);
+}
+
+static void test_cf_file_time_series_transfers(void** state)
+{
+  cf_file_t* cf = cf_file_new("cf_test_times.nc");
+  int nlat = 6, nlon = 8, nlev = 3, nt = 5;
+  real_t lat[nlat], lon[nlon], lev[nlev];
+  for (int j = 0; j < nlat; ++j)
+    lat[j] = -75.0 + 30.0*j;
+  for (int i = 0; i < nlon; ++i)
+    lon[i] = 45.0*i;
+  for (int k = 0; k < nlev; ++k)
+    lev[k] = 1000.0*k;
+  cf_file_define_latlon_grid(cf, 
+                             nlat, "degree_north",
+                             nlon, "degree_east",
+                             nlev, "meter", "up");
+  cf_file_define_time(cf, "days since 0000-1-1", "noleap");
+  cf_file_define_latlon_var(cf, "ta", true, "ta", "air_temperature", "K");
+  cf_file_set_single_precision(cf, true);
+  cf_file_define_latlon_surface_var(cf, "ps", true, "ps", "surface_air_pressure", "Pa");
+  cf_file_write_latlon_grid(cf, lat, lon, lev);
+
+  // Append the first time on its own, and the rest all at once.
+  real_t times[nt];
+  for (int t = 0; t < nt; ++t)
+    times[t] = 0.5*t;
+  assert_int_equal(0, cf_file_append_time(cf, times[0]));
+  assert_int_equal(1, cf_file_append_times(cf, nt-1, &times[1]));
+  assert_int_equal(nt, cf_file_num_times(cf));
+
+  int n3 = nlev*nlat*nlon, n2 = nlat*nlon;
+  real_t ta[nt*n3], ps[nt*n2];
+  for (int i = 0; i < nt*n3; ++i)
+    ta[i] = 200.0 + 0.25*i;
+  for (int i = 0; i < nt*n2; ++i)
+    ps[i] = 1e5 + 0.5*i;
+  cf_file_write_latlon_var_times(cf, "ta", 0, nt, ta);
+  cf_file_write_latlon_surface_var_times(cf, "ps", 0, nt, ps);
+  cf_file_close(cf);
+
+  cf = cf_file_open("cf_test_times.nc");
+  assert_int_equal(nt, cf_file_num_times(cf));
+  real_t times1[nt];
+  cf_file_get_times(cf, times1);
+  for (int t = 0; t < nt; ++t)
+    assert_true(times1[t] == times[t]);
+
+  // Bulk reads should agree with the bulk writes, as should single reads.
+  real_t ta1[nt*n3], ps1[nt*n2];
+  cf_file_read_latlon_var_times(cf, "ta", 1, nt-2, ta1);
+  for (int i = 0; i < (nt-2)*n3; ++i)
+    assert_true(ta1[i] == ta[n3 + i]);
+  cf_file_read_latlon_var(cf, "ta", nt-1, ta1);
+  for (int i = 0; i < n3; ++i)
+    assert_true(ta1[i] == ta[(nt-1)*n3 + i]);
+  cf_file_read_latlon_surface_var_times(cf, "ps", 0, nt, ps1);
+  for (int i = 0; i < nt*n2; ++i)
+    assert_true(ps1[i] == ps[i]);
+  cf_file_close(cf);
+}
+
+// Writes a smooth time-dependent temperature field to a CF file with the 
+// given storage policy, returning the size of the file.
+static size_t write_stored_field(const char* filename, 
+                                 cf_storage_policy_t* policy,
+                                 int nlat, int nlon, int nlev, int nt,
+                                 real_t* ta)
+{
+  cf_file_t* cf = cf_file_new(filename);
+  real_t lat[nlat], lon[nlon], lev[nlev];
+  for (int j = 0; j < nlat; ++j)
+    lat[j] = -90.0 + 180.0*j/(nlat-1);
+  for (int i = 0; i < nlon; ++i)
+    lon[i] = 360.0*i/nlon;
+  for (int k = 0; k < nlev; ++k)
+    lev[k] = 1000.0*k;
+  cf_file_define_latlon_grid(cf, 
+                             nlat, "degree_north",
+                             nlon, "degree_east",
+                             nlev, "meter", "up");
+  cf_file_define_time(cf, "days since 0000-1-1", "noleap");
+  cf_file_set_storage_policy(cf, policy);
+  cf_file_define_latlon_var(cf, "ta", true, "ta", "air_temperature", "K");
+  cf_file_define_latlon_surface_var(cf, "orog", false, "orog", "surface_altitude", "m");
+  cf_file_write_latlon_grid(cf, lat, lon, lev);
+  real_t times[nt];
+  for (int t = 0; t < nt; ++t)
+    times[t] = 1.0*t;
+  cf_file_append_times(cf, nt, times);
+  cf_file_write_latlon_var_times(cf, "ta", 0, nt, ta);
+  cf_file_write_latlon_surface_var(cf, "orog", 0, ta);
+  cf_file_close(cf);
+
+  struct stat s;
+  stat(filename, &s);
+  return (size_t)s.st_size;
+}
+
+// Checks that the variable with the given name and number of dimensions in 
+// the given file is stored in the given chunks (if chunks is non-NULL) and 
+// deflated at the given level (0 for none), with shuffling if it's deflated.
+static void check_var_storage(const char* filename, 
+                              const char* var_name,
+                              int num_dims,
+                              size_t* chunks,
+                              int deflate_level)
+{
+  int file_id, var_id;
+  assert_int_equal(NC_NOERR, nc_open(filename, NC_NOWRITE, &file_id));
+  assert_int_equal(NC_NOERR, nc_inq_varid(file_id, var_name, &var_id));
+  if (chunks != NULL)
+  {
+    int storage;
+    size_t var_chunks[4];
+    assert_int_equal(NC_NOERR, nc_inq_var_chunking(file_id, var_id, &storage, var_chunks));
+    assert_int_equal(NC_CHUNKED, storage);
+    for (int d = 0; d < num_dims; ++d)
+      assert_int_equal(chunks[d], var_chunks[d]);
+  }
+  int shuffle, deflate, level;
+  assert_int_equal(NC_NOERR, nc_inq_var_deflate(file_id, var_id, &shuffle, &deflate, &level));
+  assert_int_equal((deflate_level > 0), shuffle);
+  assert_int_equal((deflate_level > 0), deflate);
+  if (deflate_level > 0)
+    assert_int_equal(deflate_level, level);
+  nc_close(file_id);
+}
+
+// Defines (without writing) time-slice-chunked variables on a grid with the 
+// given numbers of points in the file with the given name.
+static void define_sliced_vars(const char* filename, 
+                               int nlat, int nlon, int nlev)
+{
+  cf_file_t* cf = cf_file_new(filename);
+  cf_file_define_latlon_grid(cf, 
+                             nlat, "degree_north",
+                             nlon, "degree_east",
+                             nlev, "meter", "up");
+  cf_file_define_time(cf, "days since 0000-1-1", "noleap");
+  cf_storage_policy_t policy = cf_default_storage_policy();
+  policy.chunking = CF_CHUNK_TIME_SLICE;
+  cf_file_set_storage_policy(cf, &policy);
+  cf_file_define_latlon_var(cf, "ta", true, "ta", "air_temperature", "K");
+  cf_file_define_latlon_surface_var(cf, "orog", false, "orog", "surface_altitude", "m");
+  cf_file_close(cf);
+}
+
+static void test_cf_file_big_time_slices(void** state)
+{
+  // A slice of 4 levels on this grid doesn't fit into a single (4 GiB) 
+  // HDF5 chunk, so its levels are split.
+  size_t max_chunk_values = (((size_t)1 << 32) - 1) / sizeof(real_t);
+  size_t nlat = 8192, nlon = 16384, nlev = 4;
+  define_sliced_vars("cf_test_big_levels.nc", (int)nlat, (int)nlon, (int)nlev);
+  size_t chunk_levels = max_chunk_values / (nlat * nlon);
+  assert_true(chunk_levels < nlev);
+  size_t level_chunks[4] = {1, chunk_levels, nlat, nlon};
+  check_var_storage("cf_test_big_levels.nc", "ta", 4, level_chunks, 0);
+
+  // A single level on this grid doesn't fit either, so its latitudes are 
+  // split too.
+  nlat = 40000; nlon = 20000; nlev = 2;
+  define_sliced_vars("cf_test_big_lats.nc", (int)nlat, (int)nlon, (int)nlev);
+  size_t chunk_lats = max_chunk_values / nlon;
+  assert_true(chunk_lats < nlat);
+  size_t lat_chunks[4] = {1, 1, chunk_lats, nlon};
+  check_var_storage("cf_test_big_lats.nc", "ta", 4, lat_chunks, 0);
+  check_var_storage("cf_test_big_lats.nc", "orog", 2, &lat_chunks[2], 0);
+}
+
+static void test_cf_file_storage_policy(void** state)
+{
+  int nlat = 24, nlon = 48, nlev = 4, nt = 6;
+  int n3 = nlev*nlat*nlon;
+  real_t* ta = polymec_malloc(sizeof(real_t) * nt * n3);
+  for (int t = 0; t < nt; ++t)
+    for (int k = 0; k < nlev; ++k)
+      for (int j = 0; j < nlat; ++j)
+        for (int i = 0; i < nlon; ++i)
+          ta[((t*nlev + k)*nlat + j)*nlon + i] = 250.0 + 10.0*k + 0.5*j + t;
+
+  // Compare the default storage to compressed time series and time slices.
+  cf_storage_policy_t policy = cf_default_storage_policy();
+  size_t default_size = write_stored_field("cf_test_storage_default.nc", &policy, 
+                                           nlat, nlon, nlev, nt, ta);
+  policy.chunking = CF_CHUNK_TIME_SERIES;
+  policy.num_chunk_times = 4;
+  policy.deflate_level = 5;
+  policy.shuffle = true;
+  policy.chunk_cache_size = 1024 * 1024;
+  size_t series_size = write_stored_field("cf_test_storage_series.nc", &policy, 
+                                          nlat, nlon, nlev, nt, ta);
+  assert_true(series_size < default_size);
+  policy.chunking = CF_CHUNK_TIME_SLICE;
+  size_t slice_size = write_stored_field("cf_test_storage_slices.nc", &policy, 
+                                         nlat, nlon, nlev, nt, ta);
+  assert_true(slice_size < default_size);
+
+  // Each preset should produce the chunk shapes it describes, with 
+  // shuffling and compression.
+  size_t series_chunks[2][4] = {{4, 1, (size_t)nlat, 32}, {(size_t)nlat, 32}};
+  size_t slice_chunks[2][4] = {{1, (size_t)nlev, (size_t)nlat, (size_t)nlon}, 
+                               {(size_t)nlat, (size_t)nlon}};
+  check_var_storage("cf_test_storage_series.nc", "ta", 4, series_chunks[0], 5);
+  check_var_storage("cf_test_storage_series.nc", "orog", 2, series_chunks[1], 5);
+  check_var_storage("cf_test_storage_slices.nc", "ta", 4, slice_chunks[0], 5);
+  check_var_storage("cf_test_storage_slices.nc", "orog", 2, slice_chunks[1], 5);
+  check_var_storage("cf_test_storage_default.nc", "ta", 4, NULL, 0);
+
+  // The data should come back intact either way.
+  const char* filenames[2] = {"cf_test_storage_series.nc", "cf_test_storage_slices.nc"};
+  real_t* ta1 = polymec_malloc(sizeof(real_t) * nt * n3);
+  for (int f = 0; f < 2; ++f)
+  {
+    cf_file_t* cf = cf_file_open(filenames[f]);
+    cf_file_set_var_chunk_cache(cf, "ta", 4 * 1024 * 1024);
+    cf_file_read_latlon_var_times(cf, "ta", 0, nt, ta1);
+    for (int i = 0; i < nt*n3; ++i)
+      assert_true(ta1[i] == ta[i]);
+    cf_file_close(cf);
+  }
+  polymec_free(ta1);
+  polymec_free(ta);
+}
+
 int main(int argc, char* argv[]) 
 {
   polymec_init(argc, argv);
@@ -84,7 +461,12 @@ int main(int argc, char* argv[])
   const struct CMUnitTest tests[] = 
   {
     cmocka_unit_test(test_cf_file_open),
-    cmocka_unit_test(test_cf_file_write)
+    cmocka_unit_test(test_cf_file_write),
+    cmocka_unit_test(test_cf_file_write_single_precision),
+    cmocka_unit_test(test_cf_file_read_region),
+    cmocka_unit_test(test_cf_file_time_series_transfers),
+    cmocka_unit_test(test_cf_file_storage_policy),
+    cmocka_unit_test(test_cf_file_big_time_slices)
   };
   return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -0,0 +1,429 @@
+// Copyright (c) 2015-2016, Jeffrey N. Johnson
+// All rights reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include "cmocka.h"
+#include "polyglot/exodus_file.h"
+#include "hex_fe_mesh.h"
+
+// Number of hexahedra in each direction in our test mesh.
+static const int nx = 6, ny = 5, nz = 4;
+
+// Returns the global index of the node at (i, j, k).
+static inline int node_index(int i, int j, int k)
+{
+  return hex_fe_mesh_node(nx, ny, i, j, k);
+}
+
+// Writes our hex mesh to the Exodus file with the given name from rank 0 
+// of MPI_COMM_WORLD. The lower two layers of elements form the block 
+// "lower" and the rest form "upper". The element set "top" holds the 
+// highest layer of elements, the node set "left" holds the nodes at x = 0, 
+// and the side set "bottom" holds the bottoms (side 5) of the lowest layer 
+// of elements. Element and node identifiers differ from their 
+// indices, and the file is titled "Hexahedra".
+static void write_hex_mesh(const char* filename)
+{
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if (rank == 0)
+  {
+    fe_mesh_t* mesh = create_hex_fe_mesh(MPI_COMM_SELF, nx, ny, nz, 2*nx*ny);
+    int* left = fe_mesh_create_node_set(mesh, "left", (ny+1)*(nz+1));
+    for (int k = 0; k <= nz; ++k)
+      for (int j = 0; j <= ny; ++j)
+        left[(ny+1)*k + j] = node_index(0, j, k);
+    int* top = fe_mesh_create_element_set(mesh, "top", nx*ny);
+    for (int e = 0; e < nx*ny; ++e)
+      top[e] = nx*ny*(nz-1) + e;
+    int* bottom = fe_mesh_create_side_set(mesh, "bottom", nx*ny);
+    for (int e = 0; e < nx*ny; ++e)
+    {
+      bottom[2*e] = e;
+      bottom[2*e+1] = 5;
+    }
+
+    int num_elem = nx*ny*nz, num_nodes = (nx+1)*(ny+1)*(nz+1);
+    int elem_ids[num_elem], node_ids[num_nodes];
+    for (int e = 0; e < num_elem; ++e)
+      elem_ids[e] = 1000 + e;
+    for (int n = 0; n < num_nodes; ++n)
+      node_ids[n] = 2*n + 1;
+    fe_mesh_set_element_ids(mesh, elem_ids);
+    fe_mesh_set_node_ids(mesh, node_ids);
+
+    exodus_file_t* file = exodus_file_new(MPI_COMM_SELF, filename);
+    exodus_file_set_title(file, "Hexahedra");
+    exodus_file_write_mesh(file, mesh);
+    exodus_file_close(file);
+    fe_mesh_free(mesh);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+}
+
+// Checks that the given nodes of the element with the given global index
+// are the right ones.
+static void check_element_nodes(int E, const int* elem_nodes, const int* node_gids)
+{
+  int expected[8];
+  hex_fe_mesh_get_element_nodes(nx, ny, E, expected);
+  for (int n = 0; n < 8; ++n)
+  {
+    int N = (node_gids != NULL) ? node_gids[elem_nodes[n]] : elem_nodes[n];
+    assert_int_equal(expected[n], N);
+  }
+}
+
+// Checks the portion of our hex mesh held by this process: the nodes of
+// each (owned or ghost) element and their positions, and sets, and, if
+// check_ids is true, element and node identifiers. Also checks that the
+// portions on all processes together hold the whole mesh and all of its
+// set entries.
+static void check_hex_mesh(fe_mesh_t* mesh, bool check_ids)
+{
+  assert_int_equal(2, fe_mesh_num_blocks(mesh));
+  assert_int_equal(1, fe_mesh_num_element_sets(mesh));
+  assert_int_equal(1, fe_mesh_num_node_sets(mesh));
+  assert_int_equal(1, fe_mesh_num_side_sets(mesh));
+  int num_elem, num_nodes;
+  int my_num_elem = fe_mesh_num_elements(mesh);
+  int my_num_nodes = fe_mesh_num_owned_nodes(mesh);
+  MPI_Allreduce(&my_num_elem, &num_elem, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  MPI_Allreduce(&my_num_nodes, &num_nodes, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  assert_int_equal(nx*ny*nz, num_elem);
+  assert_int_equal((nx+1)*(ny+1)*(nz+1), num_nodes);
+
+  // On a single process, the mesh isn't distributed, and global indices
+  // are mesh indices.
+  const int* elem_gids = fe_mesh_element_global_ids(mesh);
+  const int* node_gids = fe_mesh_node_global_ids(mesh);
+
+  // Nodes sit where they should.
+  point_t* X = fe_mesh_node_positions(mesh);
+  const int* node_ids = fe_mesh_node_ids(mesh);
+  if (check_ids)
+    assert_true(node_ids != NULL);
+  for (int n = 0; n < fe_mesh_num_nodes(mesh); ++n)
+  {
+    int N = (node_gids != NULL) ? node_gids[n] : n;
+    assert_true(X[n].x == 1.0*(N % (nx+1)));
+    assert_true(X[n].y == 1.0*((N / (nx+1)) % (ny+1)));
+    assert_true(X[n].z == 1.0*(N / ((nx+1)*(ny+1))));
+    if (check_ids)
+      assert_int_equal(2*N + 1, node_ids[n]);
+  }
+
+  // Elements are connected to the right nodes, and the element blocks are 
+  // split by layer.
+  const int* elem_ids = fe_mesh_element_ids(mesh);
+  if (check_ids)
+    assert_true(elem_ids != NULL);
+  int pos = 0, first_elem, end_elem;
+  fe_block_t* block;
+  while (fe_mesh_next_block_range(mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    for (int e = first_elem; e < end_elem; ++e)
+    {
+      int E = (elem_gids != NULL) ? elem_gids[e] : e;
+      assert_true((pos == 1) ? (E < 2*nx*ny) : (E >= 2*nx*ny));
+      assert_int_equal(8, fe_block_num_element_nodes(block, e - first_elem));
+      int elem_nodes[8];
+      fe_block_get_element_nodes(block, e - first_elem, elem_nodes);
+      check_element_nodes(E, elem_nodes, node_gids);
+      if (check_ids)
+        assert_int_equal(1000 + E, elem_ids[e]);
+    }
+  }
+
+  // So are ghost elements.
+  pos = 0;
+  while (fe_mesh_next_ghost_block_range(mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    for (int e = first_elem; e < end_elem; ++e)
+    {
+      int E = elem_gids[e];
+      assert_true((pos == 1) ? (E < 2*nx*ny) : (E >= 2*nx*ny));
+      int elem_nodes[8];
+      fe_block_get_element_nodes(block, e - first_elem, elem_nodes);
+      check_element_nodes(E, elem_nodes, node_gids);
+      if (check_ids)
+        assert_int_equal(1000 + E, elem_ids[e]);
+    }
+  }
+
+  // Sets.
+  int num_left = (ny+1)*(nz+1), num_bottom = nx*ny;
+  int found[num_left + num_bottom];
+  memset(found, 0, sizeof(int) * (num_left + num_bottom));
+  int *set;
+  size_t set_size;
+  char* set_name;
+  pos = 0;
+  assert_true(fe_mesh_next_node_set(mesh, &pos, &set_name, &set, &set_size));
+  assert_int_equal(0, strcmp(set_name, "left"));
+  for (size_t i = 0; i < set_size; ++i)
+  {
+    int N = (node_gids != NULL) ? node_gids[set[i]] : set[i];
+    assert_int_equal(0, N % (nx+1));
+    found[N / (nx+1)] = 1;
+  }
+
+  // Every node at x = 0 of an owned element is in the node set, in order.
+  for (int e = 0; e < my_num_elem; ++e)
+  {
+    int elem_nodes[8];
+    fe_mesh_get_element_nodes(mesh, e, elem_nodes);
+    for (int n = 0; n < 8; ++n)
+    {
+      if (X[elem_nodes[n]].x == 0.0)
+      {
+        bool in_set = false;
+        for (size_t i = 0; i < set_size; ++i)
+          in_set = in_set || (set[i] == elem_nodes[n]);
+        assert_true(in_set);
+      }
+    }
+  }
+  for (size_t i = 1; i < set_size; ++i)
+  {
+    int N0 = (node_gids != NULL) ? node_gids[set[i-1]] : set[i-1];
+    int N1 = (node_gids != NULL) ? node_gids[set[i]] : set[i];
+    assert_true(N0 < N1);
+  }
+  pos = 0;
+  int my_num_sides = 0, num_sides;
+  assert_true(fe_mesh_next_side_set(mesh, &pos, &set_name, &set, &set_size));
+  assert_int_equal(0, strcmp(set_name, "bottom"));
+  for (size_t i = 0; i < set_size/2; ++i)
+  {
+    int E = (elem_gids != NULL) ? elem_gids[set[2*i]] : set[2*i];
+    assert_true(E < num_bottom);
+    assert_int_equal(5, set[2*i+1]);
+    found[num_left + E] = 1;
+    ++my_num_sides;
+  }
+  int all_found[num_left + num_bottom];
+  MPI_Allreduce(found, all_found, num_left + num_bottom, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+  MPI_Allreduce(&my_num_sides, &num_sides, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  for (int i = 0; i < num_left + num_bottom; ++i)
+    assert_int_equal(1, all_found[i]);
+  assert_int_equal(num_bottom, num_sides);
+
+  // Each top element is in the element set exactly once, on its owner.
+  pos = 0;
+  assert_true(fe_mesh_next_element_set(mesh, &pos, &set_name, &set, &set_size));
+  assert_int_equal(0, strcmp(set_name, "top"));
+  int my_num_top = 0, num_top;
+  for (size_t i = 0; i < set_size; ++i)
+  {
+    assert_true(set[i] < my_num_elem);
+    int E = (elem_gids != NULL) ? elem_gids[set[i]] : set[i];
+    assert_true(E >= nx*ny*(nz-1));
+    ++my_num_top;
+  }
+  for (int e = 0; e < my_num_elem; ++e)
+  {
+    int E = (elem_gids != NULL) ? elem_gids[e] : e;
+    if (E >= nx*ny*(nz-1))
+      --my_num_top;
+  }
+  assert_int_equal(0, my_num_top);
+  my_num_top = (int)set_size;
+  MPI_Allreduce(&my_num_top, &num_top, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  assert_int_equal(nx*ny, num_top);
+}
+
+static void test_read_distributed_exodus_file(void** state)
+{
+  write_hex_mesh("test-hex.exo");
+  exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, "test-hex.exo");
+  assert_true(file != NULL);
+  fe_mesh_t* mesh = exodus_file_read_distributed_mesh(file);
+  exodus_file_close(file);
+  check_hex_mesh(mesh, true);
+  fe_mesh_free(mesh);
+}
+
+static void test_write_distributed_exodus_file(void** state)
+{
+  exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, "test-hex.exo");
+  fe_mesh_t* mesh = exodus_file_read_distributed_mesh(file);
+  exodus_file_close(file);
+
+  // Each process writes its own portion of the mesh and of its fields over 
+  // two time steps.
+  file = exodus_file_new(MPI_COMM_WORLD, "test-hex-distributed.exo");
+  exodus_file_write_distributed_mesh(file, mesh);
+  string_array_t* node_fields = string_array_new();
+  string_array_append(node_fields, "temperature");
+  string_array_t* elem_fields = string_array_new();
+  string_array_append(elem_fields, "pressure");
+  exodus_file_define_fields(file, NULL, node_fields, elem_fields,
+                            NULL, NULL, NULL, NULL, NULL);
+  string_array_free(node_fields);
+  string_array_free(elem_fields);
+  int num_elem = fe_mesh_num_elements(mesh);
+  int num_owned_nodes = fe_mesh_num_owned_nodes(mesh);
+  const int* elem_gids = fe_mesh_element_global_ids(mesh);
+  const int* node_gids = fe_mesh_node_global_ids(mesh);
+  real_t T[num_owned_nodes+1], p[num_elem+1];
+  for (int t = 0; t < 2; ++t)
+  {
+    for (int n = 0; n < num_owned_nodes; ++n)
+      T[n] = 1.0 * ((node_gids != NULL) ? node_gids[n] : n) + t;
+    for (int e = 0; e < num_elem; ++e)
+      p[e] = 10.0 * ((elem_gids != NULL) ? elem_gids[e] : e) + t;
+    int time_index = exodus_file_write_time(file, 1.0*t);
+    exodus_file_write_node_field(file, time_index, "temperature", T);
+    exodus_file_write_element_field(file, time_index, "pressure", p);
+  }
+  exodus_file_close(file);
+  fe_mesh_free(mesh);
+
+  // Every process reads the mesh back and finds its portion intact, and
+  // the fields in global order.
+  file = exodus_file_open(MPI_COMM_WORLD, "test-hex-distributed.exo");
+  assert_true(file != NULL);
+  mesh = exodus_file_read_distributed_mesh(file);
+  check_hex_mesh(mesh, true);
+  fe_mesh_free(mesh);
+  real_t* T1 = exodus_file_read_node_field(file, 2, "temperature");
+  for (int n = 0; n < (nx+1)*(ny+1)*(nz+1); ++n)
+    assert_true(T1[n] == 1.0*n + 1.0);
+  polymec_free(T1);
+  real_t* p1 = exodus_file_read_element_field(file, 2, "pressure");
+  for (int e = 0; e < nx*ny*nz; ++e)
+    assert_true(p1[e] == 10.0*e + 1.0);
+  polymec_free(p1);
+  exodus_file_close(file);
+}
+
+static void test_decomposed_exodus_file(void** state)
+{
+  // A decomposed database's id maps hold global indices, so identifiers 
+  // don't survive the trip.
+  exodus_file_split(MPI_COMM_WORLD, "test-hex.exo", "test-hex-decomposed.exo");
+  exodus_file_t* file = exodus_file_open_decomposed(MPI_COMM_WORLD, "test-hex-decomposed.exo");
+  assert_true(file != NULL);
+  assert_int_equal(0, strcmp(exodus_file_title(file), "Hexahedra"));
+  fe_mesh_t* mesh = exodus_file_read_mesh(file);
+  exodus_file_close(file);
+  check_hex_mesh(mesh, false);
+  fe_mesh_free(mesh);
+
+  // Join the database back into a single file, in which the elements
+  // appear in their original order and the sets are whole again.
+  int rank, nprocs;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+  if (rank == 0)
+  {
+    assert_true(exodus_file_join("test-hex-decomposed.exo", nprocs, "test-hex-joined.exo"));
+    file = exodus_file_open(MPI_COMM_SELF, "test-hex-joined.exo");
+    assert_true(file != NULL);
+    mesh = exodus_file_read_mesh(file);
+    exodus_file_close(file);
+    assert_int_equal(nx*ny*nz, fe_mesh_num_elements(mesh));
+    assert_int_equal((nx+1)*(ny+1)*(nz+1), fe_mesh_num_nodes(mesh));
+    assert_int_equal(2, fe_mesh_num_blocks(mesh));
+    for (int e = 0; e < nx*ny*nz; ++e)
+    {
+      int elem_nodes[8];
+      fe_mesh_get_element_nodes(mesh, e, elem_nodes);
+      check_element_nodes(e, elem_nodes, NULL);
+    }
+    int pos = 0, *set;
+    size_t set_size;
+    char* set_name;
+    assert_true(fe_mesh_next_node_set(mesh, &pos, &set_name, &set, &set_size));
+    assert_int_equal(0, strcmp(set_name, "left"));
+    assert_int_equal((ny+1)*(nz+1), set_size);
+    for (size_t i = 0; i < set_size; ++i)
+      assert_int_equal(node_index(0, i % (ny+1), i / (ny+1)), set[i]);
+    pos = 0;
+    assert_true(fe_mesh_next_side_set(mesh, &pos, &set_name, &set, &set_size));
+    assert_int_equal(0, strcmp(set_name, "bottom"));
+    assert_int_equal(2*nx*ny, set_size);
+    for (int e = 0; e < nx*ny; ++e)
+    {
+      assert_int_equal(e, set[2*e]);
+      assert_int_equal(5, set[2*e+1]);
+    }
+    fe_mesh_free(mesh);
+  }
+}
+
+static void test_join_empty_block(void** state)
+{
+  // Give our hex mesh a block that stays empty in every file of a 
+  // decomposed database.
+  int rank, nprocs;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+  fe_mesh_t* mesh = NULL;
+  if (rank == 0)
+  {
+    exodus_file_t* file = exodus_file_open(MPI_COMM_SELF, "test-hex.exo");
+    fe_mesh_t* hex_mesh = exodus_file_read_mesh(file);
+    exodus_file_close(file);
+    mesh = fe_mesh_new(MPI_COMM_SELF, fe_mesh_num_nodes(hex_mesh));
+    memcpy(fe_mesh_node_positions(mesh), fe_mesh_node_positions(hex_mesh), 
+           sizeof(point_t) * fe_mesh_num_nodes(hex_mesh));
+    int pos = 0, no_nodes[1];
+    char* block_name;
+    fe_block_t* block;
+    while (fe_mesh_next_block(hex_mesh, &pos, &block_name, &block))
+    {
+      fe_mesh_add_block(mesh, block_name, fe_block_clone(block));
+      if (pos == 1)
+        fe_mesh_add_block(mesh, "empty", fe_block_new(0, FE_HEXAHEDRON, 8, no_nodes));
+    }
+    fe_mesh_free(hex_mesh);
+  }
+  partition_fe_mesh(&mesh, MPI_COMM_WORLD, NULL);
+  exodus_file_t* file = exodus_file_new_decomposed(MPI_COMM_WORLD, "test-hex-empty.exo");
+  exodus_file_write_mesh(file, mesh);
+  exodus_file_close(file);
+  fe_mesh_free(mesh);
+
+  // The joined mesh keeps the empty block and its element type.
+  if (rank == 0)
+  {
+    assert_true(exodus_file_join("test-hex-empty.exo", nprocs, "test-hex-empty-joined.exo"));
+    file = exodus_file_open(MPI_COMM_SELF, "test-hex-empty-joined.exo");
+    assert_true(file != NULL);
+    mesh = exodus_file_read_mesh(file);
+    exodus_file_close(file);
+    assert_int_equal(3, fe_mesh_num_blocks(mesh));
+    assert_int_equal(nx*ny*nz, fe_mesh_num_elements(mesh));
+    int pos = 0;
+    char* block_name;
+    fe_block_t* block;
+    fe_mesh_next_block(mesh, &pos, &block_name, &block);
+    fe_mesh_next_block(mesh, &pos, &block_name, &block);
+    assert_int_equal(0, strcmp(block_name, "empty"));
+    assert_int_equal(0, fe_block_num_elements(block));
+    assert_int_equal(FE_HEXAHEDRON, fe_block_element_type(block));
+    fe_mesh_free(mesh);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  polymec_init(argc, argv);
+  const struct CMUnitTest tests[] =
+  {
+    cmocka_unit_test(test_read_distributed_exodus_file),
+    cmocka_unit_test(test_write_distributed_exodus_file),
+    cmocka_unit_test(test_decomposed_exodus_file),
+    cmocka_unit_test(test_join_empty_block)
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
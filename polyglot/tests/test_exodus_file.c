@@ -10,6 +10,8 @@
 #include <setjmp.h>
 #include <string.h>
 #include "cmocka.h"
+#include "exodusII.h"
+#include "netcdf.h"
 #include "polyglot/exodus_file.h"
 
 static void test_exodus_file_query(void** state)
@@ -84,12 +86,28 @@ static void test_write_exodus_file(void** state)
   int* ss1 = fe_mesh_create_side_set(mesh, "sset_1", 1);
   ss1[0] = 0; ss1[1] = 5;
 
+  // Element and node identifiers.
+  int elem_ids[] = {10, 20, 30, 40};
+  fe_mesh_set_element_ids(mesh, elem_ids);
+  int node_ids[22];
+  for (int n = 0; n < 22; ++n)
+    node_ids[n] = 100 + 2*n;
+  fe_mesh_set_node_ids(mesh, node_ids);
+
   exodus_file_t* file = exodus_file_new(MPI_COMM_WORLD, "test-3d.exo");
   assert_true(file != NULL);
   exodus_file_set_title(file, "This is a test");
   exodus_file_write_mesh(file, mesh);
   exodus_file_close(file);
 
+  // New files store data at the precision of real_t.
+  size_t real_size;
+  float version;
+  int num_mpi_processes;
+  assert_true(exodus_file_query("test-3d.exo", &real_size, &version,
+                                &num_mpi_processes, NULL));
+  assert_true(real_size == sizeof(real_t));
+
   fe_mesh_free(mesh);
 }
 
@@ -108,6 +126,15 @@ static void test_read_exodus_file(void** state)
   assert_int_equal(2, fe_mesh_num_node_sets(mesh));
   assert_int_equal(1, fe_mesh_num_side_sets(mesh));
 
+  const int* elem_ids = fe_mesh_element_ids(mesh);
+  assert_true(elem_ids != NULL);
+  for (int e = 0; e < 4; ++e)
+    assert_int_equal(10*(e+1), elem_ids[e]);
+  const int* node_ids = fe_mesh_node_ids(mesh);
+  assert_true(node_ids != NULL);
+  for (int n = 0; n < 22; ++n)
+    assert_int_equal(100 + 2*n, node_ids[n]);
+
   int elem_nodes[10];
 
   assert_int_equal(8, fe_mesh_num_element_nodes(mesh, 0));
@@ -194,6 +221,750 @@ static void test_read_exodus_file(void** state)
   exodus_file_close(file);
 }
 
+static void test_read_fv_mesh_from_exodus_file(void** state)
+{
+  // The streaming importer should produce the same mesh as the conversion 
+  // of a finite element mesh.
+  exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, "test-3d.exo");
+  fe_mesh_t* fe_mesh = exodus_file_read_mesh(file);
+  mesh_t* mesh1 = mesh_from_fe_mesh(fe_mesh);
+  fe_mesh_free(fe_mesh);
+  mesh_t* mesh2 = exodus_file_read_fv_mesh(file);
+  exodus_file_close(file);
+
+  assert_int_equal(mesh1->num_cells, mesh2->num_cells);
+  assert_int_equal(0, mesh2->num_ghost_cells);
+  assert_int_equal(mesh1->num_faces, mesh2->num_faces);
+  assert_int_equal(mesh1->num_nodes, mesh2->num_nodes);
+  for (int c = 0; c <= mesh1->num_cells; ++c)
+    assert_int_equal(mesh1->cell_face_offsets[c], mesh2->cell_face_offsets[c]);
+  for (int i = 0; i < mesh1->cell_face_offsets[mesh1->num_cells]; ++i)
+    assert_int_equal(mesh1->cell_faces[i], mesh2->cell_faces[i]);
+  for (int f = 0; f <= mesh1->num_faces; ++f)
+    assert_int_equal(mesh1->face_node_offsets[f], mesh2->face_node_offsets[f]);
+  for (int i = 0; i < mesh1->face_node_offsets[mesh1->num_faces]; ++i)
+    assert_int_equal(mesh1->face_nodes[i], mesh2->face_nodes[i]);
+  for (int i = 0; i < 2*mesh1->num_faces; ++i)
+    assert_int_equal(mesh1->face_cells[i], mesh2->face_cells[i]);
+  for (int n = 0; n < mesh1->num_nodes; ++n)
+  {
+    assert_true(mesh1->nodes[n].x == mesh2->nodes[n].x);
+    assert_true(mesh1->nodes[n].y == mesh2->nodes[n].y);
+    assert_true(mesh1->nodes[n].z == mesh2->nodes[n].z);
+  }
+
+  // Node sets become node tags.
+  size_t tag_size;
+  int* tag = mesh_tag(mesh2->node_tags, "nset_1", &tag_size);
+  assert_true(tag != NULL);
+  assert_int_equal(5, tag_size);
+  assert_int_equal(1, tag[0]);
+  assert_int_equal(5, tag[4]);
+  tag = mesh_tag(mesh2->node_tags, "nset_2", &tag_size);
+  assert_true(tag != NULL);
+  assert_int_equal(3, tag_size);
+  assert_int_equal(11, tag[0]);
+
+  // Side sets become face tags. Side 5 of the hex is its 0th face.
+  tag = mesh_tag(mesh2->face_tags, "sset_1", &tag_size);
+  assert_true(tag != NULL);
+  assert_int_equal(1, tag_size);
+  assert_int_equal(mesh2->cell_faces[mesh2->cell_face_offsets[0]], tag[0]);
+
+  mesh_free(mesh1);
+  mesh_free(mesh2);
+}
+
+static void test_read_large_fv_mesh_from_exodus_file(void** state)
+{
+  // Build a box of nx x ny x nz cells whose lower layers are hexes (more 
+  // of them than fit in a single chunk) and whose top layer is made of 
+  // wedges.
+  int nx = 50, ny = 50, nz = 28;
+  int num_nodes = (nx+1)*(ny+1)*(nz+1);
+  int num_hexes = nx*ny*(nz-1), num_wedges = 2*nx*ny;
+  fe_mesh_t* fe_mesh = fe_mesh_new(MPI_COMM_WORLD, num_nodes);
+  int* hex_nodes = polymec_malloc(sizeof(int) * 8 * num_hexes);
+  int* wedge_nodes = polymec_malloc(sizeof(int) * 6 * num_wedges);
+  int h = 0, w = 0;
+  for (int k = 0; k < nz; ++k)
+  {
+    for (int j = 0; j < ny; ++j)
+    {
+      for (int i = 0; i < nx; ++i)
+      {
+        int n[8];
+        for (int l = 0; l < 2; ++l)
+        {
+          int n0 = (k+l)*(nx+1)*(ny+1) + j*(nx+1) + i;
+          n[4*l]   = n0;
+          n[4*l+1] = n0 + 1;
+          n[4*l+2] = n0 + nx + 2;
+          n[4*l+3] = n0 + nx + 1;
+        }
+        if (k < nz-1)
+        {
+          memcpy(&hex_nodes[8*h], n, sizeof(n));
+          ++h;
+        }
+        else
+        {
+          int wedges[12] = {n[0], n[1], n[2], n[4], n[5], n[6], 
+                            n[0], n[2], n[3], n[4], n[6], n[7]};
+          memcpy(&wedge_nodes[6*w], wedges, sizeof(wedges));
+          w += 2;
+        }
+      }
+    }
+  }
+  fe_mesh_add_block(fe_mesh, "hexes", fe_block_from_node_indices(num_hexes, FE_HEXAHEDRON, 8, hex_nodes));
+  fe_mesh_add_block(fe_mesh, "wedges", fe_block_from_node_indices(num_wedges, FE_WEDGE, 6, wedge_nodes));
+  point_t* X = fe_mesh_node_positions(fe_mesh);
+  for (int k = 0; k <= nz; ++k)
+  {
+    for (int j = 0; j <= ny; ++j)
+    {
+      for (int i = 0; i <= nx; ++i)
+      {
+        point_t* x = &X[k*(nx+1)*(ny+1) + j*(nx+1) + i];
+        x->x = 1.0*i; x->y = 1.0*j; x->z = 1.0*k;
+      }
+    }
+  }
+
+  // The bottoms (side 5) of the first row of hexes, and the tops (side 5) 
+  // of the last wedges.
+  int* ss = fe_mesh_create_side_set(fe_mesh, "bottom_and_top", 2*nx);
+  for (int i = 0; i < nx; ++i)
+  {
+    ss[2*i] = i; ss[2*i+1] = 5;
+    ss[2*(nx+i)] = num_hexes + num_wedges - 1 - i; ss[2*(nx+i)+1] = 5;
+  }
+  // The regular connectivity and coordinates of this mesh compress well.
+  exodus_file_t* file = exodus_file_new(MPI_COMM_WORLD, "test-large.exo");
+  exodus_file_set_compression(file, 4, true);
+  exodus_file_write_mesh(file, fe_mesh);
+  assert_true(exodus_file_compression_ratio(file) > 1.0);
+  exodus_file_close(file);
+  fe_mesh_free(fe_mesh);
+
+  // The streaming importer should agree with the finite element mesh 
+  // conversion.
+  file = exodus_file_open(MPI_COMM_WORLD, "test-large.exo");
+  fe_mesh = exodus_file_read_mesh(file);
+  mesh_t* mesh1 = mesh_from_fe_mesh(fe_mesh);
+  fe_mesh_free(fe_mesh);
+  mesh_t* mesh2 = exodus_file_read_fv_mesh(file);
+  exodus_file_close(file);
+
+  assert_int_equal(num_hexes + num_wedges, mesh2->num_cells);
+  assert_int_equal(mesh1->num_cells, mesh2->num_cells);
+  assert_int_equal(mesh1->num_faces, mesh2->num_faces);
+  assert_int_equal(mesh1->num_nodes, mesh2->num_nodes);
+  for (int c = 0; c <= mesh1->num_cells; ++c)
+    assert_int_equal(mesh1->cell_face_offsets[c], mesh2->cell_face_offsets[c]);
+  for (int i = 0; i < mesh1->cell_face_offsets[mesh1->num_cells]; ++i)
+    assert_int_equal(mesh1->cell_faces[i], mesh2->cell_faces[i]);
+  for (int f = 0; f <= mesh1->num_faces; ++f)
+    assert_int_equal(mesh1->face_node_offsets[f], mesh2->face_node_offsets[f]);
+  for (int i = 0; i < mesh1->face_node_offsets[mesh1->num_faces]; ++i)
+    assert_int_equal(mesh1->face_nodes[i], mesh2->face_nodes[i]);
+  for (int i = 0; i < 2*mesh1->num_faces; ++i)
+    assert_int_equal(mesh1->face_cells[i], mesh2->face_cells[i]);
+
+  // The side set's faces are boundary faces on the bottom and top.
+  size_t tag_size;
+  int* tag = mesh_tag(mesh2->face_tags, "bottom_and_top", &tag_size);
+  assert_true(tag != NULL);
+  assert_int_equal(2*nx, tag_size);
+  for (int i = 0; i < 2*nx; ++i)
+  {
+    int f = tag[i];
+    assert_int_equal(-1, mesh2->face_cells[2*f+1]);
+    double z = (i < nx) ? 0.0 : 1.0*nz;
+    for (int j = mesh2->face_node_offsets[f]; j < mesh2->face_node_offsets[f+1]; ++j)
+      assert_true(mesh2->nodes[mesh2->face_nodes[j]].z == z);
+  }
+
+  mesh_free(mesh1);
+  mesh_free(mesh2);
+}
+
+static void test_write_exodus_fields(void** state)
+{
+  exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, "test-3d.exo");
+  fe_mesh_t* mesh = exodus_file_read_mesh(file);
+  exodus_file_close(file);
+  int num_nodes = fe_mesh_num_nodes(mesh);
+  int num_elem = fe_mesh_num_elements(mesh);
+
+  // Write global fields, a node field, element fields, and a node set field 
+  // at two times.
+  file = exodus_file_new(MPI_COMM_WORLD, "test-3d-fields.exo");
+  exodus_file_set_compression(file, 4, true);
+  exodus_file_write_mesh(file, mesh);
+  string_array_t* global_fields = string_array_new();
+  string_array_append(global_fields, "energy");
+  string_array_append(global_fields, "dt");
+  string_array_t* node_fields = string_array_new();
+  string_array_append(node_fields, "temperature");
+  string_array_t* elem_fields = string_array_new();
+  string_array_append(elem_fields, "pressure");
+  string_array_append(elem_fields, "density");
+  string_array_t* node_set_fields = string_array_new();
+  string_array_append(node_set_fields, "flux");
+  exodus_file_define_fields(file, global_fields, node_fields, elem_fields, 
+                            NULL, NULL, node_set_fields, NULL, NULL);
+  string_array_free(global_fields);
+  string_array_free(node_fields);
+  string_array_free(elem_fields);
+  string_array_free(node_set_fields);
+  real_t T[num_nodes], p[num_elem], rho[num_elem], flux[8];
+  for (int t = 0; t < 2; ++t)
+  {
+    for (int n = 0; n < num_nodes; ++n)
+      T[n] = 1.0*n + t;
+    for (int e = 0; e < num_elem; ++e)
+    {
+      p[e] = 10.0*e + t;
+      rho[e] = 100.0*e + t;
+    }
+    for (int i = 0; i < 8; ++i)
+      flux[i] = 1000.0*i + t;
+    int time_index = exodus_file_write_time(file, 1.0*t);
+    real_t* node_data[] = {T};
+    real_t* elem_data[] = {p, rho};
+    real_t* node_set_data[] = {flux};
+    real_t globals[] = {5.0 + t, 0.5};
+    exodus_file_write_fields(file, time_index, globals, node_data, elem_data, 
+                             NULL, NULL, node_set_data, NULL, NULL);
+  }
+  exodus_file_close(file);
+  fe_mesh_free(mesh);
+
+  // The mesh and field variables should be deflated at the level we asked 
+  // for, with shuffling, and the fields should be chunked by time step.
+  int nc_id;
+  assert_int_equal(NC_NOERR, nc_open("test-3d-fields.exo", NC_NOWRITE, &nc_id));
+  const char* var_names[] = {"coordx", "vals_nod_var1", "vals_elem_var1eb1", "vals_nset_var1ns1"};
+  for (int i = 0; i < 4; ++i)
+  {
+    int var_id, shuffle, deflate, deflate_level;
+    assert_int_equal(NC_NOERR, nc_inq_varid(nc_id, var_names[i], &var_id));
+    assert_int_equal(NC_NOERR, nc_inq_var_deflate(nc_id, var_id, &shuffle, &deflate, &deflate_level));
+    assert_true(shuffle);
+    assert_true(deflate);
+    assert_int_equal(4, deflate_level);
+    if (i > 0)
+    {
+      int storage;
+      size_t chunks[2];
+      assert_int_equal(NC_NOERR, nc_inq_var_chunking(nc_id, var_id, &storage, chunks));
+      assert_int_equal(NC_CHUNKED, storage);
+      assert_int_equal(1, chunks[0]);
+    }
+  }
+  nc_close(nc_id);
+
+  // Read them back.
+  file = exodus_file_open(MPI_COMM_WORLD, "test-3d-fields.exo");
+  exodus_file_set_chunk_cache(file, 1 << 20);
+  assert_true(exodus_file_contains_node_field(file, 2, "temperature"));
+  assert_true(exodus_file_contains_element_field(file, 2, "density"));
+  assert_false(exodus_file_contains_element_field(file, 2, "temperature"));
+  assert_false(exodus_file_contains_face_field(file, 2, "pressure"));
+  assert_true(exodus_file_contains_global_field(file, "dt"));
+  assert_false(exodus_file_contains_global_field(file, "pressure"));
+  real_t* globals1 = exodus_file_read_global_fields(file, 2);
+  assert_true(globals1[0] == 6.0);
+  assert_true(globals1[1] == 0.5);
+  polymec_free(globals1);
+  real_t* energy = exodus_file_read_global_field_history(file, "energy", 1, 2);
+  assert_true(energy[0] == 5.0);
+  assert_true(energy[1] == 6.0);
+  polymec_free(energy);
+  real_t* T1 = exodus_file_read_node_field(file, 2, "temperature");
+  for (int n = 0; n < num_nodes; ++n)
+    assert_true(T1[n] == 1.0*n + 1.0);
+  polymec_free(T1);
+  real_t* rho1 = exodus_file_read_element_field(file, 2, "density");
+  for (int e = 0; e < num_elem; ++e)
+    assert_true(rho1[e] == 100.0*e + 1.0);
+  polymec_free(rho1);
+  real_t* flux0 = exodus_file_read_node_set_field(file, 1, "flux");
+  for (int i = 0; i < 8; ++i)
+    assert_true(flux0[i] == 1000.0*i);
+  polymec_free(flux0);
+  assert_true(exodus_file_read_element_field(file, 1, "viscosity") == NULL);
+
+  // Read portions of fields into our own buffers.
+  real_t data[num_nodes];
+  assert_true(exodus_file_read_element_field_range(file, 2, "pressure", 1, 3, data));
+  assert_true(data[0] == 11.0);
+  assert_true(data[1] == 21.0);
+  assert_true(exodus_file_read_element_block_field(file, 1, "density", "block_3", data));
+  assert_true(data[0] == 200.0);
+  assert_false(exodus_file_read_element_block_field(file, 1, "density", "block_5", data));
+  assert_true(exodus_file_read_node_field_range(file, 1, "temperature", 10, 22, data));
+  for (int n = 10; n < 22; ++n)
+    assert_true(data[n-10] == 1.0*n);
+  assert_true(exodus_file_read_node_field_on_set(file, 2, "temperature", "nset_2", data));
+  assert_true(data[0] == 12.0);
+  assert_true(data[1] == 13.0);
+  assert_true(data[2] == 14.0);
+  exodus_file_close(file);
+}
+
+static void check_fields_catalog(exodus_catalog_t* catalog)
+{
+  assert_true(catalog != NULL);
+  assert_int_equal(1, catalog->num_mpi_processes);
+  assert_int_equal(22, catalog->num_nodes);
+  assert_int_equal(4, catalog->num_elem);
+  assert_int_equal(2, catalog->num_node_sets);
+  assert_int_equal(1, catalog->num_side_sets);
+  assert_int_equal(4, catalog->num_elem_blocks);
+  assert_int_equal(FE_HEXAHEDRON, catalog->elem_block_types[0]);
+  assert_int_equal(FE_WEDGE, catalog->elem_block_types[2]);
+  assert_int_equal(1, catalog->elem_block_sizes[3]);
+  assert_int_equal(0, strcmp(catalog->elem_block_names->data[1], "block_2"));
+  assert_int_equal(2, catalog->global_fields->size);
+  assert_int_equal(0, strcmp(catalog->global_fields->data[1], "dt"));
+  assert_int_equal(1, catalog->node_fields->size);
+  assert_int_equal(0, strcmp(catalog->node_fields->data[0], "temperature"));
+  assert_int_equal(2, catalog->elem_fields->size);
+  assert_int_equal(0, strcmp(catalog->elem_fields->data[1], "density"));
+  assert_int_equal(0, catalog->elem_set_fields->size);
+  assert_int_equal(1, catalog->node_set_fields->size);
+  assert_int_equal(0, catalog->side_set_fields->size);
+  assert_int_equal(2, catalog->times->size);
+  assert_true(catalog->times->data[0] == 0.0);
+  assert_true(catalog->times->data[1] == 1.0);
+}
+
+// Overwrites bytes within the given catalog index.
+static void patch_catalog_index(const char* index_name, 
+                                long offset, 
+                                const void* data, 
+                                size_t size)
+{
+  FILE* f = fopen(index_name, "r+b");
+  assert_true(f != NULL);
+  assert_int_equal(0, fseek(f, offset, SEEK_SET));
+  assert_int_equal(size, fwrite(data, 1, size, f));
+  fclose(f);
+}
+
+static void test_exodus_file_catalog(void** state)
+{
+  assert_true(exodus_file_catalog("test.exo", false) == NULL); // 2D elements
+  assert_true(exodus_file_catalog("nonexistent.exo", true) == NULL);
+
+  // Read the catalog from the file itself.
+  remove("test-3d-fields.exo.catalog");
+  exodus_catalog_t* catalog = exodus_file_catalog("test-3d-fields.exo", false);
+  check_fields_catalog(catalog);
+  exodus_catalog_free(catalog);
+  assert_false(file_exists("test-3d-fields.exo.catalog"));
+
+  // Now write an index and read it back.
+  catalog = exodus_file_catalog("test-3d-fields.exo", true);
+  check_fields_catalog(catalog);
+  exodus_catalog_free(catalog);
+  assert_true(file_exists("test-3d-fields.exo.catalog"));
+  catalog = exodus_file_catalog("test-3d-fields.exo", true);
+  check_fields_catalog(catalog);
+  exodus_catalog_free(catalog);
+
+  // An index that doesn't match the file is replaced.
+  FILE* f = fopen("test-3d-fields.exo.catalog", "wb");
+  fputs("not a catalog", f);
+  fclose(f);
+  catalog = exodus_file_catalog("test-3d-fields.exo", true);
+  check_fields_catalog(catalog);
+  exodus_catalog_free(catalog);
+  catalog = exodus_file_catalog("test-3d-fields.exo", true);
+  check_fields_catalog(catalog);
+  exodus_catalog_free(catalog);
+
+  // An index holds a tag and 3 ints, a key of 3 size_ts (the seconds and 
+  // nanoseconds of the file's modification time, and its size), the real 
+  // size, the version, and then 9 counts, of which the last is the number 
+  // of element blocks.
+  long key_offset = 8 + 3*sizeof(int);
+  long counts_offset = key_offset + 4*sizeof(size_t) + sizeof(float);
+
+  // Show that the index is used by changing the number of nodes in it.
+  int num_nodes = 23;
+  patch_catalog_index("test-3d-fields.exo.catalog", 
+                      counts_offset + sizeof(int), &num_nodes, sizeof(int));
+  catalog = exodus_file_catalog("test-3d-fields.exo", true);
+  assert_int_equal(23, catalog->num_nodes);
+  exodus_catalog_free(catalog);
+
+  // An index for a file modified within the same second is replaced.
+  size_t nsec;
+  f = fopen("test-3d-fields.exo.catalog", "rb");
+  assert_int_equal(0, fseek(f, key_offset + sizeof(size_t), SEEK_SET));
+  assert_int_equal(1, fread(&nsec, sizeof(size_t), 1, f));
+  fclose(f);
+  nsec = (nsec + 1) % 1000000000;
+  patch_catalog_index("test-3d-fields.exo.catalog", 
+                      key_offset + sizeof(size_t), &nsec, sizeof(size_t));
+  catalog = exodus_file_catalog("test-3d-fields.exo", true);
+  check_fields_catalog(catalog);
+  exodus_catalog_free(catalog);
+
+  // So is an index with counts that don't fit within it.
+  int num_elem_blocks = 1 << 30;
+  patch_catalog_index("test-3d-fields.exo.catalog", 
+                      counts_offset + 8*sizeof(int), &num_elem_blocks, sizeof(int));
+  catalog = exodus_file_catalog("test-3d-fields.exo", true);
+  check_fields_catalog(catalog);
+  exodus_catalog_free(catalog);
+  catalog = exodus_file_catalog("test-3d-fields.exo", true);
+  check_fields_catalog(catalog);
+  exodus_catalog_free(catalog);
+}
+
+static void test_write_async_exodus_fields(void** state)
+{
+  exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, "test-3d.exo");
+  fe_mesh_t* mesh = exodus_file_read_mesh(file);
+  exodus_file_close(file);
+  int num_nodes = fe_mesh_num_nodes(mesh);
+  int num_elem = fe_mesh_num_elements(mesh);
+
+  // Stage no more than one field at a time, so that writes wait on the 
+  // I/O thread.
+  file = exodus_file_new(MPI_COMM_WORLD, "test-3d-async.exo");
+  exodus_file_enable_async_output(file, sizeof(real_t) * num_nodes);
+  exodus_file_write_mesh(file, mesh);
+  string_array_t* global_fields = string_array_new();
+  string_array_append(global_fields, "residual");
+  string_array_append(global_fields, "dt");
+  string_array_t* node_fields = string_array_new();
+  string_array_append(node_fields, "temperature");
+  string_array_t* elem_fields = string_array_new();
+  string_array_append(elem_fields, "pressure");
+  exodus_file_define_fields(file, global_fields, node_fields, elem_fields, 
+                            NULL, NULL, NULL, NULL, NULL);
+  string_array_free(global_fields);
+  string_array_free(node_fields);
+  string_array_free(elem_fields);
+  real_t T[num_nodes], p[num_elem];
+  for (int t = 0; t < 10; ++t)
+  {
+    int time_index = exodus_file_write_time(file, 1.0*t);
+    assert_int_equal(t+1, time_index);
+    for (int n = 0; n < num_nodes; ++n)
+      T[n] = 1.0*n + t;
+    for (int e = 0; e < num_elem; ++e)
+      p[e] = 10.0*e + t;
+    exodus_file_write_node_field(file, time_index, "temperature", T);
+    exodus_file_write_element_field(file, time_index, "pressure", p);
+    real_t globals[2] = {1.0 / (t+1), 0.1*t};
+    exodus_file_write_global_fields(file, time_index, globals);
+
+    // The field data is staged, so we can overwrite it.
+    for (int n = 0; n < num_nodes; ++n)
+      T[n] = -1.0;
+    for (int e = 0; e < num_elem; ++e)
+      p[e] = -1.0;
+    globals[0] = globals[1] = -1.0;
+  }
+  exodus_file_flush(file);
+  exodus_file_close(file);
+  fe_mesh_free(mesh);
+
+  file = exodus_file_open(MPI_COMM_WORLD, "test-3d-async.exo");
+  for (int t = 0; t < 10; ++t)
+  {
+    real_t* T1 = exodus_file_read_node_field(file, t+1, "temperature");
+    for (int n = 0; n < num_nodes; ++n)
+      assert_true(T1[n] == 1.0*n + t);
+    polymec_free(T1);
+    real_t* p1 = exodus_file_read_element_field(file, t+1, "pressure");
+    for (int e = 0; e < num_elem; ++e)
+      assert_true(p1[e] == 10.0*e + t);
+    polymec_free(p1);
+    real_t* globals1 = exodus_file_read_global_fields(file, t+1);
+    assert_true(globals1[0] == 1.0 / (t+1));
+    assert_true(globals1[1] == 0.1*t);
+    polymec_free(globals1);
+  }
+
+  // Read the history of a couple of elements.
+  int elems[2] = {3, 0};
+  real_t* p_hist = exodus_file_read_element_field_history(file, "pressure", 
+                                                          elems, 2, 2, 10);
+  for (int t = 1; t < 10; ++t)
+  {
+    assert_true(p_hist[2*(t-1)] == 30.0 + t);
+    assert_true(p_hist[2*(t-1)+1] == 1.0*t);
+  }
+  polymec_free(p_hist);
+  real_t* r_hist = exodus_file_read_global_field_history(file, "residual", 1, 10);
+  for (int t = 0; t < 10; ++t)
+    assert_true(r_hist[t] == 1.0 / (t+1));
+  polymec_free(r_hist);
+  assert_true(exodus_file_read_node_field_history(file, "pressure", 
+                                                  elems, 2, 1, 10) == NULL);
+  exodus_file_close(file);
+
+  // Face fields live on the face block of a polyhedral mesh.
+  file = exodus_file_open(MPI_COMM_WORLD, "test-nfaced.exo");
+  mesh = exodus_file_read_mesh(file);
+  exodus_file_close(file);
+  int num_faces = fe_mesh_num_faces(mesh);
+  file = exodus_file_new(MPI_COMM_WORLD, "test-nfaced-async.exo");
+  exodus_file_enable_async_output(file, sizeof(real_t) * num_faces);
+  exodus_file_write_mesh(file, mesh);
+  string_array_t* face_fields = string_array_new();
+  string_array_append(face_fields, "flux");
+  exodus_file_define_fields(file, NULL, NULL, NULL, face_fields, 
+                            NULL, NULL, NULL, NULL);
+  string_array_free(face_fields);
+  real_t F[num_faces];
+  for (int t = 0; t < 4; ++t)
+  {
+    int time_index = exodus_file_write_time(file, 1.0*t);
+    for (int f = 0; f < num_faces; ++f)
+      F[f] = 100.0*f + t;
+    exodus_file_write_face_field(file, time_index, "flux", F);
+    for (int f = 0; f < num_faces; ++f)
+      F[f] = -1.0;
+  }
+  exodus_file_close(file);
+  fe_mesh_free(mesh);
+
+  file = exodus_file_open(MPI_COMM_WORLD, "test-nfaced-async.exo");
+  for (int t = 0; t < 4; ++t)
+  {
+    real_t* F1 = exodus_file_read_face_field(file, t+1, "flux");
+    for (int f = 0; f < num_faces; ++f)
+      assert_true(F1[f] == 100.0*f + t);
+    polymec_free(F1);
+  }
+  exodus_file_close(file);
+
+  // We don't write edge blocks, so we append edge fields to a file with a 
+  // tetrahedron and an edge block of its 6 edges.
+  int ex_real_size = (int)sizeof(real_t), io_real_size = (int)sizeof(real_t);
+  int ex_id = ex_create("test-edges-async.exo", EX_CLOBBER, 
+                        &ex_real_size, &io_real_size);
+  ex_init_params params;
+  memset(&params, 0, sizeof(ex_init_params));
+  strcpy(params.title, "Edges");
+  params.num_dim = 3;
+  params.num_nodes = 4;
+  params.num_edge = 6;
+  params.num_edge_blk = 1;
+  params.num_elem = 1;
+  params.num_elem_blk = 1;
+  ex_put_init_ext(ex_id, &params);
+  real_t x[4] = {0.0, 1.0, 0.0, 0.0}, y[4] = {0.0, 0.0, 1.0, 0.0}, 
+         z[4] = {0.0, 0.0, 0.0, 1.0};
+  ex_put_coord(ex_id, x, y, z);
+  int tet_nodes[4] = {1, 2, 3, 4};
+  ex_put_block(ex_id, EX_ELEM_BLOCK, 1, "TETRA", 1, 4, 0, 0, 0);
+  ex_put_conn(ex_id, EX_ELEM_BLOCK, 1, tet_nodes, NULL, NULL);
+  int edge_nodes[12] = {1, 2, 2, 3, 3, 1, 1, 4, 2, 4, 3, 4};
+  ex_put_block(ex_id, EX_EDGE_BLOCK, 1, "EDGE2", 6, 2, 0, 0, 0);
+  ex_put_conn(ex_id, EX_EDGE_BLOCK, 1, edge_nodes, NULL, NULL);
+  ex_close(ex_id);
+
+  file = exodus_file_open_for_append(MPI_COMM_WORLD, "test-edges-async.exo");
+  exodus_file_enable_async_output(file, sizeof(real_t) * 6);
+  string_array_t* edge_fields = string_array_new();
+  string_array_append(edge_fields, "circulation");
+  exodus_file_define_fields(file, NULL, NULL, NULL, NULL, 
+                            edge_fields, NULL, NULL, NULL);
+  string_array_free(edge_fields);
+  real_t G[6];
+  for (int t = 0; t < 4; ++t)
+  {
+    int time_index = exodus_file_write_time(file, 1.0*t);
+    for (int i = 0; i < 6; ++i)
+      G[i] = 1.0*i + 0.5*t;
+    exodus_file_write_edge_field(file, time_index, "circulation", G);
+    for (int i = 0; i < 6; ++i)
+      G[i] = -1.0;
+  }
+
+  // Reading from the file waits for its pending output.
+  real_t* G1 = exodus_file_read_edge_field(file, 4, "circulation");
+  for (int i = 0; i < 6; ++i)
+    assert_true(G1[i] == 1.0*i + 1.5);
+  polymec_free(G1);
+  exodus_file_close(file);
+
+  file = exodus_file_open(MPI_COMM_WORLD, "test-edges-async.exo");
+  for (int t = 0; t < 4; ++t)
+  {
+    G1 = exodus_file_read_edge_field(file, t+1, "circulation");
+    for (int i = 0; i < 6; ++i)
+      assert_true(G1[i] == 1.0*i + 0.5*t);
+    polymec_free(G1);
+  }
+  exodus_file_close(file);
+}
+
+static void test_write_single_precision_exodus_fields(void** state)
+{
+  exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, "test-3d.exo");
+  fe_mesh_t* mesh = exodus_file_read_mesh(file);
+  exodus_file_close(file);
+  int num_elem = fe_mesh_num_elements(mesh);
+
+  file = exodus_file_new_single_precision(MPI_COMM_WORLD, "test-3d-float.exo");
+  exodus_file_write_mesh(file, mesh);
+  string_array_t* elem_fields = string_array_new();
+  string_array_append(elem_fields, "pressure");
+  exodus_file_define_fields(file, NULL, NULL, elem_fields, NULL, NULL, NULL, NULL, NULL);
+  string_array_free(elem_fields);
+  real_t p[num_elem];
+  for (int e = 0; e < num_elem; ++e)
+    p[e] = 0.1 * e;
+  int time_index = exodus_file_write_time(file, 0.1);
+  exodus_file_write_element_field(file, time_index, "pressure", p);
+  exodus_file_close(file);
+
+  size_t real_size;
+  float version;
+  int num_mpi_processes;
+  assert_true(exodus_file_query("test-3d-float.exo", &real_size, &version,
+                                &num_mpi_processes, NULL));
+  assert_true(real_size == sizeof(float));
+
+  // Fields come back rounded to single precision.
+  file = exodus_file_open(MPI_COMM_WORLD, "test-3d-float.exo");
+  fe_mesh_t* mesh1 = exodus_file_read_mesh(file);
+  assert_int_equal(num_elem, fe_mesh_num_elements(mesh1));
+  real_t* p1 = exodus_file_read_element_field(file, 1, "pressure");
+  for (int e = 0; e < num_elem; ++e)
+    assert_true(p1[e] == (real_t)((float)(0.1 * e)));
+  polymec_free(p1);
+  exodus_file_close(file);
+  fe_mesh_free(mesh1);
+  fe_mesh_free(mesh);
+}
+
+static void test_append_exodus_fields(void** state)
+{
+  exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, "test-3d.exo");
+  fe_mesh_t* mesh = exodus_file_read_mesh(file);
+  exodus_file_close(file);
+  int num_elem = fe_mesh_num_elements(mesh);
+
+  file = exodus_file_new(MPI_COMM_WORLD, "test-3d-restart.exo");
+  exodus_file_write_mesh(file, mesh);
+  string_array_t* elem_fields = string_array_new();
+  string_array_append(elem_fields, "pressure");
+  exodus_file_define_fields(file, NULL, NULL, elem_fields, NULL, NULL, NULL, NULL, NULL);
+  string_array_free(elem_fields);
+  real_t p[num_elem];
+  for (int t = 0; t < 5; ++t)
+  {
+    int time_index = exodus_file_write_time(file, 1.0*t);
+    for (int e = 0; e < num_elem; ++e)
+      p[e] = 10.0*e + t;
+    exodus_file_write_element_field(file, time_index, "pressure", p);
+  }
+  exodus_file_close(file);
+  fe_mesh_free(mesh);
+
+  // Restart from t = 2.5, rewriting the later steps without the mesh.
+  file = exodus_file_open_for_append(MPI_COMM_WORLD, "test-3d-restart.exo");
+  assert_true(exodus_file_contains_element_field(file, 1, "pressure"));
+  assert_int_equal(3, exodus_file_truncate(file, 2.5));
+  for (int t = 3; t < 5; ++t)
+  {
+    int time_index = exodus_file_write_time(file, 1.0*t);
+    assert_int_equal(t+1, time_index);
+    for (int e = 0; e < num_elem; ++e)
+      p[e] = -10.0*e - t;
+    exodus_file_write_element_field(file, time_index, "pressure", p);
+  }
+  exodus_file_close(file);
+
+  // Appending without truncating adds steps after the last one.
+  file = exodus_file_open_for_append(MPI_COMM_WORLD, "test-3d-restart.exo");
+  int time_index = exodus_file_write_time(file, 5.0);
+  assert_int_equal(6, time_index);
+  for (int e = 0; e < num_elem; ++e)
+    p[e] = 5.0;
+  exodus_file_write_element_field(file, time_index, "pressure", p);
+  exodus_file_close(file);
+
+  file = exodus_file_open(MPI_COMM_WORLD, "test-3d-restart.exo");
+  int pos = 0, index;
+  real_t time;
+  for (int t = 0; t < 6; ++t)
+  {
+    assert_true(exodus_file_next_time(file, &pos, &index, &time));
+    assert_true(time == 1.0*t);
+    real_t* p1 = exodus_file_read_element_field(file, index, "pressure");
+    for (int e = 0; e < num_elem; ++e)
+    {
+      real_t p_expected = (t < 3) ? 10.0*e + t : (t < 5) ? -10.0*e - t : 5.0;
+      assert_true(p1[e] == p_expected);
+    }
+    polymec_free(p1);
+  }
+  assert_false(exodus_file_next_time(file, &pos, &index, &time));
+  exodus_file_close(file);
+
+  // Restarting from t = 2.5 again, but writing only one step, leaves stale 
+  // steps at the end of the file, which readers should ignore.
+  file = exodus_file_open_for_append(MPI_COMM_WORLD, "test-3d-restart.exo");
+  assert_int_equal(3, exodus_file_truncate(file, 2.5));
+  time_index = exodus_file_write_time(file, 3.5);
+  assert_int_equal(4, time_index);
+  exodus_file_write_element_field(file, time_index, "pressure", p);
+  exodus_file_close(file);
+  file = exodus_file_open(MPI_COMM_WORLD, "test-3d-restart.exo");
+  pos = 0;
+  for (int t = 0; t < 4; ++t)
+  {
+    assert_true(exodus_file_next_time(file, &pos, &index, &time));
+    assert_true(time == ((t < 3) ? 1.0*t : 3.5));
+  }
+  assert_false(exodus_file_next_time(file, &pos, &index, &time));
+  exodus_file_close(file);
+  real_array_t* times = real_array_new();
+  size_t real_size;
+  float version;
+  int num_procs;
+  assert_true(exodus_file_query("test-3d-restart.exo", &real_size, &version, &num_procs, times));
+  assert_int_equal(4, times->size);
+  real_array_free(times);
+  exodus_catalog_t* catalog = exodus_file_catalog("test-3d-restart.exo", false);
+  assert_int_equal(4, catalog->times->size);
+  exodus_catalog_free(catalog);
+
+  // Appending picks up after the valid steps.
+  file = exodus_file_open_for_append(MPI_COMM_WORLD, "test-3d-restart.exo");
+  assert_int_equal(5, exodus_file_write_time(file, 4.5));
+  exodus_file_close(file);
+  file = exodus_file_open(MPI_COMM_WORLD, "test-3d-restart.exo");
+  pos = 0;
+  for (int t = 0; t < 5; ++t)
+    assert_true(exodus_file_next_time(file, &pos, &index, &time));
+  assert_true(time == 4.5);
+  assert_false(exodus_file_next_time(file, &pos, &index, &time));
+  exodus_file_close(file);
+
+  // Appending doesn't add QA records to the one written with the file.
+  int cpu_word_size = 0, io_word_size = 0;
+  float ex_version;
+  int ex_id = ex_open("test-3d-restart.exo", EX_READ, &cpu_word_size, 
+                      &io_word_size, &ex_version);
+  assert_true(ex_id >= 0);
+  assert_int_equal(1, ex_inquire_int(ex_id, EX_INQ_QA));
+  ex_close(ex_id);
+}
+
 static void test_read_poly_exodus_file(void** state)
 {
   exodus_file_t* file = exodus_file_open(MPI_COMM_WORLD, "test-nfaced.exo");
@@ -296,6 +1067,13 @@ int main(int argc, char* argv[])
     cmocka_unit_test(test_exodus_file_query),
     cmocka_unit_test(test_write_exodus_file),
     cmocka_unit_test(test_read_exodus_file),
+    cmocka_unit_test(test_read_fv_mesh_from_exodus_file),
+    cmocka_unit_test(test_read_large_fv_mesh_from_exodus_file),
+    cmocka_unit_test(test_write_exodus_fields),
+    cmocka_unit_test(test_exodus_file_catalog),
+    cmocka_unit_test(test_write_async_exodus_fields),
+    cmocka_unit_test(test_write_single_precision_exodus_fields),
+    cmocka_unit_test(test_append_exodus_fields),
     cmocka_unit_test(test_read_poly_exodus_file),
     cmocka_unit_test(test_write_poly_exodus_file)
   };
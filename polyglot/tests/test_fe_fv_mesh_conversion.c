@@ -10,8 +10,12 @@
 #include <setjmp.h>
 #include <string.h>
 #include "cmocka.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "geometry/create_uniform_mesh.h"
 #include "polyglot/exodus_file.h"
+#include "hex_fe_mesh.h"
 
 static void test_mesh_from_fe_mesh(void** state)
 {
@@ -28,6 +32,87 @@ static void test_mesh_from_fe_mesh(void** state)
   mesh_free(fv_mesh);
 }
 
+static void test_mesh_from_hex_fe_mesh(void** state)
+{
+  // Two hexahedra sharing a single face, with nodes n = i + 3*j + 6*k.
+  int elem_nodes[16] = {0, 1, 4, 3, 6, 7, 10, 9,
+                        1, 2, 5, 4, 7, 8, 11, 10};
+  fe_mesh_t* fe_mesh = fe_mesh_new(MPI_COMM_WORLD, 12);
+  fe_mesh_add_block(fe_mesh, "hexes", fe_block_new(2, FE_HEXAHEDRON, 8, elem_nodes));
+  point_t* x = fe_mesh_node_positions(fe_mesh);
+  for (int n = 0; n < 12; ++n)
+  {
+    x[n].x = 1.0 * (n % 3);
+    x[n].y = 1.0 * ((n / 3) % 2);
+    x[n].z = 1.0 * (n / 6);
+  }
+  mesh_t* fv_mesh = mesh_from_fe_mesh(fe_mesh);
+  fe_mesh_free(fe_mesh);
+  assert_int_equal(2, fv_mesh->num_cells);
+  assert_int_equal(11, fv_mesh->num_faces);
+
+  // Faces are numbered in the order in which they're first encountered, so 
+  // the shared face is the 5th face of the first hex and the last face of the 
+  // second.
+  int cell_faces[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 4};
+  for (int f = 0; f < 12; ++f)
+    assert_int_equal(cell_faces[f], fv_mesh->cell_faces[f]);
+  assert_int_equal(0, fv_mesh->face_cells[2*4]);
+  assert_int_equal(1, fv_mesh->face_cells[2*4+1]);
+  assert_int_equal(-1, fv_mesh->face_cells[2*10+1]);
+
+  // The shared face takes its nodes from the first hex.
+  int shared_face_nodes[4] = {1, 4, 10, 7};
+  assert_int_equal(4, fv_mesh->face_node_offsets[5] - fv_mesh->face_node_offsets[4]);
+  for (int n = 0; n < 4; ++n)
+    assert_int_equal(shared_face_nodes[n], fv_mesh->face_nodes[fv_mesh->face_node_offsets[4]+n]);
+  mesh_free(fv_mesh);
+}
+
+static void test_threaded_mesh_from_fe_mesh(void** state)
+{
+  // The conversion should produce exactly the same mesh no matter how many 
+  // threads do the work.
+  fe_mesh_t* fe_mesh = create_hex_fe_mesh(MPI_COMM_WORLD, 16, 16, 16, 16*16*16/2);
+#ifdef _OPENMP
+  int max_num_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  mesh_t* mesh1 = mesh_from_fe_mesh(fe_mesh);
+#ifdef _OPENMP
+  omp_set_num_threads(4);
+#endif
+  mesh_t* mesh2 = mesh_from_fe_mesh(fe_mesh);
+#ifdef _OPENMP
+  omp_set_num_threads(max_num_threads);
+#endif
+  fe_mesh_free(fe_mesh);
+
+  assert_int_equal(16*16*16, mesh1->num_cells);
+  assert_int_equal(3*16*16*17, mesh1->num_faces);
+  assert_int_equal(mesh1->num_cells, mesh2->num_cells);
+  assert_int_equal(mesh1->num_faces, mesh2->num_faces);
+  assert_int_equal(mesh1->num_nodes, mesh2->num_nodes);
+  for (int c = 0; c <= mesh1->num_cells; ++c)
+    assert_int_equal(mesh1->cell_face_offsets[c], mesh2->cell_face_offsets[c]);
+  for (int i = 0; i < mesh1->cell_face_offsets[mesh1->num_cells]; ++i)
+    assert_int_equal(mesh1->cell_faces[i], mesh2->cell_faces[i]);
+  for (int f = 0; f <= mesh1->num_faces; ++f)
+    assert_int_equal(mesh1->face_node_offsets[f], mesh2->face_node_offsets[f]);
+  for (int i = 0; i < mesh1->face_node_offsets[mesh1->num_faces]; ++i)
+    assert_int_equal(mesh1->face_nodes[i], mesh2->face_nodes[i]);
+  for (int i = 0; i < 2*mesh1->num_faces; ++i)
+    assert_int_equal(mesh1->face_cells[i], mesh2->face_cells[i]);
+  for (int n = 0; n < mesh1->num_nodes; ++n)
+  {
+    assert_true(mesh1->nodes[n].x == mesh2->nodes[n].x);
+    assert_true(mesh1->nodes[n].y == mesh2->nodes[n].y);
+    assert_true(mesh1->nodes[n].z == mesh2->nodes[n].z);
+  }
+  mesh_free(mesh1);
+  mesh_free(mesh2);
+}
+
 static void test_fe_mesh_from_mesh(void** state)
 {
   bbox_t bbox = {.x1 = 0.0, .x2 = 1.0,
@@ -49,6 +134,8 @@ int main(int argc, char* argv[])
   const struct CMUnitTest tests[] = 
   {
     cmocka_unit_test(test_mesh_from_fe_mesh),
+    cmocka_unit_test(test_mesh_from_hex_fe_mesh),
+    cmocka_unit_test(test_threaded_mesh_from_fe_mesh),
     cmocka_unit_test(test_fe_mesh_from_mesh)
   };
   return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,310 @@
+// Copyright (c) 2015-2016, Jeffrey N. Johnson
+// All rights reserved.
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include "cmocka.h"
+#include "polyglot/fe_mesh.h"
+
+// Creates a mesh with 3 blocks of 2, 3, and 1 tetrahedra (whose nodes are 
+// nonsense, but distinct).
+static fe_mesh_t* create_test_mesh()
+{
+  fe_mesh_t* mesh = fe_mesh_new(MPI_COMM_WORLD, 24);
+  int block1_nodes[] = {0, 1, 2, 3, 4, 5, 6, 7};
+  fe_mesh_add_block(mesh, "block_1", fe_block_new(2, FE_TETRAHEDRON, 4, block1_nodes));
+  int block2_nodes[] = {8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+  fe_mesh_add_block(mesh, "block_2", fe_block_new(3, FE_TETRAHEDRON, 4, block2_nodes));
+  int block3_nodes[] = {20, 21, 22, 23};
+  fe_mesh_add_block(mesh, "block_3", fe_block_new(1, FE_TETRAHEDRON, 4, block3_nodes));
+  return mesh;
+}
+
+static void test_fe_mesh_element_lookup(void** state)
+{
+  fe_mesh_t* mesh = create_test_mesh();
+  assert_int_equal(6, fe_mesh_num_elements(mesh));
+
+  // Each element's nodes should start at 4 times its mesh index.
+  int elem_nodes[4];
+  for (int e = 0; e < 6; ++e)
+  {
+    assert_int_equal(4, fe_mesh_num_element_nodes(mesh, e));
+    fe_mesh_get_element_nodes(mesh, e, elem_nodes);
+    for (int n = 0; n < 4; ++n)
+      assert_int_equal(4*e+n, elem_nodes[n]);
+  }
+
+  // Check the block-local indices of elements on block boundaries.
+  int block_elems[6] = {0, 1, 0, 1, 2, 0};
+  int block_index = 0, pos = 0;
+  char* block_name;
+  fe_block_t* blocks[3];
+  while (fe_mesh_next_block(mesh, &pos, &block_name, &blocks[block_index]))
+    ++block_index;
+  fe_block_t* elem_blocks[6] = {blocks[0], blocks[0], blocks[1], 
+                                blocks[1], blocks[1], blocks[2]};
+  for (int e = 0; e < 6; ++e)
+  {
+    int be;
+    fe_block_t* block = fe_mesh_element_block(mesh, e, &be);
+    assert_true(block == elem_blocks[e]);
+    assert_int_equal(block_elems[e], be);
+  }
+
+  fe_mesh_free(mesh);
+}
+
+static void test_fe_mesh_block_ranges(void** state)
+{
+  fe_mesh_t* mesh = create_test_mesh();
+  int pos = 0, first_elem, end_elem, num_elem = 0;
+  int first_elems[3] = {0, 2, 5}, end_elems[3] = {2, 5, 6};
+  fe_block_t* block;
+  while (fe_mesh_next_block_range(mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    assert_int_equal(first_elems[pos-1], first_elem);
+    assert_int_equal(end_elems[pos-1], end_elem);
+    assert_int_equal(end_elem - first_elem, fe_block_num_elements(block));
+    num_elem += end_elem - first_elem;
+  }
+  assert_int_equal(3, pos);
+  assert_int_equal(fe_mesh_num_elements(mesh), num_elem);
+  fe_mesh_free(mesh);
+}
+
+static void test_fe_mesh_connectivity_views(void** state)
+{
+  fe_mesh_t* mesh = create_test_mesh();
+
+  // Element views should point into their block's node array.
+  int pos = 0, first_elem, end_elem;
+  fe_block_t* block;
+  while (fe_mesh_next_block_range(mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    const int *elem_node_offsets, *elem_nodes;
+    fe_block_get_node_connectivity(block, &elem_node_offsets, &elem_nodes);
+    assert_true(elem_nodes != NULL);
+    for (int e = first_elem; e < end_elem; ++e)
+    {
+      int num_nodes;
+      const int* nodes = fe_mesh_element_nodes(mesh, e, &num_nodes);
+      assert_int_equal(4, num_nodes);
+      assert_true(nodes == &elem_nodes[elem_node_offsets[e-first_elem]]);
+      assert_int_equal(4*e, nodes[0]);
+    }
+
+    // Tetrahedral blocks have no element->face connectivity.
+    const int *elem_face_offsets, *elem_faces;
+    fe_block_get_face_connectivity(block, &elem_face_offsets, &elem_faces);
+    assert_true(elem_faces == NULL);
+    int num_faces;
+    assert_true(fe_block_element_faces(block, 0, &num_faces) == NULL);
+    assert_int_equal(-1, num_faces);
+  }
+
+  // Face views.
+  int num_face_nodes[2] = {3, 4};
+  int face_nodes[7] = {0, 1, 2, 3, 4, 5, 6};
+  fe_mesh_set_face_nodes(mesh, 2, num_face_nodes, face_nodes);
+  int num_nodes;
+  const int* f1_nodes = fe_mesh_face_nodes(mesh, 1, &num_nodes);
+  assert_int_equal(4, num_nodes);
+  assert_int_equal(3, f1_nodes[0]);
+  assert_int_equal(6, f1_nodes[3]);
+  const int *face_node_offsets, *all_face_nodes;
+  fe_mesh_get_face_node_connectivity(mesh, &face_node_offsets, &all_face_nodes);
+  assert_int_equal(7, face_node_offsets[2]);
+  assert_true(f1_nodes == &all_face_nodes[face_node_offsets[1]]);
+
+  fe_mesh_free(mesh);
+
+  // A block can take ownership of its element->node connectivity.
+  int* conn = polymec_malloc(sizeof(int) * 8);
+  for (int i = 0; i < 8; ++i)
+    conn[i] = 7 - i;
+  fe_block_t* owner = fe_block_from_node_indices(2, FE_TETRAHEDRON, 4, conn);
+  const int *elem_node_offsets, *elem_nodes;
+  fe_block_get_node_connectivity(owner, &elem_node_offsets, &elem_nodes);
+  assert_true(elem_nodes == conn);
+  assert_int_equal(4, elem_node_offsets[1]);
+  assert_int_equal(8, elem_node_offsets[2]);
+  assert_int_equal(2, fe_block_num_elements(owner));
+  assert_int_equal(FE_TETRAHEDRON, fe_block_element_type(owner));
+  fe_block_free(owner);
+}
+
+static void test_fe_mesh_serialization(void** state)
+{
+  fe_mesh_t* mesh = create_test_mesh();
+  int num_elem_faces[1] = {4};
+  int elem_faces[4] = {0, 1, 2, 3};
+  fe_mesh_add_block(mesh, "polyhedra", polyhedral_fe_block_new(1, num_elem_faces, elem_faces));
+  int num_face_nodes[4] = {3, 3, 3, 3};
+  int face_nodes[12] = {0, 1, 2, 0, 1, 3, 1, 2, 3, 2, 0, 3};
+  fe_mesh_set_face_nodes(mesh, 4, num_face_nodes, face_nodes);
+  point_t* x = fe_mesh_node_positions(mesh);
+  for (int n = 0; n < 24; ++n)
+    x[n].x = x[n].y = x[n].z = 1.0 * n;
+  int* elem_set = fe_mesh_create_element_set(mesh, "elems", 2);
+  elem_set[0] = 1; elem_set[1] = 4;
+  int* side_set = fe_mesh_create_side_set(mesh, "sides", 1);
+  side_set[0] = 6; side_set[1] = 2;
+
+  // Write the mesh to bytes and read it back.
+  serializer_t* s = fe_mesh_serializer();
+  byte_array_t* bytes = byte_array_new();
+  size_t offset = 0;
+  serializer_write(s, mesh, bytes, &offset);
+  assert_int_equal(serializer_size(s, mesh), offset);
+  offset = 0;
+  fe_mesh_t* mesh1 = serializer_read(s, bytes, &offset);
+  assert_int_equal(bytes->size, offset);
+  byte_array_free(bytes);
+
+  // Check the contents.
+  assert_int_equal(24, fe_mesh_num_nodes(mesh1));
+  assert_int_equal(4, fe_mesh_num_blocks(mesh1));
+  assert_int_equal(7, fe_mesh_num_elements(mesh1));
+  assert_int_equal(4, fe_mesh_num_faces(mesh1));
+  point_t* x1 = fe_mesh_node_positions(mesh1);
+  for (int n = 0; n < 24; ++n)
+    assert_true(x1[n].z == 1.0 * n);
+  for (int e = 0; e < 6; ++e)
+  {
+    int num_nodes;
+    const int* nodes = fe_mesh_element_nodes(mesh1, e, &num_nodes);
+    assert_int_equal(4, num_nodes);
+    assert_int_equal(4*e+3, nodes[3]);
+  }
+  int num_faces;
+  const int* faces = fe_mesh_element_faces(mesh1, 6, &num_faces);
+  assert_int_equal(4, num_faces);
+  assert_int_equal(3, faces[3]);
+  int num_nodes;
+  const int* f3_nodes = fe_mesh_face_nodes(mesh1, 3, &num_nodes);
+  assert_int_equal(3, num_nodes);
+  assert_int_equal(2, f3_nodes[0]);
+  int pos = 0;
+  char* block_name;
+  fe_block_t* block;
+  while (fe_mesh_next_block(mesh1, &pos, &block_name, &block));
+  assert_int_equal(0, strcmp(block_name, "polyhedra"));
+  assert_int_equal(FE_POLYHEDRON, fe_block_element_type(block));
+
+  int* set;
+  size_t set_size;
+  char* set_name;
+  pos = 0;
+  assert_true(fe_mesh_next_element_set(mesh1, &pos, &set_name, &set, &set_size));
+  assert_int_equal(0, strcmp(set_name, "elems"));
+  assert_int_equal(2, set_size);
+  assert_int_equal(4, set[1]);
+  pos = 0;
+  assert_true(fe_mesh_next_side_set(mesh1, &pos, &set_name, &set, &set_size));
+  assert_int_equal(2, set_size);
+  assert_int_equal(6, set[0]);
+  assert_int_equal(2, set[1]);
+  assert_int_equal(0, fe_mesh_num_node_sets(mesh1));
+
+  fe_mesh_free(mesh1);
+  fe_mesh_free(mesh);
+}
+
+static void test_fe_mesh_clone(void** state)
+{
+  // Give our mesh sets, identifiers, and (on a single process, empty) ghost 
+  // blocks, global indices, and halos.
+  fe_mesh_t* mesh = create_test_mesh();
+  int* elem_set = fe_mesh_create_element_set(mesh, "elems", 2);
+  elem_set[0] = 1; elem_set[1] = 4;
+  int* node_set = fe_mesh_create_node_set(mesh, "nodes", 1);
+  node_set[0] = 23;
+  int elem_gids[6], node_gids[24];
+  for (int e = 0; e < 6; ++e)
+    elem_gids[e] = e;
+  for (int n = 0; n < 24; ++n)
+    node_gids[n] = n;
+  fe_mesh_add_ghosts(&mesh, elem_gids, node_gids);
+  int elem_ids[6], node_ids[24];
+  for (int e = 0; e < 6; ++e)
+    elem_ids[e] = 100 + e;
+  for (int n = 0; n < 24; ++n)
+    node_ids[n] = 2*n + 1;
+  fe_mesh_set_element_ids(mesh, elem_ids);
+  fe_mesh_set_node_ids(mesh, node_ids);
+
+  // The clone has all of it, and survives the original.
+  fe_mesh_t* copy = fe_mesh_clone(mesh);
+  fe_mesh_free(mesh);
+  assert_int_equal(3, fe_mesh_num_blocks(copy));
+  assert_int_equal(6, fe_mesh_num_elements(copy));
+  assert_int_equal(0, fe_mesh_num_ghost_elements(copy));
+  assert_int_equal(24, fe_mesh_num_owned_nodes(copy));
+  int pos = 0, first_elem, end_elem, num_ghost_blocks = 0;
+  fe_block_t* block;
+  while (fe_mesh_next_ghost_block_range(copy, &pos, &block, &first_elem, &end_elem))
+  {
+    assert_int_equal(6, first_elem);
+    assert_int_equal(6, end_elem);
+    ++num_ghost_blocks;
+  }
+  assert_int_equal(3, num_ghost_blocks);
+  int elem_nodes[4];
+  for (int e = 0; e < 6; ++e)
+  {
+    fe_mesh_get_element_nodes(copy, e, elem_nodes);
+    assert_int_equal(4*e, elem_nodes[0]);
+    assert_int_equal(e, fe_mesh_element_global_ids(copy)[e]);
+    assert_int_equal(100 + e, fe_mesh_element_ids(copy)[e]);
+  }
+  for (int n = 0; n < 24; ++n)
+  {
+    assert_int_equal(n, fe_mesh_node_global_ids(copy)[n]);
+    assert_int_equal(2*n + 1, fe_mesh_node_ids(copy)[n]);
+  }
+  int* set;
+  size_t set_size;
+  char* set_name;
+  pos = 0;
+  assert_true(fe_mesh_next_element_set(copy, &pos, &set_name, &set, &set_size));
+  assert_int_equal(0, strcmp(set_name, "elems"));
+  assert_int_equal(2, set_size);
+  assert_int_equal(4, set[1]);
+  pos = 0;
+  assert_true(fe_mesh_next_node_set(copy, &pos, &set_name, &set, &set_size));
+  assert_int_equal(1, set_size);
+  assert_int_equal(23, set[0]);
+
+  // Its halos work.
+  int ids[7];
+  memcpy(ids, fe_mesh_element_ids(copy), sizeof(int) * 6);
+  exchanger_exchange(fe_mesh_element_exchanger(copy), ids, 1, 0, MPI_INT);
+  assert_int_equal(105, ids[5]);
+
+  // A clone of the clone frees cleanly, too.
+  fe_mesh_t* copy1 = fe_mesh_clone(copy);
+  fe_mesh_free(copy);
+  assert_int_equal(6, fe_mesh_num_elements(copy1));
+  fe_mesh_free(copy1);
+}
+
+int main(int argc, char* argv[]) 
+{
+  polymec_init(argc, argv);
+  const struct CMUnitTest tests[] = 
+  {
+    cmocka_unit_test(test_fe_mesh_element_lookup),
+    cmocka_unit_test(test_fe_mesh_block_ranges),
+    cmocka_unit_test(test_fe_mesh_connectivity_views),
+    cmocka_unit_test(test_fe_mesh_serialization),
+    cmocka_unit_test(test_fe_mesh_clone)
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,175 @@
+// Copyright (c) 2015-2016, Jeffrey N. Johnson
+// All rights reserved.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include "cmocka.h"
+#include "hex_fe_mesh.h"
+
+// Number of hexahedra in each direction in our test mesh.
+static const int nx = 4, ny = 3, nz = 2;
+
+// Creates our hex mesh on rank 0 of MPI_COMM_WORLD, with its bottom layer 
+// of elements in the "lower" block and in an element set, a node set 
+// containing the nodes at x = 0, and element and node identifiers that 
+// differ from their indices. Returns NULL on other ranks.
+static fe_mesh_t* create_hex_mesh()
+{
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if (rank != 0)
+    return NULL;
+
+  fe_mesh_t* mesh = create_hex_fe_mesh(MPI_COMM_WORLD, nx, ny, nz, nx*ny);
+  int* elem_set = fe_mesh_create_element_set(mesh, "bottom", nx*ny);
+  for (int e = 0; e < nx*ny; ++e)
+    elem_set[e] = e;
+  int* node_set = fe_mesh_create_node_set(mesh, "west", (ny+1)*(nz+1));
+  for (int n = 0; n < (ny+1)*(nz+1); ++n)
+    node_set[n] = (nx+1)*n;
+
+  int num_elem = nx*ny*nz, num_nodes = (nx+1)*(ny+1)*(nz+1);
+  int elem_ids[num_elem], node_ids[num_nodes];
+  for (int e = 0; e < num_elem; ++e)
+    elem_ids[e] = 1000 + 2*e;
+  fe_mesh_set_element_ids(mesh, elem_ids);
+  for (int n = 0; n < num_nodes; ++n)
+    node_ids[n] = 5000 + 3*n;
+  fe_mesh_set_node_ids(mesh, node_ids);
+  return mesh;
+}
+
+static int global_sum(int value)
+{
+  int sum;
+  MPI_Allreduce(&value, &sum, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+  return sum;
+}
+
+static void test_partition_fe_mesh(void** state)
+{
+  fe_mesh_t* mesh = create_hex_mesh();
+  partition_fe_mesh(&mesh, MPI_COMM_WORLD, NULL);
+
+  int nprocs;
+  MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+  int num_elem = fe_mesh_num_elements(mesh);
+  int num_ghosts = fe_mesh_num_ghost_elements(mesh);
+  int num_nodes = fe_mesh_num_nodes(mesh);
+  int num_owned_nodes = fe_mesh_num_owned_nodes(mesh);
+  assert_int_equal(nx*ny*nz, global_sum(num_elem));
+  assert_int_equal((nx+1)*(ny+1)*(nz+1), global_sum(num_owned_nodes));
+  if (nprocs == 1)
+  {
+    assert_int_equal(0, num_ghosts);
+    assert_int_equal(num_nodes, num_owned_nodes);
+  }
+  else
+    assert_true(global_sum(num_ghosts) > 0);
+
+  // Each element set and node set should be distributed intact.
+  int pos = 0, *set;
+  size_t set_size;
+  char* set_name;
+  assert_true(fe_mesh_next_element_set(mesh, &pos, &set_name, &set, &set_size));
+  assert_int_equal(0, strcmp(set_name, "bottom"));
+  assert_int_equal(nx*ny, global_sum((int)set_size));
+  pos = 0;
+  assert_true(fe_mesh_next_node_set(mesh, &pos, &set_name, &set, &set_size));
+  assert_int_equal(0, strcmp(set_name, "west"));
+  point_t* x = fe_mesh_node_positions(mesh);
+  for (size_t i = 0; i < set_size; ++i)
+    assert_true(x[set[i]].x == 0.0);
+
+  // Ghost elements should refer to nodes within the mesh.
+  int first_elem, end_elem;
+  fe_block_t* block;
+  pos = 0;
+  while (fe_mesh_next_ghost_block_range(mesh, &pos, &block, &first_elem, &end_elem))
+  {
+    assert_true(first_elem >= num_elem);
+    assert_true(end_elem <= num_elem + num_ghosts);
+    const int *elem_node_offsets, *elem_nodes;
+    fe_block_get_node_connectivity(block, &elem_node_offsets, &elem_nodes);
+    for (int i = 0; i < elem_node_offsets[end_elem-first_elem]; ++i)
+      assert_true((elem_nodes[i] >= 0) && (elem_nodes[i] < num_nodes));
+  }
+
+  // Exchanging global indices should fill in those of ghost elements and
+  // nodes.
+  const int* elem_ids = fe_mesh_element_global_ids(mesh);
+  real_t elem_data[num_elem + num_ghosts];
+  for (int e = 0; e < num_elem + num_ghosts; ++e)
+    elem_data[e] = (e < num_elem) ? 1.0 * elem_ids[e] : -1.0;
+  exchanger_exchange(fe_mesh_element_exchanger(mesh), elem_data, 1, 0, MPI_REAL_T);
+  for (int e = num_elem; e < num_elem + num_ghosts; ++e)
+    assert_true(elem_data[e] == 1.0 * elem_ids[e]);
+
+  const int* node_ids = fe_mesh_node_global_ids(mesh);
+  real_t node_data[num_nodes];
+  for (int n = 0; n < num_nodes; ++n)
+    node_data[n] = (n < num_owned_nodes) ? 1.0 * node_ids[n] : -1.0;
+  exchanger_exchange(fe_mesh_node_exchanger(mesh), node_data, 1, 0, MPI_REAL_T);
+  for (int n = num_owned_nodes; n < num_nodes; ++n)
+    assert_true(node_data[n] == 1.0 * node_ids[n]);
+
+  // Element and node identifiers should follow their elements and nodes, 
+  // ghosts included.
+  const int* elem_labels = fe_mesh_element_ids(mesh);
+  assert_true(elem_labels != NULL);
+  for (int e = 0; e < num_elem + num_ghosts; ++e)
+    assert_int_equal(1000 + 2*elem_ids[e], elem_labels[e]);
+  const int* node_labels = fe_mesh_node_ids(mesh);
+  assert_true(node_labels != NULL);
+  for (int n = 0; n < num_nodes; ++n)
+    assert_int_equal(5000 + 3*node_ids[n], node_labels[n]);
+
+  fe_mesh_free(mesh);
+}
+
+static void test_distributed_fe_mesh_conversion(void** state)
+{
+  fe_mesh_t* fe_mesh = create_hex_mesh();
+  partition_fe_mesh(&fe_mesh, MPI_COMM_WORLD, NULL);
+  mesh_t* mesh = mesh_from_fe_mesh(fe_mesh);
+  assert_int_equal(fe_mesh_num_elements(fe_mesh), mesh->num_cells);
+  assert_int_equal(fe_mesh_num_ghost_elements(fe_mesh), mesh->num_ghost_cells);
+  assert_int_equal(nx*ny*nz, global_sum(mesh->num_cells));
+
+  // Every face is attached to an owned cell. Faces shared between processes 
+  // are attached to a ghost cell on each side, so they're counted twice in 
+  // the global number of interior faces.
+  int num_interior_faces = 0, num_ghost_faces = 0;
+  for (int f = 0; f < mesh->num_faces; ++f)
+  {
+    assert_true(mesh->face_cells[2*f] < mesh->num_cells);
+    assert_true(mesh->face_cells[2*f+1] < mesh->num_cells + mesh->num_ghost_cells);
+    if (mesh->face_cells[2*f+1] != -1)
+      ++num_interior_faces;
+    if (mesh->face_cells[2*f+1] >= mesh->num_cells)
+      ++num_ghost_faces;
+  }
+  int num_global_interior_faces = (nx-1)*ny*nz + nx*(ny-1)*nz + nx*ny*(nz-1);
+  assert_int_equal(num_global_interior_faces + global_sum(num_ghost_faces)/2, 
+                   global_sum(num_interior_faces));
+
+  mesh_free(mesh);
+  fe_mesh_free(fe_mesh);
+}
+
+int main(int argc, char* argv[])
+{
+  polymec_init(argc, argv);
+  const struct CMUnitTest tests[] =
+  {
+    cmocka_unit_test(test_partition_fe_mesh),
+    cmocka_unit_test(test_distributed_fe_mesh_conversion)
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}